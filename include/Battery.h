@@ -29,6 +29,7 @@ private:
     Task _loopTask;
     mutable std::mutex _mutex;
     std::unique_ptr<BatteryProvider> _upProvider = nullptr;
+    uint32_t _lastUpdateNotified = 0;
 };
 
 extern BatteryClass Battery;
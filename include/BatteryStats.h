@@ -16,6 +16,7 @@ class BatteryStats {
 
         // the last time *any* data was updated
         uint32_t getAgeSeconds() const { return (millis() - _lastUpdate) / 1000; }
+        uint32_t getLastUpdate() const { return _lastUpdate; }
         bool updateAvailable(uint32_t since) const;
 
         uint8_t getSoC() const { return _soc; }
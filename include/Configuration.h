@@ -41,6 +41,7 @@
 #define POWERMETER_MQTT_MAX_VALUES 3
 #define POWERMETER_HTTP_JSON_MAX_VALUES 3
 #define POWERMETER_HTTP_JSON_MAX_PATH_STRLEN 256
+#define POWERMETER_HTTP_SML_MAX_VALUES 2
 #define BATTERY_JSON_MAX_PATH_STRLEN 128
 
 struct CHANNEL_CONFIG_T {
@@ -120,9 +121,17 @@ struct POWERMETER_HTTP_JSON_CONFIG_T {
 };
 using PowerMeterHttpJsonConfig = struct POWERMETER_HTTP_JSON_CONFIG_T;
 
+struct POWERMETER_HTTP_SML_VALUE_T {
+    HttpRequestConfig HttpRequest;
+    bool Enabled;
+    bool SignInverted;
+};
+using PowerMeterHttpSmlValue = struct POWERMETER_HTTP_SML_VALUE_T;
+
+// the readings of all enabled meters are added up
 struct POWERMETER_HTTP_SML_CONFIG_T {
     uint32_t PollingInterval;
-    HttpRequestConfig HttpRequest;
+    PowerMeterHttpSmlValue Values[POWERMETER_HTTP_SML_MAX_VALUES];
 };
 using PowerMeterHttpSmlConfig = struct POWERMETER_HTTP_SML_CONFIG_T;
 
@@ -172,6 +181,7 @@ struct CONFIG_T {
         bool Retain;
         uint32_t PublishInterval;
         bool CleanSession;
+        uint8_t PayloadMode; // see MqttPublisherClass::PayloadMode
 
         struct {
             char Topic[MQTT_MAX_TOPIC_STRLEN + 1];
@@ -188,6 +198,13 @@ struct CONFIG_T {
             bool Expire;
         } Hass;
 
+        struct {
+            bool Enabled;
+            float Deadband; // percent of the last published value
+            float AbsoluteDeadband; // in the unit of the value
+            uint32_t RefreshInterval; // s
+        } ChangeFilter;
+
         struct {
             bool Enabled;
             char RootCaCert[MQTT_MAX_CERT_STRLEN + 1];
@@ -200,6 +217,7 @@ struct CONFIG_T {
     struct {
         uint64_t Serial;
         uint32_t PollInterval;
+        bool ParallelPolling;
         struct {
             uint8_t PaLevel;
         } Nrf;
@@ -238,6 +256,11 @@ struct CONFIG_T {
         bool UpdatesOnly;
     } Vedirect;
 
+    struct {
+        bool Enabled;
+        uint16_t Interval; // minutes
+    } EnergyLog;
+
     struct PowerMeterConfig {
         bool Enabled;
         bool VerboseLogging;
@@ -258,10 +281,14 @@ struct CONFIG_T {
         bool IsInverterBehindPowerMeter;
         bool IsInverterSolarPowered;
         bool UseOverscalingToCompensateShading;
+        bool DistributeOverAllInverters;
         uint64_t InverterId;
         uint8_t InverterChannelId;
         int32_t TargetPowerConsumption;
         int32_t TargetPowerConsumptionHysteresis;
+        uint8_t ControllerMode;
+        float ControllerKp;
+        float ControllerKi;
         int32_t LowerPowerLimit;
         int32_t BaseLoadLimit;
         int32_t UpperPowerLimit;
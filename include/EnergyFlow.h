@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <ArduinoJson.h>
+#include <cstdint>
+#include <frozen/string.h>
+
+// decides whether surplus power is used to charge the battery using the
+// Huawei PSU or whether the inverters may discharge the battery. both
+// subsystems act on the same decision, which is made once per power meter
+// reading, such that they neither fight nor react at different rates.
+class EnergyFlowClass {
+public:
+    enum class Direction : uint8_t {
+        Idle = 0, // transition in progress, neither charging nor discharging
+        Charge = 1,
+        Discharge = 2
+    };
+
+    // the values are exported as metric, hence they must not change
+    enum class Reason : uint8_t {
+        Initializing = 0,
+        PsuNotAutomatic = 1,
+        NoPowerMeter = 2,
+        FullSolarPassthrough = 3,
+        SocStopThreshold = 4,
+        Surplus = 5,
+        NoSurplus = 6,
+        InverterStopping = 7,
+        PsuStopping = 8
+    };
+
+    struct Decision {
+        Direction direction = Direction::Discharge;
+        Reason reason = Reason::Initializing;
+
+        // power the PSU shall output in W (only valid when charging)
+        float chargePower = 0;
+
+        // the power meter reading the decision is based on
+        float gridPower = 0;
+        uint32_t meterMillis = 0;
+
+        uint32_t decisionMillis = 0;
+    };
+
+    // returns the current decision, which is re-evaluated if a new power
+    // meter reading arrived or if the decision is older than one second.
+    Decision const& getDecision();
+
+    // the most recent decision, without re-evaluating it
+    Decision const& getLastDecision() const { return _decision; }
+
+    static frozen::string const& getDirectionText(Direction direction);
+    static frozen::string const& getReasonText(Reason reason);
+
+    void toJson(JsonObject root) const;
+
+private:
+    void evaluate();
+    void decide(Direction direction, Reason reason, float chargePower = 0);
+
+    Decision _decision;
+};
+
+extern EnergyFlowClass EnergyFlow;
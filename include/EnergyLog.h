@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <TaskSchedulerDeclarations.h>
+#include <frozen/string.h>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+
+// the LittleFS partition is only 192 kB, shared with the config. appending is
+// stopped if the raw log exceeds its maximum size or if less than the reserve
+// is left on the file system.
+#ifndef ENERGYLOG_RAW_MAX_SIZE
+#define ENERGYLOG_RAW_MAX_SIZE (48 * 1024)
+#endif
+
+#ifndef ENERGYLOG_FREE_SPACE_RESERVE
+#define ENERGYLOG_FREE_SPACE_RESERVE (32 * 1024)
+#endif
+
+#ifndef ENERGYLOG_DAILY_RETENTION
+#define ENERGYLOG_DAILY_RETENTION 93 // days
+#endif
+
+#define ENERGYLOG_MIN_INTERVAL 5U // minutes
+#define ENERGYLOG_MAX_INTERVAL 60U // minutes
+
+// persists energy counters on LittleFS. the raw log is appended to at the
+// configured interval with the counter values of all sources, only changed
+// values are written. once a day has passed, its records are compacted into
+// the energy per source of that day (daily log) and added to the month's
+// energy (monthly log). all logs consist of fixed-size records.
+class EnergyLogClass {
+public:
+    enum class Source : uint8_t {
+        Inverter = 0, // index is the inverter's config slot
+        Mppt, // index is the charge controller
+        BatteryCharge,
+        BatteryDischarge,
+        GridImport,
+        GridExport
+    };
+
+    enum class Resolution : uint8_t {
+        Raw = 0,
+        Day,
+        Month
+    };
+
+    // raw records hold the counter value in Wh at the timestamp (unix time),
+    // daily and monthly records hold the energy in Wh of the day or month
+    // starting at the timestamp (local midnight). monthly records remember
+    // the last day of the month (1..31) whose energy is included, such that
+    // repeating an interrupted compaction does not count a day twice.
+    struct __attribute__((packed)) Record {
+        uint32_t timestamp;
+        Source source;
+        uint8_t index;
+        uint16_t lastDay;
+        uint32_t value;
+    };
+    static_assert(sizeof(Record) == 12, "energy log record size changed");
+
+    // a position within a log. appending keeps cursors valid, compaction
+    // rewrites the logs and ends reading with outdated cursors.
+    struct Cursor {
+        Resolution resolution;
+        uint32_t from;
+        uint32_t to;
+        size_t offset;
+        uint32_t generation;
+    };
+
+    EnergyLogClass();
+    void init(Scheduler& scheduler);
+
+    Cursor getCursor(Resolution resolution, uint32_t from, uint32_t to) const;
+
+    // copies up to count records with a timestamp within [from, to) into
+    // records and advances the cursor. returns 0 once all were read.
+    size_t read(Cursor& cursor, Record* records, size_t count) const;
+
+    static frozen::string const& getSourceName(Source source);
+    static std::optional<Resolution> resolutionFromName(char const* name);
+
+private:
+    void loop();
+    void integrate();
+    void append(uint32_t timestamp);
+    void compact(uint32_t today);
+    void appendDays(std::map<std::pair<uint32_t, uint16_t>, uint32_t> const& days);
+    void mergeMonths(std::map<std::pair<uint32_t, uint16_t>, uint32_t> const& days);
+    void applyRetention(uint32_t today);
+    void loadCounters();
+    bool replace(char const* filename);
+
+    static uint32_t getDayStart(uint32_t timestamp);
+    static uint32_t getMonthStart(uint32_t timestamp);
+    static uint8_t getDayOfMonth(uint32_t timestamp);
+    static uint16_t getKey(Source source, uint8_t index);
+    static char const* getFilename(Resolution resolution);
+
+    Task _loopTask;
+
+    mutable std::mutex _mutex;
+    uint32_t _generation = 0;
+
+    // energy integrated from power readings, in Wh. continued from the last
+    // logged values after a reboot.
+    std::map<uint16_t, double> _integrated;
+    uint32_t _lastIntegration = 0;
+
+    std::map<uint16_t, uint32_t> _lastLogged;
+    uint32_t _lastSlot = 0;
+    uint32_t _lastCompaction = 0;
+    bool _warnedFull = false;
+};
+
+extern EnergyLogClass EnergyLog;
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <ArduinoJson.h>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// publishes the Home Assistant discovery configs of a handler in slices, such
+// that (re-)connecting to the broker does not block the scheduler for long.
+// the handler enumerates all of its entities in every slice and asks claim()
+// whether to publish the respective entity: entities claimed in previous
+// slices are skipped, and at most SliceSize entities are published per
+// slice. the job is done once a slice did not have to skip an entity for
+// lack of budget. configs are not published again if they did not change
+// since they were last published as retained messages.
+class HassDiscoveryJob {
+public:
+    static constexpr size_t SliceSize = 4; // entities
+
+    // starts publishing all entities anew. forgets which configs were
+    // published before if requested, such that they are published again
+    // even if they did not change.
+    void restart(bool forget = false);
+    bool isPending() const { return _pending; }
+
+    void beginSlice();
+    void endSlice();
+
+    // to be called for every entity, before building its config. returns
+    // true if the entity shall be published within the current slice.
+    // entities are identified by their position in the enumeration, which
+    // must not change while the job is pending.
+    bool claim();
+
+    // same as above, for handlers whose entities may come and go between
+    // slices, e.g., as data of a device becomes available. entities are
+    // identified by the device and the entity name.
+    bool claim(char const* device, char const* entity);
+
+    // publishes the config below the Home Assistant base topic
+    void publish(String const& subtopic, JsonDocument const& config);
+
+    // removes the entity from Home Assistant
+    void clear(String const& subtopic);
+
+private:
+    bool claim(uint32_t key);
+    bool isDue(String const& subtopic, uint32_t payloadHash);
+    static void send(String const& subtopic, String const& payload);
+
+    bool _pending = false;
+    bool _budgetExceeded = false; // within the current slice
+    size_t _index = 0; // entities enumerated within the current slice
+    size_t _sliceClaims = 0; // entities claimed within the current slice
+
+    // keys of the entities claimed since the job was (re-)started, sorted
+    std::vector<uint32_t> _claimed;
+
+    // hashes of the topics and payloads published, sorted by topic hash
+    std::vector<std::pair<uint32_t, uint32_t>> _published;
+};
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include "TimeSeries.h"
+#include <TaskSchedulerDeclarations.h>
+#include <frozen/string.h>
+#include <array>
+#include <optional>
+
+// number of buckets of the history tiers (10 s, 1 min and 15 min), about
+// 5.8 kB per series. these tiers are only used if the board has PSRAM. the
+// buffers of a series are only allocated once its data source delivered
+// data.
+#ifndef HISTORY_TIER_10S_SIZE
+#define HISTORY_TIER_10S_SIZE 180
+#endif
+
+#ifndef HISTORY_TIER_1MIN_SIZE
+#define HISTORY_TIER_1MIN_SIZE 600
+#endif
+
+#ifndef HISTORY_TIER_15MIN_SIZE
+#define HISTORY_TIER_15MIN_SIZE 192
+#endif
+
+// without PSRAM, only the AC power is recorded for the display's diagram,
+// using 30 buckets of 1 min and HISTORY_INTERNAL_5MIN_SIZE buckets of 5 min.
+#ifndef HISTORY_INTERNAL_5MIN_SIZE
+#define HISTORY_INTERNAL_5MIN_SIZE 128
+#endif
+
+class HistoryClass {
+public:
+    enum class Series : uint8_t {
+        AcPower = 0,
+        DcPower,
+        BatterySoC,
+        BatteryVoltage,
+        BatteryCurrent,
+        MeterPower,
+        PowerLimit
+    };
+    static constexpr size_t SeriesCount = 7;
+
+    HistoryClass();
+    void init(Scheduler& scheduler);
+
+    TimeSeries const& get(Series series) const;
+
+    // seconds since boot, the time base of all series
+    static uint32_t now();
+
+    static frozen::string const& getName(Series series);
+    static std::optional<Series> fromName(char const* name);
+
+private:
+    void loop();
+
+    Task _loopTask;
+
+    std::array<TimeSeries, SeriesCount> _series;
+};
+
+extern HistoryClass History;
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <ArduinoJson.h>
+#include <Print.h>
+#include <cstdint>
+#include <type_traits>
+
+// writes a JSON document piece by piece, such that a large response does not
+// need to be built in memory as a whole. the structure (objects and arrays)
+// is written explicitly, the values are small ArduinoJson documents or plain
+// values. the output may be changed between calls, e.g., for every chunk of
+// a chunked response. keys are written as given, i.e., they must not need
+// escaping. documents can be nested at most 32 levels deep.
+class JsonStreamWriter {
+public:
+    void setOutput(Print* out) { _out = out; }
+
+    // the key is required within objects and ignored within arrays
+    void beginObject(char const* key = nullptr);
+    void endObject();
+    void beginArray(char const* key = nullptr);
+    void endArray();
+
+    void add(char const* key, JsonVariantConst value);
+    void add(JsonVariantConst value) { add(nullptr, value); }
+
+    void add(char const* key, char const* value)
+    {
+        JsonDocument doc;
+        doc.set(value);
+        add(key, doc.as<JsonVariantConst>());
+    }
+
+    template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    void add(char const* key, T value)
+    {
+        JsonDocument doc;
+        doc.set(value);
+        add(key, doc.as<JsonVariantConst>());
+    }
+
+    // writes all members of the object into the current object
+    void merge(JsonObjectConst object);
+
+private:
+    void separate(char const* key);
+
+    Print* _out = nullptr;
+    uint8_t _depth = 0;
+    uint32_t _inObject = 0; // bit per level
+    uint32_t _hasMembers = 0; // bit per level
+};
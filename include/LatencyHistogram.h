@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <ArduinoJson.h>
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+// histogram with logarithmic buckets. the upper bound of bucket i is 2^i,
+// the last bucket collects all values exceeding the largest bound. the
+// unit of the recorded values is up to the user (ms, us, ...).
+class LatencyHistogram {
+public:
+    static constexpr size_t BucketCount = 17;
+
+    // consistent copy of the bucket counts, e.g., for exporting them
+    struct Snapshot {
+        std::array<uint32_t, BucketCount> buckets;
+        uint32_t count;
+        uint64_t sum;
+    };
+
+    // the last bucket has no upper bound
+    static uint32_t getUpperBound(size_t bucket) { return 1UL << bucket; }
+
+    void record(uint32_t value);
+    void reset();
+
+    uint32_t getCount() const;
+    uint32_t getMax() const;
+    uint32_t getMean() const;
+    Snapshot getSnapshot() const;
+
+    // returns the upper bound of the bucket containing the given percentile
+    uint32_t getPercentile(float percentile) const;
+
+    // adds a summary and, optionally, the bucket counts to the given object
+    void toJson(JsonObject obj, bool withBuckets) const;
+
+private:
+    uint32_t getPercentileUnlocked(float percentile) const;
+
+    mutable std::mutex _mutex;
+    std::array<uint32_t, BucketCount> _buckets = {};
+    uint32_t _count = 0;
+    uint64_t _sum = 0;
+    uint32_t _min = 0;
+    uint32_t _max = 0;
+};
@@ -5,10 +5,27 @@
 #include <TaskSchedulerDeclarations.h>
 #include <Print.h>
 #include <freertos/task.h>
+#include <array>
+#include <atomic>
 #include <mutex>
-#include <vector>
-#include <unordered_map>
-#include <queue>
+
+// size of the ring buffer holding completed lines until they are written to
+// the serial console and the websocket. if it is full because the websocket
+// clients do not keep up, their oldest lines are dropped. lines for the
+// serial console are not dropped, writing waits for the console instead.
+#ifndef MESSAGE_OUTPUT_BUFFER_SIZE
+#define MESSAGE_OUTPUT_BUFFER_SIZE 4096
+#endif
+
+// number of tasks which can assemble a line at the same time
+#ifndef MESSAGE_OUTPUT_TASK_SLOTS
+#define MESSAGE_OUTPUT_TASK_SLOTS 8
+#endif
+
+// longer lines are forwarded in pieces of this size
+#ifndef MESSAGE_OUTPUT_LINE_SIZE
+#define MESSAGE_OUTPUT_LINE_SIZE 256
+#endif
 
 class MessageOutputClass : public Print {
 public:
@@ -18,24 +35,58 @@ public:
     size_t write(const uint8_t* buffer, size_t size) override;
     void register_ws_output(AsyncWebSocket* output);
 
+    // number of lines which were lost as the buffers were exhausted
+    uint32_t getDroppedLines() const { return _droppedLines; }
+
+    // number of lines not sent to the websocket as its clients fell behind
+    uint32_t getDroppedWebsocketLines() const { return _droppedWebsocketLines; }
+
+    // writes all buffered output to the console UART without taking any
+    // locks or using the serial driver. only to be called from the panic
+    // handler, when no other code will run anymore.
+    void flushOnPanic();
+
 private:
     void loop();
+    static void onShutdown();
 
     Task _loopTask;
 
-    using message_t = std::vector<uint8_t>;
+    // we keep a line buffer for every task and only move complete lines to
+    // the ring buffer, which is drained to the serial and the websocket
+    // output. this way we prevent mangling of messages from different
+    // contexts. all buffers are allocated statically.
+    struct TaskLine {
+        TaskHandle_t task = nullptr;
+        bool dropping = false;
+        size_t length = 0;
+        std::array<uint8_t, MESSAGE_OUTPUT_LINE_SIZE> buffer;
+    };
+    std::array<TaskLine, MESSAGE_OUTPUT_TASK_SLOTS> _taskLines;
 
-    // we keep a buffer for every task and only write complete lines to the
-    // serial output and then move them to be pushed through the websocket.
-    // this way we prevent mangling of messages from different contexts.
-    std::unordered_map<TaskHandle_t, message_t> _task_messages;
-    std::queue<message_t> _lines;
+    TaskLine* getTaskLine();
+    void appendLine(TaskLine& line, bool complete);
+
+    std::array<uint8_t, MESSAGE_OUTPUT_BUFFER_SIZE> _ring;
+
+    // monotonic positions within _ring, the serial and the websocket output
+    // consume the same lines independently.
+    size_t _ringHead = 0;
+    size_t _serialTail = 0;
+    size_t _wsTail = 0;
+
+    bool wsActive() const;
+    size_t ringFree() const;
+    void drainSerial(bool blocking);
+    void drainWebsocket();
+    void dropWebsocketLines(size_t required);
+
+    std::atomic<uint32_t> _droppedLines = 0;
+    std::atomic<uint32_t> _droppedWebsocketLines = 0;
 
     AsyncWebSocket* _ws = nullptr;
 
     std::mutex _msgLock;
-
-    void serialWrite(message_t const& m);
 };
 
 extern MessageOutputClass MessageOutput;
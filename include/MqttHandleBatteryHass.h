@@ -1,24 +1,27 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include "HassDiscoveryJob.h"
 #include <ArduinoJson.h>
 #include <TaskSchedulerDeclarations.h>
 
 class MqttHandleBatteryHassClass {
 public:
     void init(Scheduler& scheduler);
-    void forceUpdate() { _doPublish = true; }
+    void forceUpdate() { _updateForced = true; }
 
 private:
     void loop();
-    void publish(const String& subtopic, const String& payload);
+    void publishConfig();
     void publishBinarySensor(const char* caption, const char* icon, const char* subTopic, const char* payload_on, const char* payload_off);
     void publishSensor(const char* caption, const char* icon, const char* subTopic, const char* deviceClass = NULL, const char* stateClass = NULL, const char* unitOfMeasurement = NULL);
     void createDeviceInfo(JsonObject& object);
 
     Task _loopTask;
+    HassDiscoveryJob _discovery;
 
     bool _doPublish = true;
+    bool _updateForced = false;
     String serial = "0001"; // pseudo-serial, can be replaced in future with real serialnumber
 };
 
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include "HassDiscoveryJob.h"
 #include <ArduinoJson.h>
 #include <Hoymiles.h>
 #include <TaskSchedulerDeclarations.h>
@@ -53,15 +54,17 @@ class MqttHandleHassClass {
 public:
     MqttHandleHassClass();
     void init(Scheduler& scheduler);
-    void publishConfig();
-    void forceUpdate();
+    // publishes all discovery configs again. configs that did not change
+    // since they were published on the current connection are skipped,
+    // unless forget is set, e.g., because the Home Assistant settings changed.
+    void forceUpdate(bool forget = true);
 
     static String getDtuUniqueId();
     static String getDtuUrl();
 
 private:
     void loop();
-    void publish(const String& subtopic, const String& payload);
+    void publishConfig();
     void publishDtuSensor(const char* name, const char* device_class, const char* category, const char* icon, const char* unit_of_measure, const char* subTopic);
     void publishDtuBinarySensor(const char* name, const char* device_class, const char* category, const char* payload_on, const char* payload_off, const char* subTopic = "");
     void publishInverterField(std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const byteAssign_fieldDeviceClass_t fieldType, const bool clear = false);
@@ -75,9 +78,11 @@ private:
     static void createDeviceInfo(JsonDocument& doc, const String& name, const String& identifiers, const String& configuration_url, const String& manufacturer, const String& model, const String& sw_version, const String& via_device = "");
 
     Task _loopTask;
+    HassDiscoveryJob _discovery;
 
     bool _wasConnected = false;
     bool _updateForced = false;
+    bool _forgetPublished = false;
 };
 
 extern MqttHandleHassClass MqttHandleHass;
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "Configuration.h"
+#include "MqttPublisher.h"
 #include <Hoymiles.h>
 #include <TaskSchedulerDeclarations.h>
 #include <espMqttClient.h>
@@ -18,7 +19,7 @@ public:
 
 private:
     void loop();
-    void publishField(std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId);
+    void publishField(const MqttPublisherClass::Group& group, const StatisticsSnapshot& stats, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId);
     void onMqttMessage(const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, const size_t len, const size_t index, const size_t total);
 
     Task _loopTask;
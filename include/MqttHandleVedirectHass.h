@@ -2,18 +2,18 @@
 #pragma once
 
 #include <ArduinoJson.h>
+#include "HassDiscoveryJob.h"
 #include "VeDirectMpptController.h"
 #include <TaskSchedulerDeclarations.h>
 
 class MqttHandleVedirectHassClass {
 public:
     void init(Scheduler& scheduler);
-    void publishConfig();
     void forceUpdate();
 
 private:
     void loop();
-    void publish(const String& subtopic, const String& payload);
+    void publishConfig();
     void publishBinarySensor(const char *caption, const char *icon, const char *subTopic,
                              const char *payload_on, const char *payload_off,
                              const VeDirectMpptController::data_t &mpptData);
@@ -25,6 +25,7 @@ private:
                           const VeDirectMpptController::data_t &mpptData);
 
     Task _loopTask;
+    HassDiscoveryJob _discovery;
 
     bool _wasConnected = false;
     bool _updateForced = false;
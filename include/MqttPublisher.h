@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+// publishes values below the MQTT base topic, but only if they changed. the
+// full topic of every value is built once and kept along with the payload
+// that was published last. numeric values are published if they changed
+// by more than a deadband, which is the largest of the deadband given by the
+// caller and the absolute and relative deadbands from the config. counters,
+// e.g., the yield, only use the deadband given by the caller, as their small
+// increments would otherwise be held back for a long time. once the refresh
+// interval elapsed, values are published regardless of whether they
+// changed. if the change filter is disabled, all values are published
+// without keeping anything.
+//
+// depending on the payload mode, the values of a device are published to
+// their own topics, as a single JSON document, or both. the document is
+// published to the "json" subtopic of the device, its keys are the
+// subtopics of the values relative to the device.
+class MqttPublisherClass {
+public:
+    enum class PayloadMode : uint8_t {
+        Topics = 0,
+        Json = 1,
+        Both = 2
+    };
+
+    // topics sharing a common prefix, e.g., the values of one device. the
+    // prefix is appended to the MQTT base topic.
+    class Group {
+    public:
+        explicit Group(String const& prefix = "");
+        String const& getPrefix() const { return _prefix; }
+
+    private:
+        friend class MqttPublisherClass;
+        String _prefix;
+        uint32_t _hash;
+    };
+
+    // leading and trailing whitespace is not published. payloads are only
+    // copied if they need to be trimmed or were not published before.
+    void publish(Group const& group, char const* name, char const* payload);
+    void publish(Group const& group, char const* name, float value,
+            uint8_t decimals = 2, float deadband = 0, bool counter = false);
+
+    void publish(Group const& group, char const* name, String const& payload)
+    {
+        publish(group, name, payload.c_str());
+    }
+
+    // integers (and bools) are published as decimal numbers without a
+    // deadband. characters are not integers in this sense.
+    template <typename T, typename std::enable_if<std::is_integral<T>::value
+            && !std::is_same<T, char>::value, bool>::type = true>
+    void publish(Group const& group, char const* name, T value)
+    {
+        char payload[24];
+        if (std::is_signed<T>::value) {
+            snprintf(payload, sizeof(payload), "%lld", static_cast<long long>(value));
+        } else {
+            snprintf(payload, sizeof(payload), "%llu", static_cast<unsigned long long>(value));
+        }
+        publish(group, name, static_cast<char const*>(payload));
+    }
+
+    void publish(char const* subtopic, char const* payload)
+    {
+        publish(_root, subtopic, payload);
+    }
+
+    void publish(char const* subtopic, String const& payload)
+    {
+        publish(_root, subtopic, payload.c_str());
+    }
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value
+            && !std::is_same<T, char>::value, bool>::type = true>
+    void publish(char const* subtopic, T value)
+    {
+        publish(_root, subtopic, value);
+    }
+
+    void publish(char const* subtopic, float value,
+            uint8_t decimals = 2, float deadband = 0, bool counter = false)
+    {
+        publish(_root, subtopic, value, decimals, deadband, counter);
+    }
+
+    // forgets all topics and payloads. to be called if the connection was
+    // (re-)established or the base topic changed.
+    void reset();
+
+    // values published below the group until endDocument() is called are
+    // collected into the group's JSON document, if enabled. documents can
+    // not be nested.
+    void beginDocument(Group const& group);
+    void endDocument();
+
+    static PayloadMode getPayloadMode();
+    static bool isTopicModeEnabled() { return getPayloadMode() != PayloadMode::Json; }
+    static bool isJsonModeEnabled() { return getPayloadMode() != PayloadMode::Topics; }
+
+    // sets the state topic (and value template) of a Home Assistant
+    // discovery config for the value with the given subtopic below the
+    // prefix of a device.
+    static void setHassStateTopic(JsonVariant root, String const& prefix, String const& name);
+
+private:
+    struct Entry {
+        String topic; // including the base topic
+        String payload;
+        float value = 0;
+        uint32_t lastPublish = 0;
+    };
+
+    Entry* getEntry(Group const& group, char const* name);
+    bool appendKey(Group const& group, char const* name);
+    bool appendToDocument(Group const& group, char const* name, char const* value);
+    bool appendToDocument(Group const& group, char const* name, float value, uint8_t decimals);
+    bool isRefreshDue(Entry const& entry) const;
+    void publish(Entry& entry, char const* payload);
+
+    Group const _root;
+    std::mutex _mutex;
+    std::unordered_map<uint32_t, Entry> _entries;
+
+    std::optional<Group> _document;
+    std::string _documentBuffer; // keeps its capacity between documents
+};
+
+extern MqttPublisherClass MqttPublisher;
@@ -2,12 +2,15 @@
 #pragma once
 
 #include "Configuration.h"
+#include "LatencyHistogram.h"
+#include "PowerLimiterCalc.h"
 #include <espMqttClient.h>
 #include <Arduino.h>
 #include <Hoymiles.h>
 #include <memory>
 #include <functional>
 #include <optional>
+#include <vector>
 #include <TaskSchedulerDeclarations.h>
 #include <frozen/string.h>
 
@@ -18,6 +21,7 @@
 
 class PowerLimiterClass {
 public:
+    // the numeric values are exported as metrics, new values are appended
     enum class Status : unsigned {
         Initializing,
         DisabledByConfig,
@@ -41,7 +45,12 @@ public:
     };
 
     void init(Scheduler& scheduler);
+    Status getStatus() const { return _lastStatus; }
+    frozen::string const& getStatusText(Status status);
     uint8_t getInverterUpdateTimeouts() const { return _inverterUpdateTimeouts; }
+    uint32_t getLastCalculationMillis() const { return _calculationGate.getLastCalculation(); }
+    uint32_t getCalculationBackoffMs() const { return _calculationGate.getBackoffMs(); }
+    uint32_t getLastUpdateDurationMs() const { return _lastUpdateDurationMs; }
     uint8_t getPowerLimiterState();
     int32_t getLastRequestedPowerLimit() { return _lastRequestedPowerLimit; }
     bool getFullSolarPassThroughEnabled() const { return _fullSolarPassThroughEnabled; }
@@ -52,26 +61,51 @@ public:
         UnconditionalFullSolarPassthrough = 2
     };
 
-    void setMode(Mode m) { _mode = m; }
+    // values of PowerLimiterConfig::ControllerMode
+    enum class ControllerMode : uint8_t {
+        Proportional = 0,
+        PiFeedForward = 1
+    };
+
+    // timing of the control loop, from reading the power meter until the
+    // inverter reports stats after applying the new limit.
+    struct LatencyStats {
+        LatencyHistogram meterAge; // ms, age of the power meter reading when calculating a new limit
+        LatencyHistogram calculation; // us, time to calculate a new limit
+        LatencyHistogram commandRoundTrip; // ms, from starting an inverter update until the limit is confirmed
+        LatencyHistogram statsSettling; // ms, from limit confirmation until the inverter reports new stats
+        LatencyHistogram total; // ms, from the power meter reading until the limit is confirmed
+    };
+    LatencyStats const& getLatencyStats() const { return _latencyStats; }
+    void resetLatencyStats();
+
+    // wakes the DPL after any of its inputs changed. the DPL runs within the
+    // next scheduler iteration if called from the scheduler's context.
+    // otherwise the periodic fallback iteration picks up the change.
+    void notify();
+
+    void setMode(Mode m) { _mode = m; notify(); }
     Mode getMode() const { return _mode; }
     void calcNextInverterRestart();
 
+    // true if the target inverter or any secondary inverter produces power
+    bool isGovernedInverterProducing();
+
 private:
     void loop();
 
     Task _loopTask;
+    TaskHandle_t _schedulerTask = nullptr;
 
     int32_t _lastRequestedPowerLimit = 0;
     bool _shutdownPending = false;
-    std::optional<uint32_t> _oInverterStatsMillis = std::nullopt;
+    bool _secondariesShutdown = false;
     std::optional<uint32_t> _oUpdateStartMillis = std::nullopt;
     std::optional<int32_t> _oTargetPowerLimitWatts = std::nullopt;
     std::optional<bool> _oTargetPowerState = std::nullopt;
     Status _lastStatus = Status::Initializing;
     uint32_t _lastStatusPrinted = 0;
-    uint32_t _lastCalculation = 0;
-    static constexpr uint32_t _calculationBackoffMsDefault = 128;
-    uint32_t _calculationBackoffMs = _calculationBackoffMsDefault;
+    PowerLimiterCalc::CalculationGate _calculationGate;
     Mode _mode = Mode::Normal;
     std::shared_ptr<InverterAbstract> _inverter = nullptr;
     bool _batteryDischargeEnabled = false;
@@ -81,8 +115,12 @@ private:
     bool _fullSolarPassThroughEnabled = false;
     bool _verboseLogging = true;
     uint8_t _inverterUpdateTimeouts = 0;
+    uint32_t _lastUpdateDurationMs = 0;
+    LatencyStats _latencyStats;
+    std::optional<uint32_t> _oDecisionMeterMillis = std::nullopt;
+    std::optional<uint32_t> _oLimitConfirmedMillis = std::nullopt;
+    PowerLimiterCalc::PiController _controller;
 
-    frozen::string const& getStatusText(Status status);
     void announceStatus(Status status);
     bool shutdown(Status status);
     bool shutdown() { return shutdown(_lastStatus); }
@@ -93,6 +131,17 @@ private:
     bool calcPowerLimit(std::shared_ptr<InverterAbstract> inverter, int32_t solarPower, bool batteryPower);
     bool updateInverter();
     bool setNewPowerLimit(std::shared_ptr<InverterAbstract> inverter, int32_t newPowerLimit);
+    std::shared_ptr<InverterAbstract> getConfiguredInverter() const;
+    std::vector<std::shared_ptr<InverterAbstract>> getSecondaryInverters();
+    int32_t getSecondaryInvertersOutput();
+    int32_t getGovernedCapacity(std::shared_ptr<InverterAbstract> primary);
+    int32_t getGovernedLimit(std::shared_ptr<InverterAbstract> primary);
+    int32_t calcControllerOutput(int32_t error, int32_t base,
+            int32_t lower, int32_t upper);
+    int32_t distributePowerLimit(std::shared_ptr<InverterAbstract> primary, int32_t totalLimit);
+    bool updateSecondaryInverter(std::shared_ptr<InverterAbstract> inverter, std::optional<int32_t> oLimitWatts, bool powerOn);
+    bool shutdownSecondaryInverters();
+    void updatePollPriority();
     int32_t getSolarPower();
     float getLoadCorrectedVoltage();
     bool testThreshold(float socThreshold, float voltThreshold,
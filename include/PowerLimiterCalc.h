@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// hardware independent parts of the dynamic power limiter's control law. all
+// inputs are passed explicitly, such that the calculations neither depend on
+// the Arduino core nor on the inverter, power meter or config singletons.
+namespace PowerLimiterCalc {
+
+// the power the governed inverters shall produce to reach the target
+// consumption. falls back to the base load if the power meter is invalid.
+int32_t requiredPower(bool meterValid, int32_t meterValue,
+        bool meterIncludesInverters, int32_t governedInvertersOutput,
+        int32_t targetConsumption, int32_t baseLoad);
+
+// decides whether a new limit may be calculated. a calculation needs inverter
+// stats received after the last command was acknowledged by the inverter and,
+// if the power meter is valid, a reading that arrived more than 2 seconds
+// after those stats. calculations are spaced by a backoff period, which grows
+// while the limit does not need to be updated.
+class CalculationGate {
+public:
+    enum class State {
+        StatsPending,
+        MeterPending,
+        Backoff,
+        Ready
+    };
+
+    State check(uint32_t now, uint32_t lastUpdateCommand, uint32_t lastStats,
+            bool meterValid, uint32_t meterMillis);
+
+    // timestamp of the inverter stats the next calculation is based on
+    std::optional<uint32_t> getStatsMillis() const { return _oStatsMillis; }
+
+    uint32_t getLastCalculation() const { return _lastCalculation; }
+    uint32_t getBackoffMs() const { return _backoffMs; }
+    uint32_t getRemainingBackoff(uint32_t now) const;
+
+    void calculated(uint32_t now) { _lastCalculation = now; }
+    void setBackoff(uint32_t backoffMs) { _backoffMs = backoffMs; }
+
+    // doubles the backoff up to about a second if the limit did not need to
+    // be updated, resets it otherwise.
+    void adaptBackoff(bool limitUpdated);
+
+private:
+    static constexpr uint32_t _backoffMsDefault = 128;
+    static constexpr uint32_t _backoffMsMax = 1024;
+
+    std::optional<uint32_t> _oStatsMillis = std::nullopt;
+    uint32_t _lastCalculation = 0;
+    uint32_t _backoffMs = _backoffMsDefault;
+};
+
+struct Bounds {
+    int32_t lower;
+    int32_t upper;
+};
+
+// the range the total limit must stay within due to the energy source. without
+// battery power, only the available solar power may be used. with full solar
+// passthrough, at least all solar power is used.
+Bounds energySourceBounds(bool batteryPower, bool fullSolarPassthrough, int32_t solarPowerAC);
+
+// returns std::nullopt if the limit is less than the lower power limit and the
+// inverter shall be shut down. solar powered inverters keep running at the
+// lower power limit instead.
+std::optional<int32_t> applyLowerLimit(int32_t limit, int32_t lowerLimit, bool solarPowered);
+
+// a new limit is only sent if it deviates from the inverter's current limit
+// by more than the hysteresis.
+bool exceedsHysteresis(int32_t limit, int32_t currentLimit, int32_t hysteresis);
+
+// splits the total limit between inverters proportionally to their (positive)
+// capacities, where the first capacity is the one of the target inverter. the
+// total limit is clamped to the summed capacity and the rounding remainder is
+// left to the target inverter. secondary inverters are dropped, smallest share
+// first, until all shares are at least the lower power limit. the shares of
+// dropped inverters are std::nullopt.
+std::vector<std::optional<int32_t>> distributeLimit(int32_t totalLimit,
+        std::vector<int32_t> const& capacities, int32_t lowerLimit);
+
+struct ScalingInput {
+    int32_t newLimit = 0;
+    int32_t currentLimit = 0;
+    bool producing = false;
+
+    // the inverter has one MPPT per DC input
+    bool mpptPerInput = false;
+
+    float inverterOutputAc = 0;
+    float efficiencyFactor = 1;
+    std::vector<float> channelPowerDc;
+
+    // compensate shaded inputs (only sensible for solar powered inverters)
+    bool overscaling = false;
+};
+
+struct ScalingResult {
+    enum class Method {
+        None, // the limit is used as is
+        KeepCurrent, // all inputs are shaded, the current limit is kept
+        Overscaling, // compensating shaded inputs
+        ProducingInputs // scaled to the ratio of total and producing inputs
+    };
+
+    int32_t limit = 0;
+    Method method = Method::None;
+
+    // number of shaded or non-producing inputs, respectively
+    size_t affectedInputs = 0;
+};
+
+// the expected AC power per input when overscaling
+float expectedAcPowerPerInput(int32_t currentLimit, size_t inputs);
+
+// scales the limit such that inputs which are not producing or shaded do not
+// keep the inverter from reaching the desired output power
+ScalingResult scaleLimit(ScalingInput const& in);
+
+// the power the governed inverters currently provide, as the starting point of
+// the PI controller: the limit confirmed by the inverters, which is known
+// without waiting for their stats. the measured output is used instead if it
+// falls short of the limit by more than 20 %, e.g., while the DC side cannot
+// deliver the power or the inverters do not follow the limit at all.
+int32_t controllerBase(int32_t confirmedLimit, int32_t measuredOutput);
+
+// PI controller for the grid power in velocity form. the new limit is the
+// controller base (see controllerBase()) plus ki times the deviation of the
+// grid power from the target consumption plus kp times the change of that
+// deviation since the previous update. the integrating state is the inverter
+// limit itself, which cannot wind up beyond what the inverters accepted. the
+// gains apply per update, as the loop waits for the inverters and the power
+// meter to reflect the previous limit before calculating a new one. with
+// kp = 0, ki = 1 and the measured output as base, this is equivalent to
+// requiredPower().
+class PiController {
+public:
+    void setTuning(float kp, float ki) { _kp = kp; _ki = ki; }
+    void reset() { _oLastError = std::nullopt; }
+
+    // error: grid power minus target consumption in W, base: see
+    // controllerBase(). the result is limited to [lower, upper].
+    int32_t update(float error, float base, int32_t lower, int32_t upper);
+
+private:
+    float _kp = 0;
+    float _ki = 1;
+    std::optional<float> _oLastError = std::nullopt;
+};
+
+} // namespace PowerLimiterCalc
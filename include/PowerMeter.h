@@ -22,6 +22,7 @@ private:
     Task _loopTask;
     mutable std::mutex _mutex;
     std::unique_ptr<PowerMeterProvider> _upProvider = nullptr;
+    uint32_t _lastUpdateNotified = 0;
 };
 
 extern PowerMeterClass PowerMeter;
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <condition_variable>
@@ -13,9 +14,7 @@
 
 class PowerMeterHttpSml : public PowerMeterSml {
 public:
-    explicit PowerMeterHttpSml(PowerMeterHttpSmlConfig const& cfg)
-        : PowerMeterSml("PowerMeterHttpSml")
-        , _cfg(cfg) { }
+    explicit PowerMeterHttpSml(PowerMeterHttpSmlConfig const& cfg);
 
     ~PowerMeterHttpSml();
 
@@ -28,6 +27,8 @@ public:
     String poll();
 
 private:
+    String pollMeter(size_t meter);
+
     static void pollingLoopHelper(void* context);
     std::atomic<bool> _taskDone;
     void pollingLoop();
@@ -36,7 +37,7 @@ private:
 
     uint32_t _lastPoll = 0;
 
-    std::unique_ptr<HttpGetter> _upHttpGetter;
+    std::array<std::unique_ptr<HttpGetter>, POWERMETER_HTTP_SML_MAX_VALUES> _httpGetters;
 
     TaskHandle_t _taskHandle = nullptr;
     bool _stopPolling;
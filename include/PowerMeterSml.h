@@ -1,9 +1,9 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
-#include <list>
 #include <mutex>
 #include <optional>
+#include <vector>
 #include <stdint.h>
 #include <Arduino.h>
 #include <HTTPClient.h>
@@ -11,17 +11,28 @@
 #include "PowerMeterProvider.h"
 #include "sml.h"
 
-class PowerMeterSml : public PowerMeterProvider {
+class PowerMeterSml : public PowerMeterProvider, private SmlParser::Listener {
 public:
     float getPowerTotal() const final;
     void doMqttPublish() const final;
 
+    // total power of a single meter as it contributes to the total
+    float getPowerTotal(size_t meter) const;
+
 protected:
-    explicit PowerMeterSml(char const* user)
-        : _user(user) { }
+    // every meter is decoded by a parser of its own, such that several
+    // SML sources can be processed at the same time.
+    explicit PowerMeterSml(char const* user, size_t meterCount = 1)
+        : _user(user)
+        , _meters(meterCount) { }
+
+    void setSignInverted(size_t meter, bool inverted);
+    void reset(size_t meter = 0);
+    void processSmlData(size_t meter, uint8_t const* data, size_t length);
 
-    void reset();
-    void processSmlByte(uint8_t byte);
+    // millis() when the meter's last complete datagram was decoded, 0 if
+    // none was decoded yet
+    uint32_t getMeterLastUpdate(size_t meter) const;
 
 private:
     std::string _user;
@@ -42,28 +53,21 @@ private:
         std::optional<float> energyExport = std::nullopt;
     };
 
-    values_t _values;
-    values_t _cache;
+    struct Meter {
+        SmlParser parser;
+        values_t values;
+        values_t cache;
+        bool signInverted = false;
+        uint32_t lastUpdate = 0;
+    };
+
+    std::vector<Meter> _meters;
+
+    void onSmlEvent(SmlParser& parser, sml_states_t state) final;
 
     using OBISHandler = struct {
-        uint8_t const OBIS[6];
-        void (*decoder)(float&);
-        std::optional<float>* target;
+        void (SmlParser::*decoder)(float&) const;
+        std::optional<float> values_t::*target;
         char const* name;
     };
-
-    const std::list<OBISHandler> smlHandlerList{
-        {{0x01, 0x00, 0x10, 0x07, 0x00, 0xff}, &smlOBISW, &_cache.activePowerTotal, "active power total"},
-        {{0x01, 0x00, 0x24, 0x07, 0x00, 0xff}, &smlOBISW, &_cache.activePowerL1, "active power L1"},
-        {{0x01, 0x00, 0x38, 0x07, 0x00, 0xff}, &smlOBISW, &_cache.activePowerL2, "active power L2"},
-        {{0x01, 0x00, 0x4c, 0x07, 0x00, 0xff}, &smlOBISW, &_cache.activePowerL3, "active power L3"},
-        {{0x01, 0x00, 0x20, 0x07, 0x00, 0xff}, &smlOBISVolt, &_cache.voltageL1, "voltage L1"},
-        {{0x01, 0x00, 0x34, 0x07, 0x00, 0xff}, &smlOBISVolt, &_cache.voltageL2, "voltage L2"},
-        {{0x01, 0x00, 0x48, 0x07, 0x00, 0xff}, &smlOBISVolt, &_cache.voltageL3, "voltage L3"},
-        {{0x01, 0x00, 0x1f, 0x07, 0x00, 0xff}, &smlOBISAmpere, &_cache.currentL1, "current L1"},
-        {{0x01, 0x00, 0x33, 0x07, 0x00, 0xff}, &smlOBISAmpere, &_cache.currentL2, "current L2"},
-        {{0x01, 0x00, 0x47, 0x07, 0x00, 0xff}, &smlOBISAmpere, &_cache.currentL3, "current L3"},
-        {{0x01, 0x00, 0x01, 0x08, 0x00, 0xff}, &smlOBISWh, &_cache.energyImport, "energy import"},
-        {{0x01, 0x00, 0x02, 0x08, 0x00, 0xff}, &smlOBISWh, &_cache.energyExport, "energy export"}
-    };
 };
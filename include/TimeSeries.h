@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// ring buffers of min/avg/max aggregates with decreasing resolution. every
+// sample is accumulated by each tier, a tier's bucket is stored once its
+// period elapsed. insertion and lookups take constant time. values are
+// stored as 16 bit integers in multiples of the series' resolution. the
+// buffers are only allocated once the first sample is added.
+class TimeSeries {
+public:
+    struct TierConfig {
+        uint32_t period; // s
+        size_t capacity; // number of buckets
+    };
+
+    struct Aggregate {
+        bool valid = false; // false if no sample was added in this period
+        float min = 0;
+        float avg = 0;
+        float max = 0;
+    };
+
+    TimeSeries(float resolution, std::vector<TierConfig> const& tiers);
+
+    // replaces the tiers. has no effect once the first sample was added.
+    void setTiers(std::vector<TierConfig> const& tiers);
+
+    // timestamps are seconds of a monotonic clock, e.g., the uptime
+    void add(float value, uint32_t now);
+
+    // stores the buckets of all elapsed periods, even without samples
+    void update(uint32_t now);
+
+    size_t getTierCount() const { return _tiers.size(); }
+    uint32_t getPeriod(size_t tier) const;
+    size_t getCapacity(size_t tier) const;
+
+    // number of stored buckets of the tier
+    size_t getSize(size_t tier) const;
+
+    // the end of the most recently stored bucket of the tier
+    uint32_t getLastEnd(size_t tier) const;
+
+    // age 0 is the most recently stored bucket
+    Aggregate get(size_t tier, size_t age) const;
+
+    // uses the finest tier covering the duration (or the coarsest tier) to
+    // aggregate the most recent duration into the given number of points,
+    // oldest first. returns the number of points filled, which is less than
+    // requested if the duration is not covered by stored buckets yet. the
+    // end of the last point and the seconds covered by each point are
+    // written to lastEnd and interval, respectively, if given.
+    size_t resample(uint32_t duration, Aggregate* points, size_t count,
+            uint32_t* lastEnd = nullptr, float* interval = nullptr) const;
+
+private:
+    static constexpr int16_t NoData = std::numeric_limits<int16_t>::min();
+
+    struct Bucket {
+        int16_t min = NoData;
+        int16_t avg = NoData;
+        int16_t max = NoData;
+    };
+
+    struct Tier {
+        TierConfig config;
+        std::unique_ptr<Bucket[]> buckets;
+        size_t head = 0; // next bucket to write
+        size_t size = 0;
+        uint32_t index = 0; // index of the current period, i.e., now / period
+
+        float sum = 0;
+        float min = 0;
+        float max = 0;
+        uint32_t count = 0;
+    };
+
+    void advance(Tier& tier, uint32_t now);
+    void store(Tier& tier);
+    int16_t encode(float value) const;
+    float decode(int16_t value) const;
+    Aggregate decode(Bucket const& bucket) const;
+
+    float _resolution;
+    bool _allocated = false;
+    std::vector<Tier> _tiers;
+    mutable std::mutex _mutex;
+};
@@ -1,8 +1,10 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
-#include <mutex>
+#include <array>
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include "VeDirectMpptController.h"
 #include "Configuration.h"
@@ -24,7 +26,7 @@ public:
     uint32_t getDataAgeMillis() const;
     uint32_t getDataAgeMillis(size_t idx) const;
 
-    size_t controllerAmount() const { return _controllers.size(); }
+    size_t controllerAmount() const { return _controllerCount; }
     std::optional<VeDirectMpptController::data_t> getData(size_t idx = 0) const;
 
     // total output of all MPPT charge controllers in Watts
@@ -51,9 +53,44 @@ private:
 
     Task _loopTask;
 
-    mutable std::mutex _mutex;
-    using controller_t = std::unique_ptr<VeDirectMpptController>;
-    std::vector<controller_t> _controllers;
+    // each charge controller's UART is drained by a FreeRTOS task of its
+    // own. the task publishes the controller's data once a frame was
+    // received, hence readers never wait for serial data being parsed.
+    struct Receiver {
+        std::unique_ptr<VeDirectMpptController> upController;
+        size_t index;
+        TaskHandle_t taskHandle = nullptr;
+        SemaphoreHandle_t stopped = nullptr; // given by the task when done
+        std::atomic<bool> stopPolling { false };
+    };
+
+    static void pollingLoopHelper(void* context);
+    void pollingLoop(Receiver& receiver);
+    void stopReceivers();
+
+    struct ControllerSnapshot {
+        uint32_t lastUpdate = 0;
+        VeDirectMpptController::data_t data = {};
+
+        // same rules as VeDirectFrameHandler::isDataValid()
+        bool isDataValid() const;
+    };
+
+    // one slot per charge controller, each written by the respective
+    // receiver task only. a published snapshot is immutable, the slot is
+    // replaced using atomic stores and read using atomic loads of the
+    // shared pointer. the slots never hold a nullptr.
+    static constexpr size_t s_maxControllers = 3;
+    using SnapshotPtr = std::shared_ptr<ControllerSnapshot const>;
+    SnapshotPtr getSnapshot(size_t idx) const;
+    void publish(size_t index, uint32_t lastUpdate, VeDirectMpptController::data_t const& data);
+
+    std::array<SnapshotPtr, s_maxControllers> _snapshots;
+    std::atomic<size_t> _controllerCount { 0 };
+    std::atomic<uint32_t> _publishCount { 0 };
+    uint32_t _publishCountNotified = 0;
+
+    std::vector<std::unique_ptr<Receiver>> _receivers;
 
     std::vector<String> _serialPortOwners;
     bool initController(int8_t rx, int8_t tx, bool logging,
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include "JsonStreamWriter.h"
 #include "WebApi_battery.h"
 #include "WebApi_config.h"
 #include "WebApi_device.h"
@@ -10,6 +11,7 @@
 #include "WebApi_eventlog.h"
 #include "WebApi_firmware.h"
 #include "WebApi_gridprofile.h"
+#include "WebApi_history.h"
 #include "WebApi_inverter.h"
 #include "WebApi_limit.h"
 #include "WebApi_maintenance.h"
@@ -33,9 +35,15 @@
 #include "WebApi_ws_battery.h"
 #include <ESPAsyncWebServer.h>
 #include <TaskSchedulerDeclarations.h>
+#include <functional>
 
 class WebApiClass {
 public:
+    // generate the given section of a chunked response, return false if
+    // there is no such section
+    using ChunkGenerator = std::function<bool(Print& out, size_t section)>;
+    using JsonChunkGenerator = std::function<bool(JsonStreamWriter& writer, size_t section)>;
+
     WebApiClass();
     void init(Scheduler& scheduler);
 
@@ -50,6 +58,11 @@ public:
     static uint64_t parseSerialFromRequest(AsyncWebServerRequest* request, String param_name = "inv");
     static bool sendJsonResponse(AsyncWebServerRequest* request, AsyncJsonResponse* response, const char* function, const uint16_t line);
 
+    // the response is generated section by section while it is sent, such
+    // that only a single section is buffered at any time.
+    static void sendChunkedResponse(AsyncWebServerRequest* request, const char* contentType, ChunkGenerator&& generator);
+    static void sendChunkedJsonResponse(AsyncWebServerRequest* request, JsonChunkGenerator&& generator);
+
 private:
     AsyncWebServer _server;
 
@@ -61,6 +74,7 @@ private:
     WebApiEventlogClass _webApiEventlog;
     WebApiFirmwareClass _webApiFirmware;
     WebApiGridProfileClass _webApiGridprofile;
+    WebApiHistoryClass _webApiHistory;
     WebApiInverterClass _webApiInverter;
     WebApiLimitClass _webApiLimit;
     WebApiMaintenanceClass _webApiMaintenance;
@@ -12,6 +12,8 @@ public:
 private:
     void onDtuAdminGet(AsyncWebServerRequest* request);
     void onDtuAdminPost(AsyncWebServerRequest* request);
+    void onDtuScheduleGet(AsyncWebServerRequest* request);
+    void onDtuLinksGet(AsyncWebServerRequest* request);
 
     Task _applyDataTask;
     void applyDataTaskCb();
@@ -61,6 +61,10 @@ enum WebApiError {
     MqttHassTopicCharacter,
     MqttLwtQos,
     MqttClientIdLength,
+    MqttChangeFilterDeadband,
+    MqttChangeFilterRefreshInterval,
+    MqttPayloadMode,
+    MqttChangeFilterAbsoluteDeadband,
 
     NetworkBase = 8000,
     NetworkIpInvalid,
@@ -92,4 +96,7 @@ enum WebApiError {
 
     HardwareBase = 12000,
     HardwarePinMappingLength,
+
+    EnergyLogBase = 13000,
+    EnergyLogIntervalInvalid,
 };
@@ -0,0 +1,16 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <ESPAsyncWebServer.h>
+#include <TaskSchedulerDeclarations.h>
+
+class WebApiHistoryClass {
+public:
+    void init(AsyncWebServer& server, Scheduler& scheduler);
+
+private:
+    void onHistoryGet(AsyncWebServerRequest* request);
+    void onEnergyGet(AsyncWebServerRequest* request);
+    void onConfigGet(AsyncWebServerRequest* request);
+    void onConfigPost(AsyncWebServerRequest* request);
+};
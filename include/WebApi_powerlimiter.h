@@ -12,6 +12,8 @@ public:
 private:
     void onStatus(AsyncWebServerRequest* request);
     void onMetaData(AsyncWebServerRequest* request);
+    void onLatencyGet(AsyncWebServerRequest* request);
+    void onLatencyDelete(AsyncWebServerRequest* request);
     void onAdminGet(AsyncWebServerRequest* request);
     void onAdminPost(AsyncWebServerRequest* request);
 
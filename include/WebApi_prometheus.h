@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include "LatencyHistogram.h"
 #include <ESPAsyncWebServer.h>
 #include <Hoymiles.h>
 #include <TaskSchedulerDeclarations.h>
@@ -13,9 +14,23 @@ public:
 private:
     void onPrometheusMetricsGet(AsyncWebServerRequest* request);
 
-    void addField(AsyncResponseStream* stream, const String& serial, const uint8_t idx, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, const char* metricName, const char* channelName = nullptr);
+    // Prints the given section of the metrics, returns false if there is no such section
+    bool generateSection(Print* stream, const size_t section);
 
-    void addPanelInfo(AsyncResponseStream* stream, const String& serial, const uint8_t idx, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel);
+    void addMetricHeader(Print* stream, const char* name, const char* help, const char* type);
+    void addHistogram(Print* stream, const char* name, const char* help, const LatencyHistogram& histogram);
+
+    void addSystemInfo(Print* stream);
+    void addInverterInfo(Print* stream, const uint8_t idx);
+    void addPowerLimiterInfo(Print* stream);
+    void addPowerMeterInfo(Print* stream);
+    void addBatteryInfo(Print* stream);
+    void addMpptInfo(Print* stream);
+    void addHuaweiInfo(Print* stream);
+
+    void addField(Print* stream, const String& serial, const uint8_t idx, std::shared_ptr<InverterAbstract> inv, const StatisticsSnapshot& stats, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, const char* metricName, const char* channelName = nullptr);
+
+    void addPanelInfo(Print* stream, const String& serial, const uint8_t idx, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel);
 
     enum MetricType_t {
         NONE = 0,
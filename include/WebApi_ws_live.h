@@ -6,6 +6,9 @@
 #include <ESPAsyncWebServer.h>
 #include <Hoymiles.h>
 #include <TaskSchedulerDeclarations.h>
+#include <array>
+#include <map>
+#include <vector>
 
 class WebApiWsLiveClass {
 public:
@@ -13,14 +16,40 @@ public:
     void init(AsyncWebServer& server, Scheduler& scheduler);
 
 private:
+    // channel values of one inverter as known by a client using the binary
+    // delta format. fields are identified by the order of their generation.
+    struct LiveDataDelta {
+        uint64_t serial = 0;
+        uint32_t frames = 0;
+        uint32_t pendingSeq = 0;
+        size_t slot = 0;
+        std::vector<uint16_t> keys;
+        std::vector<float> pending; // values sent with frame pendingSeq
+        std::vector<float> acked; // empty until a frame was acknowledged
+
+        // true if all fields, including static ones, shall be sent
+        bool isKeyframe() const { return acked.empty(); }
+    };
+
+    struct DeltaClient {
+        uint32_t seq = 0;
+        std::array<LiveDataDelta, INV_MAX_COUNT> inverters;
+    };
+
     static void generateInverterCommonJsonResponse(JsonObject& root, std::shared_ptr<InverterAbstract> inv);
-    static void generateInverterChannelJsonResponse(JsonObject& root, std::shared_ptr<InverterAbstract> inv);
+    static void generateInverterChannelJsonResponse(JsonObject& root, std::shared_ptr<InverterAbstract> inv, LiveDataDelta* delta = nullptr);
     static void generateCommonJsonResponse(JsonVariant& root);
 
     void generateOnBatteryJsonResponse(JsonVariant& root, bool all);
     void sendOnBatteryStats();
 
-    static void addField(JsonObject& root, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, String topic = "");
+    bool hasJsonClients();
+    void sendJson(JsonDocument& root);
+    void sendMsgPack(JsonDocument& root);
+    void sendDeltaFrame(AsyncWebSocketClient& client, DeltaClient& state, const uint8_t idx, std::shared_ptr<InverterAbstract> inv);
+    static void acknowledge(DeltaClient& state, const uint32_t seq);
+
+    static void addField(JsonObject& root, const StatisticsSnapshot& stats, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, String topic = "", LiveDataDelta* delta = nullptr);
     static void addTotalField(JsonObject& root, const String& name, const float value, const String& unit, const uint8_t digits);
 
     void onLivedataStatus(AsyncWebServerRequest* request);
@@ -36,6 +65,9 @@ private:
 
     uint32_t _lastPublishStats[INV_MAX_COUNT] = { 0 };
 
+    // clients which negotiated the binary delta format, by client id
+    std::map<uint32_t, DeltaClient> _deltaClients;
+
     std::mutex _mutex;
 
     Task _wsCleanupTask;
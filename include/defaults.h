@@ -79,9 +79,11 @@
 #define MQTT_LWT_QOS 2U
 #define MQTT_PUBLISH_INTERVAL 5U
 #define MQTT_CLEAN_SESSION true
+#define MQTT_PAYLOAD_MODE 0U // per-value topics
 
 #define DTU_SERIAL 0x99978563412U
 #define DTU_POLL_INTERVAL 5U
+#define DTU_PARALLEL_POLLING false
 #define DTU_NRF_PA_LEVEL 0U
 #define DTU_CMT_PA_LEVEL 0
 #define DTU_CMT_FREQUENCY 865000000U
@@ -93,6 +95,11 @@
 #define MQTT_HASS_TOPIC "homeassistant/"
 #define MQTT_HASS_INDIVIDUALPANELS false
 
+#define MQTT_CHANGEFILTER_ENABLED false
+#define MQTT_CHANGEFILTER_DEADBAND 1.0
+#define MQTT_CHANGEFILTER_ABSOLUTE_DEADBAND 0.0
+#define MQTT_CHANGEFILTER_REFRESH_INTERVAL 60U
+
 #define DEV_PINMAPPING ""
 
 #define DISPLAY_POWERSAFE true
@@ -114,6 +121,9 @@
 #define VEDIRECT_VERBOSE_LOGGING false
 #define VEDIRECT_UPDATESONLY true
 
+#define ENERGYLOG_ENABLED false
+#define ENERGYLOG_INTERVAL 15U // minutes
+
 #define POWERMETER_ENABLED false
 #define POWERMETER_POLLING_INTERVAL 10
 #define POWERMETER_SOURCE 0
@@ -129,10 +139,14 @@
 #define POWERLIMITER_IS_INVERTER_BEHIND_POWER_METER true
 #define POWERLIMITER_IS_INVERTER_SOLAR_POWERED false
 #define POWERLIMITER_USE_OVERSCALING_TO_COMPENSATE_SHADING false
+#define POWERLIMITER_DISTRIBUTE_OVER_ALL_INVERTERS false
 #define POWERLIMITER_INVERTER_ID 0ULL
 #define POWERLIMITER_INVERTER_CHANNEL_ID 0
 #define POWERLIMITER_TARGET_POWER_CONSUMPTION 0
 #define POWERLIMITER_TARGET_POWER_CONSUMPTION_HYSTERESIS 0
+#define POWERLIMITER_CONTROLLER_MODE 0
+#define POWERLIMITER_CONTROLLER_KP 0.1
+#define POWERLIMITER_CONTROLLER_KI 0.8
 #define POWERLIMITER_LOWER_POWER_LIMIT 10
 #define POWERLIMITER_BASE_LOAD_LIMIT 100
 #define POWERLIMITER_UPPER_POWER_LIMIT 800
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "CommandQueue.h"
+#include "Hoymiles.h"
+#include <algorithm>
+
+void CommandQueue::push(std::shared_ptr<CommandAbstract> cmd)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (auto& queued : _queue) {
+        if (cmd->supersedes(*queued)) {
+            Hoymiles.getVerboseMessageOutput()->printf("Replace queued %s command\r\n",
+                queued->getCommandName().c_str());
+            queued = cmd;
+            return;
+        }
+    }
+
+    // keep commands of the same priority in FIFO order
+    auto pos = std::find_if(_queue.begin(), _queue.end(),
+        [&cmd](const std::shared_ptr<CommandAbstract>& queued) {
+            return queued->getPriority() > cmd->getPriority();
+        });
+
+    _queue.insert(pos, cmd);
+}
+
+std::shared_ptr<CommandAbstract> CommandQueue::front()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_inFlight == nullptr && !_queue.empty()) {
+        _inFlight = _queue.front();
+        _queue.pop_front();
+    }
+
+    return _inFlight;
+}
+
+void CommandQueue::pop()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_inFlight != nullptr) {
+        _inFlight = nullptr;
+        return;
+    }
+
+    if (!_queue.empty()) {
+        _queue.pop_front();
+    }
+}
+
+unsigned long CommandQueue::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size() + (_inFlight != nullptr ? 1 : 0);
+}
+
+bool CommandQueue::canSupersede(const CommandAbstract& cmd) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return std::any_of(_queue.begin(), _queue.end(),
+        [&cmd](const std::shared_ptr<CommandAbstract>& queued) {
+            return cmd.supersedes(*queued);
+        });
+}
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include "commands/CommandAbstract.h"
+#include <deque>
+#include <memory>
+#include <mutex>
+
+/*
+ * Priority aware command queue used by the radios. Commands with
+ * CommandPriority::High (limit and power control) are sent before any queued
+ * polling request. A new command replaces a queued command it supersedes
+ * (same request to the same inverter), such that duplicate polling requests
+ * are merged and stale limit commands are dropped.
+ *
+ * The command returned by front() is considered in flight: it stays at the
+ * front of the queue until pop() is called, regardless of what is pushed in
+ * the meantime.
+ */
+class CommandQueue {
+public:
+    CommandQueue() = default;
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    void push(std::shared_ptr<CommandAbstract> cmd);
+    std::shared_ptr<CommandAbstract> front();
+    void pop();
+
+    unsigned long size() const;
+
+    // Returns true if the command can replace a queued command, which was not yet sent
+    bool canSupersede(const CommandAbstract& cmd) const;
+
+private:
+    std::shared_ptr<CommandAbstract> _inFlight = nullptr;
+    std::deque<std::shared_ptr<CommandAbstract>> _queue;
+    mutable std::mutex _mutex;
+};
@@ -46,112 +46,203 @@ void HoymilesClass::loop()
         return;
     }
 
-    if (millis() - _lastPoll > (_pollInterval * 1000)) {
-        static uint8_t inverterPos = 0;
+    for (auto& inv : _inverters) {
+        inv->Schedule()->trackStatistics(inv->Statistics()->getLastUpdate());
+    }
 
-        std::shared_ptr<InverterAbstract> iv = getInverterByPos(inverterPos);
-        if ((iv == nullptr) || ((iv != nullptr) && (!iv->getRadio()->isInitialized()))) {
-            if (++inverterPos >= getNumInverters()) {
-                inverterPos = 0;
-            }
-        }
+    bool pollSlot = false;
 
-        if (iv != nullptr && iv->getRadio()->isInitialized() && iv->getRadio()->isQueueEmpty()) {
+    if (_parallelPolling) {
+        // the radios are independent hardware, hence each radio polls its
+        // own inverters at the poll interval, at the same time.
+        pollSlot |= pollRadio(_radioNrf.get(), _pollStateNrf);
+        pollSlot |= pollRadio(_radioCmt.get(), _pollStateCmt);
+    } else {
+        pollSlot = pollRadio(nullptr, _pollState);
+    }
 
-            if (iv->getZeroValuesIfUnreachable() && !iv->isReachable()) {
-                iv->Statistics()->zeroRuntimeData();
-            }
+    if (pollSlot) {
+        performHousekeeping();
+    }
+}
 
-            if (iv->getEnablePolling() || iv->getEnableCommands()) {
-                _messageOutput->print("Fetch inverter: ");
-                _messageOutput->println(iv->serial(), HEX);
+// Polls the next inverter of the given radio (of any radio if nullptr) if the
+// poll interval elapsed since the last poll. Returns false if the interval did
+// not elapse yet.
+bool HoymilesClass::pollRadio(const HoymilesRadio* radio, PollState& state)
+{
+    if (millis() - state.lastPoll <= (_pollInterval * 1000)) {
+        return false;
+    }
 
-                if (!iv->isReachable()) {
-                    iv->sendChangeChannelRequest();
-                }
+    uint8_t pollableCount = 0;
+    std::shared_ptr<InverterAbstract> iv = getNextInverterToPoll(millis(), radio, state.fastStreak, pollableCount);
+    if (iv == nullptr) {
+        return true;
+    }
 
-                iv->sendStatsRequest();
+    if (iv->Schedule()->getMode() == PollMode::Fast) {
+        if (state.fastStreak < UINT8_MAX) {
+            state.fastStreak++;
+        }
+    } else {
+        state.fastStreak = 0;
+    }
 
-                // Fetch event log
-                const bool force = iv->EventLog()->getLastAlarmRequestSuccess() == CMD_NOK;
-                iv->sendAlarmLogRequest(force);
+    pollInverter(iv, pollableCount);
+    state.lastPoll = millis();
+    return true;
+}
 
-                // Fetch limit
-                if (((millis() - iv->SystemConfigPara()->getLastUpdateRequest() > HOY_SYSTEM_CONFIG_PARA_POLL_INTERVAL)
-                        && (millis() - iv->SystemConfigPara()->getLastUpdateCommand() > HOY_SYSTEM_CONFIG_PARA_POLL_MIN_DURATION))) {
-                    _messageOutput->println("Request SystemConfigPara");
-                    iv->sendSystemConfigParaRequest();
-                }
+void HoymilesClass::pollInverter(const std::shared_ptr<InverterAbstract>& iv, const uint8_t pollableCount)
+{
+    if (iv->getZeroValuesIfUnreachable() && !iv->isReachable()) {
+        iv->Statistics()->zeroRuntimeData();
+    }
 
-                // Set limit if required
-                if (iv->SystemConfigPara()->getLastLimitCommandSuccess() == CMD_NOK) {
-                    _messageOutput->println("Resend ActivePowerControl");
-                    iv->resendActivePowerControlRequest();
-                }
+    _messageOutput->print("Fetch inverter: ");
+    _messageOutput->print(iv->serial(), HEX);
+    _messageOutput->printf(" (%s)\r\n", iv->Schedule()->getModeName());
 
-                // Set power status if required
-                if (iv->PowerCommand()->getLastPowerCommandSuccess() == CMD_NOK) {
-                    _messageOutput->println("Resend PowerCommand");
-                    iv->resendPowerControlRequest();
-                }
+    if (!iv->isReachable()) {
+        iv->sendChangeChannelRequest();
+    }
 
-                // Fetch dev info (but first fetch stats)
-                if (iv->Statistics()->getLastUpdate() > 0) {
-                    const bool invalidDevInfo = !iv->DevInfo()->containsValidData()
-                        && iv->DevInfo()->getLastUpdateAll() > 0
-                        && iv->DevInfo()->getLastUpdateSimple() > 0;
-
-                    if (invalidDevInfo) {
-                        _messageOutput->println("DevInfo: No Valid Data");
-                    }
-
-                    if ((iv->DevInfo()->getLastUpdateAll() == 0)
-                        || (iv->DevInfo()->getLastUpdateSimple() == 0)
-                        || invalidDevInfo) {
-                        _messageOutput->println("Request device info");
-                        iv->sendDevInfoRequest();
-                    }
-                }
+    iv->sendStatsRequest();
 
-                // Fetch grid profile
-                if (iv->Statistics()->getLastUpdate() > 0 && (iv->GridProfile()->getLastUpdate() == 0 || !iv->GridProfile()->containsValidData())) {
-                    iv->sendGridOnProFileParaRequest();
-                }
+    // Unreachable inverters are only probed with a short stats request
+    if (iv->Schedule()->getMode() != PollMode::Probe) {
+        // Fetch event log
+        const bool force = iv->EventLog()->getLastAlarmRequestSuccess() == CMD_NOK;
+        iv->sendAlarmLogRequest(force);
+
+        // Fetch limit
+        if (((millis() - iv->SystemConfigPara()->getLastUpdateRequest() > HOY_SYSTEM_CONFIG_PARA_POLL_INTERVAL)
+                && (millis() - iv->SystemConfigPara()->getLastUpdateCommand() > HOY_SYSTEM_CONFIG_PARA_POLL_MIN_DURATION))) {
+            _messageOutput->println("Request SystemConfigPara");
+            iv->sendSystemConfigParaRequest();
+        }
+
+        // Set limit if required
+        if (iv->SystemConfigPara()->getLastLimitCommandSuccess() == CMD_NOK) {
+            _messageOutput->println("Resend ActivePowerControl");
+            iv->resendActivePowerControlRequest();
+        }
 
-                _lastPoll = millis();
+        // Set power status if required
+        if (iv->PowerCommand()->getLastPowerCommandSuccess() == CMD_NOK) {
+            _messageOutput->println("Resend PowerCommand");
+            iv->resendPowerControlRequest();
+        }
+
+        // Fetch dev info (but first fetch stats)
+        if (iv->Statistics()->getLastUpdate() > 0) {
+            const bool invalidDevInfo = !iv->DevInfo()->containsValidData()
+                && iv->DevInfo()->getLastUpdateAll() > 0
+                && iv->DevInfo()->getLastUpdateSimple() > 0;
+
+            if (invalidDevInfo) {
+                _messageOutput->println("DevInfo: No Valid Data");
             }
 
-            if (++inverterPos >= getNumInverters()) {
-                inverterPos = 0;
+            if ((iv->DevInfo()->getLastUpdateAll() == 0)
+                || (iv->DevInfo()->getLastUpdateSimple() == 0)
+                || invalidDevInfo) {
+                _messageOutput->println("Request device info");
+                iv->sendDevInfoRequest();
             }
         }
 
-        // Perform housekeeping of all inverters on day change
-        const int8_t currentWeekDay = Utils::getWeekDay();
-        static int8_t lastWeekDay = -1;
-        if (lastWeekDay == -1) {
-            lastWeekDay = currentWeekDay;
-        } else {
-            if (currentWeekDay != lastWeekDay) {
-
-                for (auto& inv : _inverters) {
-                    // Have to reset the offets first, otherwise it will
-                    // Substract the offset from zero which leads to a high value
-                    inv->Statistics()->resetYieldDayCorrection();
-                    if (inv->getZeroYieldDayOnMidnight()) {
-                        inv->Statistics()->zeroDailyData();
-                    }
-                    if (inv->getClearEventlogOnMidnight()) {
-                        inv->EventLog()->clearBuffer();
-                    }
-                }
+        // Fetch grid profile
+        if (iv->Statistics()->getLastUpdate() > 0 && (iv->GridProfile()->getLastUpdate() == 0 || !iv->GridProfile()->containsValidData())) {
+            iv->sendGridOnProFileParaRequest();
+        }
+    }
+
+    iv->Schedule()->polled(*iv, _pollInterval * 1000, pollableCount);
+}
 
-                lastWeekDay = currentWeekDay;
+void HoymilesClass::performHousekeeping()
+{
+    // Perform housekeeping of all inverters on day change
+    const int8_t currentWeekDay = Utils::getWeekDay();
+    static int8_t lastWeekDay = -1;
+    if (lastWeekDay == -1) {
+        lastWeekDay = currentWeekDay;
+    } else {
+        if (currentWeekDay != lastWeekDay) {
+
+            for (auto& inv : _inverters) {
+                // Have to reset the offets first, otherwise it will
+                // Substract the offset from zero which leads to a high value
+                inv->Statistics()->resetYieldDayCorrection();
+                if (inv->getZeroYieldDayOnMidnight()) {
+                    inv->Statistics()->zeroDailyData();
+                }
+                if (inv->getClearEventlogOnMidnight()) {
+                    inv->EventLog()->clearBuffer();
+                }
             }
+
+            lastWeekDay = currentWeekDay;
         }
     }
 }
 
+// Returns the due inverter with the earliest deadline. Inverters which are not
+// due yet are skipped, such that the poll slot is left unused and the radio
+// airtime is available for commands. Only inverters using the given radio are
+// considered, unless radio is nullptr. After HOY_POLL_FAST_MAX_STREAK
+// consecutive polls of inverters in fast mode, a due inverter in another mode
+// is preferred, such that inverters in fast mode cannot starve the others.
+std::shared_ptr<InverterAbstract> HoymilesClass::getNextInverterToPoll(const uint32_t now, const HoymilesRadio* radio, const uint8_t fastStreak, uint8_t& pollableCount)
+{
+    std::shared_ptr<InverterAbstract> next = nullptr;
+    int32_t nextOverdue = 0;
+    std::shared_ptr<InverterAbstract> nextOther = nullptr;
+    int32_t nextOtherOverdue = 0;
+    pollableCount = 0;
+
+    for (auto& inv : _inverters) {
+        if (radio != nullptr && inv->getRadio() != radio) {
+            continue;
+        }
+
+        if (!inv->getRadio()->isInitialized()
+            || !(inv->getEnablePolling() || inv->getEnableCommands())) {
+            continue;
+        }
+
+        pollableCount++;
+
+        if (!inv->getRadio()->isQueueEmpty() || !inv->Schedule()->isDue(now)) {
+            continue;
+        }
+
+        // never polled inverters are treated as most overdue
+        const int32_t overdue = inv->Schedule()->getPollCount() == 0
+            ? INT32_MAX
+            : static_cast<int32_t>(now - inv->Schedule()->getNextPoll());
+
+        if (next == nullptr || overdue > nextOverdue) {
+            next = inv;
+            nextOverdue = overdue;
+        }
+
+        if (inv->Schedule()->getMode() != PollMode::Fast
+            && (nextOther == nullptr || overdue > nextOtherOverdue)) {
+            nextOther = inv;
+            nextOtherOverdue = overdue;
+        }
+    }
+
+    if (fastStreak >= HOY_POLL_FAST_MAX_STREAK && nextOther != nullptr) {
+        return nextOther;
+    }
+
+    return next;
+}
+
 std::shared_ptr<InverterAbstract> HoymilesClass::addInverter(const char* name, const uint64_t serial)
 {
     std::shared_ptr<InverterAbstract> i = nullptr;
@@ -272,11 +363,33 @@ void HoymilesClass::setPollInterval(const uint32_t interval)
     _pollInterval = interval;
 }
 
+bool HoymilesClass::getParallelPolling() const
+{
+    return _parallelPolling;
+}
+
+void HoymilesClass::setParallelPolling(const bool enabled)
+{
+    _parallelPolling = enabled;
+}
+
 void HoymilesClass::setVerboseLogging(bool verboseLogging)
 {
     _verboseLogging = verboseLogging;
 }
 
+void HoymilesClass::setCommandFinishedCallback(std::function<void(InverterAbstract&)> callback)
+{
+    _commandFinishedCallback = callback;
+}
+
+void HoymilesClass::handleCommandFinished(InverterAbstract& inv)
+{
+    if (_commandFinishedCallback) {
+        _commandFinishedCallback(inv);
+    }
+}
+
 void HoymilesClass::setMessageOutput(Print* output)
 {
     _messageOutput = output;
@@ -7,6 +7,7 @@
 #include "types.h"
 #include <Print.h>
 #include <SPI.h>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -36,11 +37,31 @@ public:
 
     uint32_t PollInterval() const;
     void setPollInterval(const uint32_t interval);
+
+    // if enabled, the NRF and the CMT radio poll their inverters
+    // concurrently, each at the poll interval.
+    bool getParallelPolling() const;
+    void setParallelPolling(const bool enabled);
     void setVerboseLogging(bool verboseLogging);
 
     bool isAllRadioIdle() const;
 
+    // invoked from within loop() whenever a command to an inverter finished,
+    // successfully or not, such that users can process new data immediately.
+    void setCommandFinishedCallback(std::function<void(InverterAbstract&)> callback);
+    void handleCommandFinished(InverterAbstract& inv);
+
 private:
+    struct PollState {
+        uint32_t lastPoll = 0;
+        uint8_t fastStreak = 0; // consecutive polls of inverters in fast mode
+    };
+
+    bool pollRadio(const HoymilesRadio* radio, PollState& state);
+    void pollInverter(const std::shared_ptr<InverterAbstract>& iv, const uint8_t pollableCount);
+    void performHousekeeping();
+    std::shared_ptr<InverterAbstract> getNextInverterToPoll(const uint32_t now, const HoymilesRadio* radio, const uint8_t fastStreak, uint8_t& pollableCount);
+
     std::vector<std::shared_ptr<InverterAbstract>> _inverters;
     std::unique_ptr<HoymilesRadio_NRF> _radioNrf;
     std::unique_ptr<HoymilesRadio_CMT> _radioCmt;
@@ -49,9 +70,14 @@ private:
 
     uint32_t _pollInterval = 0;
     bool _verboseLogging = true;
-    uint32_t _lastPoll = 0;
+    bool _parallelPolling = false;
+    PollState _pollState;
+    PollState _pollStateNrf;
+    PollState _pollStateCmt;
 
     Print* _messageOutput = &Serial;
+
+    std::function<void(InverterAbstract&)> _commandFinishedCallback;
 };
 
 extern HoymilesClass Hoymiles;
\ No newline at end of file
@@ -53,13 +53,14 @@ void HoymilesRadio::sendLastPacketAgain()
 
 void HoymilesRadio::handleReceivedPackage()
 {
-    if (_busyFlag && _rxTimeout.occured()) {
+    if (_busyFlag && (_rxTimeout.occured() || isAnswerOverdue())) {
         Hoymiles.getVerboseMessageOutput()->println("RX Period End");
         std::shared_ptr<InverterAbstract> inv = Hoymiles.getInverterBySerial(_commandQueue.front().get()->getTargetAddress());
 
         if (nullptr != inv) {
             CommandAbstract* cmd = _commandQueue.front().get();
             uint8_t verifyResult = inv->verifyAllFragments(*cmd);
+            inv->LinkStats()->trackResult(verifyResult);
             if (verifyResult == FRAGMENT_ALL_MISSING_RESEND) {
                 Hoymiles.getMessageOutput()->println("Nothing received, resend whole request");
                 sendLastPacketAgain();
@@ -91,6 +92,10 @@ void HoymilesRadio::handleReceivedPackage()
                 _commandQueue.pop();
                 _busyFlag = false;
             }
+
+            if (!_busyFlag) {
+                Hoymiles.handleCommandFinished(*inv);
+            }
         } else {
             // If inverter was not found, assume the command is invalid
             Hoymiles.getMessageOutput()->println("RX: Invalid inverter found");
@@ -114,6 +119,27 @@ void HoymilesRadio::handleReceivedPackage()
     }
 }
 
+// the receive period ends before the timeout of the packet once the answer
+// is complete or overdue according to the timing observed for the inverter
+bool HoymilesRadio::isAnswerOverdue() const
+{
+    if (nullptr == _rxInverter) {
+        return false;
+    }
+
+    return _rxInverter->LinkStats()->isAnswerOverdue(_rxCommandTimeout, _rxInverter->isRxComplete());
+}
+
+void HoymilesRadio::trackTx(const CommandAbstract& cmd, const uint8_t channel)
+{
+    _rxInverter = Hoymiles.getInverterBySerial(cmd.getTargetAddress());
+    _rxCommandTimeout = cmd.getTimeout();
+
+    if (nullptr != _rxInverter) {
+        _rxInverter->LinkStats()->trackTx(channel);
+    }
+}
+
 void HoymilesRadio::dumpBuf(const uint8_t buf[], const uint8_t len, const bool appendNewline)
 {
     for (uint8_t i = 0; i < len; i++) {
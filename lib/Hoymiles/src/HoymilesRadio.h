@@ -1,12 +1,14 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include "CommandQueue.h"
 #include "commands/CommandAbstract.h"
 #include "types.h"
-#include <ThreadSafeQueue.h>
 #include <TimeoutHelper.h>
 #include <memory>
 
+class InverterAbstract;
+
 class HoymilesRadio {
 public:
     serial_u DtuSerial() const;
@@ -21,6 +23,12 @@ public:
         _commandQueue.push(cmd);
     }
 
+    // Returns true if the command would replace a queued command that was not yet sent
+    bool canSupersedeCommand(const CommandAbstract& cmd) const
+    {
+        return _commandQueue.canSupersede(cmd);
+    }
+
     template <typename T>
     std::shared_ptr<T> prepareCommand(InverterAbstract* inv)
     {
@@ -36,11 +44,17 @@ protected:
     void sendRetransmitPacket(const uint8_t fragment_id);
     void sendLastPacketAgain();
     void handleReceivedPackage();
+    bool isAnswerOverdue() const;
+    void trackTx(const CommandAbstract& cmd, const uint8_t channel);
 
     serial_u _dtuSerial;
-    ThreadSafeQueue<std::shared_ptr<CommandAbstract>> _commandQueue;
+    CommandQueue _commandQueue;
     bool _isInitialized = false;
     bool _busyFlag = false;
 
     TimeoutHelper _rxTimeout;
+
+    // the inverter and the timeout of the packet sent last
+    std::shared_ptr<InverterAbstract> _rxInverter;
+    uint32_t _rxCommandTimeout = 0;
 };
@@ -128,7 +128,7 @@ void HoymilesRadio_CMT::loop()
     if (_packetReceived) {
         Hoymiles.getVerboseMessageOutput()->println("Interrupt received");
         while (_radio->available()) {
-            if (!(_rxBuffer.size() > FRAGMENT_BUFFER_SIZE)) {
+            if (_rxBuffer.size() < _rxBuffer.capacity()) {
                 fragment_t f;
                 memset(f.fragment, 0xcc, MAX_RF_PAYLOAD_SIZE);
                 f.len = _radio->getDynamicPayloadSize();
@@ -152,7 +152,7 @@ void HoymilesRadio_CMT::loop()
     } else {
         // Perform package parsing only if no packages are received
         if (!_rxBuffer.empty()) {
-            fragment_t f = _rxBuffer.back();
+            const fragment_t& f = *_rxBuffer.front();
             if (checkFragmentCrc(f)) {
 
                 const serial_u dtuId = convertSerialToRadioId(_dtuSerial);
@@ -169,6 +169,7 @@ void HoymilesRadio_CMT::loop()
                         dumpBuf(f.fragment, f.len, false);
                         Hoymiles.getVerboseMessageOutput()->printf("| %d dBm\r\n", f.rssi);
 
+                        inv->LinkStats()->trackRx(f.channel, f.rssi);
                         inv->addRxFragment(f.fragment, f.len);
                     } else {
                         Hoymiles.getMessageOutput()->println("Inverter Not found!");
@@ -277,6 +278,7 @@ void HoymilesRadio_CMT::sendEsbPacket(CommandAbstract& cmd)
     Hoymiles.getVerboseMessageOutput()->printf("TX %s %.2f MHz --> ",
         cmd.getCommandName().c_str(), getFrequencyFromChannel(_radio->getChannel()) / 1000000.0);
     cmd.dumpDataPayload(Hoymiles.getVerboseMessageOutput());
+    trackTx(cmd, _radio->getChannel());
 
     if (!_radio->write(cmd.getDataPayload(), cmd.getDataSize())) {
         Hoymiles.getMessageOutput()->println("TX SPI Timeout");
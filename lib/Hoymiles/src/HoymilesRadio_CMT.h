@@ -5,13 +5,13 @@
 #include "commands/CommandAbstract.h"
 #include "types.h"
 #include <Arduino.h>
+#include <LockFreeQueue.h>
 #include <cmt2300wrapper.h>
 #include <memory>
-#include <queue>
 #include <vector>
 
 // number of fragments hold in buffer
-#define FRAGMENT_BUFFER_SIZE 30
+#define FRAGMENT_BUFFER_SIZE 32
 
 #ifndef HOYMILES_CMT_WORK_FREQ
 #define HOYMILES_CMT_WORK_FREQ 865000000
@@ -80,7 +80,7 @@ private:
     bool _gpio2_configured = false;
     bool _gpio3_configured = false;
 
-    std::queue<fragment_t> _rxBuffer;
+    SpscQueue<fragment_t, FRAGMENT_BUFFER_SIZE> _rxBuffer;
     TimeoutHelper _txTimeout;
 
     uint32_t _inverterTargetFrequency = HOYMILES_CMT_WORK_FREQ;
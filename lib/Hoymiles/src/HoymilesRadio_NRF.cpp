@@ -50,7 +50,7 @@ void HoymilesRadio_NRF::loop()
     if (_packetReceived) {
         Hoymiles.getVerboseMessageOutput()->println("Interrupt received");
         while (_radio->available()) {
-            if (!(_rxBuffer.size() > FRAGMENT_BUFFER_SIZE)) {
+            if (_rxBuffer.size() < _rxBuffer.capacity()) {
                 fragment_t f;
                 memset(f.fragment, 0xcc, MAX_RF_PAYLOAD_SIZE);
                 f.len = _radio->getDynamicPayloadSize();
@@ -70,7 +70,7 @@ void HoymilesRadio_NRF::loop()
     } else {
         // Perform package parsing only if no packages are received
         if (!_rxBuffer.empty()) {
-            fragment_t f = _rxBuffer.back();
+            const fragment_t& f = *_rxBuffer.front();
             if (checkFragmentCrc(f)) {
                 std::shared_ptr<InverterAbstract> inv = Hoymiles.getInverterByFragment(f);
 
@@ -80,6 +80,7 @@ void HoymilesRadio_NRF::loop()
                     dumpBuf(f.fragment, f.len, false);
                     Hoymiles.getVerboseMessageOutput()->printf("| %d dBm\r\n", f.rssi);
 
+                    inv->LinkStats()->trackRx(f.channel, f.rssi);
                     inv->addRxFragment(f.fragment, f.len);
                 } else {
                     Hoymiles.getMessageOutput()->println("Inverter Not found!");
@@ -155,17 +156,34 @@ uint8_t HoymilesRadio_NRF::getRxNxtChannel()
     return _rxChLst[_rxChIdx];
 }
 
-uint8_t HoymilesRadio_NRF::getTxNxtChannel()
+uint8_t HoymilesRadio_NRF::getTxNxtChannel(LinkStatistics* linkStats)
 {
     if (++_txChIdx >= sizeof(_txChLst))
         _txChIdx = 0;
-    return _txChLst[_txChIdx];
+
+    if (linkStats == nullptr) {
+        return _txChLst[_txChIdx];
+    }
+
+    return _txChLst[linkStats->selectTxChannel(_txChLst, sizeof(_txChLst), _txChIdx)];
 }
 
 void HoymilesRadio_NRF::switchRxCh()
 {
+    uint8_t channel;
+
+    // while waiting for an answer, every other slot is spent on the channel
+    // the inverter was received best on recently.
+    if (_busyFlag && _rxPreferredCh > 0 && !_rxOnPreferredCh) {
+        channel = _rxPreferredCh;
+        _rxOnPreferredCh = true;
+    } else {
+        channel = getRxNxtChannel();
+        _rxOnPreferredCh = false;
+    }
+
     _radio->stopListening();
-    _radio->setChannel(getRxNxtChannel());
+    _radio->setChannel(channel);
     _radio->startListening();
 }
 
@@ -175,22 +193,29 @@ void HoymilesRadio_NRF::sendEsbPacket(CommandAbstract& cmd)
 
     cmd.setRouterAddress(DtuSerial().u64);
 
-    _radio->stopListening();
-    _radio->setChannel(getTxNxtChannel());
-
     serial_u s;
     s.u64 = cmd.getTargetAddress();
+
+    auto inv = Hoymiles.getInverterBySerial(s.u64);
+    LinkStatistics* linkStats = inv != nullptr ? inv->LinkStats() : nullptr;
+
+    _radio->stopListening();
+    _radio->setChannel(getTxNxtChannel(linkStats));
+
     openWritingPipe(s);
     _radio->setRetries(3, 15);
 
     Hoymiles.getVerboseMessageOutput()->printf("TX %s Channel: %d --> ",
         cmd.getCommandName().c_str(), _radio->getChannel());
     cmd.dumpDataPayload(Hoymiles.getVerboseMessageOutput());
+    trackTx(cmd, _radio->getChannel());
     _radio->write(cmd.getDataPayload(), cmd.getDataSize());
 
     _radio->setRetries(0, 0);
     openReadingPipe();
-    _radio->setChannel(getRxNxtChannel());
+    _rxPreferredCh = linkStats != nullptr ? linkStats->getBestRxChannel() : 0;
+    _rxOnPreferredCh = _rxPreferredCh > 0;
+    _radio->setChannel(_rxOnPreferredCh ? _rxPreferredCh : getRxNxtChannel());
     _radio->startListening();
     _busyFlag = true;
     _rxTimeout.set(cmd.getTimeout());
@@ -2,14 +2,15 @@
 #pragma once
 
 #include "HoymilesRadio.h"
+#include "LinkStatistics.h"
 #include "commands/CommandAbstract.h"
+#include <LockFreeQueue.h>
 #include <RF24.h>
 #include <memory>
 #include <nRF24L01.h>
-#include <queue>
 
 // number of fragments hold in buffer
-#define FRAGMENT_BUFFER_SIZE 30
+#define FRAGMENT_BUFFER_SIZE 32
 
 class HoymilesRadio_NRF : public HoymilesRadio {
 public:
@@ -25,7 +26,7 @@ public:
 private:
     void ARDUINO_ISR_ATTR handleIntr();
     uint8_t getRxNxtChannel();
-    uint8_t getTxNxtChannel();
+    uint8_t getTxNxtChannel(LinkStatistics* linkStats);
     void switchRxCh();
     void openReadingPipe();
     void openWritingPipe(const serial_u serial);
@@ -40,7 +41,10 @@ private:
     uint8_t _txChLst[5] = { 3, 23, 40, 61, 75 };
     uint8_t _txChIdx = 0;
 
+    uint8_t _rxPreferredCh = 0; // 0 if there is no preferred channel
+    bool _rxOnPreferredCh = false;
+
     volatile bool _packetReceived = false;
 
-    std::queue<fragment_t> _rxBuffer;
+    SpscQueue<fragment_t, FRAGMENT_BUFFER_SIZE> _rxBuffer;
 };
\ No newline at end of file
@@ -0,0 +1,232 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "LinkStatistics.h"
+#include "inverters/InverterAbstract.h"
+#include <Arduino.h>
+#include <cmath>
+
+void LinkStatistics::Timing::add(const uint32_t sample)
+{
+    if (samples == 0) {
+        mean = sample;
+        deviation = sample / 2.0f;
+    } else {
+        deviation = deviation * 0.75f + std::fabs(sample - mean) * 0.25f;
+        mean = mean * 0.875f + sample * 0.125f;
+    }
+
+    if (samples < UINT32_MAX) {
+        samples++;
+    }
+}
+
+// an answer was missed, possibly because the bound was too tight
+void LinkStatistics::Timing::backOff()
+{
+    deviation = deviation * 2 + 1;
+}
+
+bool LinkStatistics::Timing::isValid() const
+{
+    return samples >= HOY_LINK_TIMING_MIN_SAMPLES;
+}
+
+uint32_t LinkStatistics::Timing::getBound() const
+{
+    return mean + 4 * deviation + HOY_LINK_TIMING_MARGIN;
+}
+
+LinkStatistics::ChannelStats* LinkStatistics::getStats(const uint8_t channel)
+{
+    for (uint8_t i = 0; i < _channelCount; i++) {
+        if (_channels[i].channel == channel) {
+            return &_channels[i];
+        }
+    }
+
+    if (_channelCount >= HOY_LINK_MAX_CHANNELS) {
+        return nullptr;
+    }
+
+    ChannelStats& stats = _channels[_channelCount++];
+    stats.channel = channel;
+    return &stats;
+}
+
+void LinkStatistics::trackTx(const uint8_t channel)
+{
+    _pendingTx = getStats(channel);
+    _pendingAnswered = false;
+    _txCount++;
+    _txMillis = millis();
+
+    if (_pendingTx != nullptr) {
+        _pendingTx->txCount++;
+    }
+}
+
+void LinkStatistics::trackRx(const uint8_t channel, const int8_t rssi)
+{
+    // fragments arriving after the receive period ended are sampled as well,
+    // such that a bound which is too tight is corrected.
+    const uint32_t now = millis();
+    if (_txCount > 0) {
+        if (!_pendingAnswered) {
+            _latency.add(now - _txMillis);
+        } else {
+            _fragmentGap.add(now - _lastRxMillis);
+        }
+    }
+    _lastRxMillis = now;
+    _pendingAnswered = true;
+
+    ChannelStats* stats = getStats(channel);
+    if (stats == nullptr) {
+        return;
+    }
+
+    stats->rssi = stats->rxCount == 0 ? rssi : stats->rssi * 0.9f + rssi * 0.1f;
+    stats->rxCount++;
+    stats->rxScore += 1;
+}
+
+void LinkStatistics::trackResult(const uint8_t verifyResult)
+{
+    if (_pendingTx != nullptr) {
+        _pendingTx->txAnswered += _pendingAnswered ? 1 : 0;
+        _pendingTx->txScore = _pendingTx->txScore * 0.8f + (_pendingAnswered ? 0.2f : 0);
+    }
+    _pendingTx = nullptr;
+
+    // older receptions count less, such that the preferred receive channel
+    // follows changes of the link
+    for (uint8_t i = 0; i < _channelCount; i++) {
+        _channels[i].rxScore *= 0.9f;
+    }
+
+    switch (verifyResult) {
+    case FRAGMENT_ALL_MISSING_RESEND:
+        _resendCount++;
+        _latency.backOff();
+        return;
+    case FRAGMENT_ALL_MISSING_TIMEOUT:
+    case FRAGMENT_RETRANSMIT_TIMEOUT:
+        _timeoutCount++;
+        break;
+    case FRAGMENT_HANDLE_ERROR:
+        _errorCount++;
+        break;
+    case FRAGMENT_OK:
+        _successCount++;
+        break;
+    default:
+        // the missing fragment is requested, the command is not finished yet
+        _retransmitCount++;
+        _fragmentGap.backOff();
+        return;
+    }
+
+    _commandCount++;
+}
+
+bool LinkStatistics::isAnswerOverdue(const uint32_t timeout, const bool rxComplete) const
+{
+    const uint32_t now = millis();
+
+    if (rxComplete) {
+        return now - _lastRxMillis > HOY_LINK_TIMING_MARGIN;
+    }
+
+    if (timeout > HOY_LINK_ADAPTIVE_MAX_TIMEOUT) {
+        return false;
+    }
+
+    if (!_pendingAnswered) {
+        return _latency.isValid() && now - _txMillis > _latency.getBound();
+    }
+
+    return _fragmentGap.isValid() && now - _lastRxMillis > _fragmentGap.getBound();
+}
+
+uint32_t LinkStatistics::getAnswerLatency() const
+{
+    return _latency.samples > 0 ? _latency.mean : 0;
+}
+
+uint32_t LinkStatistics::getFragmentGap() const
+{
+    return _fragmentGap.samples > 0 ? _fragmentGap.mean : 0;
+}
+
+uint8_t LinkStatistics::selectTxChannel(const uint8_t channels[], const uint8_t count, const uint8_t roundRobinIdx)
+{
+    if (_txCount % HOY_LINK_EXPLORE_INTERVAL == 0) {
+        return roundRobinIdx;
+    }
+
+    uint8_t best = roundRobinIdx;
+    float bestScore = -1;
+    for (uint8_t i = 0; i < count; i++) {
+        const ChannelStats* stats = getStats(channels[i]);
+        const float score = stats != nullptr ? stats->txScore : 0.5f;
+        if (score > bestScore) {
+            best = i;
+            bestScore = score;
+        }
+    }
+
+    return best;
+}
+
+uint8_t LinkStatistics::getBestRxChannel() const
+{
+    uint8_t best = 0;
+    float bestScore = 0;
+    for (uint8_t i = 0; i < _channelCount; i++) {
+        if (_channels[i].rxScore > bestScore) {
+            best = _channels[i].channel;
+            bestScore = _channels[i].rxScore;
+        }
+    }
+
+    return best;
+}
+
+uint8_t LinkStatistics::getChannelCount() const
+{
+    return _channelCount;
+}
+
+const LinkStatistics::ChannelStats& LinkStatistics::getChannel(const uint8_t idx) const
+{
+    return _channels[idx];
+}
+
+uint32_t LinkStatistics::getCommandCount() const
+{
+    return _commandCount;
+}
+
+uint32_t LinkStatistics::getSuccessCount() const
+{
+    return _successCount;
+}
+
+uint32_t LinkStatistics::getResendCount() const
+{
+    return _resendCount;
+}
+
+uint32_t LinkStatistics::getRetransmitCount() const
+{
+    return _retransmitCount;
+}
+
+uint32_t LinkStatistics::getTimeoutCount() const
+{
+    return _timeoutCount;
+}
+
+uint32_t LinkStatistics::getErrorCount() const
+{
+    return _errorCount;
+}
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstdint>
+
+// number of RF channels tracked per inverter
+#define HOY_LINK_MAX_CHANNELS 5
+// every n-th transmission uses the next channel in turn rather than the best
+// channel, such that the statistics of all channels stay current.
+#define HOY_LINK_EXPLORE_INTERVAL 4
+// the receive period of requests with at most this timeout (ms) ends as soon
+// as the answer is overdue according to the timing observed for the inverter.
+// device control commands take the inverter longer and keep their timeout.
+#define HOY_LINK_ADAPTIVE_MAX_TIMEOUT 750
+// number of timing samples required before the timing is used
+#define HOY_LINK_TIMING_MIN_SAMPLES 8
+// ms added to the observed timing, covers channel hopping and loop jitter
+#define HOY_LINK_TIMING_MARGIN 20
+
+class LinkStatistics {
+public:
+    struct ChannelStats {
+        uint8_t channel = 0;
+        uint32_t txCount = 0; // packets sent on this channel
+        uint32_t txAnswered = 0; // of which at least one fragment was received
+        uint32_t rxCount = 0; // fragments received on this channel
+        float rssi = 0; // exponential moving average in dBm
+
+        float txScore = 0.5f; // moving average of the answer rate
+        float rxScore = 0; // decaying number of received fragments
+    };
+
+    // To be called by the radio whenever a packet is sent to or a fragment
+    // is received from the inverter.
+    void trackTx(const uint8_t channel);
+    void trackRx(const uint8_t channel, const int8_t rssi);
+
+    // To be called with the result of verifyAllFragments() at the end of
+    // each receive period.
+    void trackResult(const uint8_t verifyResult);
+
+    // Returns the index within channels to send the next packet on. Mostly
+    // the channel with the best answer rate, every HOY_LINK_EXPLORE_INTERVAL
+    // transmissions the channel at roundRobinIdx.
+    uint8_t selectTxChannel(const uint8_t channels[], const uint8_t count, const uint8_t roundRobinIdx);
+
+    // The channel most fragments were received on recently, 0 if unknown
+    uint8_t getBestRxChannel() const;
+
+    // Returns true if the receive period of the last request can end before
+    // its timeout: the answer is complete and no more fragments arrive, or
+    // the first or next fragment is overdue.
+    bool isAnswerOverdue(const uint32_t timeout, const bool rxComplete) const;
+
+    // Smoothed time in ms from a request to the first fragment of the answer
+    // and between consecutive fragments, 0 if unknown
+    uint32_t getAnswerLatency() const;
+    uint32_t getFragmentGap() const;
+
+    uint8_t getChannelCount() const;
+    const ChannelStats& getChannel(const uint8_t idx) const;
+
+    uint32_t getCommandCount() const;
+    uint32_t getSuccessCount() const;
+    uint32_t getResendCount() const;
+    uint32_t getRetransmitCount() const;
+    uint32_t getTimeoutCount() const;
+    uint32_t getErrorCount() const;
+
+private:
+    // mean and mean deviation of a duration, as for TCP's retransmit timer
+    struct Timing {
+        float mean = 0;
+        float deviation = 0;
+        uint32_t samples = 0;
+
+        void add(const uint32_t sample);
+        void backOff();
+        bool isValid() const;
+        uint32_t getBound() const;
+    };
+
+    ChannelStats* getStats(const uint8_t channel);
+
+    ChannelStats _channels[HOY_LINK_MAX_CHANNELS];
+    uint8_t _channelCount = 0;
+
+    ChannelStats* _pendingTx = nullptr;
+    bool _pendingAnswered = false;
+    uint32_t _txCount = 0;
+
+    Timing _latency;
+    Timing _fragmentGap;
+    uint32_t _txMillis = 0;
+    uint32_t _lastRxMillis = 0;
+
+    uint32_t _commandCount = 0;
+    uint32_t _successCount = 0;
+    uint32_t _resendCount = 0;
+    uint32_t _retransmitCount = 0;
+    uint32_t _timeoutCount = 0;
+    uint32_t _errorCount = 0;
+};
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "PollSchedule.h"
+#include "inverters/InverterAbstract.h"
+
+void PollSchedule::setHighPriority(const bool enabled)
+{
+    _highPriority = enabled;
+}
+
+bool PollSchedule::getHighPriority() const
+{
+    return _highPriority;
+}
+
+PollMode PollSchedule::getMode() const
+{
+    return _mode;
+}
+
+const char* PollSchedule::getModeName() const
+{
+    switch (_mode) {
+    case PollMode::Fast:
+        return "fast";
+    case PollMode::Idle:
+        return "idle";
+    case PollMode::Probe:
+        return "probe";
+    default:
+        return "normal";
+    }
+}
+
+uint8_t PollSchedule::getBackoff() const
+{
+    return _backoff;
+}
+
+uint32_t PollSchedule::getInterval() const
+{
+    return _interval;
+}
+
+uint32_t PollSchedule::getNextPoll() const
+{
+    return _lastPoll + _interval;
+}
+
+bool PollSchedule::isDue(const uint32_t now) const
+{
+    return _pollCount == 0 || (now - _lastPoll) >= _interval;
+}
+
+void PollSchedule::polled(InverterAbstract& inv, const uint32_t baseInterval, const uint8_t inverterCount)
+{
+    PollMode mode = PollMode::Normal;
+    if (!inv.getEnablePolling()) {
+        // only commands are sent, nothing to adapt to
+        mode = PollMode::Normal;
+    } else if (!inv.isReachable()) {
+        mode = PollMode::Probe;
+    } else if (_highPriority) {
+        mode = PollMode::Fast;
+    } else if (!inv.isProducing()) {
+        mode = PollMode::Idle;
+    }
+
+    // back off exponentially as long as the inverter stays idle or unreachable
+    if (mode != _mode) {
+        _backoff = 0;
+    } else if (mode == PollMode::Idle && _backoff < HOY_POLL_IDLE_MAX_BACKOFF) {
+        _backoff++;
+    } else if (mode == PollMode::Probe && _backoff < HOY_POLL_PROBE_MAX_BACKOFF) {
+        _backoff++;
+    }
+    _mode = mode;
+
+    // an inverter without special needs is polled once per round,
+    // i.e., as often as with a plain round robin schedule.
+    const uint32_t roundInterval = baseInterval * (inverterCount > 0 ? inverterCount : 1);
+
+    switch (_mode) {
+    case PollMode::Fast:
+        _interval = baseInterval;
+        break;
+    case PollMode::Idle:
+    case PollMode::Probe:
+        _interval = roundInterval << _backoff;
+        break;
+    default:
+        _interval = roundInterval;
+        break;
+    }
+
+    _lastPoll = millis();
+    _pollCount++;
+}
+
+void PollSchedule::trackStatistics(const uint32_t lastUpdate)
+{
+    if (lastUpdate == 0 || lastUpdate == _lastStatistics) {
+        return;
+    }
+
+    if (_lastStatistics > 0) {
+        const float interval = lastUpdate - _lastStatistics;
+        if (_avgStatisticsInterval <= 0) {
+            _avgStatisticsInterval = interval;
+        } else {
+            _avgStatisticsInterval = _avgStatisticsInterval * 0.75f + interval * 0.25f;
+        }
+    }
+
+    _lastStatistics = lastUpdate;
+}
+
+float PollSchedule::getUpdateRate() const
+{
+    if (_avgStatisticsInterval <= 0) {
+        return 0;
+    }
+    return 60000.0f / _avgStatisticsInterval;
+}
+
+uint32_t PollSchedule::getPollCount() const
+{
+    return _pollCount;
+}
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstdint>
+
+// maximum exponent of the poll interval backoff of idle inverters (factor 8)
+#define HOY_POLL_IDLE_MAX_BACKOFF 3
+// maximum exponent of the poll interval backoff of unreachable inverters (factor 4)
+#define HOY_POLL_PROBE_MAX_BACKOFF 2
+// maximum number of consecutive poll slots given to inverters in fast mode
+// while other inverters are due, i.e., the others get at least every 4th slot
+#define HOY_POLL_FAST_MAX_STREAK 3
+
+enum class PollMode : uint8_t {
+    Fast, // inverter is controlled by an application (e.g., a power limiter)
+    Normal, // inverter is reachable and producing
+    Idle, // inverter is reachable but not producing
+    Probe, // inverter is unreachable, only short requests are sent
+};
+
+class InverterAbstract;
+
+class PollSchedule {
+public:
+    // Inverters with high priority are polled at the base poll interval
+    void setHighPriority(const bool enabled);
+    bool getHighPriority() const;
+
+    PollMode getMode() const;
+    const char* getModeName() const;
+    uint8_t getBackoff() const;
+
+    // Interval in ms between two polls of this inverter
+    uint32_t getInterval() const;
+    uint32_t getNextPoll() const;
+    bool isDue(const uint32_t now) const;
+
+    // Determines the mode and interval according to the inverter state and
+    // schedules the next poll. To be called whenever the inverter is polled.
+    void polled(InverterAbstract& inv, const uint32_t baseInterval, const uint8_t inverterCount);
+
+    // Accounts for statistics that were received from the inverter
+    void trackStatistics(const uint32_t lastUpdate);
+
+    // Achieved rate of statistics updates per minute
+    float getUpdateRate() const;
+    uint32_t getPollCount() const;
+
+private:
+    bool _highPriority = false;
+    PollMode _mode = PollMode::Normal;
+    uint8_t _backoff = 0;
+    uint32_t _interval = 0;
+    uint32_t _lastPoll = 0;
+    uint32_t _pollCount = 0;
+
+    uint32_t _lastStatistics = 0;
+    float _avgStatisticsInterval = 0; // exponential moving average in ms
+};
@@ -138,3 +138,16 @@ uint8_t CommandAbstract::getMaxRetransmitCount() const
 {
     return MAX_RETRANSMIT_COUNT;
 }
+
+CommandPriority CommandAbstract::getPriority() const
+{
+    return CommandPriority::Normal;
+}
+
+bool CommandAbstract::supersedes(const CommandAbstract& other) const
+{
+    // Same main command and sub command (or data type) to the same inverter
+    return getTargetAddress() == other.getTargetAddress()
+        && _payload[0] == other._payload[0]
+        && _payload[10] == other._payload[10];
+}
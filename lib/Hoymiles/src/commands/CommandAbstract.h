@@ -9,6 +9,11 @@
 #define MAX_RESEND_COUNT 4 // Used if all packages are missing
 #define MAX_RETRANSMIT_COUNT 5 // Used to send the retransmit package
 
+enum class CommandPriority : uint8_t {
+    High, // Commands which change the inverter state (limit, power)
+    Normal, // Polling requests
+};
+
 class InverterAbstract;
 
 class CommandAbstract {
@@ -46,6 +51,12 @@ public:
     // Sets the amount how often a missing fragment is re-requested if it was not available
     virtual uint8_t getMaxRetransmitCount() const;
 
+    // Commands with higher priority are sent before queued commands with lower priority
+    virtual CommandPriority getPriority() const;
+
+    // Returns true if this command makes the other (queued) command obsolete
+    virtual bool supersedes(const CommandAbstract& other) const;
+
 protected:
     uint8_t _payload[RF_LEN];
     uint8_t _payload_size;
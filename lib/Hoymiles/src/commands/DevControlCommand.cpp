@@ -49,3 +49,8 @@ bool DevControlCommand::handleResponse(const fragment_t fragment[], const uint8_
 
     return true;
 }
+
+CommandPriority DevControlCommand::getPriority() const
+{
+    return CommandPriority::High;
+}
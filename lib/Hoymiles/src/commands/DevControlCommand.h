@@ -9,6 +9,8 @@ public:
 
     virtual bool handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id);
 
+    virtual CommandPriority getPriority() const;
+
 protected:
     void udpateCRC(const uint8_t len);
 };
@@ -60,6 +60,13 @@ void PowerControlCommand::gotTimeout()
     _inv->PowerCommand()->setLastPowerCommandSuccess(CMD_NOK);
 }
 
+bool PowerControlCommand::supersedes(const CommandAbstract& other) const
+{
+    // A newer power command (on, off or restart) replaces any queued one
+    return getTargetAddress() == other.getTargetAddress()
+        && getCommandName() == other.getCommandName();
+}
+
 void PowerControlCommand::setPowerOn(const bool state)
 {
     if (state) {
@@ -12,6 +12,8 @@ public:
     virtual bool handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id);
     virtual void gotTimeout();
 
+    virtual bool supersedes(const CommandAbstract& other) const;
+
     void setPowerOn(const bool state);
     void setRestart();
 };
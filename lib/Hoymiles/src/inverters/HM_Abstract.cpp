@@ -122,19 +122,21 @@ bool HM_Abstract::sendActivePowerControlRequest(float limit, const PowerLimitCon
         return false;
     }
 
-    if (CMD_PENDING == SystemConfigPara()->getLastLimitCommandSuccess()) {
-        return false;
-    }
-
     if (type == PowerLimitControlType::RelativNonPersistent || type == PowerLimitControlType::RelativPersistent) {
         limit = min<float>(100, limit);
     }
 
+    auto cmd = _radio->prepareCommand<ActivePowerControlCommand>(this);
+    cmd->setActivePowerLimit(limit, type);
+
+    // A pending limit command can only be replaced as long as it was not sent yet
+    if (CMD_PENDING == SystemConfigPara()->getLastLimitCommandSuccess() && !_radio->canSupersedeCommand(*cmd)) {
+        return false;
+    }
+
     _activePowerControlLimit = limit;
     _activePowerControlType = type;
 
-    auto cmd = _radio->prepareCommand<ActivePowerControlCommand>(this);
-    cmd->setActivePowerLimit(limit, type);
     SystemConfigPara()->setLastLimitCommandSuccess(CMD_PENDING);
     _radio->enqueCommand(cmd);
 
@@ -152,7 +154,11 @@ bool HM_Abstract::sendPowerControlRequest(const bool turnOn)
         return false;
     }
 
-    if (CMD_PENDING == PowerCommand()->getLastPowerCommandSuccess()) {
+    auto cmd = _radio->prepareCommand<PowerControlCommand>(this);
+    cmd->setPowerOn(turnOn);
+
+    // A pending power command can only be replaced as long as it was not sent yet
+    if (CMD_PENDING == PowerCommand()->getLastPowerCommandSuccess() && !_radio->canSupersedeCommand(*cmd)) {
         return false;
     }
 
@@ -162,8 +168,6 @@ bool HM_Abstract::sendPowerControlRequest(const bool turnOn)
         _powerState = 0;
     }
 
-    auto cmd = _radio->prepareCommand<PowerControlCommand>(this);
-    cmd->setPowerOn(turnOn);
     PowerCommand()->setLastPowerCommandSuccess(CMD_PENDING);
     _radio->enqueCommand(cmd);
 
@@ -177,6 +177,16 @@ SystemConfigParaParser* InverterAbstract::SystemConfigPara()
     return _systemConfigParaParser.get();
 }
 
+PollSchedule* InverterAbstract::Schedule()
+{
+    return &_pollSchedule;
+}
+
+LinkStatistics* InverterAbstract::LinkStats()
+{
+    return &_linkStatistics;
+}
+
 void InverterAbstract::clearRxFragmentBuffer()
 {
     memset(_rxFragmentBuffer, 0, MAX_RF_FRAGMENT_COUNT * sizeof(fragment_t));
@@ -228,6 +238,22 @@ void InverterAbstract::addRxFragment(const uint8_t fragment[], const uint8_t len
 }
 
 // Returns Zero on Success or the Fragment ID for retransmit or error code
+// true if the last fragment (the one with 0x80) and all before were received
+bool InverterAbstract::isRxComplete() const
+{
+    if (_rxFragmentMaxPacketId == 0) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < _rxFragmentMaxPacketId; i++) {
+        if (!_rxFragmentBuffer[i].wasReceived) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 uint8_t InverterAbstract::verifyAllFragments(CommandAbstract& cmd)
 {
     // All missing
@@ -7,8 +7,11 @@
 #include "../parser/GridProfileParser.h"
 #include "../parser/PowerCommandParser.h"
 #include "../parser/StatisticsParser.h"
+#include "../parser/StatisticsSnapshot.h"
 #include "../parser/SystemConfigParaParser.h"
 #include "HoymilesRadio.h"
+#include "LinkStatistics.h"
+#include "PollSchedule.h"
 #include "types.h"
 #include <Arduino.h>
 #include <cstdint>
@@ -64,6 +67,7 @@ public:
     void clearRxFragmentBuffer();
     void addRxFragment(const uint8_t fragment[], const uint8_t len);
     uint8_t verifyAllFragments(CommandAbstract& cmd);
+    bool isRxComplete() const;
 
     virtual bool sendStatsRequest() = 0;
     virtual bool sendAlarmLogRequest(const bool force = false) = 0;
@@ -86,6 +90,9 @@ public:
     StatisticsParser* Statistics();
     SystemConfigParaParser* SystemConfigPara();
 
+    PollSchedule* Schedule();
+    LinkStatistics* LinkStats();
+
 protected:
     HoymilesRadio* _radio;
 
@@ -113,4 +120,7 @@ private:
     std::unique_ptr<PowerCommandParser> _powerCommandParser;
     std::unique_ptr<StatisticsParser> _statisticsParser;
     std::unique_ptr<SystemConfigParaParser> _systemConfigParaParser;
+
+    PollSchedule _pollSchedule;
+    LinkStatistics _linkStatistics;
 };
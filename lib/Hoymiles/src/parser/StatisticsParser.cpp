@@ -4,6 +4,7 @@
  */
 #include "StatisticsParser.h"
 #include "../Hoymiles.h"
+#include "StatisticsSnapshot.h"
 
 static float calcTotalYieldTotal(StatisticsParser* iv, uint8_t arg0);
 static float calcTotalYieldDay(StatisticsParser* iv, uint8_t arg0);
@@ -56,10 +57,25 @@ const FieldId_t dailyProductionFields[] = {
     FLD_YD,
 };
 
+StatisticsLayout::StatisticsLayout()
+{
+    memset(fieldIndex, FIELD_INDEX_NONE, sizeof(fieldIndex));
+}
+
+uint8_t StatisticsLayout::getIndex(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
+{
+    if (type >= TYPE_CNT || channel >= CH_CNT || fieldId >= FLD_CNT) {
+        return FIELD_INDEX_NONE;
+    }
+    return fieldIndex[type][channel][fieldId];
+}
+
 StatisticsParser::StatisticsParser()
     : Parser()
 {
+    _layout = std::make_shared<StatisticsLayout>();
     clearBuffer();
+    publishSnapshot();
 }
 
 void StatisticsParser::setByteAssignment(const byteAssign_t* byteAssignment, const uint8_t size)
@@ -67,12 +83,37 @@ void StatisticsParser::setByteAssignment(const byteAssign_t* byteAssignment, con
     _byteAssignment = byteAssignment;
     _byteAssignmentSize = size;
 
+    auto layout = std::make_shared<StatisticsLayout>();
+    layout->byteAssignment = byteAssignment;
+    layout->byteAssignmentSize = size;
+
     for (uint8_t i = 0; i < _byteAssignmentSize; i++) {
-        if (_byteAssignment[i].div == CMD_CALC) {
+        const byteAssign_t& assign = _byteAssignment[i];
+
+        // keep the first assignment in case of duplicates, like the former linear search did
+        if (layout->fieldIndex[assign.type][assign.ch][assign.fieldId] == FIELD_INDEX_NONE) {
+            layout->fieldIndex[assign.type][assign.ch][assign.fieldId] = i;
+        }
+        layout->channelsByType[assign.type].push_back(assign.ch);
+
+        if (assign.div == CMD_CALC) {
             continue;
         }
-        _expectedByteCount = max<uint8_t>(_expectedByteCount, _byteAssignment[i].start + _byteAssignment[i].num);
+        _expectedByteCount = max<uint8_t>(_expectedByteCount, assign.start + assign.num);
     }
+
+    for (auto& l : layout->channelsByType) {
+        l.unique();
+    }
+
+    HOY_SEMAPHORE_TAKE();
+    _layout = layout;
+    _fieldOffsets.assign(_byteAssignmentSize, 0);
+    _fieldValues.assign(_byteAssignmentSize, 0);
+    updateValueCache();
+    HOY_SEMAPHORE_GIVE();
+
+    publishSnapshot();
 }
 
 uint8_t StatisticsParser::getExpectedByteCount()
@@ -98,6 +139,10 @@ void StatisticsParser::appendFragment(const uint8_t offset, const uint8_t* paylo
 
 void StatisticsParser::endAppendFragment()
 {
+    // Decode all values once while the semaphore is still held, readers
+    // only access the decoded values afterwards.
+    updateValueCache();
+
     Parser::endAppendFragment();
 
     if (!_enableYieldDayCorrection) {
@@ -120,78 +165,86 @@ void StatisticsParser::endAppendFragment()
     }
 }
 
-const byteAssign_t* StatisticsParser::getAssignmentByChannelField(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
+uint8_t StatisticsParser::getIndexByChannelField(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
 {
-    for (uint8_t i = 0; i < _byteAssignmentSize; i++) {
-        if (_byteAssignment[i].type == type && _byteAssignment[i].ch == channel && _byteAssignment[i].fieldId == fieldId) {
-            return &_byteAssignment[i];
-        }
-    }
-    return nullptr;
+    return _layout->getIndex(type, channel, fieldId);
 }
 
-fieldSettings_t* StatisticsParser::getSettingByChannelField(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId)
+const byteAssign_t* StatisticsParser::getAssignmentByChannelField(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
 {
-    for (auto& i : _fieldSettings) {
-        if (i.type == type && i.ch == channel && i.fieldId == fieldId) {
-            return &i;
-        }
+    const uint8_t index = getIndexByChannelField(type, channel, fieldId);
+    if (index == FIELD_INDEX_NONE) {
+        return nullptr;
     }
-    return nullptr;
+    return &_byteAssignment[index];
 }
 
-float StatisticsParser::getChannelFieldValue(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId)
+// Has to be called while holding the semaphore
+float StatisticsParser::decodeFieldValue(const uint8_t index) const
 {
-    const byteAssign_t* pos = getAssignmentByChannelField(type, channel, fieldId);
-    if (pos == nullptr) {
-        return 0;
-    }
+    const byteAssign_t* pos = &_byteAssignment[index];
 
     uint8_t ptr = pos->start;
     const uint8_t end = ptr + pos->num;
     const uint16_t div = pos->div;
 
-    if (CMD_CALC != div) {
-        // Value is a static value
-        uint32_t val = 0;
-        HOY_SEMAPHORE_TAKE();
-        do {
-            val <<= 8;
-            val |= _payloadStatistic[ptr];
-        } while (++ptr != end);
-        HOY_SEMAPHORE_GIVE();
+    uint32_t val = 0;
+    do {
+        val <<= 8;
+        val |= _payloadStatistic[ptr];
+    } while (++ptr != end);
 
-        float result;
-        if (pos->isSigned && pos->num == 2) {
-            result = static_cast<float>(static_cast<int16_t>(val));
-        } else if (pos->isSigned && pos->num == 4) {
-            result = static_cast<float>(static_cast<int32_t>(val));
-        } else {
-            result = static_cast<float>(val);
-        }
+    float result;
+    if (pos->isSigned && pos->num == 2) {
+        result = static_cast<float>(static_cast<int16_t>(val));
+    } else if (pos->isSigned && pos->num == 4) {
+        result = static_cast<float>(static_cast<int32_t>(val));
+    } else {
+        result = static_cast<float>(val);
+    }
 
-        result /= static_cast<float>(div);
+    result /= static_cast<float>(div);
 
-        const fieldSettings_t* setting = getSettingByChannelField(type, channel, fieldId);
-        if (setting != nullptr && _statisticLength > 0) {
-            result += setting->offset;
+    if (_statisticLength > 0) {
+        result += _fieldOffsets[index];
+    }
+    return result;
+}
+
+// Has to be called while holding the semaphore
+void StatisticsParser::updateValueCache()
+{
+    // Static values first, as the calculated values are based on them
+    for (uint8_t i = 0; i < _byteAssignmentSize; i++) {
+        if (_byteAssignment[i].div != CMD_CALC) {
+            _fieldValues[i] = decodeFieldValue(i);
         }
-        return result;
-    } else {
-        // Value has to be calculated
-        return calcFunctions[pos->start].func(this, pos->num);
     }
 
-    return 0;
+    for (uint8_t i = 0; i < _byteAssignmentSize; i++) {
+        if (_byteAssignment[i].div == CMD_CALC) {
+            _fieldValues[i] = calcFunctions[_byteAssignment[i].start].func(this, _byteAssignment[i].num);
+        }
+    }
+}
+
+float StatisticsParser::getChannelFieldValue(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
+{
+    const uint8_t index = getIndexByChannelField(type, channel, fieldId);
+    if (index == FIELD_INDEX_NONE) {
+        return 0;
+    }
+    return _fieldValues[index];
 }
 
 bool StatisticsParser::setChannelFieldValue(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, float value)
 {
-    const byteAssign_t* pos = getAssignmentByChannelField(type, channel, fieldId);
-    if (pos == nullptr) {
+    const uint8_t index = getIndexByChannelField(type, channel, fieldId);
+    if (index == FIELD_INDEX_NONE) {
         return false;
     }
 
+    const byteAssign_t* pos = &_byteAssignment[index];
     uint8_t ptr = pos->start + pos->num - 1;
     const uint8_t end = pos->start;
     const uint16_t div = pos->div;
@@ -200,10 +253,7 @@ bool StatisticsParser::setChannelFieldValue(const ChannelType_t type, const Chan
         return false;
     }
 
-    const fieldSettings_t* setting = getSettingByChannelField(type, channel, fieldId);
-    if (setting != nullptr) {
-        value -= setting->offset;
-    }
+    value -= _fieldOffsets[index];
     value *= static_cast<float>(div);
 
     uint32_t val = 0;
@@ -220,12 +270,13 @@ bool StatisticsParser::setChannelFieldValue(const ChannelType_t type, const Chan
         _payloadStatistic[ptr] = val;
         val >>= 8;
     } while (--ptr >= end);
+    updateValueCache();
     HOY_SEMAPHORE_GIVE();
 
     return true;
 }
 
-String StatisticsParser::getChannelFieldValueString(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId)
+String StatisticsParser::getChannelFieldValueString(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
 {
     return String(
         getChannelFieldValue(type, channel, fieldId),
@@ -234,8 +285,7 @@ String StatisticsParser::getChannelFieldValueString(const ChannelType_t type, co
 
 bool StatisticsParser::hasChannelFieldValue(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
 {
-    const byteAssign_t* pos = getAssignmentByChannelField(type, channel, fieldId);
-    return pos != nullptr;
+    return getIndexByChannelField(type, channel, fieldId) != FIELD_INDEX_NONE;
 }
 
 const char* StatisticsParser::getChannelFieldUnit(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
@@ -256,23 +306,26 @@ uint8_t StatisticsParser::getChannelFieldDigits(const ChannelType_t type, const
     return pos->digits;
 }
 
-float StatisticsParser::getChannelFieldOffset(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId)
+float StatisticsParser::getChannelFieldOffset(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
 {
-    const fieldSettings_t* setting = getSettingByChannelField(type, channel, fieldId);
-    if (setting != nullptr) {
-        return setting->offset;
+    const uint8_t index = getIndexByChannelField(type, channel, fieldId);
+    if (index == FIELD_INDEX_NONE) {
+        return 0;
     }
-    return 0;
+    return _fieldOffsets[index];
 }
 
 void StatisticsParser::setChannelFieldOffset(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, const float offset)
 {
-    fieldSettings_t* setting = getSettingByChannelField(type, channel, fieldId);
-    if (setting != nullptr) {
-        setting->offset = offset;
-    } else {
-        _fieldSettings.push_back({ type, channel, fieldId, offset });
+    const uint8_t index = getIndexByChannelField(type, channel, fieldId);
+    if (index == FIELD_INDEX_NONE) {
+        return;
     }
+
+    HOY_SEMAPHORE_TAKE();
+    _fieldOffsets[index] = offset;
+    updateValueCache();
+    HOY_SEMAPHORE_GIVE();
 }
 
 std::list<ChannelType_t> StatisticsParser::getChannelTypes() const
@@ -291,14 +344,10 @@ const char* StatisticsParser::getChannelTypeName(const ChannelType_t type) const
 
 std::list<ChannelNum_t> StatisticsParser::getChannelsByType(const ChannelType_t type) const
 {
-    std::list<ChannelNum_t> l;
-    for (uint8_t i = 0; i < _byteAssignmentSize; i++) {
-        if (_byteAssignment[i].type == type) {
-            l.push_back(_byteAssignment[i].ch);
-        }
+    if (type >= TYPE_CNT) {
+        return {};
     }
-    l.unique();
-    return l;
+    return _layout->channelsByType[type];
 }
 
 uint16_t StatisticsParser::getStringMaxPower(const uint8_t channel) const
@@ -309,7 +358,11 @@ uint16_t StatisticsParser::getStringMaxPower(const uint8_t channel) const
 void StatisticsParser::setStringMaxPower(const uint8_t channel, const uint16_t power)
 {
     if (channel < sizeof(_stringMaxPower) / sizeof(_stringMaxPower[0])) {
+        HOY_SEMAPHORE_TAKE();
         _stringMaxPower[channel] = power;
+        updateValueCache(); // irradiation depends on the max power
+        HOY_SEMAPHORE_GIVE();
+        publishSnapshot();
     }
 }
 
@@ -352,6 +405,7 @@ uint32_t StatisticsParser::getLastUpdateFromInternal() const
 void StatisticsParser::setLastUpdateFromInternal(const uint32_t lastUpdate)
 {
     _lastUpdateFromInternal = lastUpdate;
+    publishSnapshot();
 }
 
 bool StatisticsParser::getYieldDayCorrection() const
@@ -364,6 +418,22 @@ void StatisticsParser::setYieldDayCorrection(const bool enabled)
     _enableYieldDayCorrection = enabled;
 }
 
+std::shared_ptr<const StatisticsSnapshot> StatisticsParser::getSnapshot() const
+{
+    return std::atomic_load(&_snapshot);
+}
+
+void StatisticsParser::publishSnapshot()
+{
+    HOY_SEMAPHORE_TAKE();
+    auto snapshot = std::make_shared<const StatisticsSnapshot>(
+        _layout, _fieldValues, _stringMaxPower,
+        ++_snapshotVersion, getLastUpdate(), _lastUpdateFromInternal);
+    HOY_SEMAPHORE_GIVE();
+
+    std::atomic_store(&_snapshot, snapshot);
+}
+
 void StatisticsParser::zeroFields(const FieldId_t* fields)
 {
     // Loop all channels
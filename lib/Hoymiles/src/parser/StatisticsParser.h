@@ -3,6 +3,8 @@
 #include "Parser.h"
 #include <cstdint>
 #include <list>
+#include <memory>
+#include <vector>
 
 #define STATISTIC_PACKET_SIZE (7 * 16)
 
@@ -47,7 +49,8 @@ enum FieldId_t {
     FLD_UAC_31,
     FLD_IAC_1,
     FLD_IAC_2,
-    FLD_IAC_3
+    FLD_IAC_3,
+    FLD_CNT
 };
 const char* const fields[] = { "Voltage", "Current", "Power", "YieldDay", "YieldTotal",
     "Voltage", "Current", "Power", "Frequency", "Temperature", "PowerFactor", "Efficiency", "Irradiation", "ReactivePower", "EventLogCount",
@@ -79,7 +82,8 @@ enum ChannelNum_t {
 enum ChannelType_t {
     TYPE_AC = 0,
     TYPE_DC,
-    TYPE_INV
+    TYPE_INV,
+    TYPE_CNT
 };
 const char* const channelsTypes[] = { "AC", "DC", "INV" };
 
@@ -95,12 +99,23 @@ typedef struct {
     uint8_t digits; // number of valid digits after the decimal point
 } byteAssign_t;
 
-typedef struct {
-    ChannelType_t type;
-    ChannelNum_t ch; // channel 0 - 5
-    FieldId_t fieldId; // field id
-    float offset; // offset (positive/negative) to be applied on the fetched value
-} fieldSettings_t;
+// marks a (type, channel, field) tuple without byte assignment in the field index
+#define FIELD_INDEX_NONE 0xff
+
+// Lookup tables of a byte assignment, shared between the parser and its snapshots
+struct StatisticsLayout {
+    const byteAssign_t* byteAssignment = nullptr;
+    uint8_t byteAssignmentSize = 0;
+
+    // position of each (type, channel, field) tuple within byteAssignment
+    uint8_t fieldIndex[TYPE_CNT][CH_CNT][FLD_CNT];
+    std::list<ChannelNum_t> channelsByType[TYPE_CNT];
+
+    StatisticsLayout();
+    uint8_t getIndex(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
+};
+
+class StatisticsSnapshot;
 
 class StatisticsParser : public Parser {
 public:
@@ -115,10 +130,10 @@ public:
     uint8_t getExpectedByteCount();
 
     const byteAssign_t* getAssignmentByChannelField(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
-    fieldSettings_t* getSettingByChannelField(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId);
 
-    float getChannelFieldValue(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId);
-    String getChannelFieldValueString(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId);
+    // Returns the value decoded by the last update of the internal data structure
+    float getChannelFieldValue(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
+    String getChannelFieldValueString(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
     bool hasChannelFieldValue(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
     const char* getChannelFieldUnit(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
     const char* getChannelFieldName(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
@@ -126,7 +141,7 @@ public:
 
     bool setChannelFieldValue(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, float value);
 
-    float getChannelFieldOffset(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId);
+    float getChannelFieldOffset(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
     void setChannelFieldOffset(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, const float offset);
 
     std::list<ChannelType_t> getChannelTypes() const;
@@ -153,21 +168,38 @@ public:
 
     bool getYieldDayCorrection() const;
     void setYieldDayCorrection(const bool enabled);
+
+    // Returns a consistent copy of all values, which is renewed whenever
+    // the internal data structure changes
+    std::shared_ptr<const StatisticsSnapshot> getSnapshot() const;
+
 private:
+    uint8_t getIndexByChannelField(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
+    float decodeFieldValue(const uint8_t index) const;
+    void updateValueCache();
+    void publishSnapshot();
     void zeroFields(const FieldId_t* fields);
 
     uint8_t _payloadStatistic[STATISTIC_PACKET_SIZE] = {};
     uint8_t _statisticLength = 0;
-    uint16_t _stringMaxPower[CH_CNT];
+    uint16_t _stringMaxPower[CH_CNT] = {};
 
-    const byteAssign_t* _byteAssignment;
-    uint8_t _byteAssignmentSize;
+    const byteAssign_t* _byteAssignment = nullptr;
+    uint8_t _byteAssignmentSize = 0;
     uint8_t _expectedByteCount = 0;
-    std::list<fieldSettings_t> _fieldSettings;
+
+    std::shared_ptr<const StatisticsLayout> _layout;
+
+    // offset and decoded value per entry of _byteAssignment
+    std::vector<float> _fieldOffsets;
+    std::vector<float> _fieldValues;
 
     uint32_t _rxFailureCount = 0;
     uint32_t _lastUpdateFromInternal = 0;
 
+    std::shared_ptr<const StatisticsSnapshot> _snapshot;
+    uint32_t _snapshotVersion = 0;
+
     bool _enableYieldDayCorrection = false;
     float _lastYieldDay[CH_CNT] = {};
 };
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "StatisticsSnapshot.h"
+#include <cstring>
+
+StatisticsSnapshot::StatisticsSnapshot(std::shared_ptr<const StatisticsLayout> layout,
+    const std::vector<float>& values, const uint16_t (&stringMaxPower)[CH_CNT],
+    const uint32_t version, const uint32_t lastUpdate, const uint32_t lastUpdateFromInternal)
+    : _layout(layout)
+    , _values(values)
+    , _version(version)
+    , _lastUpdate(lastUpdate)
+    , _lastUpdateFromInternal(lastUpdateFromInternal)
+{
+    memcpy(_stringMaxPower, stringMaxPower, sizeof(_stringMaxPower));
+}
+
+uint32_t StatisticsSnapshot::getVersion() const
+{
+    return _version;
+}
+
+uint32_t StatisticsSnapshot::getLastUpdate() const
+{
+    return _lastUpdate;
+}
+
+uint32_t StatisticsSnapshot::getLastUpdateFromInternal() const
+{
+    return _lastUpdateFromInternal;
+}
+
+const byteAssign_t* StatisticsSnapshot::getAssignmentByChannelField(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
+{
+    const uint8_t index = _layout->getIndex(type, channel, fieldId);
+    if (index == FIELD_INDEX_NONE) {
+        return nullptr;
+    }
+    return &_layout->byteAssignment[index];
+}
+
+float StatisticsSnapshot::getChannelFieldValue(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
+{
+    const uint8_t index = _layout->getIndex(type, channel, fieldId);
+    if (index == FIELD_INDEX_NONE || index >= _values.size()) {
+        return 0;
+    }
+    return _values[index];
+}
+
+String StatisticsSnapshot::getChannelFieldValueString(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
+{
+    return String(
+        getChannelFieldValue(type, channel, fieldId),
+        static_cast<unsigned int>(getChannelFieldDigits(type, channel, fieldId)));
+}
+
+bool StatisticsSnapshot::hasChannelFieldValue(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
+{
+    return _layout->getIndex(type, channel, fieldId) != FIELD_INDEX_NONE;
+}
+
+const char* StatisticsSnapshot::getChannelFieldUnit(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
+{
+    const byteAssign_t* pos = getAssignmentByChannelField(type, channel, fieldId);
+    return units[pos->unitId];
+}
+
+const char* StatisticsSnapshot::getChannelFieldName(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
+{
+    const byteAssign_t* pos = getAssignmentByChannelField(type, channel, fieldId);
+    return fields[pos->fieldId];
+}
+
+uint8_t StatisticsSnapshot::getChannelFieldDigits(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const
+{
+    const byteAssign_t* pos = getAssignmentByChannelField(type, channel, fieldId);
+    return pos->digits;
+}
+
+std::list<ChannelType_t> StatisticsSnapshot::getChannelTypes() const
+{
+    return {
+        TYPE_AC,
+        TYPE_DC,
+        TYPE_INV
+    };
+}
+
+const char* StatisticsSnapshot::getChannelTypeName(const ChannelType_t type) const
+{
+    return channelsTypes[type];
+}
+
+const std::list<ChannelNum_t>& StatisticsSnapshot::getChannelsByType(const ChannelType_t type) const
+{
+    static const std::list<ChannelNum_t> empty;
+    if (type >= TYPE_CNT) {
+        return empty;
+    }
+    return _layout->channelsByType[type];
+}
+
+uint16_t StatisticsSnapshot::getStringMaxPower(const uint8_t channel) const
+{
+    if (channel >= CH_CNT) {
+        return 0;
+    }
+    return _stringMaxPower[channel];
+}
@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+#include "StatisticsParser.h"
+#include <Arduino.h>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+
+/*
+ * Immutable copy of all values of a StatisticsParser. A new snapshot is
+ * created whenever the data of the parser changes, i.e., once per received
+ * statistics packet. Consumers get all values of the same packet without
+ * any locking by holding on to the shared pointer as long as needed.
+ */
+class StatisticsSnapshot {
+public:
+    StatisticsSnapshot(std::shared_ptr<const StatisticsLayout> layout,
+        const std::vector<float>& values, const uint16_t (&stringMaxPower)[CH_CNT],
+        const uint32_t version, const uint32_t lastUpdate, const uint32_t lastUpdateFromInternal);
+
+    // Incremented for every snapshot of the same parser
+    uint32_t getVersion() const;
+    uint32_t getLastUpdate() const;
+    uint32_t getLastUpdateFromInternal() const;
+
+    float getChannelFieldValue(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
+    String getChannelFieldValueString(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
+    bool hasChannelFieldValue(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
+    const char* getChannelFieldUnit(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
+    const char* getChannelFieldName(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
+    uint8_t getChannelFieldDigits(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
+
+    std::list<ChannelType_t> getChannelTypes() const;
+    const char* getChannelTypeName(const ChannelType_t type) const;
+    const std::list<ChannelNum_t>& getChannelsByType(const ChannelType_t type) const;
+
+    uint16_t getStringMaxPower(const uint8_t channel) const;
+
+private:
+    const byteAssign_t* getAssignmentByChannelField(const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId) const;
+
+    const std::shared_ptr<const StatisticsLayout> _layout;
+    const std::vector<float> _values;
+    uint16_t _stringMaxPower[CH_CNT];
+
+    const uint32_t _version;
+    const uint32_t _lastUpdate;
+    const uint32_t _lastUpdateFromInternal;
+};
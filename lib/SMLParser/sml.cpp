@@ -5,7 +5,7 @@
 #include "smlCrcTable.h"
 
 #ifdef SML_DEBUG
-char logBuff[200];
+static char logBuff[200];
 
 #ifdef SML_NATIVE
 #define SML_LOG(...)                                                           \
@@ -40,22 +40,7 @@ char logBuff[200];
   } while (0)
 #endif
 
-#define MAX_LIST_SIZE 80
-#define MAX_TREE_SIZE 10
-
-static sml_states_t currentState = SML_START;
-static char nodes[MAX_TREE_SIZE];
-static unsigned char currentLevel = 0;
-static unsigned short crc = 0xFFFF;
-static signed char sc;
-static unsigned short crcMine = 0xFFFF;
-static unsigned short crcReceived = 0x0000;
-static unsigned char len = 4;
-static unsigned char listBuffer[MAX_LIST_SIZE]; /* keeps a list
-                                                   as length + state + data  */
-static unsigned char listPos = 0;
-
-void crc16(unsigned char &byte)
+void SmlParser::crc16(unsigned char byte)
 {
 #ifdef ARDUINO
   crc =
@@ -65,29 +50,29 @@ void crc16(unsigned char &byte)
 #endif
 }
 
-void setState(sml_states_t state, int byteLen)
+void SmlParser::setState(sml_states_t state, int byteLen)
 {
   currentState = state;
   len = byteLen;
 }
 
-void pushListBuffer(unsigned char byte)
+void SmlParser::pushListBuffer(unsigned char byte)
 {
-  if (listPos < MAX_LIST_SIZE) {
+  if (listPos < MaxListSize) {
     listBuffer[listPos++] = byte;
   }
 }
 
-void reduceList()
+void SmlParser::reduceList()
 {
-  if (currentLevel < MAX_TREE_SIZE && nodes[currentLevel] > 0)
+  if (currentLevel < MaxTreeSize && nodes[currentLevel] > 0)
     nodes[currentLevel]--;
 }
 
-void smlNewList(unsigned char size)
+void SmlParser::newList(unsigned char size)
 {
   reduceList();
-  if (currentLevel < MAX_TREE_SIZE)
+  if (currentLevel < MaxTreeSize - 1)
     currentLevel++;
   nodes[currentLevel] = size;
   SML_TREELOG(currentLevel, "LISTSTART on level %i with %i nodes\n",
@@ -96,7 +81,7 @@ void smlNewList(unsigned char size)
   // @todo workaround for lists inside obis lists
   if (size > 5) {
     listPos = 0;
-    memset(listBuffer, '\0', MAX_LIST_SIZE);
+    memset(listBuffer, '\0', MaxListSize);
   }
   else {
     pushListBuffer(size);
@@ -104,7 +89,7 @@ void smlNewList(unsigned char size)
   }
 }
 
-void checkMagicByte(unsigned char &byte)
+void SmlParser::checkMagicByte(unsigned char byte)
 {
   unsigned int size = 0;
   while (currentLevel > 0 && nodes[currentLevel] == 0) {
@@ -115,7 +100,7 @@ void checkMagicByte(unsigned char &byte)
   if (byte > 0x70 && byte <= 0x7F) {
     /* new list */
     size = byte & 0x0F;
-    smlNewList(size);
+    newList(size);
   }
   else if (byte >= 0x01 && byte <= 0x6F && nodes[currentLevel] > 0) {
     if (byte == 0x01) {
@@ -189,13 +174,13 @@ void checkMagicByte(unsigned char &byte)
   }
 }
 
-void smlReset(void)
+void SmlParser::reset(void)
 {
   len = 4; // expect start sequence
   currentState = SML_START;
 }
 
-sml_states_t smlState(unsigned char currentByte)
+sml_states_t SmlParser::state(unsigned char currentByte)
 {
   unsigned char size;
   if (len > 0)
@@ -215,11 +200,10 @@ sml_states_t smlState(unsigned char currentByte)
       SML_TREELOG(0, "START\n");
       /* completely clean any garbage from crc checksum */
       crc = 0xFFFF;
-      currentByte = 0x1b;
-      crc16(currentByte);
-      crc16(currentByte);
-      crc16(currentByte);
-      crc16(currentByte);
+      crc16(0x1b);
+      crc16(0x1b);
+      crc16(0x1b);
+      crc16(0x1b);
       setState(SML_VERSION, 4);
     }
     break;
@@ -271,7 +255,7 @@ sml_states_t smlState(unsigned char currentByte)
   case SML_LISTEXTENDED:
     size = len + (currentByte & 0x0F);
     SML_TREELOG(currentLevel, "Extended List with Size=%i\n", size);
-    smlNewList(size);
+    newList(size);
     break;
   case SML_DATA:
   case SML_DATA_SIGNED_INT:
@@ -301,12 +285,50 @@ sml_states_t smlState(unsigned char currentByte)
   return currentState;
 }
 
-bool smlOBISCheck(const unsigned char *obis)
+void SmlParser::parse(const unsigned char *data, size_t length,
+                      Listener &listener)
+{
+  size_t i = 0;
+  while (i < length) {
+    bool inData = currentState == SML_DATA ||
+                  currentState == SML_DATA_SIGNED_INT ||
+                  currentState == SML_DATA_UNSIGNED_INT ||
+                  currentState == SML_DATA_OCTET_STRING;
+
+    if (inData && len > 1) {
+      /* all but the last payload byte of a node leave the state unchanged */
+      size_t run = len - 1;
+      if (run > length - i)
+        run = length - i;
+      for (size_t r = 0; r < run; ++r) {
+        SML_LOG("%02X ", data[i + r]);
+        crc16(data[i + r]);
+        pushListBuffer(data[i + r]);
+      }
+      len -= run;
+      i += run;
+      continue;
+    }
+
+    sml_states_t s = state(data[i++]);
+    if (s == SML_LISTEND || s == SML_FINAL || s == SML_CHECKSUM_ERROR) {
+      listener.onSmlEvent(*this, s);
+    }
+  }
+}
+
+uint64_t SmlParser::obisKey(void) const
+{
+  return obisKey(listBuffer[2], listBuffer[3], listBuffer[4], listBuffer[5],
+                 listBuffer[6], listBuffer[7]);
+}
+
+bool SmlParser::obisCheck(const unsigned char *obis) const
 {
   return (memcmp(obis, &listBuffer[2], 6) == 0);
 }
 
-void smlOBISManufacturer(unsigned char *str, int maxSize)
+void SmlParser::obisManufacturer(unsigned char *str, int maxSize) const
 {
   int i = 0, pos = 0, size = 0;
   while (i < listPos) {
@@ -323,7 +345,7 @@ void smlOBISManufacturer(unsigned char *str, int maxSize)
   }
 }
 
-void smlPow(float &val, signed char &scaler)
+static void smlPow(float &val, signed char &scaler)
 {
   if (scaler < 0) {
     while (scaler++) {
@@ -337,7 +359,8 @@ void smlPow(float &val, signed char &scaler)
   }
 }
 
-void smlOBISByUnit(long long int &val, signed char &scaler, sml_units_t unit)
+void SmlParser::obisByUnit(long long int &val, signed char &scaler,
+                           sml_units_t unit) const
 {
   unsigned char i = 0, pos = 0, size = 0, y = 0, skip = 0;
   sml_states_t type;
@@ -378,50 +401,23 @@ void smlOBISByUnit(long long int &val, signed char &scaler, sml_units_t unit)
   }
 }
 
-void smlOBISWh(float &wh)
+void SmlParser::obisValue(float &value, sml_units_t unit) const
 {
   long long int val;
-  smlOBISByUnit(val, sc, SML_WATT_HOUR);
-  wh = val;
-  smlPow(wh, sc);
+  signed char sc = 0;
+  obisByUnit(val, sc, unit);
+  value = val;
+  smlPow(value, sc);
 }
 
-void smlOBISW(float &w)
-{
-  long long int val;
-  smlOBISByUnit(val, sc, SML_WATT);
-  w = val;
-  smlPow(w, sc);
-}
+void SmlParser::obisWh(float &wh) const { obisValue(wh, SML_WATT_HOUR); }
 
-void smlOBISVolt(float &v)
-{
-  long long int val;
-  smlOBISByUnit(val, sc, SML_VOLT);
-  v = val;
-  smlPow(v, sc);
-}
+void SmlParser::obisW(float &w) const { obisValue(w, SML_WATT); }
 
-void smlOBISAmpere(float &a)
-{
-  long long int val;
-  smlOBISByUnit(val, sc, SML_AMPERE);
-  a = val;
-  smlPow(a, sc);
-}
+void SmlParser::obisVolt(float &v) const { obisValue(v, SML_VOLT); }
 
-void smlOBISHertz(float &h)
-{
-  long long int val;
-  smlOBISByUnit(val, sc, SML_HERTZ);
-  h = val;
-  smlPow(h, sc);
-}
+void SmlParser::obisAmpere(float &a) const { obisValue(a, SML_AMPERE); }
 
-void smlOBISDegree(float &d)
-{
-  long long int val;
-  smlOBISByUnit(val, sc, SML_DEGREE);
-  d = val;
-  smlPow(d, sc);
-}
+void SmlParser::obisHertz(float &h) const { obisValue(h, SML_HERTZ); }
+
+void SmlParser::obisDegree(float &d) const { obisValue(d, SML_DEGREE); }
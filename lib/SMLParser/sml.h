@@ -2,6 +2,8 @@
 #define SML_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 typedef enum {
   SML_START,
@@ -92,17 +94,76 @@ typedef enum {
   SML_COUNT = 255
 } sml_units_t;
 
-void smlReset(void);
-sml_states_t smlState(unsigned char byte);
-bool smlOBISCheck(const unsigned char *obis);
-void smlOBISManufacturer(unsigned char *str, int maxSize);
-void smlOBISByUnit(long long int &wh, signed char &scaler, sml_units_t unit);
+/*
+ * reentrant SML parser. all state is kept per instance, so any number of SML
+ * sources can be parsed at the same time, e.g., by different tasks.
+ */
+class SmlParser {
+public:
+  /* receives the events of parse(), i.e., the states SML_LISTEND (an OBIS
+   * list was completed and can be evaluated using the parser's OBIS
+   * functions), SML_FINAL and SML_CHECKSUM_ERROR. */
+  class Listener {
+  public:
+    virtual void onSmlEvent(SmlParser &parser, sml_states_t state) = 0;
 
-void smlOBISWh(float &wh);
-void smlOBISW(float &w);
-void smlOBISVolt(float &v);
-void smlOBISAmpere(float &a);
-void smlOBISHertz(float &h);
-void smlOBISDegree(float &d);
+  protected:
+    ~Listener() = default;
+  };
+
+  void reset(void);
+  sml_states_t state(unsigned char byte);
+
+  /* feeds a whole buffer into the parser. payload bytes of data nodes are
+   * consumed in runs without evaluating the state machine for each of them. */
+  void parse(const unsigned char *data, size_t length, Listener &listener);
+
+  /* packs a six byte OBIS code into an integer, e.g., for lookup tables */
+  static constexpr uint64_t obisKey(unsigned char a, unsigned char b,
+                                    unsigned char c, unsigned char d,
+                                    unsigned char e, unsigned char f)
+  {
+    return (uint64_t(a) << 40) | (uint64_t(b) << 32) | (uint64_t(c) << 24) |
+           (uint64_t(d) << 16) | (uint64_t(e) << 8) | uint64_t(f);
+  }
+
+  /* the OBIS code of the current list as packed by obisKey() */
+  uint64_t obisKey(void) const;
+
+  bool obisCheck(const unsigned char *obis) const;
+  void obisManufacturer(unsigned char *str, int maxSize) const;
+  void obisByUnit(long long int &val, signed char &scaler,
+                  sml_units_t unit) const;
+
+  void obisWh(float &wh) const;
+  void obisW(float &w) const;
+  void obisVolt(float &v) const;
+  void obisAmpere(float &a) const;
+  void obisHertz(float &h) const;
+  void obisDegree(float &d) const;
+
+private:
+  static constexpr unsigned char MaxListSize = 80;
+  static constexpr unsigned char MaxTreeSize = 10;
+
+  void crc16(unsigned char byte);
+  void setState(sml_states_t state, int byteLen);
+  void pushListBuffer(unsigned char byte);
+  void reduceList(void);
+  void newList(unsigned char size);
+  void checkMagicByte(unsigned char byte);
+  void obisValue(float &value, sml_units_t unit) const;
+
+  sml_states_t currentState = SML_START;
+  char nodes[MaxTreeSize] = {};
+  unsigned char currentLevel = 0;
+  unsigned short crc = 0xFFFF;
+  unsigned short crcMine = 0xFFFF;
+  unsigned short crcReceived = 0x0000;
+  unsigned char len = 4;
+  unsigned char listBuffer[MaxListSize] = {}; /* keeps a list as
+                                                 length + state + data */
+  unsigned char listPos = 0;
+};
 
 #endif
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Bounded lock-free queue with a single consumer. All slots are allocated
+ * within the object, so pushing and popping never touches the heap. Items
+ * are moved in and out, hence move-only types are supported.
+ *
+ * With MultiProducer == false, exactly one task may push (SPSC). Otherwise
+ * any number of tasks may push concurrently (MPSC). In both cases only one
+ * task may call pop(), front() and empty().
+ *
+ * Every slot carries a sequence number which tells whether the slot is free
+ * for the producer of a given position or holds an item for the consumer.
+ */
+template <typename T, size_t Capacity, bool MultiProducer = false>
+class LockFreeQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+        "Capacity must be a power of two");
+
+public:
+    LockFreeQueue()
+    {
+        for (size_t i = 0; i < Capacity; ++i) {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    ~LockFreeQueue()
+    {
+        while (pop()) { }
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Number of queued items. Only a snapshot if other tasks access the queue.
+    unsigned long size() const
+    {
+        size_t dequeuePos = _dequeuePos.load(std::memory_order_relaxed);
+        size_t enqueuePos = _enqueuePos.load(std::memory_order_relaxed);
+        size_t used = enqueuePos - dequeuePos;
+        return used > Capacity ? Capacity : used;
+    }
+
+    // Returns false if the queue is full. The item is left untouched then.
+    bool push(const T& item) { return emplace(item); }
+    bool push(T&& item) { return emplace(std::move(item)); }
+
+    template <typename... Args>
+    bool emplace(Args&&... args)
+    {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        if constexpr (MultiProducer) {
+            for (;;) {
+                slot = &_slots[pos & Mask];
+                size_t seq = slot->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+                if (diff == 0) {
+                    if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    return false; // the consumer did not yet free this slot
+                } else {
+                    pos = _enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        } else {
+            slot = &_slots[pos & Mask];
+            if (slot->sequence.load(std::memory_order_acquire) != pos) {
+                return false;
+            }
+            _enqueuePos.store(pos + 1, std::memory_order_relaxed);
+        }
+
+        new (&slot->storage) T(std::forward<Args>(args)...);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    std::optional<T> pop()
+    {
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        Slot& slot = _slots[pos & Mask];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return {};
+        }
+
+        T* item = slot.item();
+        std::optional<T> result(std::move(*item));
+        item->~T();
+
+        slot.sequence.store(pos + Capacity, std::memory_order_release);
+        _dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        return result;
+    }
+
+    // Consumer only. Returns the oldest item, which stays in the queue, or
+    // nullptr if the queue is empty.
+    T* front()
+    {
+        size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        Slot& slot = _slots[pos & Mask];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return nullptr;
+        }
+        return slot.item();
+    }
+
+    // Consumer only
+    bool empty()
+    {
+        return front() == nullptr;
+    }
+
+private:
+    static constexpr size_t Mask = Capacity - 1;
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        T* item() { return std::launder(reinterpret_cast<T*>(&storage)); }
+    };
+
+    std::array<Slot, Capacity> _slots;
+    std::atomic<size_t> _enqueuePos = 0;
+    std::atomic<size_t> _dequeuePos = 0;
+};
+
+template <typename T, size_t Capacity>
+using SpscQueue = LockFreeQueue<T, Capacity, false>;
+
+template <typename T, size_t Capacity>
+using MpscQueue = LockFreeQueue<T, Capacity, true>;
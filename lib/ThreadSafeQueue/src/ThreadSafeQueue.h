@@ -32,7 +32,7 @@ public:
         if (_queue.empty()) {
             return {};
         }
-        T tmp = _queue.front();
+        T tmp = std::move(_queue.front());
         _queue.pop();
         return tmp;
     }
@@ -43,6 +43,12 @@ public:
         _queue.push(item);
     }
 
+    void push(T&& item)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push(std::move(item));
+    }
+
     T front()
     {
         std::lock_guard<std::mutex> lock(_mutex);
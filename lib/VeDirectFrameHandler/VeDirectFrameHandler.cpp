@@ -35,10 +35,37 @@
 
 #include <Arduino.h>
 #include "VeDirectFrameHandler.h"
+#include <frozen/unordered_map.h>
 
 // The name of the record that contains the checksum.
 static constexpr char checksumTagName[] = "CHECKSUM";
 
+// fields common to all devices. device specific fields are provided by the
+// derived classes through getTextField().
+template<typename T>
+static constexpr auto s_commonTextFields = frozen::make_unordered_map<frozen::string, VeDirectTextField<T>>({
+	{ "PID", { VeDirectTextField<T>::Type::Number, [](T& frame, int32_t number, char const*) {
+		frame.productID_PID = number; } } },
+	{ "SER", { VeDirectTextField<T>::Type::Text, [](T& frame, int32_t, char const* text) {
+		strlcpy(frame.serialNr_SER, text, sizeof(frame.serialNr_SER)); } } },
+	{ "FW", { VeDirectTextField<T>::Type::Text, [](T& frame, int32_t, char const* text) {
+		strlcpy(frame.firmwareVer_FW, text, sizeof(frame.firmwareVer_FW)); } } },
+	{ "V", { VeDirectTextField<T>::Type::Number, [](T& frame, int32_t number, char const*) {
+		frame.batteryVoltage_V_mV = number; } } },
+	{ "I", { VeDirectTextField<T>::Type::Number, [](T& frame, int32_t number, char const*) {
+		frame.batteryCurrent_I_mA = number; } } }
+});
+
+// values are decimal or hexadecimal, the latter with (upper case) 0X prefix
+static int32_t parseTextNumber(char const* value)
+{
+	if (value[0] == '0' && value[1] == 'X') {
+		return static_cast<int32_t>(strtoul(value + 2, nullptr, 16));
+	}
+
+	return static_cast<int32_t>(strtol(value, nullptr, 10));
+}
+
 class Silent : public Print {
 	public:
 		size_t write(uint8_t c) final { return 0; }
@@ -57,7 +84,9 @@ VeDirectFrameHandler<T>::VeDirectFrameHandler() :
 	_name(""),
 	_value(""),
 	_debugIn(0),
-	_lastByteMillis(0)
+	_lastByteMillis(0),
+	_stagedValueCount(0),
+	_stagedTextCount(0)
 {
 }
 
@@ -96,7 +125,8 @@ void VeDirectFrameHandler<T>::reset()
 {
 	_checksum = 0;
 	_state = State::IDLE;
-	_textData.clear();
+	_stagedValueCount = 0;
+	_stagedTextCount = 0;
 }
 
 template<typename T>
@@ -191,7 +221,7 @@ void VeDirectFrameHandler<T>::rxData(uint8_t inbyte)
 		case '\n':
 			if ( _textPointer < (_value + sizeof(_value)) ) {
 				*_textPointer = 0; // make zero ended
-				_textData.push_back({_name, _value});
+				stageTextData(_name, _value);
 			}
 			_state = State::RECORD_BEGIN;
 			break;
@@ -208,9 +238,7 @@ void VeDirectFrameHandler<T>::rxData(uint8_t inbyte)
 	{
 		if (_verboseLogging) { dumpDebugBuffer(); }
 		if (_checksum == 0) {
-			for (auto const& event : _textData) {
-				processTextData(event.first, event.second);
-			}
+			commitTextData();
 			_lastUpdate = millis();
 			frameValidEvent();
 		}
@@ -227,44 +255,71 @@ void VeDirectFrameHandler<T>::rxData(uint8_t inbyte)
 }
 
 /*
- * This function is called every time a new name/value is successfully parsed.  It writes the values to the temporary buffer.
+ * This function is called every time a new name/value is successfully parsed.
+ * It parses the value into the staging area, which is applied to the data once
+ * the frame's checksum was verified.
  */
 template<typename T>
-void VeDirectFrameHandler<T>::processTextData(std::string const& name, std::string const& value) {
+void VeDirectFrameHandler<T>::stageTextData(char const* name, char const* value) {
 	if (_verboseLogging) {
 		_msgOut->printf("%s Text Data '%s' = '%s'\r\n",
-				_logId, name.c_str(), value.c_str());
+				_logId, name, value);
 	}
 
-	if (processTextDataDerived(name, value)) { return; }
+	frozen::string key(name, strlen(name));
+	VeDirectTextField<T> const* field = nullptr;
 
-	if (name == "PID") {
-		_tmpFrame.productID_PID = strtol(value.c_str(), nullptr, 0);
-		return;
+	auto iter = s_commonTextFields<T>.find(key);
+	if (iter != s_commonTextFields<T>.end()) {
+		field = &iter->second;
+	} else {
+		field = getTextField(key);
 	}
 
-	if (name == "SER") {
-		strncpy(_tmpFrame.serialNr_SER, value.c_str(), sizeof(_tmpFrame.serialNr_SER));
+	if (field == nullptr) {
+		_msgOut->printf("%s Unknown text data '%s' (value '%s')\r\n",
+				_logId, name, value);
 		return;
 	}
 
-	if (name == "FW") {
-		strncpy(_tmpFrame.firmwareVer_FW, value.c_str(), sizeof(_tmpFrame.firmwareVer_FW));
+	if (_stagedValueCount >= _stagedValues.size()) {
+		_msgOut->printf("%s too many text data fields, ignoring '%s'\r\n",
+				_logId, name);
 		return;
 	}
 
-	if (name == "V") {
-		_tmpFrame.batteryVoltage_V_mV = atol(value.c_str());
+	int32_t number = 0;
+	switch (field->type) {
+	case VeDirectTextField<T>::Type::Number:
+		number = parseTextNumber(value);
+		break;
+	case VeDirectTextField<T>::Type::Flag:
+		number = (strcmp(value, "ON") == 0) ? 1 : 0;
+		break;
+	case VeDirectTextField<T>::Type::Text:
+		if (_stagedTextCount >= _stagedTexts.size()) { return; }
+		strlcpy(_stagedTexts[_stagedTextCount].data(), value, VE_MAX_VALUE_LEN);
+		number = _stagedTextCount++;
+		break;
+	case VeDirectTextField<T>::Type::Ignored:
 		return;
 	}
 
-	if (name == "I") {
-		_tmpFrame.batteryCurrent_I_mA = atol(value.c_str());
-		return;
-	}
+	_stagedValues[_stagedValueCount++] = { field, number };
+}
 
-	_msgOut->printf("%s Unknown text data '%s' (value '%s')\r\n",
-			_logId, name.c_str(), value.c_str());
+template<typename T>
+void VeDirectFrameHandler<T>::commitTextData() {
+	for (size_t i = 0; i < _stagedValueCount; ++i) {
+		auto const& staged = _stagedValues[i];
+
+		char const* text = nullptr;
+		if (staged.field->type == VeDirectTextField<T>::Type::Text) {
+			text = _stagedTexts[staged.number].data();
+		}
+
+		staged.field->apply(_tmpFrame, staged.number, text);
+	}
 }
 
 /*
@@ -16,9 +16,22 @@
 #include <array>
 #include <memory>
 #include <utility>
-#include <deque>
+#include <frozen/string.h>
 #include "VeDirectData.h"
 
+/**
+ * describes a field of VE.Direct text frames. the value is parsed when the
+ * field is received and applied to the data once the frame's checksum was
+ * verified. numbers are decimal or hexadecimal (with 0x prefix), flags are
+ * "ON" or "OFF". text values are passed as-is.
+ */
+template<typename T>
+struct VeDirectTextField {
+    enum class Type : uint8_t { Number, Flag, Text, Ignored };
+    Type type;
+    void (*apply)(T& frame, int32_t number, char const* text);
+};
+
 template<typename T>
 class VeDirectFrameHandler {
 public:
@@ -47,8 +60,9 @@ private:
     void reset();
     void dumpDebugBuffer();
     void rxData(uint8_t inbyte);              // byte of serial data
-    void processTextData(std::string const& name, std::string const& value);
-    virtual bool processTextDataDerived(std::string const& name, std::string const& value) = 0;
+    void stageTextData(char const* name, char const* value);
+    void commitTextData();
+    virtual VeDirectTextField<T> const* getTextField(frozen::string const& name) const = 0;
     virtual void frameValidEvent() { }
     bool disassembleHexData(VeDirectHexData &data);     //return true if disassembling was possible
 
@@ -80,13 +94,22 @@ private:
     /**
      * not every frame contains every value the device is communicating, i.e.,
      * a set of values can be fragmented across multiple frames. frames can be
-     * invalid. in order to only process data from valid frames, we add data
-     * to this queue and only process it once the frame was found to be valid.
+     * invalid. in order to only process data from valid frames, the parsed
+     * values are staged and only applied once the frame was found to be valid.
      * this also handles fragmentation nicely, since there is no need to reset
-     * our data buffer. we simply update the interpreted data from this event
-     * queue, which is fine as we know the source frame was valid.
+     * our data buffer. the staging area has a fixed size, such that parsing
+     * a frame does not allocate memory.
      */
-    std::deque<std::pair<std::string, std::string>> _textData;
+    struct StagedValue {
+        VeDirectTextField<T> const* field;
+        int32_t number;     // parsed value, or index of the staged text
+    };
+    static constexpr size_t MaxStagedValues = 32;
+    static constexpr size_t MaxStagedTexts = 4;
+    std::array<StagedValue, MaxStagedValues> _stagedValues;
+    size_t _stagedValueCount;
+    std::array<std::array<char, VE_MAX_VALUE_LEN>, MaxStagedTexts> _stagedTexts;
+    size_t _stagedTextCount;
 };
 
 template class VeDirectFrameHandler<veMpptStruct>;
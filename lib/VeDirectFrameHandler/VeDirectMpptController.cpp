@@ -9,6 +9,7 @@
 
 #include <Arduino.h>
 #include "VeDirectMpptController.h"
+#include <frozen/unordered_map.h>
 
 //#define PROCESS_NETWORK_STATE
 
@@ -19,66 +20,44 @@ void VeDirectMpptController::init(int8_t rx, int8_t tx, Print* msgOut,
 			verboseLogging, hwSerialPort);
 }
 
-bool VeDirectMpptController::processTextDataDerived(std::string const& name, std::string const& value)
+using TextField = VeDirectTextField<veMpptStruct>;
+
+static constexpr auto s_textFields = frozen::make_unordered_map<frozen::string, TextField>({
+	{ "IL", { TextField::Type::Number, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.loadCurrent_IL_mA = number; } } },
+	{ "LOAD", { TextField::Type::Flag, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.loadOutputState_LOAD = number; } } },
+	{ "CS", { TextField::Type::Number, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.currentState_CS = number; } } },
+	{ "ERR", { TextField::Type::Number, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.errorCode_ERR = number; } } },
+	{ "OR", { TextField::Type::Number, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.offReason_OR = number; } } },
+	{ "MPPT", { TextField::Type::Number, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.stateOfTracker_MPPT = number; } } },
+	{ "HSDS", { TextField::Type::Number, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.daySequenceNr_HSDS = number; } } },
+	{ "VPV", { TextField::Type::Number, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.panelVoltage_VPV_mV = number; } } },
+	{ "PPV", { TextField::Type::Number, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.panelPower_PPV_W = number; } } },
+	{ "H19", { TextField::Type::Number, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.yieldTotal_H19_Wh = number * 10; } } },
+	{ "H20", { TextField::Type::Number, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.yieldToday_H20_Wh = number * 10; } } },
+	{ "H21", { TextField::Type::Number, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.maxPowerToday_H21_W = number; } } },
+	{ "H22", { TextField::Type::Number, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.yieldYesterday_H22_Wh = number * 10; } } },
+	{ "H23", { TextField::Type::Number, [](veMpptStruct& frame, int32_t number, char const*) {
+		frame.maxPowerYesterday_H23_W = number; } } }
+});
+
+TextField const* VeDirectMpptController::getTextField(frozen::string const& name) const
 {
-	if (name == "IL") {
-		_tmpFrame.loadCurrent_IL_mA = atol(value.c_str());
-		return true;
-	}
-	if (name == "LOAD") {
-		_tmpFrame.loadOutputState_LOAD = (value == "ON");
-		return true;
-	}
-	if (name == "CS") {
-		_tmpFrame.currentState_CS = atoi(value.c_str());
-		return true;
-	}
-	if (name == "ERR") {
-		_tmpFrame.errorCode_ERR = atoi(value.c_str());
-		return true;
-	}
-	if (name == "OR") {
-		_tmpFrame.offReason_OR = strtol(value.c_str(), nullptr, 0);
-		return true;
-	}
-	if (name == "MPPT") {
-		_tmpFrame.stateOfTracker_MPPT = atoi(value.c_str());
-		return true;
-	}
-	if (name == "HSDS") {
-		_tmpFrame.daySequenceNr_HSDS = atoi(value.c_str());
-		return true;
-	}
-	if (name == "VPV") {
-		_tmpFrame.panelVoltage_VPV_mV = atol(value.c_str());
-		return true;
-	}
-	if (name == "PPV") {
-		_tmpFrame.panelPower_PPV_W = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H19") {
-		_tmpFrame.yieldTotal_H19_Wh = atol(value.c_str()) * 10;
-		return true;
-	}
-	if (name == "H20") {
-		_tmpFrame.yieldToday_H20_Wh = atol(value.c_str()) * 10;
-		return true;
-	}
-	if (name == "H21") {
-		_tmpFrame.maxPowerToday_H21_W = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H22") {
-		_tmpFrame.yieldYesterday_H22_Wh = atol(value.c_str()) * 10;
-		return true;
-	}
-	if (name == "H23") {
-		_tmpFrame.maxPowerYesterday_H23_W = atoi(value.c_str());
-		return true;
-	}
-
-	return false;
+	auto iter = s_textFields.find(name);
+	if (iter == s_textFields.end()) { return nullptr; }
+	return &iter->second;
 }
 
 /*
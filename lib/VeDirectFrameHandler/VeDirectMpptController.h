@@ -49,7 +49,7 @@ public:
 
 private:
     bool hexDataHandler(VeDirectHexData const &data) final;
-    bool processTextDataDerived(std::string const& name, std::string const& value) final;
+    VeDirectTextField<data_t> const* getTextField(frozen::string const& name) const final;
     void frameValidEvent() final;
     MovingAverage<float, 5> _efficiency;
 };
@@ -1,5 +1,6 @@
 #include <Arduino.h>
 #include "VeDirectShuntController.h"
+#include <frozen/unordered_map.h>
 
 VeDirectShuntController VeDirectShunt;
 
@@ -10,125 +11,74 @@ void VeDirectShuntController::init(int8_t rx, int8_t tx, Print* msgOut,
 			verboseLogging, hwSerialPort);
 }
 
-bool VeDirectShuntController::processTextDataDerived(std::string const& name, std::string const& value)
+using TextField = VeDirectTextField<veShuntStruct>;
+
+// BMV contains a textual description of the BMV model, for example 602S or
+// 702. It is deprecated, refer to the field PID instead.
+static constexpr auto s_textFields = frozen::make_unordered_map<frozen::string, TextField>({
+	{ "T", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.T = number;
+		frame.tempPresent = true; } } },
+	{ "P", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.P = number; } } },
+	{ "CE", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.CE = number; } } },
+	{ "SOC", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.SOC = number; } } },
+	{ "TTG", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.TTG = number; } } },
+	{ "ALARM", { TextField::Type::Flag, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.ALARM = number; } } },
+	{ "AR", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.alarmReason_AR = number; } } },
+	{ "H1", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H1 = number; } } },
+	{ "H2", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H2 = number; } } },
+	{ "H3", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H3 = number; } } },
+	{ "H4", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H4 = number; } } },
+	{ "H5", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H5 = number; } } },
+	{ "H6", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H6 = number; } } },
+	{ "H7", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H7 = number; } } },
+	{ "H8", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H8 = number; } } },
+	{ "H9", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H9 = number; } } },
+	{ "H10", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H10 = number; } } },
+	{ "H11", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H11 = number; } } },
+	{ "H12", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H12 = number; } } },
+	{ "H13", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H13 = number; } } },
+	{ "H14", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H14 = number; } } },
+	{ "H15", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H15 = number; } } },
+	{ "H16", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H16 = number; } } },
+	{ "H17", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H17 = number; } } },
+	{ "VM", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.VM = number; } } },
+	{ "DM", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.DM = number; } } },
+	{ "H18", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.H18 = number; } } },
+	{ "BMV", { TextField::Type::Ignored, nullptr } },
+	{ "MON", { TextField::Type::Number, [](veShuntStruct& frame, int32_t number, char const*) {
+		frame.dcMonitorMode_MON = static_cast<int8_t>(number); } } }
+});
+
+TextField const* VeDirectShuntController::getTextField(frozen::string const& name) const
 {
-	if (name == "T") {
-		_tmpFrame.T = atoi(value.c_str());
-		_tmpFrame.tempPresent = true;
-		return true;
-	}
-	if (name == "P") {
-		_tmpFrame.P = atoi(value.c_str());
-		return true;
-	}
-	if (name == "CE") {
-		_tmpFrame.CE = atoi(value.c_str());
-		return true;
-	}
-	if (name == "SOC") {
-		_tmpFrame.SOC = atoi(value.c_str());
-		return true;
-	}
-	if (name == "TTG") {
-		_tmpFrame.TTG = atoi(value.c_str());
-		return true;
-	}
-	if (name == "ALARM") {
-		_tmpFrame.ALARM = (value == "ON");
-		return true;
-	}
-	if (name == "AR") {
-		_tmpFrame.alarmReason_AR = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H1") {
-		_tmpFrame.H1 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H2") {
-		_tmpFrame.H2 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H3") {
-		_tmpFrame.H3 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H4") {
-		_tmpFrame.H4 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H5") {
-		_tmpFrame.H5 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H6") {
-		_tmpFrame.H6 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H7") {
-		_tmpFrame.H7 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H8") {
-		_tmpFrame.H8 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H9") {
-		_tmpFrame.H9 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H10") {
-		_tmpFrame.H10 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H11") {
-		_tmpFrame.H11 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H12") {
-		_tmpFrame.H12 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H13") {
-		_tmpFrame.H13 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H14") {
-		_tmpFrame.H14 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H15") {
-		_tmpFrame.H15 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H16") {
-		_tmpFrame.H16 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H17") {
-		_tmpFrame.H17 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "VM") {
-		_tmpFrame.VM = atoi(value.c_str());
-		return true;
-	}
-	if (name == "DM") {
-		_tmpFrame.DM = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H18") {
-		_tmpFrame.H18 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "BMV") {
-		// This field contains a textual description of the BMV model,
-		// for example 602S or 702. It is deprecated, refer to the field PID instead.
-		return true;
-	}
-	if (name == "MON") {
-		_tmpFrame.dcMonitorMode_MON = static_cast<int8_t>(atoi(value.c_str()));
-		return true;
-	}
-	return false;
+	auto iter = s_textFields.find(name);
+	if (iter == s_textFields.end()) { return nullptr; }
+	return &iter->second;
 }
@@ -14,7 +14,7 @@ public:
     using data_t = veShuntStruct;
 
 private:
-    bool processTextDataDerived(std::string const& name, std::string const& value) final;
+    VeDirectTextField<data_t> const* getTextField(frozen::string const& name) const final;
 };
 
 extern VeDirectShuntController VeDirectShunt;
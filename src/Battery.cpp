@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #include "Battery.h"
 #include "MessageOutput.h"
+#include "PowerLimiter.h"
 #include "PylontechCanReceiver.h"
 #include "JkBmsController.h"
 #include "VictronSmartShunt.h"
@@ -77,5 +78,14 @@ void BatteryClass::loop()
 
     _upProvider->loop();
 
-    _upProvider->getStats()->mqttLoop();
+    auto spStats = _upProvider->getStats();
+
+    // also catches updates that were processed in another context since the
+    // last iteration, e.g., by the MQTT battery provider.
+    if (spStats->getLastUpdate() != _lastUpdateNotified) {
+        _lastUpdateNotified = spStats->getLastUpdate();
+        PowerLimiter.notify();
+    }
+
+    spStats->mqttLoop();
 }
@@ -5,7 +5,7 @@
 #include "Configuration.h"
 #include "MqttSettings.h"
 #include "JkBmsDataPoints.h"
-#include "MqttSettings.h"
+#include "MqttPublisher.h"
 
 template<typename T>
 static void addLiveViewInSection(JsonVariant& root,
@@ -278,7 +278,9 @@ void BatteryStats::mqttLoop()
         return;
     }
 
+    MqttPublisher.beginDocument(MqttPublisherClass::Group("battery/"));
     mqttPublish();
+    MqttPublisher.endDocument();
 
     _lastMqttPublish = millis();
 }
@@ -296,16 +298,16 @@ uint32_t BatteryStats::getMqttFullPublishIntervalMs() const
 
 void BatteryStats::mqttPublish() const
 {
-    MqttSettings.publish("battery/manufacturer", _manufacturer);
-    MqttSettings.publish("battery/dataAge", String(getAgeSeconds()));
+    MqttPublisher.publish("battery/manufacturer", _manufacturer);
+    MqttPublisher.publish("battery/dataAge", getAgeSeconds());
     if (isSoCValid()) {
-        MqttSettings.publish("battery/stateOfCharge", String(_soc));
+        MqttPublisher.publish("battery/stateOfCharge", _soc);
     }
     if (isVoltageValid()) {
-        MqttSettings.publish("battery/voltage", String(_voltage));
+        MqttPublisher.publish("battery/voltage", _voltage);
     }
     if (isCurrentValid()) {
-        MqttSettings.publish("battery/current", String(_current));
+        MqttPublisher.publish("battery/current", _current);
     }
 }
 
@@ -313,89 +315,89 @@ void PylontechBatteryStats::mqttPublish() const
 {
     BatteryStats::mqttPublish();
 
-    MqttSettings.publish("battery/settings/chargeVoltage", String(_chargeVoltage));
-    MqttSettings.publish("battery/settings/chargeCurrentLimitation", String(_chargeCurrentLimitation));
-    MqttSettings.publish("battery/settings/dischargeCurrentLimitation", String(_dischargeCurrentLimitation));
-    MqttSettings.publish("battery/stateOfHealth", String(_stateOfHealth));
-    MqttSettings.publish("battery/temperature", String(_temperature));
-    MqttSettings.publish("battery/alarm/overCurrentDischarge", String(_alarmOverCurrentDischarge));
-    MqttSettings.publish("battery/alarm/overCurrentCharge", String(_alarmOverCurrentCharge));
-    MqttSettings.publish("battery/alarm/underTemperature", String(_alarmUnderTemperature));
-    MqttSettings.publish("battery/alarm/overTemperature", String(_alarmOverTemperature));
-    MqttSettings.publish("battery/alarm/underVoltage", String(_alarmUnderVoltage));
-    MqttSettings.publish("battery/alarm/overVoltage", String(_alarmOverVoltage));
-    MqttSettings.publish("battery/alarm/bmsInternal", String(_alarmBmsInternal));
-    MqttSettings.publish("battery/warning/highCurrentDischarge", String(_warningHighCurrentDischarge));
-    MqttSettings.publish("battery/warning/highCurrentCharge", String(_warningHighCurrentCharge));
-    MqttSettings.publish("battery/warning/lowTemperature", String(_warningLowTemperature));
-    MqttSettings.publish("battery/warning/highTemperature", String(_warningHighTemperature));
-    MqttSettings.publish("battery/warning/lowVoltage", String(_warningLowVoltage));
-    MqttSettings.publish("battery/warning/highVoltage", String(_warningHighVoltage));
-    MqttSettings.publish("battery/warning/bmsInternal", String(_warningBmsInternal));
-    MqttSettings.publish("battery/charging/chargeEnabled", String(_chargeEnabled));
-    MqttSettings.publish("battery/charging/dischargeEnabled", String(_dischargeEnabled));
-    MqttSettings.publish("battery/charging/chargeImmediately", String(_chargeImmediately));
+    MqttPublisher.publish("battery/settings/chargeVoltage", _chargeVoltage);
+    MqttPublisher.publish("battery/settings/chargeCurrentLimitation", _chargeCurrentLimitation);
+    MqttPublisher.publish("battery/settings/dischargeCurrentLimitation", _dischargeCurrentLimitation);
+    MqttPublisher.publish("battery/stateOfHealth", _stateOfHealth);
+    MqttPublisher.publish("battery/temperature", _temperature);
+    MqttPublisher.publish("battery/alarm/overCurrentDischarge", _alarmOverCurrentDischarge);
+    MqttPublisher.publish("battery/alarm/overCurrentCharge", _alarmOverCurrentCharge);
+    MqttPublisher.publish("battery/alarm/underTemperature", _alarmUnderTemperature);
+    MqttPublisher.publish("battery/alarm/overTemperature", _alarmOverTemperature);
+    MqttPublisher.publish("battery/alarm/underVoltage", _alarmUnderVoltage);
+    MqttPublisher.publish("battery/alarm/overVoltage", _alarmOverVoltage);
+    MqttPublisher.publish("battery/alarm/bmsInternal", _alarmBmsInternal);
+    MqttPublisher.publish("battery/warning/highCurrentDischarge", _warningHighCurrentDischarge);
+    MqttPublisher.publish("battery/warning/highCurrentCharge", _warningHighCurrentCharge);
+    MqttPublisher.publish("battery/warning/lowTemperature", _warningLowTemperature);
+    MqttPublisher.publish("battery/warning/highTemperature", _warningHighTemperature);
+    MqttPublisher.publish("battery/warning/lowVoltage", _warningLowVoltage);
+    MqttPublisher.publish("battery/warning/highVoltage", _warningHighVoltage);
+    MqttPublisher.publish("battery/warning/bmsInternal", _warningBmsInternal);
+    MqttPublisher.publish("battery/charging/chargeEnabled", _chargeEnabled);
+    MqttPublisher.publish("battery/charging/dischargeEnabled", _dischargeEnabled);
+    MqttPublisher.publish("battery/charging/chargeImmediately", _chargeImmediately);
 }
 
 void PytesBatteryStats::mqttPublish() const
 {
     BatteryStats::mqttPublish();
 
-    MqttSettings.publish("battery/settings/chargeVoltage", String(_chargeVoltageLimit));
-    MqttSettings.publish("battery/settings/chargeCurrentLimitation", String(_chargeCurrentLimit));
-    MqttSettings.publish("battery/settings/dischargeCurrentLimitation", String(_dischargeCurrentLimit));
-    MqttSettings.publish("battery/settings/dischargeVoltageLimitation", String(_dischargeVoltageLimit));
+    MqttPublisher.publish("battery/settings/chargeVoltage", _chargeVoltageLimit);
+    MqttPublisher.publish("battery/settings/chargeCurrentLimitation", _chargeCurrentLimit);
+    MqttPublisher.publish("battery/settings/dischargeCurrentLimitation", _dischargeCurrentLimit);
+    MqttPublisher.publish("battery/settings/dischargeVoltageLimitation", _dischargeVoltageLimit);
 
-    MqttSettings.publish("battery/stateOfHealth", String(_stateOfHealth));
-    MqttSettings.publish("battery/temperature", String(_temperature));
+    MqttPublisher.publish("battery/stateOfHealth", _stateOfHealth);
+    MqttPublisher.publish("battery/temperature", _temperature);
 
     if (_chargedEnergy != -1) {
-        MqttSettings.publish("battery/chargedEnergy", String(_chargedEnergy));
+        MqttPublisher.publish("battery/chargedEnergy", _chargedEnergy, 2, 0, true);
     }
 
     if (_dischargedEnergy != -1) {
-        MqttSettings.publish("battery/dischargedEnergy", String(_dischargedEnergy));
+        MqttPublisher.publish("battery/dischargedEnergy", _dischargedEnergy, 2, 0, true);
     }
 
-    MqttSettings.publish("battery/capacity", String(_totalCapacity));
-    MqttSettings.publish("battery/availableCapacity", String(_availableCapacity));
-
-    MqttSettings.publish("battery/CellMinMilliVolt", String(_cellMinMilliVolt));
-    MqttSettings.publish("battery/CellMaxMilliVolt", String(_cellMaxMilliVolt));
-    MqttSettings.publish("battery/CellDiffMilliVolt", String(_cellMaxMilliVolt - _cellMinMilliVolt));
-    MqttSettings.publish("battery/CellMinTemperature", String(_cellMinTemperature));
-    MqttSettings.publish("battery/CellMaxTemperature", String(_cellMaxTemperature));
-    MqttSettings.publish("battery/CellMinVoltageName", String(_cellMinVoltageName));
-    MqttSettings.publish("battery/CellMaxVoltageName", String(_cellMaxVoltageName));
-    MqttSettings.publish("battery/CellMinTemperatureName", String(_cellMinTemperatureName));
-    MqttSettings.publish("battery/CellMaxTemperatureName", String(_cellMaxTemperatureName));
-
-    MqttSettings.publish("battery/modulesOnline", String(_moduleCountOnline));
-    MqttSettings.publish("battery/modulesOffline", String(_moduleCountOffline));
-    MqttSettings.publish("battery/modulesBlockingCharge", String(_moduleCountBlockingCharge));
-    MqttSettings.publish("battery/modulesBlockingDischarge", String(_moduleCountBlockingDischarge));
-
-    MqttSettings.publish("battery/alarm/overCurrentDischarge", String(_alarmOverCurrentDischarge));
-    MqttSettings.publish("battery/alarm/overCurrentCharge", String(_alarmOverCurrentCharge));
-    MqttSettings.publish("battery/alarm/underVoltage", String(_alarmUnderVoltage));
-    MqttSettings.publish("battery/alarm/overVoltage", String(_alarmOverVoltage));
-    MqttSettings.publish("battery/alarm/underTemperature", String(_alarmUnderTemperature));
-    MqttSettings.publish("battery/alarm/overTemperature", String(_alarmOverTemperature));
-    MqttSettings.publish("battery/alarm/underTemperatureCharge", String(_alarmUnderTemperatureCharge));
-    MqttSettings.publish("battery/alarm/overTemperatureCharge", String(_alarmOverTemperatureCharge));
-    MqttSettings.publish("battery/alarm/bmsInternal", String(_alarmInternalFailure));
-    MqttSettings.publish("battery/alarm/cellImbalance", String(_alarmCellImbalance));
-
-    MqttSettings.publish("battery/warning/highCurrentDischarge", String(_warningHighDischargeCurrent));
-    MqttSettings.publish("battery/warning/highCurrentCharge", String(_warningHighChargeCurrent));
-    MqttSettings.publish("battery/warning/lowVoltage", String(_warningLowVoltage));
-    MqttSettings.publish("battery/warning/highVoltage", String(_warningHighVoltage));
-    MqttSettings.publish("battery/warning/lowTemperature", String(_warningLowTemperature));
-    MqttSettings.publish("battery/warning/highTemperature", String(_warningHighTemperature));
-    MqttSettings.publish("battery/warning/lowTemperatureCharge", String(_warningLowTemperatureCharge));
-    MqttSettings.publish("battery/warning/highTemperatureCharge", String(_warningHighTemperatureCharge));
-    MqttSettings.publish("battery/warning/bmsInternal", String(_warningInternalFailure));
-    MqttSettings.publish("battery/warning/cellImbalance", String(_warningCellImbalance));
+    MqttPublisher.publish("battery/capacity", _totalCapacity);
+    MqttPublisher.publish("battery/availableCapacity", _availableCapacity);
+
+    MqttPublisher.publish("battery/CellMinMilliVolt", _cellMinMilliVolt);
+    MqttPublisher.publish("battery/CellMaxMilliVolt", _cellMaxMilliVolt);
+    MqttPublisher.publish("battery/CellDiffMilliVolt", _cellMaxMilliVolt - _cellMinMilliVolt);
+    MqttPublisher.publish("battery/CellMinTemperature", _cellMinTemperature);
+    MqttPublisher.publish("battery/CellMaxTemperature", _cellMaxTemperature);
+    MqttPublisher.publish("battery/CellMinVoltageName", _cellMinVoltageName);
+    MqttPublisher.publish("battery/CellMaxVoltageName", _cellMaxVoltageName);
+    MqttPublisher.publish("battery/CellMinTemperatureName", _cellMinTemperatureName);
+    MqttPublisher.publish("battery/CellMaxTemperatureName", _cellMaxTemperatureName);
+
+    MqttPublisher.publish("battery/modulesOnline", _moduleCountOnline);
+    MqttPublisher.publish("battery/modulesOffline", _moduleCountOffline);
+    MqttPublisher.publish("battery/modulesBlockingCharge", _moduleCountBlockingCharge);
+    MqttPublisher.publish("battery/modulesBlockingDischarge", _moduleCountBlockingDischarge);
+
+    MqttPublisher.publish("battery/alarm/overCurrentDischarge", _alarmOverCurrentDischarge);
+    MqttPublisher.publish("battery/alarm/overCurrentCharge", _alarmOverCurrentCharge);
+    MqttPublisher.publish("battery/alarm/underVoltage", _alarmUnderVoltage);
+    MqttPublisher.publish("battery/alarm/overVoltage", _alarmOverVoltage);
+    MqttPublisher.publish("battery/alarm/underTemperature", _alarmUnderTemperature);
+    MqttPublisher.publish("battery/alarm/overTemperature", _alarmOverTemperature);
+    MqttPublisher.publish("battery/alarm/underTemperatureCharge", _alarmUnderTemperatureCharge);
+    MqttPublisher.publish("battery/alarm/overTemperatureCharge", _alarmOverTemperatureCharge);
+    MqttPublisher.publish("battery/alarm/bmsInternal", _alarmInternalFailure);
+    MqttPublisher.publish("battery/alarm/cellImbalance", _alarmCellImbalance);
+
+    MqttPublisher.publish("battery/warning/highCurrentDischarge", _warningHighDischargeCurrent);
+    MqttPublisher.publish("battery/warning/highCurrentCharge", _warningHighChargeCurrent);
+    MqttPublisher.publish("battery/warning/lowVoltage", _warningLowVoltage);
+    MqttPublisher.publish("battery/warning/highVoltage", _warningHighVoltage);
+    MqttPublisher.publish("battery/warning/lowTemperature", _warningLowTemperature);
+    MqttPublisher.publish("battery/warning/highTemperature", _warningHighTemperature);
+    MqttPublisher.publish("battery/warning/lowTemperatureCharge", _warningLowTemperatureCharge);
+    MqttPublisher.publish("battery/warning/highTemperatureCharge", _warningHighTemperatureCharge);
+    MqttPublisher.publish("battery/warning/bmsInternal", _warningInternalFailure);
+    MqttPublisher.publish("battery/warning/cellImbalance", _warningCellImbalance);
 }
 
 void JkBmsBatteryStats::mqttPublish() const
@@ -417,8 +419,10 @@ void JkBmsBatteryStats::mqttPublish() const
     // regularly publish all topics regardless of whether or not their value changed
     bool neverFullyPublished = _lastFullMqttPublish == 0;
     bool intervalElapsed = _lastFullMqttPublish + getMqttFullPublishIntervalMs() < millis();
-    bool fullPublish = neverFullyPublished || intervalElapsed;
+    bool fullPublish = neverFullyPublished || intervalElapsed
+        || MqttPublisherClass::isJsonModeEnabled();
 
+    const MqttPublisherClass::Group batteryGroup("battery/");
     for (auto iter = _dataPoints.cbegin(); iter != _dataPoints.cend(); ++iter) {
         // skip data points that did not change since last published
         if (!fullPublish && iter->second.getTimestamp() < _lastMqttPublish) { continue; }
@@ -426,44 +430,45 @@ void JkBmsBatteryStats::mqttPublish() const
         auto skipMatch = std::find(mqttSkip.begin(), mqttSkip.end(), iter->first);
         if (skipMatch != mqttSkip.end()) { continue; }
 
-        String topic((std::string("battery/") + iter->second.getLabelText()).c_str());
-        MqttSettings.publish(topic, iter->second.getValueText().c_str());
+        MqttPublisher.publish(batteryGroup, iter->second.getLabelText().c_str(),
+                iter->second.getValueText().c_str());
     }
 
     auto oCellVoltages = _dataPoints.get<Label::CellsMilliVolt>();
     if (oCellVoltages.has_value() && (fullPublish || _cellVoltageTimestamp > _lastMqttPublish)) {
         unsigned idx = 1;
         for (auto iter = oCellVoltages->cbegin(); iter != oCellVoltages->cend(); ++iter) {
-            String topic("battery/Cell");
-            topic += String(idx);
-            topic += "MilliVolt";
+            char topic[32];
+            snprintf(topic, sizeof(topic), "battery/Cell%uMilliVolt", idx);
 
-            MqttSettings.publish(topic, String(iter->second));
+            MqttPublisher.publish(topic, iter->second);
 
             ++idx;
         }
 
-        MqttSettings.publish("battery/CellMinMilliVolt", String(_cellMinMilliVolt));
-        MqttSettings.publish("battery/CellAvgMilliVolt", String(_cellAvgMilliVolt));
-        MqttSettings.publish("battery/CellMaxMilliVolt", String(_cellMaxMilliVolt));
-        MqttSettings.publish("battery/CellDiffMilliVolt", String(_cellMaxMilliVolt - _cellMinMilliVolt));
+        MqttPublisher.publish("battery/CellMinMilliVolt", _cellMinMilliVolt);
+        MqttPublisher.publish("battery/CellAvgMilliVolt", _cellAvgMilliVolt);
+        MqttPublisher.publish("battery/CellMaxMilliVolt", _cellMaxMilliVolt);
+        MqttPublisher.publish("battery/CellDiffMilliVolt", _cellMaxMilliVolt - _cellMinMilliVolt);
     }
 
     auto oAlarms = _dataPoints.get<Label::AlarmsBitmask>();
     if (oAlarms.has_value()) {
+        const MqttPublisherClass::Group group("battery/alarms/");
         for (auto iter = JkBms::AlarmBitTexts.begin(); iter != JkBms::AlarmBitTexts.end(); ++iter) {
             auto bit = iter->first;
-            String value = (*oAlarms & static_cast<uint16_t>(bit))?"1":"0";
-            MqttSettings.publish(String("battery/alarms/") + iter->second.data(), value);
+            char const* value = (*oAlarms & static_cast<uint16_t>(bit))?"1":"0";
+            MqttPublisher.publish(group, iter->second.data(), value);
         }
     }
 
     auto oStatus = _dataPoints.get<Label::StatusBitmask>();
     if (oStatus.has_value()) {
+        const MqttPublisherClass::Group group("battery/status/");
         for (auto iter = JkBms::StatusBitTexts.begin(); iter != JkBms::StatusBitTexts.end(); ++iter) {
             auto bit = iter->first;
-            String value = (*oStatus & static_cast<uint16_t>(bit))?"1":"0";
-            MqttSettings.publish(String("battery/status/") + iter->second.data(), value);
+            char const* value = (*oStatus & static_cast<uint16_t>(bit))?"1":"0";
+            MqttPublisher.publish(group, iter->second.data(), value);
         }
     }
 
@@ -602,12 +607,12 @@ void VictronSmartShuntStats::getLiveViewData(JsonVariant& root) const {
 void VictronSmartShuntStats::mqttPublish() const {
     BatteryStats::mqttPublish();
 
-    MqttSettings.publish("battery/chargeCycles", String(_chargeCycles));
-    MqttSettings.publish("battery/chargedEnergy", String(_chargedEnergy));
-    MqttSettings.publish("battery/dischargedEnergy", String(_dischargedEnergy));
-    MqttSettings.publish("battery/instantaneousPower", String(_instantaneousPower));
-    MqttSettings.publish("battery/consumedAmpHours", String(_consumedAmpHours));
-    MqttSettings.publish("battery/lastFullCharge", String(_lastFullCharge));
-    MqttSettings.publish("battery/midpointVoltage", String(_midpointVoltage));
-    MqttSettings.publish("battery/midpointDeviation", String(_midpointDeviation));
+    MqttPublisher.publish("battery/chargeCycles", _chargeCycles);
+    MqttPublisher.publish("battery/chargedEnergy", _chargedEnergy, 2, 0, true);
+    MqttPublisher.publish("battery/dischargedEnergy", _dischargedEnergy, 2, 0, true);
+    MqttPublisher.publish("battery/instantaneousPower", _instantaneousPower);
+    MqttPublisher.publish("battery/consumedAmpHours", _consumedAmpHours);
+    MqttPublisher.publish("battery/lastFullCharge", _lastFullCharge);
+    MqttPublisher.publish("battery/midpointVoltage", _midpointVoltage);
+    MqttPublisher.publish("battery/midpointDeviation", _midpointDeviation);
 }
@@ -71,7 +71,17 @@ void ConfigurationClass::serializePowerMeterHttpJsonConfig(PowerMeterHttpJsonCon
 void ConfigurationClass::serializePowerMeterHttpSmlConfig(PowerMeterHttpSmlConfig const& source, JsonObject& target)
 {
     target["polling_interval"] = source.PollingInterval;
-    serializeHttpRequestConfig(source.HttpRequest, target);
+
+    JsonArray values = target["values"].to<JsonArray>();
+    for (size_t i = 0; i < POWERMETER_HTTP_SML_MAX_VALUES; ++i) {
+        JsonObject t = values.add<JsonObject>();
+        PowerMeterHttpSmlValue const& s = source.Values[i];
+
+        serializeHttpRequestConfig(s.HttpRequest, t);
+
+        t["enabled"] = s.Enabled;
+        t["sign_inverted"] = s.SignInverted;
+    }
 }
 
 bool ConfigurationClass::write()
@@ -123,6 +133,7 @@ bool ConfigurationClass::write()
     mqtt["retain"] = config.Mqtt.Retain;
     mqtt["publish_interval"] = config.Mqtt.PublishInterval;
     mqtt["clean_session"] = config.Mqtt.CleanSession;
+    mqtt["payload_mode"] = config.Mqtt.PayloadMode;
 
     JsonObject mqtt_lwt = mqtt["lwt"].to<JsonObject>();
     mqtt_lwt["topic"] = config.Mqtt.Lwt.Topic;
@@ -144,9 +155,16 @@ bool ConfigurationClass::write()
     mqtt_hass["individual_panels"] = config.Mqtt.Hass.IndividualPanels;
     mqtt_hass["expire"] = config.Mqtt.Hass.Expire;
 
+    JsonObject mqtt_changefilter = mqtt["change_filter"].to<JsonObject>();
+    mqtt_changefilter["enabled"] = config.Mqtt.ChangeFilter.Enabled;
+    mqtt_changefilter["deadband"] = config.Mqtt.ChangeFilter.Deadband;
+    mqtt_changefilter["deadband_absolute"] = config.Mqtt.ChangeFilter.AbsoluteDeadband;
+    mqtt_changefilter["refresh_interval"] = config.Mqtt.ChangeFilter.RefreshInterval;
+
     JsonObject dtu = doc["dtu"].to<JsonObject>();
     dtu["serial"] = config.Dtu.Serial;
     dtu["poll_interval"] = config.Dtu.PollInterval;
+    dtu["parallel_polling"] = config.Dtu.ParallelPolling;
     dtu["verbose_logging"] = config.Dtu.VerboseLogging;
     dtu["nrf_pa_level"] = config.Dtu.Nrf.PaLevel;
     dtu["cmt_pa_level"] = config.Dtu.Cmt.PaLevel;
@@ -205,6 +223,10 @@ bool ConfigurationClass::write()
     vedirect["verbose_logging"] = config.Vedirect.VerboseLogging;
     vedirect["updates_only"] = config.Vedirect.UpdatesOnly;
 
+    JsonObject energylog = doc["energylog"].to<JsonObject>();
+    energylog["enabled"] = config.EnergyLog.Enabled;
+    energylog["interval"] = config.EnergyLog.Interval;
+
     JsonObject powermeter = doc["powermeter"].to<JsonObject>();
     powermeter["enabled"] = config.PowerMeter.Enabled;
     powermeter["verbose_logging"] = config.PowerMeter.VerboseLogging;
@@ -232,10 +254,14 @@ bool ConfigurationClass::write()
     powerlimiter["is_inverter_behind_powermeter"] = config.PowerLimiter.IsInverterBehindPowerMeter;
     powerlimiter["is_inverter_solar_powered"] = config.PowerLimiter.IsInverterSolarPowered;
     powerlimiter["use_overscaling_to_compensate_shading"] = config.PowerLimiter.UseOverscalingToCompensateShading;
+    powerlimiter["distribute_over_all_inverters"] = config.PowerLimiter.DistributeOverAllInverters;
     powerlimiter["inverter_id"] = config.PowerLimiter.InverterId;
     powerlimiter["inverter_channel_id"] = config.PowerLimiter.InverterChannelId;
     powerlimiter["target_power_consumption"] = config.PowerLimiter.TargetPowerConsumption;
     powerlimiter["target_power_consumption_hysteresis"] = config.PowerLimiter.TargetPowerConsumptionHysteresis;
+    powerlimiter["controller_mode"] = config.PowerLimiter.ControllerMode;
+    powerlimiter["controller_kp"] = config.PowerLimiter.ControllerKp;
+    powerlimiter["controller_ki"] = config.PowerLimiter.ControllerKi;
     powerlimiter["lower_power_limit"] = config.PowerLimiter.LowerPowerLimit;
     powerlimiter["base_load_limit"] = config.PowerLimiter.BaseLoadLimit;
     powerlimiter["upper_power_limit"] = config.PowerLimiter.UpperPowerLimit;
@@ -350,7 +376,23 @@ void ConfigurationClass::deserializePowerMeterHttpJsonConfig(JsonObject const& s
 void ConfigurationClass::deserializePowerMeterHttpSmlConfig(JsonObject const& source, PowerMeterHttpSmlConfig& target)
 {
     target.PollingInterval = source["polling_interval"] | POWERMETER_POLLING_INTERVAL;
-    deserializeHttpRequestConfig(source, target.HttpRequest);
+
+    JsonArray values = source["values"].as<JsonArray>();
+    for (size_t i = 0; i < POWERMETER_HTTP_SML_MAX_VALUES; ++i) {
+        PowerMeterHttpSmlValue& t = target.Values[i];
+        JsonObject s = values[i];
+
+        // the http request of the (then only) meter was previously stored
+        // alongside the polling interval.
+        if (i == 0 && values.isNull()) { s = source; }
+
+        deserializeHttpRequestConfig(s, t.HttpRequest);
+
+        t.Enabled = s["enabled"] | false;
+        t.SignInverted = s["sign_inverted"] | false;
+    }
+
+    target.Values[0].Enabled = true;
 }
 
 bool ConfigurationClass::read()
@@ -439,6 +481,7 @@ bool ConfigurationClass::read()
     config.Mqtt.Retain = mqtt["retain"] | MQTT_RETAIN;
     config.Mqtt.PublishInterval = mqtt["publish_interval"] | MQTT_PUBLISH_INTERVAL;
     config.Mqtt.CleanSession = mqtt["clean_session"] | MQTT_CLEAN_SESSION;
+    config.Mqtt.PayloadMode = mqtt["payload_mode"] | MQTT_PAYLOAD_MODE;
 
     JsonObject mqtt_lwt = mqtt["lwt"];
     strlcpy(config.Mqtt.Lwt.Topic, mqtt_lwt["topic"] | MQTT_LWT_TOPIC, sizeof(config.Mqtt.Lwt.Topic));
@@ -460,9 +503,16 @@ bool ConfigurationClass::read()
     config.Mqtt.Hass.IndividualPanels = mqtt_hass["individual_panels"] | MQTT_HASS_INDIVIDUALPANELS;
     strlcpy(config.Mqtt.Hass.Topic, mqtt_hass["topic"] | MQTT_HASS_TOPIC, sizeof(config.Mqtt.Hass.Topic));
 
+    JsonObject mqtt_changefilter = mqtt["change_filter"];
+    config.Mqtt.ChangeFilter.Enabled = mqtt_changefilter["enabled"] | MQTT_CHANGEFILTER_ENABLED;
+    config.Mqtt.ChangeFilter.Deadband = mqtt_changefilter["deadband"] | MQTT_CHANGEFILTER_DEADBAND;
+    config.Mqtt.ChangeFilter.AbsoluteDeadband = mqtt_changefilter["deadband_absolute"] | MQTT_CHANGEFILTER_ABSOLUTE_DEADBAND;
+    config.Mqtt.ChangeFilter.RefreshInterval = mqtt_changefilter["refresh_interval"] | MQTT_CHANGEFILTER_REFRESH_INTERVAL;
+
     JsonObject dtu = doc["dtu"];
     config.Dtu.Serial = dtu["serial"] | DTU_SERIAL;
     config.Dtu.PollInterval = dtu["poll_interval"] | DTU_POLL_INTERVAL;
+    config.Dtu.ParallelPolling = dtu["parallel_polling"] | DTU_PARALLEL_POLLING;
     config.Dtu.VerboseLogging = dtu["verbose_logging"] | VERBOSE_LOGGING;
     config.Dtu.Nrf.PaLevel = dtu["nrf_pa_level"] | DTU_NRF_PA_LEVEL;
     config.Dtu.Cmt.PaLevel = dtu["cmt_pa_level"] | DTU_CMT_PA_LEVEL;
@@ -521,6 +571,10 @@ bool ConfigurationClass::read()
     config.Vedirect.VerboseLogging = vedirect["verbose_logging"] | VEDIRECT_VERBOSE_LOGGING;
     config.Vedirect.UpdatesOnly = vedirect["updates_only"] | VEDIRECT_UPDATESONLY;
 
+    JsonObject energylog = doc["energylog"];
+    config.EnergyLog.Enabled = energylog["enabled"] | ENERGYLOG_ENABLED;
+    config.EnergyLog.Interval = energylog["interval"] | ENERGYLOG_INTERVAL;
+
     JsonObject powermeter = doc["powermeter"];
     config.PowerMeter.Enabled = powermeter["enabled"] | POWERMETER_ENABLED;
     config.PowerMeter.VerboseLogging = powermeter["verbose_logging"] | VERBOSE_LOGGING;
@@ -582,10 +636,14 @@ bool ConfigurationClass::read()
     config.PowerLimiter.IsInverterBehindPowerMeter = powerlimiter["is_inverter_behind_powermeter"] | POWERLIMITER_IS_INVERTER_BEHIND_POWER_METER;
     config.PowerLimiter.IsInverterSolarPowered = powerlimiter["is_inverter_solar_powered"] | POWERLIMITER_IS_INVERTER_SOLAR_POWERED;
     config.PowerLimiter.UseOverscalingToCompensateShading = powerlimiter["use_overscaling_to_compensate_shading"] | POWERLIMITER_USE_OVERSCALING_TO_COMPENSATE_SHADING;
+    config.PowerLimiter.DistributeOverAllInverters = powerlimiter["distribute_over_all_inverters"] | POWERLIMITER_DISTRIBUTE_OVER_ALL_INVERTERS;
     config.PowerLimiter.InverterId = powerlimiter["inverter_id"] | POWERLIMITER_INVERTER_ID;
     config.PowerLimiter.InverterChannelId = powerlimiter["inverter_channel_id"] | POWERLIMITER_INVERTER_CHANNEL_ID;
     config.PowerLimiter.TargetPowerConsumption = powerlimiter["target_power_consumption"] | POWERLIMITER_TARGET_POWER_CONSUMPTION;
     config.PowerLimiter.TargetPowerConsumptionHysteresis = powerlimiter["target_power_consumption_hysteresis"] | POWERLIMITER_TARGET_POWER_CONSUMPTION_HYSTERESIS;
+    config.PowerLimiter.ControllerMode = powerlimiter["controller_mode"] | POWERLIMITER_CONTROLLER_MODE;
+    config.PowerLimiter.ControllerKp = powerlimiter["controller_kp"] | POWERLIMITER_CONTROLLER_KP;
+    config.PowerLimiter.ControllerKi = powerlimiter["controller_ki"] | POWERLIMITER_CONTROLLER_KI;
     config.PowerLimiter.LowerPowerLimit = powerlimiter["lower_power_limit"] | POWERLIMITER_LOWER_POWER_LIMIT;
     config.PowerLimiter.BaseLoadLimit = powerlimiter["base_load_limit"] | POWERLIMITER_BASE_LOAD_LIMIT;
     config.PowerLimiter.UpperPowerLimit = powerlimiter["upper_power_limit"] | POWERLIMITER_UPPER_POWER_LIMIT;
@@ -81,31 +81,34 @@ void DatastoreClass::loop()
             }
         }
 
-        for (auto& c : inv->Statistics()->getChannelsByType(TYPE_INV)) {
+        // read all values from the same statistics packet
+        auto stats = inv->Statistics()->getSnapshot();
+
+        for (auto& c : stats->getChannelsByType(TYPE_INV)) {
             if (cfg->Poll_Enable) {
-                _totalAcYieldTotalEnabled += inv->Statistics()->getChannelFieldValue(TYPE_INV, c, FLD_YT);
-                _totalAcYieldDayEnabled += inv->Statistics()->getChannelFieldValue(TYPE_INV, c, FLD_YD);
+                _totalAcYieldTotalEnabled += stats->getChannelFieldValue(TYPE_INV, c, FLD_YT);
+                _totalAcYieldDayEnabled += stats->getChannelFieldValue(TYPE_INV, c, FLD_YD);
 
-                _totalAcYieldTotalDigits = max<unsigned int>(_totalAcYieldTotalDigits, inv->Statistics()->getChannelFieldDigits(TYPE_INV, c, FLD_YT));
-                _totalAcYieldDayDigits = max<unsigned int>(_totalAcYieldDayDigits, inv->Statistics()->getChannelFieldDigits(TYPE_INV, c, FLD_YD));
+                _totalAcYieldTotalDigits = max<unsigned int>(_totalAcYieldTotalDigits, stats->getChannelFieldDigits(TYPE_INV, c, FLD_YT));
+                _totalAcYieldDayDigits = max<unsigned int>(_totalAcYieldDayDigits, stats->getChannelFieldDigits(TYPE_INV, c, FLD_YD));
             }
         }
 
-        for (auto& c : inv->Statistics()->getChannelsByType(TYPE_AC)) {
+        for (auto& c : stats->getChannelsByType(TYPE_AC)) {
             if (inv->getEnablePolling()) {
-                _totalAcPowerEnabled += inv->Statistics()->getChannelFieldValue(TYPE_AC, c, FLD_PAC);
-                _totalAcPowerDigits = max<unsigned int>(_totalAcPowerDigits, inv->Statistics()->getChannelFieldDigits(TYPE_AC, c, FLD_PAC));
+                _totalAcPowerEnabled += stats->getChannelFieldValue(TYPE_AC, c, FLD_PAC);
+                _totalAcPowerDigits = max<unsigned int>(_totalAcPowerDigits, stats->getChannelFieldDigits(TYPE_AC, c, FLD_PAC));
             }
         }
 
-        for (auto& c : inv->Statistics()->getChannelsByType(TYPE_DC)) {
+        for (auto& c : stats->getChannelsByType(TYPE_DC)) {
             if (inv->getEnablePolling()) {
-                _totalDcPowerEnabled += inv->Statistics()->getChannelFieldValue(TYPE_DC, c, FLD_PDC);
-                _totalDcPowerDigits = max<unsigned int>(_totalDcPowerDigits, inv->Statistics()->getChannelFieldDigits(TYPE_DC, c, FLD_PDC));
+                _totalDcPowerEnabled += stats->getChannelFieldValue(TYPE_DC, c, FLD_PDC);
+                _totalDcPowerDigits = max<unsigned int>(_totalDcPowerDigits, stats->getChannelFieldDigits(TYPE_DC, c, FLD_PDC));
 
-                if (inv->Statistics()->getStringMaxPower(c) > 0) {
-                    _totalDcPowerIrradiation += inv->Statistics()->getChannelFieldValue(TYPE_DC, c, FLD_PDC);
-                    _totalDcIrradiationInstalled += inv->Statistics()->getStringMaxPower(c);
+                if (stats->getStringMaxPower(c) > 0) {
+                    _totalDcPowerIrradiation += stats->getChannelFieldValue(TYPE_DC, c, FLD_PDC);
+                    _totalDcIrradiationInstalled += stats->getStringMaxPower(c);
                 }
             }
         }
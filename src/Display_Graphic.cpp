@@ -68,7 +68,7 @@ void DisplayGraphicClass::init(Scheduler& scheduler, const DisplayType_t type, c
         _display->begin();
         setContrast(DISPLAY_CONTRAST);
         setStatus(true);
-        _diagram.init(scheduler, _display);
+        _diagram.init(_display);
 
         scheduler.addTask(_loopTask);
         _loopTask.setInterval(_period);
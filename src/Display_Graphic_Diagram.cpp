@@ -4,63 +4,28 @@
  */
 #include "Display_Graphic_Diagram.h"
 #include "Configuration.h"
-#include "Datastore.h"
+#include "History.h"
 #include <algorithm>
+#include <array>
 
-DisplayGraphicDiagramClass::DisplayGraphicDiagramClass()
-    : _averageTask(1 * TASK_SECOND, TASK_FOREVER, std::bind(&DisplayGraphicDiagramClass::averageLoop, this))
-    , _dataPointTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&DisplayGraphicDiagramClass::dataPointLoop, this))
-{
-}
-
-void DisplayGraphicDiagramClass::init(Scheduler& scheduler, U8G2* display)
+void DisplayGraphicDiagramClass::init(U8G2* display)
 {
     _display = display;
-
-    scheduler.addTask(_averageTask);
-    _averageTask.enable();
-
-    scheduler.addTask(_dataPointTask);
-    updatePeriod();
-    _dataPointTask.enable();
-}
-
-void DisplayGraphicDiagramClass::averageLoop()
-{
-    const float currentWatts = Datastore.getTotalAcPowerEnabled(); // get the current AC production
-    _iRunningAverage += currentWatts;
-    _iRunningAverageCnt++;
-}
-
-void DisplayGraphicDiagramClass::dataPointLoop()
-{
-    if (_graphValuesCount >= std::size(_graphValues)) {
-        for (uint8_t i = 0; i < std::size(_graphValues) - 1; i++) {
-            _graphValues[i] = _graphValues[i + 1];
-        }
-        _graphValuesCount = std::size(_graphValues) - 1;
-    }
-    if (_iRunningAverageCnt != 0) {
-        _graphValues[_graphValuesCount++] = _iRunningAverage / _iRunningAverageCnt;
-        _iRunningAverage = 0;
-        _iRunningAverageCnt = 0;
-    }
-}
-
-uint32_t DisplayGraphicDiagramClass::getSecondsPerDot()
-{
-    return Configuration.get().Display.Diagram.Duration / _chartWidth;
-}
-
-void DisplayGraphicDiagramClass::updatePeriod()
-{
-    //  Calculate seconds per datapoint
-    _dataPointTask.setInterval(Configuration.get().Display.Diagram.Duration * TASK_SECOND / MAX_DATAPOINTS);
 }
 
 void DisplayGraphicDiagramClass::redraw(uint8_t screenSaverOffsetX, uint8_t xPos, uint8_t yPos, uint8_t width, uint8_t height, bool isFullscreen)
 {
-    _chartWidth = width;
+    // the AC power history is aggregated into (at most) one point per pixel
+    const uint32_t duration = Configuration.get().Display.Diagram.Duration;
+    std::array<TimeSeries::Aggregate, MAX_DATAPOINTS> points;
+    float secondsPerPoint = 0;
+    const size_t pointCount = History.get(HistoryClass::Series::AcPower).resample(
+        duration, points.data(), std::min<size_t>(width, points.size()), nullptr, &secondsPerPoint);
+
+    std::array<float, MAX_DATAPOINTS> graphValues = {};
+    for (size_t i = 0; i < pointCount; i++) {
+        graphValues[i] = points[i].valid ? points[i].avg : 0;
+    }
 
     // screenSaverOffsetX expected to be in range 0..6
     const uint8_t graphPosX = xPos + ((screenSaverOffsetX > 3) ? 1 : 0);
@@ -83,7 +48,7 @@ void DisplayGraphicDiagramClass::redraw(uint8_t screenSaverOffsetX, uint8_t xPos
 
     // draw AC value
     char fmtText[7];
-    const float maxWatts = *std::max_element(_graphValues.begin(), _graphValues.end());
+    const float maxWatts = *std::max_element(graphValues.begin(), graphValues.end());
     if (maxWatts > 999) {
         snprintf(fmtText, sizeof(fmtText), "%2.1fkW", maxWatts / 1000);
     } else {
@@ -103,7 +68,7 @@ void DisplayGraphicDiagramClass::redraw(uint8_t screenSaverOffsetX, uint8_t xPos
 
     // draw chart
     const float scaleFactorY = maxWatts / static_cast<float>(height);
-    const float scaleFactorX = static_cast<float>(MAX_DATAPOINTS) / static_cast<float>(_chartWidth);
+    const float scaleFactorX = (secondsPerPoint > 0) ? (duration / static_cast<float>(width)) / secondsPerPoint : 0;
 
     if (maxWatts > 0 && isFullscreen) {
         // draw y axis ticks
@@ -118,10 +83,10 @@ void DisplayGraphicDiagramClass::redraw(uint8_t screenSaverOffsetX, uint8_t xPos
     }
 
     uint8_t xAxisTicks = 1;
-    for (uint8_t i = 1; i < _graphValuesCount; i++) {
+    for (uint8_t i = 1; i < pointCount; i++) {
         // draw one tick per hour to the x-axis
-        if (i * getSecondsPerDot() > (3600u * xAxisTicks)) {
-            _display->drawPixel((graphPosX + 1 + i) * scaleFactorX, graphPosY + height);
+        if (i * secondsPerPoint > (3600u * xAxisTicks)) {
+            _display->drawPixel(graphPosX + 1 + i / scaleFactorX, graphPosY + height);
             xAxisTicks++;
         }
 
@@ -130,7 +95,7 @@ void DisplayGraphicDiagramClass::redraw(uint8_t screenSaverOffsetX, uint8_t xPos
         }
 
         _display->drawLine(
-            graphPosX + (i - 1) / scaleFactorX, horizontal_line_y - std::max<int16_t>(0, _graphValues[i - 1] / scaleFactorY - 0.5),
-            graphPosX + i / scaleFactorX, horizontal_line_y - std::max<int16_t>(0, _graphValues[i] / scaleFactorY - 0.5));
+            graphPosX + (i - 1) / scaleFactorX, horizontal_line_y - std::max<int16_t>(0, graphValues[i - 1] / scaleFactorY - 0.5),
+            graphPosX + i / scaleFactorX, horizontal_line_y - std::max<int16_t>(0, graphValues[i] / scaleFactorY - 0.5));
     }
 }
@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "EnergyFlow.h"
+#include "Battery.h"
+#include "Configuration.h"
+#include "Huawei_can.h"
+#include "MessageOutput.h"
+#include "PowerLimiter.h"
+#include "PowerMeter.h"
+#include <frozen/map.h>
+
+EnergyFlowClass EnergyFlow;
+
+frozen::string const& EnergyFlowClass::getDirectionText(EnergyFlowClass::Direction direction)
+{
+    static const frozen::string missing = "unknown";
+
+    static const frozen::map<Direction, frozen::string, 3> texts = {
+        { Direction::Idle, "idle" },
+        { Direction::Charge, "charge" },
+        { Direction::Discharge, "discharge" }
+    };
+
+    auto iter = texts.find(direction);
+    if (iter == texts.end()) { return missing; }
+
+    return iter->second;
+}
+
+frozen::string const& EnergyFlowClass::getReasonText(EnergyFlowClass::Reason reason)
+{
+    static const frozen::string missing = "programmer error: missing reason text";
+
+    static const frozen::map<Reason, frozen::string, 9> texts = {
+        { Reason::Initializing, "no decision made yet" },
+        { Reason::PsuNotAutomatic, "Huawei PSU disabled or not in internal automatic mode" },
+        { Reason::NoPowerMeter, "no valid power meter reading" },
+        { Reason::FullSolarPassthrough, "full solar passthrough is active" },
+        { Reason::SocStopThreshold, "battery SoC reached the PSU's stop threshold" },
+        { Reason::Surplus, "surplus power is used to charge the battery" },
+        { Reason::NoSurplus, "not enough surplus power to charge the battery" },
+        { Reason::InverterStopping, "surplus power available, waiting for the inverters to stop" },
+        { Reason::PsuStopping, "no surplus power, waiting for the PSU to stop" }
+    };
+
+    auto iter = texts.find(reason);
+    if (iter == texts.end()) { return missing; }
+
+    return iter->second;
+}
+
+EnergyFlowClass::Decision const& EnergyFlowClass::getDecision()
+{
+    // decisions are shared by the PSU and the DPL, which shall act on the
+    // same power meter reading. the periodic re-evaluation catches state
+    // changes of the subsystems, e.g., inverters which stopped producing.
+    if (_decision.reason == Reason::Initializing ||
+            PowerMeter.getLastUpdate() != _decision.meterMillis ||
+            (millis() - _decision.decisionMillis) >= 1000) {
+        evaluate();
+    }
+
+    return _decision;
+}
+
+void EnergyFlowClass::evaluate()
+{
+    auto const& config = Configuration.get();
+
+    _decision.gridPower = PowerMeter.getPowerTotal();
+    _decision.meterMillis = PowerMeter.getLastUpdate();
+    _decision.decisionMillis = millis();
+
+    if (!config.Huawei.Enabled || HuaweiCan.getMode() != HUAWEI_MODE_AUTO_INT) {
+        return decide(Direction::Discharge, Reason::PsuNotAutomatic);
+    }
+
+    // the inverters shall pass through all solar power. the PSU must not
+    // charge the battery using the power fed into the grid.
+    if (PowerLimiter.getFullSolarPassThroughEnabled()) {
+        return decide(Direction::Discharge, Reason::FullSolarPassthrough);
+    }
+
+    RectifierParameters_t const* rp = HuaweiCan.get();
+    bool psuActive = rp->output_current > HUAWEI_AUTO_MODE_SHUTDOWN_CURRENT;
+
+    if (!PowerMeter.isDataValid()) {
+        return decide(psuActive ? Direction::Idle : Direction::Discharge,
+                Reason::NoPowerMeter);
+    }
+
+    bool socStop = config.Battery.Enabled &&
+        config.Huawei.Auto_Power_BatterySoC_Limits_Enabled &&
+        Battery.getStats()->getSoC() >= config.Huawei.Auto_Power_Stop_BatterySoC_Threshold;
+
+    // the PSU output power is the requested output power plus the
+    // permissible grid consumption, factoring in the efficiency
+    float efficiency = (rp->efficiency > 0.5 ? rp->efficiency : 1.0);
+    float chargePower = -1 * round(_decision.gridPower) + rp->output_power +
+        config.Huawei.Auto_Power_Target_Power_Consumption / efficiency;
+
+    if (!socStop && chargePower > config.Huawei.Auto_Power_Lower_Power_Limit) {
+        if (PowerLimiter.isGovernedInverterProducing()) {
+            return decide(Direction::Idle, Reason::InverterStopping);
+        }
+
+        return decide(Direction::Charge, Reason::Surplus, chargePower);
+    }
+
+    if (psuActive) {
+        return decide(Direction::Idle, Reason::PsuStopping);
+    }
+
+    return decide(Direction::Discharge,
+            socStop ? Reason::SocStopThreshold : Reason::NoSurplus);
+}
+
+void EnergyFlowClass::decide(EnergyFlowClass::Direction direction,
+        EnergyFlowClass::Reason reason, float chargePower)
+{
+    auto const& config = Configuration.get();
+    bool verboseLogging = config.Huawei.VerboseLogging ||
+        config.PowerLimiter.VerboseLogging;
+
+    if (direction != _decision.direction || verboseLogging) {
+        MessageOutput.printf("[EnergyFlow::decide] %s (%s), grid power: %.0f W, "
+                "charge power: %.0f W\r\n", getDirectionText(direction).data(),
+                getReasonText(reason).data(), _decision.gridPower, chargePower);
+    }
+
+    _decision.direction = direction;
+    _decision.reason = reason;
+    _decision.chargePower = chargePower;
+}
+
+void EnergyFlowClass::toJson(JsonObject root) const
+{
+    root["direction"] = getDirectionText(_decision.direction).data();
+    root["reason"] = getReasonText(_decision.reason).data();
+    root["charge_power"] = _decision.chargePower;
+    root["grid_power"] = _decision.gridPower;
+    root["age_ms"] = millis() - _decision.decisionMillis;
+}
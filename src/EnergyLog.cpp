@@ -0,0 +1,508 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "EnergyLog.h"
+#include "Battery.h"
+#include "Configuration.h"
+#include "MessageOutput.h"
+#include "PowerMeter.h"
+#include "VictronMppt.h"
+#include <Hoymiles.h>
+#include <LittleFS.h>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <frozen/map.h>
+#include <vector>
+
+EnergyLogClass EnergyLog;
+
+static constexpr char const* s_tempFilename = "/energy.tmp";
+
+EnergyLogClass::EnergyLogClass()
+    : _loopTask(1 * TASK_SECOND, TASK_FOREVER, std::bind(&EnergyLogClass::loop, this))
+{
+}
+
+void EnergyLogClass::init(Scheduler& scheduler)
+{
+    loadCounters();
+
+    scheduler.addTask(_loopTask);
+    _loopTask.enable();
+}
+
+char const* EnergyLogClass::getFilename(EnergyLogClass::Resolution resolution)
+{
+    switch (resolution) {
+        case Resolution::Raw: return "/energy_raw.bin";
+        case Resolution::Day: return "/energy_day.bin";
+        case Resolution::Month: return "/energy_month.bin";
+    }
+
+    return "/energy_raw.bin";
+}
+
+uint16_t EnergyLogClass::getKey(EnergyLogClass::Source source, uint8_t index)
+{
+    return (static_cast<uint16_t>(source) << 8) | index;
+}
+
+uint32_t EnergyLogClass::getDayStart(uint32_t timestamp)
+{
+    time_t t = timestamp;
+    struct tm tm;
+    localtime_r(&t, &tm);
+    tm.tm_hour = 0;
+    tm.tm_min = 0;
+    tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+    return mktime(&tm);
+}
+
+uint32_t EnergyLogClass::getMonthStart(uint32_t timestamp)
+{
+    time_t t = timestamp;
+    struct tm tm;
+    localtime_r(&t, &tm);
+    tm.tm_mday = 1;
+    tm.tm_hour = 0;
+    tm.tm_min = 0;
+    tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+    return mktime(&tm);
+}
+
+uint8_t EnergyLogClass::getDayOfMonth(uint32_t timestamp)
+{
+    time_t t = timestamp;
+    struct tm tm;
+    localtime_r(&t, &tm);
+    return tm.tm_mday;
+}
+
+frozen::string const& EnergyLogClass::getSourceName(EnergyLogClass::Source source)
+{
+    static const frozen::string missing = "unknown";
+
+    static const frozen::map<Source, frozen::string, 6> names = {
+        { Source::Inverter, "inverter" },
+        { Source::Mppt, "mppt" },
+        { Source::BatteryCharge, "battery_charge" },
+        { Source::BatteryDischarge, "battery_discharge" },
+        { Source::GridImport, "grid_import" },
+        { Source::GridExport, "grid_export" }
+    };
+
+    auto iter = names.find(source);
+    if (iter == names.end()) { return missing; }
+
+    return iter->second;
+}
+
+std::optional<EnergyLogClass::Resolution> EnergyLogClass::resolutionFromName(char const* name)
+{
+    if (strcmp(name, "raw") == 0) { return Resolution::Raw; }
+    if (strcmp(name, "day") == 0) { return Resolution::Day; }
+    if (strcmp(name, "month") == 0) { return Resolution::Month; }
+    return std::nullopt;
+}
+
+// the integrated counters continue from the values logged last, such that
+// they never decrease, which would be mistaken for a counter glitch.
+void EnergyLogClass::loadCounters()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    File file = LittleFS.open(getFilename(Resolution::Raw), "r", false);
+    if (!file) { return; }
+
+    Record record;
+    while (file.read(reinterpret_cast<uint8_t*>(&record), sizeof(record)) == sizeof(record)) {
+        auto key = getKey(record.source, record.index);
+        _lastLogged[key] = record.value;
+
+        switch (record.source) {
+            case Source::BatteryCharge:
+            case Source::BatteryDischarge:
+            case Source::GridImport:
+            case Source::GridExport:
+                _integrated[key] = record.value;
+                break;
+            default:
+                break;
+        }
+    }
+
+    file.close();
+}
+
+void EnergyLogClass::integrate()
+{
+    uint32_t now = millis();
+    float seconds = (now - _lastIntegration) / 1000.0;
+    _lastIntegration = now;
+
+    // do not integrate across gaps, e.g., while logging was disabled
+    if (seconds > 10) { return; }
+
+    auto add = [this,seconds](Source source, float power) {
+        _integrated[getKey(source, 0)] += power * seconds / 3600;
+    };
+
+    if (PowerMeter.isDataValid()) {
+        float power = PowerMeter.getPowerTotal();
+        if (power > 0) { add(Source::GridImport, power); }
+        else { add(Source::GridExport, -power); }
+    }
+
+    if (Configuration.get().Battery.Enabled) {
+        auto spStats = Battery.getStats();
+        if (spStats->isVoltageValid() && spStats->isCurrentValid()) {
+            float power = spStats->getVoltage() * spStats->getChargeCurrent();
+            if (power > 0) { add(Source::BatteryCharge, power); }
+            else { add(Source::BatteryDischarge, -power); }
+        }
+    }
+}
+
+void EnergyLogClass::loop()
+{
+    auto const& config = Configuration.get();
+
+    if (!config.EnergyLog.Enabled) { return; }
+
+    integrate();
+
+    struct tm timeinfo;
+    if (!getLocalTime(&timeinfo, 5)) { return; } // no valid time yet
+
+    uint32_t now = time(nullptr);
+    uint32_t interval = std::clamp<uint32_t>(config.EnergyLog.Interval,
+            ENERGYLOG_MIN_INTERVAL, ENERGYLOG_MAX_INTERVAL) * 60;
+
+    // records are aligned to the interval
+    uint32_t slot = now / interval;
+    if (slot == _lastSlot) { return; }
+    _lastSlot = slot;
+
+    // compacts the raw log after boot and after midnight
+    uint32_t today = getDayStart(now);
+    if (today != _lastCompaction) {
+        compact(today);
+        applyRetention(today);
+        _lastCompaction = today;
+    }
+
+    append(slot * interval);
+}
+
+void EnergyLogClass::append(uint32_t timestamp)
+{
+    std::vector<Record> records;
+
+    // unchanged counters are not logged, which saves most writes at night
+    auto add = [this,timestamp,&records](Source source, uint8_t index, uint32_t value) {
+        auto key = getKey(source, index);
+        auto iter = _lastLogged.find(key);
+        if (iter != _lastLogged.end() && iter->second == value) { return; }
+        _lastLogged[key] = value;
+        records.push_back({ timestamp, source, index, 0, value });
+    };
+
+    auto const& config = Configuration.get();
+    for (uint8_t i = 0; i < INV_MAX_COUNT; ++i) {
+        if (config.Inverter[i].Serial == 0) { continue; }
+
+        auto inv = Hoymiles.getInverterBySerial(config.Inverter[i].Serial);
+        if (inv == nullptr || !inv->isReachable()) { continue; }
+
+        auto stats = inv->Statistics()->getSnapshot();
+        float yield = 0;
+        for (auto& c : stats->getChannelsByType(TYPE_INV)) {
+            yield += stats->getChannelFieldValue(TYPE_INV, c, FLD_YT);
+        }
+
+        // inverters report zero until their first statistics packet
+        if (yield > 0) { add(Source::Inverter, i, static_cast<uint32_t>(yield * 1000)); }
+    }
+
+    // per controller, as the sum drops while a controller is unavailable
+    for (size_t i = 0; config.Vedirect.Enabled && i < VictronMppt.controllerAmount(); ++i) {
+        if (!VictronMppt.isDataValid(i)) { continue; }
+        auto data = VictronMppt.getData(i);
+        if (!data) { continue; }
+        add(Source::Mppt, i, data->yieldTotal_H19_Wh);
+    }
+
+    // only full Wh are logged, the fraction is kept in _integrated
+    for (auto const& [key, value] : _integrated) {
+        add(static_cast<Source>(key >> 8), key & 0xFF, static_cast<uint32_t>(value));
+    }
+
+    if (records.empty()) { return; }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    File file = LittleFS.open(getFilename(Resolution::Raw), "a", true);
+    if (!file) {
+        MessageOutput.printf("[EnergyLog] cannot open raw log\r\n");
+        return;
+    }
+
+    size_t needed = records.size() * sizeof(Record);
+    bool full = file.size() + needed > ENERGYLOG_RAW_MAX_SIZE ||
+        LittleFS.totalBytes() - LittleFS.usedBytes() < ENERGYLOG_FREE_SPACE_RESERVE + needed;
+
+    if (full) {
+        if (!_warnedFull) {
+            MessageOutput.printf("[EnergyLog] raw log or file system full, "
+                    "records are dropped until the next compaction\r\n");
+            _warnedFull = true;
+        }
+
+        // the dropped values must be logged once there is space again
+        for (auto const& record : records) {
+            _lastLogged.erase(getKey(record.source, record.index));
+        }
+
+        file.close();
+        return;
+    }
+
+    file.write(reinterpret_cast<uint8_t const*>(records.data()), needed);
+    file.close();
+}
+
+// makes the temporary file the given log. littlefs replaces the destination
+// atomically, readers use the generation to detect the rewrite.
+bool EnergyLogClass::replace(char const* filename)
+{
+    if (!LittleFS.rename(s_tempFilename, filename)) {
+        MessageOutput.printf("[EnergyLog] cannot replace %s\r\n", filename);
+        LittleFS.remove(s_tempFilename);
+        return false;
+    }
+
+    ++_generation;
+    return true;
+}
+
+// the energy between two consecutive records of a source is attributed to the
+// day of the later one. counters decreasing (e.g., a replaced inverter) do not
+// contribute. the last record of every source before today is kept as the
+// baseline for the next record. the daily and monthly logs are updated before
+// the raw log is replaced. both skip days they already contain, such that a
+// compaction interrupted by a power loss can simply be repeated.
+void EnergyLogClass::compact(uint32_t today)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    File raw = LittleFS.open(getFilename(Resolution::Raw), "r", false);
+    if (!raw) { return; }
+
+    std::map<uint16_t, Record> baselines;
+    std::map<uint16_t, uint32_t> previous;
+    std::map<std::pair<uint32_t, uint16_t>, uint32_t> days;
+    bool compactable = false;
+
+    Record record;
+    while (raw.read(reinterpret_cast<uint8_t*>(&record), sizeof(record)) == sizeof(record)) {
+        auto key = getKey(record.source, record.index);
+
+        auto iter = previous.find(key);
+        if (iter != previous.end() && record.value > iter->second && record.timestamp < today) {
+            days[{ getDayStart(record.timestamp), key }] += record.value - iter->second;
+        }
+        previous[key] = record.value;
+
+        if (record.timestamp < today) {
+            baselines[key] = record;
+            compactable = true;
+        }
+    }
+
+    if (!compactable) {
+        raw.close();
+        return;
+    }
+
+    if (!days.empty()) {
+        appendDays(days);
+        mergeMonths(days);
+    }
+
+    File temp = LittleFS.open(s_tempFilename, "w", true);
+    if (!temp) {
+        raw.close();
+        return;
+    }
+
+    for (auto const& [key, baseline] : baselines) {
+        temp.write(reinterpret_cast<uint8_t const*>(&baseline), sizeof(baseline));
+    }
+
+    raw.seek(0);
+    while (raw.read(reinterpret_cast<uint8_t*>(&record), sizeof(record)) == sizeof(record)) {
+        if (record.timestamp < today) { continue; }
+        temp.write(reinterpret_cast<uint8_t const*>(&record), sizeof(record));
+    }
+
+    raw.close();
+    temp.close();
+
+    if (replace(getFilename(Resolution::Raw))) {
+        _warnedFull = false;
+        MessageOutput.printf("[EnergyLog] compacted %u daily records\r\n", days.size());
+    }
+}
+
+// days are compacted in chronological order, hence a day is already part of
+// the daily log if it is not newer than the latest day logged for the source.
+void EnergyLogClass::appendDays(std::map<std::pair<uint32_t, uint16_t>, uint32_t> const& days)
+{
+    std::map<uint16_t, uint32_t> latest;
+
+    File daily = LittleFS.open(getFilename(Resolution::Day), "r", false);
+    if (daily) {
+        Record record;
+        while (daily.read(reinterpret_cast<uint8_t*>(&record), sizeof(record)) == sizeof(record)) {
+            auto& day = latest[getKey(record.source, record.index)];
+            day = std::max(day, record.timestamp);
+        }
+        daily.close();
+    }
+
+    daily = LittleFS.open(getFilename(Resolution::Day), "a", true);
+    if (!daily) { return; }
+
+    for (auto const& [dayKey, energy] : days) {
+        auto iter = latest.find(dayKey.second);
+        if (iter != latest.end() && dayKey.first <= iter->second) { continue; }
+
+        Record aggregate = { dayKey.first, static_cast<Source>(dayKey.second >> 8),
+            static_cast<uint8_t>(dayKey.second & 0xFF), 0, energy };
+        daily.write(reinterpret_cast<uint8_t const*>(&aggregate), sizeof(aggregate));
+    }
+
+    daily.close();
+}
+
+void EnergyLogClass::mergeMonths(std::map<std::pair<uint32_t, uint16_t>, uint32_t> const& days)
+{
+    // a few records per source and month, small enough to be rewritten
+    std::vector<Record> months;
+
+    File monthly = LittleFS.open(getFilename(Resolution::Month), "r", false);
+    if (monthly) {
+        Record record;
+        while (monthly.read(reinterpret_cast<uint8_t*>(&record), sizeof(record)) == sizeof(record)) {
+            months.push_back(record);
+        }
+        monthly.close();
+    }
+
+    bool changed = false;
+
+    for (auto const& [dayKey, energy] : days) {
+        uint32_t month = getMonthStart(dayKey.first);
+        uint8_t dayOfMonth = getDayOfMonth(dayKey.first);
+        auto source = static_cast<Source>(dayKey.second >> 8);
+        uint8_t index = dayKey.second & 0xFF;
+
+        auto iter = std::find_if(months.begin(), months.end(), [&](Record const& r) {
+            return r.timestamp == month && r.source == source && r.index == index;
+        });
+
+        if (iter == months.end()) {
+            months.push_back({ month, source, index, dayOfMonth, energy });
+            changed = true;
+            continue;
+        }
+
+        // the day was merged before the compaction was interrupted
+        if (dayOfMonth <= iter->lastDay) { continue; }
+
+        iter->value += energy;
+        iter->lastDay = dayOfMonth;
+        changed = true;
+    }
+
+    if (!changed) { return; }
+
+    std::stable_sort(months.begin(), months.end(), [](Record const& a, Record const& b) {
+        return a.timestamp < b.timestamp;
+    });
+
+    File temp = LittleFS.open(s_tempFilename, "w", true);
+    if (!temp) { return; }
+    temp.write(reinterpret_cast<uint8_t const*>(months.data()), months.size() * sizeof(Record));
+    temp.close();
+
+    replace(getFilename(Resolution::Month));
+}
+
+void EnergyLogClass::applyRetention(uint32_t today)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    File daily = LittleFS.open(getFilename(Resolution::Day), "r", false);
+    if (!daily) { return; }
+
+    uint32_t cutoff = today - ENERGYLOG_DAILY_RETENTION * 24 * 3600;
+
+    Record record;
+    if (daily.read(reinterpret_cast<uint8_t*>(&record), sizeof(record)) != sizeof(record)
+            || record.timestamp >= cutoff) {
+        daily.close();
+        return;
+    }
+
+    File temp = LittleFS.open(s_tempFilename, "w", true);
+    if (!temp) {
+        daily.close();
+        return;
+    }
+
+    daily.seek(0);
+    while (daily.read(reinterpret_cast<uint8_t*>(&record), sizeof(record)) == sizeof(record)) {
+        if (record.timestamp < cutoff) { continue; }
+        temp.write(reinterpret_cast<uint8_t const*>(&record), sizeof(record));
+    }
+
+    daily.close();
+    temp.close();
+
+    replace(getFilename(Resolution::Day));
+}
+
+EnergyLogClass::Cursor EnergyLogClass::getCursor(EnergyLogClass::Resolution resolution,
+        uint32_t from, uint32_t to) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return { resolution, from, to, 0, _generation };
+}
+
+size_t EnergyLogClass::read(EnergyLogClass::Cursor& cursor, EnergyLogClass::Record* records, size_t count) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (cursor.generation != _generation) { return 0; }
+
+    File file = LittleFS.open(getFilename(cursor.resolution), "r", false);
+    if (!file) { return 0; }
+
+    if (!file.seek(cursor.offset)) {
+        file.close();
+        return 0;
+    }
+
+    size_t filled = 0;
+    Record record;
+    while (filled < count && file.read(reinterpret_cast<uint8_t*>(&record), sizeof(record)) == sizeof(record)) {
+        cursor.offset += sizeof(record);
+        if (record.timestamp < cursor.from || record.timestamp >= cursor.to) { continue; }
+        records[filled++] = record;
+    }
+
+    file.close();
+    return filled;
+}
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "HassDiscoveryJob.h"
+#include "Configuration.h"
+#include "MqttSettings.h"
+#include <Print.h>
+#include <algorithm>
+
+namespace {
+
+// FNV-1a of everything printed, to compare configs without storing them
+class HashPrint : public Print {
+public:
+    size_t write(uint8_t c) override
+    {
+        _hash ^= c;
+        _hash *= 16777619U;
+        return 1;
+    }
+
+    uint32_t get() const { return _hash; }
+
+private:
+    uint32_t _hash = 2166136261U;
+};
+
+} // namespace
+
+void HassDiscoveryJob::restart(bool forget)
+{
+    if (forget) { _published.clear(); }
+
+    _pending = true;
+    _claimed.clear();
+}
+
+void HassDiscoveryJob::beginSlice()
+{
+    _index = 0;
+    _sliceClaims = 0;
+    _budgetExceeded = false;
+}
+
+void HassDiscoveryJob::endSlice()
+{
+    // entities were skipped as the budget of this slice was used up
+    if (_budgetExceeded) { return; }
+
+    _pending = false;
+    std::vector<uint32_t>().swap(_claimed);
+}
+
+bool HassDiscoveryJob::claim(uint32_t key)
+{
+    auto iter = std::lower_bound(_claimed.begin(), _claimed.end(), key);
+    if (iter != _claimed.end() && *iter == key) { return false; }
+
+    if (_sliceClaims >= SliceSize) {
+        _budgetExceeded = true;
+        return false;
+    }
+
+    _claimed.insert(iter, key);
+    ++_sliceClaims;
+    return true;
+}
+
+bool HassDiscoveryJob::claim()
+{
+    return claim(static_cast<uint32_t>(_index++));
+}
+
+bool HassDiscoveryJob::claim(char const* device, char const* entity)
+{
+    HashPrint key;
+    key.print(device);
+    key.write('/');
+    key.print(entity);
+    return claim(key.get());
+}
+
+// remembers the hash of the payload. returns false if the same payload was
+// published to the topic as a retained message before.
+bool HassDiscoveryJob::isDue(String const& subtopic, uint32_t payloadHash)
+{
+    HashPrint topicHash;
+    topicHash.print(subtopic);
+    auto key = topicHash.get();
+
+    auto iter = std::lower_bound(_published.begin(), _published.end(), key,
+            [](std::pair<uint32_t, uint32_t> const& entry, uint32_t key) {
+                return entry.first < key;
+            });
+
+    if (iter == _published.end() || iter->first != key) {
+        _published.insert(iter, { key, payloadHash });
+        return true;
+    }
+
+    bool changed = iter->second != payloadHash;
+    iter->second = payloadHash;
+
+    // configs that are not retained by the broker must be published again
+    return changed || !Configuration.get().Mqtt.Hass.Retain;
+}
+
+void HassDiscoveryJob::send(String const& subtopic, String const& payload)
+{
+    auto const& config = Configuration.get();
+
+    String topic = config.Mqtt.Hass.Topic;
+    topic += subtopic;
+    MqttSettings.publishGeneric(topic, payload, config.Mqtt.Hass.Retain);
+}
+
+void HassDiscoveryJob::publish(String const& subtopic, JsonDocument const& config)
+{
+    HashPrint payloadHash;
+    serializeJson(config, payloadHash);
+    if (!isDue(subtopic, payloadHash.get())) { return; }
+
+    String payload;
+    serializeJson(config, payload);
+    send(subtopic, payload);
+}
+
+void HassDiscoveryJob::clear(String const& subtopic)
+{
+    if (!isDue(subtopic, HashPrint().get())) { return; }
+
+    send(subtopic, "");
+}
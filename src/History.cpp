@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "History.h"
+#include "Battery.h"
+#include "Configuration.h"
+#include "Datastore.h"
+#include "PowerLimiter.h"
+#include "PowerMeter.h"
+#include <Esp.h>
+#include <cstring>
+#include <frozen/map.h>
+
+HistoryClass History;
+
+static std::vector<TimeSeries::TierConfig> const& psramTiers()
+{
+    static const std::vector<TimeSeries::TierConfig> tiers = {
+        { 10, HISTORY_TIER_10S_SIZE },
+        { 60, HISTORY_TIER_1MIN_SIZE },
+        { 15 * 60, HISTORY_TIER_15MIN_SIZE }
+    };
+    return tiers;
+}
+
+static std::vector<TimeSeries::TierConfig> const& internalTiers()
+{
+    static const std::vector<TimeSeries::TierConfig> tiers = {
+        { 60, 30 },
+        { 5 * 60, HISTORY_INTERNAL_5MIN_SIZE }
+    };
+    return tiers;
+}
+
+// the resolution of the stored values limits their range to +/- 32767 times
+// the resolution, e.g., 3276.7 A for the battery current. the tiers are set
+// in init(), once PSRAM was detected.
+HistoryClass::HistoryClass()
+    : _loopTask(1 * TASK_SECOND, TASK_FOREVER, std::bind(&HistoryClass::loop, this))
+    , _series{{
+        TimeSeries(1, {}), // AcPower, W
+        TimeSeries(1, {}), // DcPower, W
+        TimeSeries(0.1, {}), // BatterySoC, %
+        TimeSeries(0.1, {}), // BatteryVoltage, V
+        TimeSeries(0.1, {}), // BatteryCurrent, A
+        TimeSeries(1, {}), // MeterPower, W
+        TimeSeries(1, {}) // PowerLimit, W
+    }}
+{
+}
+
+void HistoryClass::init(Scheduler& scheduler)
+{
+    // the buffers are large enough to be placed in PSRAM, see main.cpp.
+    // series without tiers still accept samples but store nothing.
+    bool psram = ESP.getPsramSize() > 0;
+    for (size_t i = 0; i < SeriesCount; ++i) {
+        if (psram) {
+            _series[i].setTiers(psramTiers());
+        } else if (static_cast<Series>(i) == Series::AcPower) {
+            _series[i].setTiers(internalTiers());
+        }
+    }
+
+    scheduler.addTask(_loopTask);
+    _loopTask.enable();
+}
+
+uint32_t HistoryClass::now()
+{
+    // unlike millis(), this does not wrap after 49 days
+    return esp_timer_get_time() / 1000000;
+}
+
+TimeSeries const& HistoryClass::get(HistoryClass::Series series) const
+{
+    return _series[static_cast<size_t>(series)];
+}
+
+frozen::string const& HistoryClass::getName(HistoryClass::Series series)
+{
+    static const frozen::string missing = "unknown";
+
+    static const frozen::map<Series, frozen::string, SeriesCount> names = {
+        { Series::AcPower, "ac_power" },
+        { Series::DcPower, "dc_power" },
+        { Series::BatterySoC, "battery_soc" },
+        { Series::BatteryVoltage, "battery_voltage" },
+        { Series::BatteryCurrent, "battery_current" },
+        { Series::MeterPower, "meter_power" },
+        { Series::PowerLimit, "power_limit" }
+    };
+
+    auto iter = names.find(series);
+    if (iter == names.end()) { return missing; }
+
+    return iter->second;
+}
+
+std::optional<HistoryClass::Series> HistoryClass::fromName(char const* name)
+{
+    for (size_t i = 0; i < SeriesCount; ++i) {
+        auto series = static_cast<Series>(i);
+        if (strcmp(getName(series).data(), name) == 0) { return series; }
+    }
+
+    return std::nullopt;
+}
+
+void HistoryClass::loop()
+{
+    auto const& config = Configuration.get();
+    uint32_t timestamp = now();
+
+    auto add = [this,timestamp](Series series, float value) {
+        _series[static_cast<size_t>(series)].add(value, timestamp);
+    };
+
+    add(Series::AcPower, Datastore.getTotalAcPowerEnabled());
+    add(Series::DcPower, Datastore.getTotalDcPowerEnabled());
+
+    if (config.Battery.Enabled) {
+        auto spStats = Battery.getStats();
+        if (spStats->isSoCValid()) { add(Series::BatterySoC, spStats->getSoC()); }
+        if (spStats->isVoltageValid()) { add(Series::BatteryVoltage, spStats->getVoltage()); }
+        if (spStats->isCurrentValid()) { add(Series::BatteryCurrent, spStats->getChargeCurrent()); }
+    }
+
+    if (PowerMeter.isDataValid()) {
+        add(Series::MeterPower, PowerMeter.getPowerTotal());
+    }
+
+    if (config.PowerLimiter.Enabled) {
+        add(Series::PowerLimit, PowerLimiter.getLastRequestedPowerLimit());
+    }
+
+    // periods without data are stored as gaps
+    for (auto& series : _series) { series.update(timestamp); }
+}
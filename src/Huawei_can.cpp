@@ -5,8 +5,7 @@
 #include "Battery.h"
 #include "Huawei_can.h"
 #include "MessageOutput.h"
-#include "PowerMeter.h"
-#include "PowerLimiter.h"
+#include "EnergyFlow.h"
 #include "Configuration.h"
 #include "Battery.h"
 #include <SPI.h>
@@ -351,59 +350,37 @@ void HuaweiCanClass::loop()
     }
 
 
-    // Check if inverter used by the power limiter is active
-    std::shared_ptr<InverterAbstract> inverter =
-        Hoymiles.getInverterBySerial(config.PowerLimiter.InverterId);
+    // The energy flow decision is shared with the power limiter. It only
+    // assigns charge power while the inverters are not producing and takes
+    // the battery SoC limit into account.
+    auto const& decision = EnergyFlow.getDecision();
+    bool charge = (decision.direction == EnergyFlowClass::Direction::Charge);
 
-    if (inverter == nullptr && config.PowerLimiter.InverterId < INV_MAX_COUNT) {
-        // we previously had an index saved as InverterId. fall back to the
-        // respective positional lookup if InverterId is not a known serial.
-        inverter = Hoymiles.getInverterByPos(config.PowerLimiter.InverterId);
-    }
-
-    if (inverter != nullptr) {
-        if(inverter->isProducing()) {
-          _setValue(0.0, HUAWEI_ONLINE_CURRENT);
-          // Don't run auto mode for a second now. Otherwise we may send too much over the CAN bus
-          _autoModeBlockedTillMillis = millis() + 1000;
-          MessageOutput.printf("[HuaweiCanClass::loop] Inverter is active, disable\r\n");
-          return;
-        }
+    if (!charge && _rp.output_current > HUAWEI_AUTO_MODE_SHUTDOWN_CURRENT) {
+      _autoPowerEnabled = false;
+      _setValue(0.0, HUAWEI_ONLINE_CURRENT);
+      // Don't run auto mode for a second now. Otherwise we may send too much over the CAN bus
+      _autoModeBlockedTillMillis = millis() + 1000;
+      MessageOutput.printf("[HuaweiCanClass::loop] Charging not permitted (%s), disable\r\n",
+          EnergyFlow.getReasonText(decision.reason).data());
+      return;
     }
 
-    if (PowerMeter.getLastUpdate() > _lastPowerMeterUpdateReceivedMillis &&
+    if (decision.meterMillis > _lastPowerMeterUpdateReceivedMillis &&
         _autoPowerEnabledCounter > 0) {
         // We have received a new PowerMeter value. Also we're _autoPowerEnabled
         // So we're good to calculate a new limit
 
-      _lastPowerMeterUpdateReceivedMillis = PowerMeter.getLastUpdate();
+      _lastPowerMeterUpdateReceivedMillis = decision.meterMillis;
 
-      // Calculate new power limit
-      float newPowerLimit = -1 * round(PowerMeter.getPowerTotal());
+      float newPowerLimit = decision.chargePower;
       float efficiency =  (_rp.efficiency > 0.5 ? _rp.efficiency : 1.0);
 
-      // Powerlimit is the requested output power + permissable Grid consumption factoring in the efficiency factor
-      newPowerLimit += _rp.output_power + config.Huawei.Auto_Power_Target_Power_Consumption / efficiency;
-
       if (verboseLogging){
         MessageOutput.printf("[HuaweiCanClass::loop] newPowerLimit: %f, output_power: %f \r\n", newPowerLimit, _rp.output_power);
       }
 
-      // Check whether the battery SoC limit setting is enabled
-      if (config.Battery.Enabled && config.Huawei.Auto_Power_BatterySoC_Limits_Enabled) {
-        uint8_t _batterySoC = Battery.getStats()->getSoC();
-        // Sets power limit to 0 if the BMS reported SoC reaches or exceeds the user configured value
-        if (_batterySoC >= config.Huawei.Auto_Power_Stop_BatterySoC_Threshold) {
-          newPowerLimit = 0;
-          if (verboseLogging) {
-            MessageOutput.printf("[HuaweiCanClass::loop] Current battery SoC %i reached "
-                    "stop threshold %i, set newPowerLimit to %f \r\n", _batterySoC,
-                    config.Huawei.Auto_Power_Stop_BatterySoC_Threshold, newPowerLimit);
-          }
-        }
-      }
-
-      if (newPowerLimit > config.Huawei.Auto_Power_Lower_Power_Limit) {
+      if (charge) {
 
         // Check if the output power has dropped below the lower limit (i.e. the battery is full)
         // and if the PSU should be turned off. Also we use a simple counter mechanism here to be able
@@ -442,7 +419,7 @@ void HuaweiCanClass::loop()
         // Don't run auto mode some time to allow for output stabilization after issuing a new value
         _autoModeBlockedTillMillis = millis() + 2 * HUAWEI_DATA_REQUEST_INTERVAL_MS;
       } else {
-        // requested PL is below minium. Set current to 0
+        // no charge power assigned. Set current to 0
         _autoPowerEnabled = false;
         _setValue(0.0, HUAWEI_ONLINE_CURRENT);
       }
@@ -67,6 +67,7 @@ void InverterSettingsClass::init(Scheduler& scheduler)
 
         MessageOutput.println("  Setting poll interval... ");
         Hoymiles.setPollInterval(config.Dtu.PollInterval);
+        Hoymiles.setParallelPolling(config.Dtu.ParallelPolling);
 
         MessageOutput.println("  Setting verbosity... ");
         Hoymiles.setVerboseLogging(config.Dtu.VerboseLogging);
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "JsonStreamWriter.h"
+
+void JsonStreamWriter::separate(char const* key)
+{
+    if (_depth == 0) { return; }
+
+    uint32_t bit = 1UL << (_depth - 1);
+    if (_hasMembers & bit) { _out->print(','); }
+    _hasMembers |= bit;
+
+    if ((_inObject & bit) && key != nullptr) {
+        _out->print('"');
+        _out->print(key);
+        _out->print("\":");
+    }
+}
+
+void JsonStreamWriter::beginObject(char const* key)
+{
+    separate(key);
+    _out->print('{');
+
+    uint32_t bit = 1UL << _depth++;
+    _inObject |= bit;
+    _hasMembers &= ~bit;
+}
+
+void JsonStreamWriter::endObject()
+{
+    if (_depth > 0) { --_depth; }
+    _out->print('}');
+}
+
+void JsonStreamWriter::beginArray(char const* key)
+{
+    separate(key);
+    _out->print('[');
+
+    uint32_t bit = 1UL << _depth++;
+    _inObject &= ~bit;
+    _hasMembers &= ~bit;
+}
+
+void JsonStreamWriter::endArray()
+{
+    if (_depth > 0) { --_depth; }
+    _out->print(']');
+}
+
+void JsonStreamWriter::add(char const* key, JsonVariantConst value)
+{
+    separate(key);
+    serializeJson(value, *_out);
+}
+
+void JsonStreamWriter::merge(JsonObjectConst object)
+{
+    for (JsonPairConst member : object) {
+        add(member.key().c_str(), member.value());
+    }
+}
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+void LatencyHistogram::record(uint32_t value)
+{
+    size_t bucket = 0;
+    while (bucket < BucketCount - 1 && value > getUpperBound(bucket)) { ++bucket; }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_buckets[bucket];
+    _min = (_count == 0) ? value : std::min(_min, value);
+    _max = std::max(_max, value);
+    _sum += value;
+    ++_count;
+}
+
+void LatencyHistogram::reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _buckets.fill(0);
+    _count = 0;
+    _sum = 0;
+    _min = 0;
+    _max = 0;
+}
+
+uint32_t LatencyHistogram::getCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _count;
+}
+
+uint32_t LatencyHistogram::getMax() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _max;
+}
+
+uint32_t LatencyHistogram::getMean() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_count == 0) { return 0; }
+    return _sum / _count;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::getSnapshot() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return { _buckets, _count, _sum };
+}
+
+uint32_t LatencyHistogram::getPercentile(float percentile) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return getPercentileUnlocked(percentile);
+}
+
+uint32_t LatencyHistogram::getPercentileUnlocked(float percentile) const
+{
+    if (_count == 0) { return 0; }
+
+    auto rank = static_cast<uint32_t>(std::ceil(percentile / 100 * _count));
+    uint32_t cumulated = 0;
+    for (size_t bucket = 0; bucket < BucketCount - 1; ++bucket) {
+        cumulated += _buckets[bucket];
+        // the actual maximum is more precise than the bucket's upper bound
+        if (cumulated >= rank) { return std::min<uint32_t>(getUpperBound(bucket), _max); }
+    }
+
+    return _max;
+}
+
+void LatencyHistogram::toJson(JsonObject obj, bool withBuckets) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    obj["count"] = _count;
+    obj["min"] = _min;
+    obj["max"] = _max;
+    obj["mean"] = (_count > 0) ? static_cast<uint32_t>(_sum / _count) : 0;
+    obj["p50"] = getPercentileUnlocked(50);
+    obj["p90"] = getPercentileUnlocked(90);
+    obj["p99"] = getPercentileUnlocked(99);
+
+    if (!withBuckets) { return; }
+
+    auto buckets = obj["buckets"].to<JsonArray>();
+    for (size_t bucket = 0; bucket < BucketCount; ++bucket) {
+        auto entry = buckets.add<JsonObject>();
+        // the last bucket has no upper bound
+        if (bucket < BucketCount - 1) { entry["le"] = getUpperBound(bucket); }
+        entry["count"] = _buckets[bucket];
+    }
+}
@@ -3,10 +3,26 @@
  * Copyright (C) 2022-2024 Thomas Basler and others
  */
 #include <HardwareSerial.h>
+#include <esp_rom_uart.h>
+#include <esp_system.h>
+#include <algorithm>
+#include <cstring>
 #include "MessageOutput.h"
 
 MessageOutputClass MessageOutput;
 
+// the linker redirects calls to esp_panic_handler() here, see the build flag
+// "-Wl,--wrap=esp_panic_handler". the buffered output most probably explains
+// the panic, so it is written before the panic handler prints its report and
+// resets the chip. this also covers resets by the interrupt watchdog and the
+// task watchdog (if configured to panic).
+extern "C" void __real_esp_panic_handler(void* info);
+extern "C" void __wrap_esp_panic_handler(void* info)
+{
+    MessageOutput.flushOnPanic();
+    __real_esp_panic_handler(info);
+}
+
 MessageOutputClass::MessageOutputClass()
     : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&MessageOutputClass::loop, this))
 {
@@ -16,6 +32,45 @@ void MessageOutputClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
     _loopTask.enable();
+
+    esp_register_shutdown_handler(&MessageOutputClass::onShutdown);
+}
+
+// invoked by esp_restart(), i.e., before a software reset
+void MessageOutputClass::onShutdown()
+{
+    // the restart might have been triggered while holding the lock. we do
+    // not wait for it, the output is flushed either way.
+    std::unique_lock<std::mutex> lock(MessageOutput._msgLock, std::try_to_lock);
+
+    for (auto& line : MessageOutput._taskLines) {
+        if (line.task == nullptr || line.length == 0) { continue; }
+        MessageOutput.appendLine(line, true);
+    }
+
+    MessageOutput.drainSerial(true);
+    Serial.flush();
+}
+
+void MessageOutputClass::flushOnPanic()
+{
+    auto put = [](uint8_t c) {
+        if (c == '\n') { esp_rom_uart_tx_one_char('\r'); }
+        if (c != '\r') { esp_rom_uart_tx_one_char(c); }
+    };
+
+    for (size_t pos = _serialTail; pos != _ringHead; ++pos) {
+        put(_ring[pos % _ring.size()]);
+    }
+
+    // incomplete lines, e.g., of the task which caused the panic
+    for (auto const& line : _taskLines) {
+        if (line.task == nullptr || line.length == 0) { continue; }
+        for (size_t idx = 0; idx < line.length; ++idx) { put(line.buffer[idx]); }
+        put('\n');
+    }
+
+    _serialTail = _ringHead;
 }
 
 void MessageOutputClass::register_ws_output(AsyncWebSocket* output)
@@ -25,90 +80,175 @@ void MessageOutputClass::register_ws_output(AsyncWebSocket* output)
     _ws = output;
 }
 
-void MessageOutputClass::serialWrite(MessageOutputClass::message_t const& m)
+MessageOutputClass::TaskLine* MessageOutputClass::getTaskLine()
 {
-    // operator bool() of HWCDC returns false if the device is not attached to
-    // a USB host. in general it makes sense to skip writing entirely if the
-    // default serial port is not ready.
-    if (!Serial) { return; }
+    auto task = xTaskGetCurrentTaskHandle();
+    TaskLine* unused = nullptr;
 
-    size_t written = 0;
-    while (written < m.size()) {
-        written += Serial.write(m.data() + written, m.size() - written);
+    for (auto& line : _taskLines) {
+        if (line.task == task) { return &line; }
+        if (line.task == nullptr && unused == nullptr) { unused = &line; }
     }
+
+    if (unused != nullptr) { unused->task = task; }
+
+    return unused;
 }
 
-size_t MessageOutputClass::write(uint8_t c)
+bool MessageOutputClass::wsActive() const
 {
-    std::lock_guard<std::mutex> lock(_msgLock);
+    return _ws != nullptr && _ws->count() > 0;
+}
 
-    auto res = _task_messages.emplace(xTaskGetCurrentTaskHandle(), message_t());
-    auto iter = res.first;
-    auto& message = iter->second;
+size_t MessageOutputClass::ringFree() const
+{
+    // positions are monotonic, unsigned differences survive wrapping
+    size_t used = std::max(_ringHead - _serialTail, _ringHead - _wsTail);
+    return _ring.size() - used;
+}
 
-    message.push_back(c);
+void MessageOutputClass::appendLine(MessageOutputClass::TaskLine& line, bool complete)
+{
+    if (!wsActive()) { _wsTail = _ringHead; }
 
-    if (c == '\n') {
-        serialWrite(message);
-        _lines.emplace(std::move(message));
-        _task_messages.erase(iter);
+    if (!line.dropping && ringFree() < line.length) {
+        // the serial console must not lose lines. rather wait until it
+        // caught up, just like writing to it directly would.
+        drainSerial(true);
     }
 
-    return 1;
+    if (!line.dropping && ringFree() < line.length) {
+        dropWebsocketLines(line.length);
+    }
+
+    if (!line.dropping && ringFree() >= line.length) {
+        size_t offset = _ringHead % _ring.size();
+        size_t first = std::min(line.length, _ring.size() - offset);
+        memcpy(&_ring[offset], line.buffer.data(), first);
+        memcpy(&_ring[0], line.buffer.data() + first, line.length - first);
+        _ringHead += line.length;
+    } else if (!line.dropping) {
+        // drop the remainder of this line as well, but count it only once
+        ++_droppedLines;
+        line.dropping = true;
+    }
+
+    line.length = 0;
+
+    if (complete) { line.dropping = false; }
+}
+
+size_t MessageOutputClass::write(uint8_t c)
+{
+    return write(&c, 1);
 }
 
 size_t MessageOutputClass::write(const uint8_t *buffer, size_t size)
 {
     std::lock_guard<std::mutex> lock(_msgLock);
 
-    auto res = _task_messages.emplace(xTaskGetCurrentTaskHandle(), message_t());
-    auto iter = res.first;
-    auto& message = iter->second;
-
-    message.reserve(message.size() + size);
+    auto line = getTaskLine();
 
     for (size_t idx = 0; idx < size; ++idx) {
         uint8_t c = buffer[idx];
 
-        message.push_back(c);
-
-        if (c == '\n') {
-            serialWrite(message);
-            _lines.emplace(std::move(message));
-            message.clear();
-            message.reserve(size - idx - 1);
+        if (line == nullptr) {
+            if (c == '\n') { ++_droppedLines; }
+            continue;
         }
+
+        if (line->length == line->buffer.size()) { appendLine(*line, false); }
+
+        line->buffer[line->length++] = c;
+
+        if (c == '\n') { appendLine(*line, true); }
+    }
+
+    if (line != nullptr && line->length == 0 && !line->dropping) {
+        line->task = nullptr;
     }
 
-    if (message.empty()) { _task_messages.erase(iter); }
+    drainSerial(false);
 
     return size;
 }
 
-void MessageOutputClass::loop()
+void MessageOutputClass::drainSerial(bool blocking)
 {
-    std::lock_guard<std::mutex> lock(_msgLock);
+    // operator bool() of HWCDC returns false if the device is not attached to
+    // a USB host. in general it makes sense to skip writing entirely if the
+    // default serial port is not ready.
+    if (!Serial) {
+        _serialTail = _ringHead;
+        return;
+    }
 
-    // clean up (possibly filled) buffers of deleted tasks
-    auto map_iter = _task_messages.begin();
-    while (map_iter != _task_messages.end()) {
-        if (eTaskGetState(map_iter->first) == eDeleted) {
-            map_iter = _task_messages.erase(map_iter);
-            continue;
+    // unless asked to block, only write what the serial driver accepts
+    // without waiting for the transmission
+    while (_serialTail != _ringHead) {
+        size_t offset = _serialTail % _ring.size();
+        size_t chunk = std::min(_ringHead - _serialTail, _ring.size() - offset);
+
+        if (!blocking) {
+            int space = Serial.availableForWrite();
+            if (space <= 0) { return; }
+            chunk = std::min(chunk, static_cast<size_t>(space));
         }
 
-        ++map_iter;
+        size_t written = Serial.write(&_ring[offset], chunk);
+        if (written == 0) { return; }
+
+        _serialTail += written;
     }
+}
 
-    if (!_ws) {
-        while (!_lines.empty()) {
-            _lines.pop(); // do not hog memory
-        }
+// the websocket clients fell behind and their backlog occupies the space
+// required for a new line. skips their oldest lines until it fits.
+void MessageOutputClass::dropWebsocketLines(size_t required)
+{
+    while (_wsTail != _ringHead && ringFree() < required) {
+        while (_wsTail != _ringHead && _ring[_wsTail++ % _ring.size()] != '\n') { }
+        ++_droppedWebsocketLines;
+    }
+}
+
+void MessageOutputClass::drainWebsocket()
+{
+    if (!wsActive()) {
+        _wsTail = _ringHead; // do not hog buffer space
         return;
     }
 
-    while (!_lines.empty() && _ws->availableForWriteAll()) {
-        _ws->textAll(std::make_shared<message_t>(std::move(_lines.front())));
-        _lines.pop();
+    if (_wsTail == _ringHead || !_ws->availableForWriteAll()) { return; }
+
+    // the ring only holds complete lines (or pieces of overly long lines),
+    // so all pending lines are sent as a single message.
+    size_t length = _ringHead - _wsTail;
+    size_t offset = _wsTail % _ring.size();
+    size_t first = std::min(length, _ring.size() - offset);
+
+    auto message = std::make_shared<std::vector<uint8_t>>(length);
+    memcpy(message->data(), &_ring[offset], first);
+    memcpy(message->data() + first, &_ring[0], length - first);
+
+    _ws->textAll(message);
+    _wsTail = _ringHead;
+}
+
+void MessageOutputClass::loop()
+{
+    std::lock_guard<std::mutex> lock(_msgLock);
+
+    // clean up (possibly filled) buffers of deleted tasks
+    for (auto& line : _taskLines) {
+        if (line.task == nullptr) { continue; }
+        if (eTaskGetState(line.task) != eDeleted) { continue; }
+
+        line.task = nullptr;
+        line.length = 0;
+        line.dropping = false;
     }
+
+    drainSerial(false);
+    drainWebsocket();
 }
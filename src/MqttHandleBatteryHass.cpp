@@ -4,6 +4,7 @@
 #include "Battery.h"
 #include "MqttHandleBatteryHass.h"
 #include "Configuration.h"
+#include "MqttPublisher.h"
 #include "MqttSettings.h"
 #include "MqttHandleHass.h"
 #include "Utils.h"
@@ -35,8 +36,24 @@ void MqttHandleBatteryHassClass::loop()
     }
 
     // only publish HA config once when (re-)connecting
-    // to the MQTT broker or on config changes.
-    if (!_doPublish) { return; }
+    // to the MQTT broker or on config changes. the broker might not have
+    // retained the configs published before, e.g., if it was restarted.
+    if (_doPublish || _updateForced) {
+        _discovery.restart(true);
+        _doPublish = false;
+        _updateForced = false;
+    }
+
+    if (!_discovery.isPending()) { return; }
+
+    _discovery.beginSlice();
+    publishConfig();
+    _discovery.endSlice();
+}
+
+void MqttHandleBatteryHassClass::publishConfig()
+{
+    auto const& config = Configuration.get();
 
     // the MQTT battery provider does not re-publish the SoC under a different
     // known topic. we don't know the manufacture either. HASS auto-discovery
@@ -182,12 +199,14 @@ void MqttHandleBatteryHassClass::loop()
             publishBinarySensor("Warning Cell Imbalance", "mdi:alert-outline", "warning/cellImbalance", "1", "0");
             break;
     }
-
-    _doPublish = false;
 }
 
 void MqttHandleBatteryHassClass::publishSensor(const char* caption, const char* icon, const char* subTopic, const char* deviceClass, const char* stateClass, const char* unitOfMeasurement )
 {
+    if (!_discovery.claim()) {
+        return;
+    }
+
     String sensorId = caption;
     sensorId.replace(" ", "_");
     sensorId.replace(".", "");
@@ -199,15 +218,10 @@ void MqttHandleBatteryHassClass::publishSensor(const char* caption, const char*
         + "/" + sensorId
         + "/config";
 
-    String statTopic = MqttSettings.getPrefix() + "battery/";
-    // omit serial to avoid a breaking change
-    // statTopic.concat(serial);
-    // statTopic.concat("/");
-    statTopic.concat(subTopic);
-
     JsonDocument root;
     root["name"] = caption;
-    root["stat_t"] = statTopic;
+    // omit serial to avoid a breaking change
+    MqttPublisherClass::setHassStateTopic(root, "battery/", subTopic);
     root["uniq_id"] = serial + "_" + sensorId;
 
     if (icon != NULL) {
@@ -235,14 +249,15 @@ void MqttHandleBatteryHassClass::publishSensor(const char* caption, const char*
         return;
     }
 
-    char buffer[512];
-    serializeJson(root, buffer);
-    publish(configTopic, buffer);
-
+    _discovery.publish(configTopic, root);
 }
 
 void MqttHandleBatteryHassClass::publishBinarySensor(const char* caption, const char* icon, const char* subTopic, const char* payload_on, const char* payload_off)
 {
+    if (!_discovery.claim()) {
+        return;
+    }
+
     String sensorId = caption;
     sensorId.replace(" ", "_");
     sensorId.replace(".", "");
@@ -255,17 +270,12 @@ void MqttHandleBatteryHassClass::publishBinarySensor(const char* caption, const
         + "/" + sensorId
         + "/config";
 
-    String statTopic = MqttSettings.getPrefix() + "battery/";
-    // omit serial to avoid a breaking change
-    // statTopic.concat(serial);
-    // statTopic.concat("/");
-    statTopic.concat(subTopic);
-
     JsonDocument root;
 
     root["name"] = caption;
     root["uniq_id"] = serial + "_" + sensorId;
-    root["stat_t"] = statTopic;
+    // omit serial to avoid a breaking change
+    MqttPublisherClass::setHassStateTopic(root, "battery/", subTopic);
     root["pl_on"] = payload_on;
     root["pl_off"] = payload_off;
 
@@ -280,9 +290,7 @@ void MqttHandleBatteryHassClass::publishBinarySensor(const char* caption, const
         return;
     }
 
-    char buffer[512];
-    serializeJson(root, buffer);
-    publish(configTopic, buffer);
+    _discovery.publish(configTopic, root);
 }
 
 void MqttHandleBatteryHassClass::createDeviceInfo(JsonObject& object)
@@ -301,10 +309,3 @@ void MqttHandleBatteryHassClass::createDeviceInfo(JsonObject& object)
     object["sw"] = __COMPILED_GIT_HASH__;
     object["via_device"] = MqttHandleHass.getDtuUniqueId();
 }
-
-void MqttHandleBatteryHassClass::publish(const String& subtopic, const String& payload)
-{
-    String topic = Configuration.get().Mqtt.Hass.Topic;
-    topic += subtopic;
-    MqttSettings.publishGeneric(topic.c_str(), payload.c_str(), Configuration.get().Mqtt.Hass.Retain);
-}
@@ -4,6 +4,7 @@
  */
 #include "MqttHandleHass.h"
 #include "MqttHandleInverter.h"
+#include "MqttPublisher.h"
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
 #include "Utils.h"
@@ -26,22 +27,33 @@ void MqttHandleHassClass::init(Scheduler& scheduler)
 void MqttHandleHassClass::loop()
 {
     if (_updateForced) {
-        publishConfig();
+        _discovery.restart(_forgetPublished);
         _updateForced = false;
+        _forgetPublished = false;
     }
 
     if (MqttSettings.getConnected() && !_wasConnected) {
-        // Connection established
+        // Connection established. the broker might not have retained the
+        // configs published before, e.g., if it was restarted.
         _wasConnected = true;
-        publishConfig();
+        _discovery.restart(true);
     } else if (!MqttSettings.getConnected() && _wasConnected) {
         // Connection lost
         _wasConnected = false;
     }
+
+    if (!_discovery.isPending()) {
+        return;
+    }
+
+    _discovery.beginSlice();
+    publishConfig();
+    _discovery.endSlice();
 }
 
-void MqttHandleHassClass::forceUpdate()
+void MqttHandleHassClass::forceUpdate(bool forget)
 {
+    _forgetPublished = _forgetPublished || forget;
     _updateForced = true;
 }
 
@@ -101,6 +113,10 @@ void MqttHandleHassClass::publishConfig()
 
 void MqttHandleHassClass::publishInverterField(std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const byteAssign_fieldDeviceClass_t fieldType, const bool clear)
 {
+    if (!_discovery.claim()) {
+        return;
+    }
+
     if (!inv->Statistics()->hasChannelFieldValue(type, channel, fieldType.fieldId)) {
         return;
     }
@@ -127,7 +143,6 @@ void MqttHandleHassClass::publishInverterField(std::shared_ptr<InverterAbstract>
         + "/config";
 
     if (!clear) {
-        const String stateTopic = MqttSettings.getPrefix() + MqttHandleInverter.getTopic(inv, type, channel, fieldType.fieldId);
         const char* devCls = deviceClasses[fieldType.deviceClsId];
         const char* stateCls = stateClasses[fieldType.stateClsId];
 
@@ -141,7 +156,8 @@ void MqttHandleHassClass::publishInverterField(std::shared_ptr<InverterAbstract>
         JsonDocument root;
 
         root["name"] = name;
-        root["stat_t"] = stateTopic;
+        MqttPublisherClass::setHassStateTopic(root, serial + "/",
+            MqttHandleInverter.getTopic(inv, type, channel, fieldType.fieldId).substring(serial.length() + 1));
         root["uniq_id"] = serial + "_ch" + chanNum + "_" + fieldName;
 
         String unit_of_measure = inv->Statistics()->getChannelFieldUnit(type, channel, fieldType.fieldId);
@@ -165,16 +181,18 @@ void MqttHandleHassClass::publishInverterField(std::shared_ptr<InverterAbstract>
             return;
         }
 
-        String buffer;
-        serializeJson(root, buffer);
-        publish(configTopic, buffer);
+        _discovery.publish(configTopic, root);
     } else {
-        publish(configTopic, "");
+        _discovery.clear(configTopic);
     }
 }
 
 void MqttHandleHassClass::publishInverterButton(std::shared_ptr<InverterAbstract> inv, const char* caption, const char* icon, const char* category, const char* deviceClass, const char* subTopic, const char* payload)
 {
+    if (!_discovery.claim()) {
+        return;
+    }
+
     const String serial = inv->serialString();
 
     String buttonId = caption;
@@ -207,9 +225,7 @@ void MqttHandleHassClass::publishInverterButton(std::shared_ptr<InverterAbstract
         return;
     }
 
-    String buffer;
-    serializeJson(root, buffer);
-    publish(configTopic, buffer);
+    _discovery.publish(configTopic, root);
 }
 
 void MqttHandleHassClass::publishInverterNumber(
@@ -217,6 +233,10 @@ void MqttHandleHassClass::publishInverterNumber(
     const char* commandTopic, const char* stateTopic, const char* unitOfMeasure,
     const int16_t min, const int16_t max, float step)
 {
+    if (!_discovery.claim()) {
+        return;
+    }
+
     const String serial = inv->serialString();
 
     String buttonId = caption;
@@ -228,7 +248,6 @@ void MqttHandleHassClass::publishInverterNumber(
         + "/config";
 
     const String cmdTopic = MqttSettings.getPrefix() + serial + "/" + commandTopic;
-    const String statTopic = MqttSettings.getPrefix() + serial + "/" + stateTopic;
 
     JsonDocument root;
 
@@ -239,7 +258,7 @@ void MqttHandleHassClass::publishInverterNumber(
     }
     root["ent_cat"] = category;
     root["cmd_t"] = cmdTopic;
-    root["stat_t"] = statTopic;
+    MqttPublisherClass::setHassStateTopic(root, serial + "/", stateTopic);
     root["unit_of_meas"] = unitOfMeasure;
     root["min"] = min;
     root["max"] = max;
@@ -251,13 +270,15 @@ void MqttHandleHassClass::publishInverterNumber(
         return;
     }
 
-    String buffer;
-    serializeJson(root, buffer);
-    publish(configTopic, buffer);
+    _discovery.publish(configTopic, root);
 }
 
 void MqttHandleHassClass::publishInverterBinarySensor(std::shared_ptr<InverterAbstract> inv, const char* caption, const char* subTopic, const char* payload_on, const char* payload_off)
 {
+    if (!_discovery.claim()) {
+        return;
+    }
+
     const String serial = inv->serialString();
 
     String sensorId = caption;
@@ -268,13 +289,11 @@ void MqttHandleHassClass::publishInverterBinarySensor(std::shared_ptr<InverterAb
         + "/" + sensorId
         + "/config";
 
-    const String statTopic = MqttSettings.getPrefix() + serial + "/" + subTopic;
-
     JsonDocument root;
 
     root["name"] = caption;
     root["uniq_id"] = serial + "_" + sensorId;
-    root["stat_t"] = statTopic;
+    MqttPublisherClass::setHassStateTopic(root, serial + "/", subTopic);
     root["pl_on"] = payload_on;
     root["pl_off"] = payload_off;
 
@@ -284,13 +303,15 @@ void MqttHandleHassClass::publishInverterBinarySensor(std::shared_ptr<InverterAb
         return;
     }
 
-    String buffer;
-    serializeJson(root, buffer);
-    publish(configTopic, buffer);
+    _discovery.publish(configTopic, root);
 }
 
 void MqttHandleHassClass::publishDtuSensor(const char* name, const char* device_class, const char* category, const char* icon, const char* unit_of_measure, const char* subTopic)
 {
+    if (!_discovery.claim()) {
+        return;
+    }
+
     String id = name;
     id.toLowerCase();
     id.replace(" ", "_");
@@ -327,14 +348,16 @@ void MqttHandleHassClass::publishDtuSensor(const char* name, const char* device_
 
  
 
-    String buffer;
     const String configTopic = "sensor/" + getDtuUniqueId() + "/" + id + "/config";
-    serializeJson(root, buffer);
-    publish(configTopic, buffer);
+    _discovery.publish(configTopic, root);
 }
 
 void MqttHandleHassClass::publishDtuBinarySensor(const char* name, const char* device_class, const char* category, const char* payload_on, const char* payload_off, const char* subTopic)
 {
+    if (!_discovery.claim()) {
+        return;
+    }
+
     String id = name;
     id.toLowerCase();
     id.replace(" ", "_");
@@ -365,10 +388,8 @@ void MqttHandleHassClass::publishDtuBinarySensor(const char* name, const char* d
         return;
     }
 
-    String buffer;
     const String configTopic = "binary_sensor/" + getDtuUniqueId() + "/" + id + "/config";
-    serializeJson(root, buffer);
-    publish(configTopic, buffer);
+    _discovery.publish(configTopic, root);
 }
 
 void MqttHandleHassClass::createInverterInfo(JsonDocument& root, std::shared_ptr<InverterAbstract> inv)
@@ -425,10 +446,3 @@ String MqttHandleHassClass::getDtuUrl()
 {
     return String("http://") + NetworkSettings.localIP().toString();
 }
-
-void MqttHandleHassClass::publish(const String& subtopic, const String& payload)
-{
-    String topic = Configuration.get().Mqtt.Hass.Topic;
-    topic += subtopic;
-    MqttSettings.publishGeneric(topic, payload, Configuration.get().Mqtt.Hass.Retain);
-}
@@ -4,6 +4,7 @@
  */
 #include "MqttHandleHuawei.h"
 #include "MessageOutput.h"
+#include "MqttPublisher.h"
 #include "MqttSettings.h"
 #include "Huawei_can.h"
 // #include "Failsafe.h"
@@ -64,18 +65,23 @@ void MqttHandleHuaweiClass::loop()
     const RectifierParameters_t *rp = HuaweiCan.get();
 
     if ((millis() - _lastPublish) > (config.Mqtt.PublishInterval * 1000) ) {
-      MqttSettings.publish("huawei/data_age", String((millis() - HuaweiCan.getLastUpdate()) / 1000));
-      MqttSettings.publish("huawei/input_voltage", String(rp->input_voltage));
-      MqttSettings.publish("huawei/input_current", String(rp->input_current));
-      MqttSettings.publish("huawei/input_power", String(rp->input_power));
-      MqttSettings.publish("huawei/output_voltage", String(rp->output_voltage));
-      MqttSettings.publish("huawei/output_current", String(rp->output_current));
-      MqttSettings.publish("huawei/max_output_current", String(rp->max_output_current));
-      MqttSettings.publish("huawei/output_power", String(rp->output_power));
-      MqttSettings.publish("huawei/input_temp", String(rp->input_temp));
-      MqttSettings.publish("huawei/output_temp", String(rp->output_temp));
-      MqttSettings.publish("huawei/efficiency", String(rp->efficiency));
-      MqttSettings.publish("huawei/mode", String(HuaweiCan.getMode()));
+      MqttPublisher.beginDocument(MqttPublisherClass::Group("huawei/"));
+
+      // the readings fluctuate, power and temperatures use absolute
+      // deadbands in addition to the configured relative one.
+      MqttPublisher.publish("huawei/data_age", (millis() - HuaweiCan.getLastUpdate()) / 1000);
+      MqttPublisher.publish("huawei/input_voltage", rp->input_voltage);
+      MqttPublisher.publish("huawei/input_current", rp->input_current);
+      MqttPublisher.publish("huawei/input_power", rp->input_power, 2, 1.0f);
+      MqttPublisher.publish("huawei/output_voltage", rp->output_voltage);
+      MqttPublisher.publish("huawei/output_current", rp->output_current);
+      MqttPublisher.publish("huawei/max_output_current", rp->max_output_current);
+      MqttPublisher.publish("huawei/output_power", rp->output_power, 2, 1.0f);
+      MqttPublisher.publish("huawei/input_temp", rp->input_temp, 2, 0.5f);
+      MqttPublisher.publish("huawei/output_temp", rp->output_temp, 2, 0.5f);
+      MqttPublisher.publish("huawei/efficiency", rp->efficiency);
+      MqttPublisher.publish("huawei/mode", HuaweiCan.getMode());
+      MqttPublisher.endDocument();
 
 
       yield();
@@ -4,6 +4,7 @@
  */
 #include "MqttHandleInverter.h"
 #include "MessageOutput.h"
+#include "MqttPublisher.h"
 #include "MqttSettings.h"
 #include <ctime>
 
@@ -45,80 +46,110 @@ void MqttHandleInverterClass::loop()
     for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
         auto inv = Hoymiles.getInverterByPos(i);
 
-        const String subtopic = inv->serialString();
+        const MqttPublisherClass::Group invGroup(inv->serialString() + "/");
+        MqttPublisher.beginDocument(invGroup);
 
         // Name
-        MqttSettings.publish(subtopic + "/name", inv->name());
+        MqttPublisher.publish(invGroup, "name", inv->name());
 
         if (inv->DevInfo()->getLastUpdate() > 0) {
             // Bootloader Version
-            MqttSettings.publish(subtopic + "/device/bootloaderversion", String(inv->DevInfo()->getFwBootloaderVersion()));
+            MqttPublisher.publish(invGroup, "device/bootloaderversion", inv->DevInfo()->getFwBootloaderVersion());
 
             // Firmware Version
-            MqttSettings.publish(subtopic + "/device/fwbuildversion", String(inv->DevInfo()->getFwBuildVersion()));
+            MqttPublisher.publish(invGroup, "device/fwbuildversion", inv->DevInfo()->getFwBuildVersion());
 
             // Firmware Build DateTime
-            MqttSettings.publish(subtopic + "/device/fwbuilddatetime", inv->DevInfo()->getFwBuildDateTimeStr());
+            MqttPublisher.publish(invGroup, "device/fwbuilddatetime", inv->DevInfo()->getFwBuildDateTimeStr());
 
             // Hardware part number
-            MqttSettings.publish(subtopic + "/device/hwpartnumber", String(inv->DevInfo()->getHwPartNumber()));
+            MqttPublisher.publish(invGroup, "device/hwpartnumber", inv->DevInfo()->getHwPartNumber());
 
             // Hardware version
-            MqttSettings.publish(subtopic + "/device/hwversion", inv->DevInfo()->getHwVersion());
+            MqttPublisher.publish(invGroup, "device/hwversion", inv->DevInfo()->getHwVersion());
         }
 
         if (inv->SystemConfigPara()->getLastUpdate() > 0) {
             // Limit
-            MqttSettings.publish(subtopic + "/status/limit_relative", String(inv->SystemConfigPara()->getLimitPercent()));
+            MqttPublisher.publish(invGroup, "status/limit_relative", inv->SystemConfigPara()->getLimitPercent());
 
             uint16_t maxpower = inv->DevInfo()->getMaxPower();
             if (maxpower > 0) {
-                MqttSettings.publish(subtopic + "/status/limit_absolute", String(inv->SystemConfigPara()->getLimitPercent() * maxpower / 100));
+                MqttPublisher.publish(invGroup, "status/limit_absolute", inv->SystemConfigPara()->getLimitPercent() * maxpower / 100);
             }
         }
 
-        MqttSettings.publish(subtopic + "/status/reachable", String(inv->isReachable()));
-        MqttSettings.publish(subtopic + "/status/producing", String(inv->isProducing()));
+        MqttPublisher.publish(invGroup, "status/reachable", inv->isReachable());
+        MqttPublisher.publish(invGroup, "status/producing", inv->isProducing());
 
-        if (inv->Statistics()->getLastUpdate() > 0) {
-            MqttSettings.publish(subtopic + "/status/last_update", String(std::time(0) - (millis() - inv->Statistics()->getLastUpdate()) / 1000));
+        // publish all values of the same statistics packet
+        auto stats = inv->Statistics()->getSnapshot();
+
+        if (stats->getLastUpdate() > 0) {
+            MqttPublisher.publish(invGroup, "status/last_update", std::time(0) - (millis() - stats->getLastUpdate()) / 1000);
         } else {
-            MqttSettings.publish(subtopic + "/status/last_update", String(0));
+            MqttPublisher.publish(invGroup, "status/last_update", 0);
         }
 
-        const uint32_t lastUpdateInternal = inv->Statistics()->getLastUpdateFromInternal();
-        if (inv->Statistics()->getLastUpdate() > 0 && (lastUpdateInternal != _lastPublishStats[i])) {
+        // the JSON document always contains all values
+        const uint32_t lastUpdateInternal = stats->getLastUpdateFromInternal();
+        if (stats->getLastUpdate() > 0 && (lastUpdateInternal != _lastPublishStats[i] || MqttPublisherClass::isJsonModeEnabled())) {
             _lastPublishStats[i] = lastUpdateInternal;
 
             // Loop all channels
-            for (auto& t : inv->Statistics()->getChannelTypes()) {
-                for (auto& c : inv->Statistics()->getChannelsByType(t)) {
+            for (auto& t : stats->getChannelTypes()) {
+                for (auto& c : stats->getChannelsByType(t)) {
+                    String chanNum;
+                    if (t == TYPE_DC) {
+                        // TODO(tbnobody)
+                        chanNum = static_cast<uint8_t>(c) + 1;
+                    } else {
+                        chanNum = c;
+                    }
+
+                    const MqttPublisherClass::Group chanGroup(invGroup.getPrefix() + chanNum + "/");
+
                     if (t == TYPE_DC) {
                         INVERTER_CONFIG_T* inv_cfg = Configuration.getInverterConfig(inv->serial());
                         if (inv_cfg != nullptr) {
-                            // TODO(tbnobody)
-                            MqttSettings.publish(inv->serialString() + "/" + String(static_cast<uint8_t>(c) + 1) + "/name", inv_cfg->channel[c].Name);
+                            MqttPublisher.publish(chanGroup, "name", inv_cfg->channel[c].Name);
                         }
                     }
                     for (uint8_t f = 0; f < sizeof(_publishFields) / sizeof(FieldId_t); f++) {
-                        publishField(inv, t, c, _publishFields[f]);
+                        publishField(chanGroup, *stats, t, c, _publishFields[f]);
                     }
                 }
             }
         }
 
+        MqttPublisher.endDocument();
+
         yield();
     }
 }
 
-void MqttHandleInverterClass::publishField(std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId)
+void MqttHandleInverterClass::publishField(const MqttPublisherClass::Group& group, const StatisticsSnapshot& stats, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId)
 {
-    const String topic = getTopic(inv, type, channel, fieldId);
-    if (topic == "") {
+    if (!stats.hasChannelFieldValue(type, channel, fieldId)) {
         return;
     }
 
-    MqttSettings.publish(topic, inv->Statistics()->getChannelFieldValueString(type, channel, fieldId));
+    // lower-case field name without allocating a String for every value
+    char name[32] = "powerdc";
+    if (type != TYPE_INV || fieldId != FLD_PDC) {
+        const char* fieldName = stats.getChannelFieldName(type, channel, fieldId);
+        size_t n = 0;
+        for (; fieldName[n] != '\0' && n < sizeof(name) - 1; ++n) {
+            name[n] = tolower(fieldName[n]);
+        }
+        name[n] = '\0';
+    }
+
+    bool counter = (fieldId == FLD_YD || fieldId == FLD_YT);
+
+    MqttPublisher.publish(group, name,
+        stats.getChannelFieldValue(type, channel, fieldId),
+        stats.getChannelFieldDigits(type, channel, fieldId), 0, counter);
 }
 
 String MqttHandleInverterClass::getTopic(std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId)
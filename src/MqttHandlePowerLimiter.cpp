@@ -2,6 +2,7 @@
 /*
  * Copyright (C) 2022 Thomas Basler, Malte Schmidt and others
  */
+#include "EnergyFlow.h"
 #include "MessageOutput.h"
 #include "MqttSettings.h"
 #include "MqttHandlePowerLimiter.h"
@@ -84,6 +85,29 @@ void MqttHandlePowerLimiterClass::loop()
 
     MqttSettings.publish("powerlimiter/status/inverter_update_timeouts", String(PowerLimiter.getInverterUpdateTimeouts()));
 
+    auto publishLatency = [](char const* name, LatencyHistogram const& histogram) {
+        JsonDocument doc;
+        histogram.toJson(doc.to<JsonObject>(), false/*summary only*/);
+        String buffer;
+        serializeJson(doc, buffer);
+        MqttSettings.publish(String("powerlimiter/status/latency/") + name, buffer);
+    };
+
+    auto const& latency = PowerLimiter.getLatencyStats();
+    publishLatency("meter_age_ms", latency.meterAge);
+    publishLatency("calculation_us", latency.calculation);
+    publishLatency("command_round_trip_ms", latency.commandRoundTrip);
+    publishLatency("stats_settling_ms", latency.statsSettling);
+    publishLatency("total_ms", latency.total);
+
+    if (config.Huawei.Enabled) {
+        JsonDocument doc;
+        EnergyFlow.toJson(doc.to<JsonObject>());
+        String buffer;
+        serializeJson(doc, buffer);
+        MqttSettings.publish("powerlimiter/status/energy_flow", buffer);
+    }
+
     // no thresholds are relevant for setups without a battery
     if (config.PowerLimiter.IsInverterSolarPowered) { return; }
 
@@ -27,18 +27,27 @@ void MqttHandlePowerLimiterHassClass::loop()
         return;
     }
     if (_updateForced) {
-        publishConfig();
+        _discovery.restart(true);
         _updateForced = false;
     }
 
     if (MqttSettings.getConnected() && !_wasConnected) {
-        // Connection established
+        // Connection established. the broker might not have retained the
+        // configs published before, e.g., if it was restarted.
         _wasConnected = true;
-        publishConfig();
+        _discovery.restart(true);
     } else if (!MqttSettings.getConnected() && _wasConnected) {
         // Connection lost
         _wasConnected = false;
     }
+
+    if (!_discovery.isPending()) {
+        return;
+    }
+
+    _discovery.beginSlice();
+    publishConfig();
+    _discovery.endSlice();
 }
 
 void MqttHandlePowerLimiterHassClass::forceUpdate()
@@ -108,6 +117,9 @@ void MqttHandlePowerLimiterHassClass::publishSelect(
     const char* caption, const char* icon, const char* category,
     const char* commandTopic, const char* stateTopic)
 {
+    if (!_discovery.claim()) {
+        return;
+    }
 
     String selectId = caption;
     selectId.replace(" ", "_");
@@ -139,9 +151,7 @@ void MqttHandlePowerLimiterHassClass::publishSelect(
         return;
     }
 
-    String buffer;
-    serializeJson(root, buffer);
-    publish(configTopic, buffer);
+    _discovery.publish(configTopic, root);
 }
 
 void MqttHandlePowerLimiterHassClass::publishNumber(
@@ -149,6 +159,9 @@ void MqttHandlePowerLimiterHassClass::publishNumber(
     const char* commandTopic, const char* stateTopic, const char* unitOfMeasure,
     const int16_t min, const int16_t max, const float step)
 {
+    if (!_discovery.claim()) {
+        return;
+    }
 
     String numberId = caption;
     numberId.replace(" ", "_");
@@ -186,15 +199,16 @@ void MqttHandlePowerLimiterHassClass::publishNumber(
         return;
     }
 
-    String buffer;
-    serializeJson(root, buffer);
-    publish(configTopic, buffer);
+    _discovery.publish(configTopic, root);
 }
 
 void MqttHandlePowerLimiterHassClass::publishBinarySensor(
     const char* caption, const char* icon,
     const char* stateTopic, const char* payload_on, const char* payload_off)
 {
+    if (!_discovery.claim()) {
+        return;
+    }
 
     String numberId = caption;
     numberId.replace(" ", "_");
@@ -226,9 +240,7 @@ void MqttHandlePowerLimiterHassClass::publishBinarySensor(
         return;
     }
 
-    String buffer;
-    serializeJson(root, buffer);
-    publish(configTopic, buffer);
+    _discovery.publish(configTopic, root);
 }
 
 
@@ -243,10 +255,3 @@ void MqttHandlePowerLimiterHassClass::createDeviceInfo(JsonDocument& root)
     object["sw"] = __COMPILED_GIT_HASH__;
     object["via_device"] = MqttHandleHass.getDtuUniqueId();
 }
-
-void MqttHandlePowerLimiterHassClass::publish(const String& subtopic, const String& payload)
-{
-    String topic = Configuration.get().Mqtt.Hass.Topic;
-    topic += subtopic;
-    MqttSettings.publishGeneric(topic.c_str(), payload.c_str(), Configuration.get().Mqtt.Hass.Retain);
-}
@@ -4,6 +4,7 @@
  */
 #include "VictronMppt.h"
 #include "MqttHandleVedirect.h"
+#include "MqttPublisher.h"
 #include "MqttSettings.h"
 #include "MessageOutput.h"
 
@@ -102,10 +103,21 @@ void MqttHandleVedirectClass::publish_mppt_data(const VeDirectMpptController::da
     String topic = "victron/";
     topic.concat(currentData.serialNr_SER);
     topic.concat("/");
+    const MqttPublisherClass::Group group(topic);
+
+    // the JSON document always contains all values
+    bool publishFull = _PublishFull || MqttPublisherClass::isJsonModeEnabled();
+
+    MqttPublisher.beginDocument(group);
 
 #define PUBLISH(sm, t, val) \
-    if (_PublishFull || currentData.sm != previousData.sm) { \
-        MqttSettings.publish(topic + t, String(val)); \
+    if (publishFull || currentData.sm != previousData.sm) { \
+        MqttPublisher.publish(group, t, val); \
+    }
+
+#define PUBLISH_COUNTER(sm, t, val) \
+    if (publishFull || currentData.sm != previousData.sm) { \
+        MqttPublisher.publish(group, t, val, 2, 0, true); \
     }
 
     PUBLISH(productID_PID,           "PID",  currentData.getPidAsString().data());
@@ -124,20 +136,23 @@ void MqttHandleVedirectClass::publish_mppt_data(const VeDirectMpptController::da
     PUBLISH(panelCurrent_mA,         "IPV",  currentData.panelCurrent_mA / 1000.0);
     PUBLISH(panelPower_PPV_W,        "PPV",  currentData.panelPower_PPV_W);
     PUBLISH(mpptEfficiency_Percent,    "E",  currentData.mpptEfficiency_Percent);
-    PUBLISH(yieldTotal_H19_Wh,       "H19",  currentData.yieldTotal_H19_Wh / 1000.0);
-    PUBLISH(yieldToday_H20_Wh,       "H20",  currentData.yieldToday_H20_Wh / 1000.0);
+    PUBLISH_COUNTER(yieldTotal_H19_Wh,       "H19",  currentData.yieldTotal_H19_Wh / 1000.0);
+    PUBLISH_COUNTER(yieldToday_H20_Wh,       "H20",  currentData.yieldToday_H20_Wh / 1000.0);
     PUBLISH(maxPowerToday_H21_W,     "H21",  currentData.maxPowerToday_H21_W);
-    PUBLISH(yieldYesterday_H22_Wh,   "H22",  currentData.yieldYesterday_H22_Wh / 1000.0);
+    PUBLISH_COUNTER(yieldYesterday_H22_Wh,   "H22",  currentData.yieldYesterday_H22_Wh / 1000.0);
     PUBLISH(maxPowerYesterday_H23_W, "H23",  currentData.maxPowerYesterday_H23_W);
 #undef PUBLILSH
+#undef PUBLISH_COUNTER
 
 #define PUBLISH_OPT(sm, t, val) \
-    if (currentData.sm.first != 0 && (_PublishFull || currentData.sm.second != previousData.sm.second)) { \
-        MqttSettings.publish(topic + t, String(val)); \
+    if (currentData.sm.first != 0 && (publishFull || currentData.sm.second != previousData.sm.second)) { \
+        MqttPublisher.publish(group, t, val); \
     }
 
     PUBLISH_OPT(NetworkTotalDcInputPowerMilliWatts,       "NetworkTotalDcInputPower",     currentData.NetworkTotalDcInputPowerMilliWatts.second / 1000.0);
     PUBLISH_OPT(MpptTemperatureMilliCelsius,              "MpptTemperature",              currentData.MpptTemperatureMilliCelsius.second / 1000.0);
     PUBLISH_OPT(SmartBatterySenseTemperatureMilliCelsius, "SmartBatterySenseTemperature", currentData.SmartBatterySenseTemperatureMilliCelsius.second / 1000.0);
 #undef PUBLILSH_OPT
+
+    MqttPublisher.endDocument();
 }
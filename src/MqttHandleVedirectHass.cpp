@@ -4,6 +4,7 @@
  */
 #include "MqttHandleVedirectHass.h"
 #include "Configuration.h"
+#include "MqttPublisher.h"
 #include "MqttSettings.h"
 #include "MqttHandleHass.h"
 #include "NetworkSettings.h"
@@ -28,18 +29,27 @@ void MqttHandleVedirectHassClass::loop()
         return;
     }
     if (_updateForced) {
-        publishConfig();
+        _discovery.restart(true);
         _updateForced = false;
     }
 
     if (MqttSettings.getConnected() && !_wasConnected) {
-        // Connection established
+        // Connection established. the broker might not have retained the
+        // configs published before, e.g., if it was restarted.
         _wasConnected = true;
-        publishConfig();
+        _discovery.restart(true);
     } else if (!MqttSettings.getConnected() && _wasConnected) {
         // Connection lost
         _wasConnected = false;
     }
+
+    if (!_discovery.isPending()) {
+        return;
+    }
+
+    _discovery.beginSlice();
+    publishConfig();
+    _discovery.endSlice();
 }
 
 void MqttHandleVedirectHassClass::forceUpdate()
@@ -108,6 +118,10 @@ void MqttHandleVedirectHassClass::publishSensor(const char *caption, const char
                                                 const char *unitOfMeasurement,
                                                 const VeDirectMpptController::data_t &mpptData)
 {
+    if (!_discovery.claim(mpptData.serialNr_SER, subTopic)) {
+        return;
+    }
+
     String serial = mpptData.serialNr_SER;
 
     String sensorId = caption;
@@ -121,15 +135,10 @@ void MqttHandleVedirectHassClass::publishSensor(const char *caption, const char
         + "/" + sensorId
         + "/config";
 
-    String statTopic = MqttSettings.getPrefix() + "victron/";
-    statTopic.concat(serial);
-    statTopic.concat("/");
-    statTopic.concat(subTopic);
-
     JsonDocument root;
 
     root["name"] = caption;
-    root["stat_t"] = statTopic;
+    MqttPublisherClass::setHassStateTopic(root, "victron/" + serial + "/", subTopic);
     root["uniq_id"] = serial + "_" + sensorId;
 
     if (icon != NULL) {
@@ -157,15 +166,16 @@ void MqttHandleVedirectHassClass::publishSensor(const char *caption, const char
         return;
     }
 
-    char buffer[512];
-    serializeJson(root, buffer);
-    publish(configTopic, buffer);
-
+    _discovery.publish(configTopic, root);
 }
 void MqttHandleVedirectHassClass::publishBinarySensor(const char *caption, const char *icon, const char *subTopic,
                                                       const char *payload_on, const char *payload_off,
                                                       const VeDirectMpptController::data_t &mpptData)
 {
+    if (!_discovery.claim(mpptData.serialNr_SER, subTopic)) {
+        return;
+    }
+
     String serial = mpptData.serialNr_SER;
 
     String sensorId = caption;
@@ -179,15 +189,10 @@ void MqttHandleVedirectHassClass::publishBinarySensor(const char *caption, const
         + "/" + sensorId
         + "/config";
 
-    String statTopic = MqttSettings.getPrefix() + "victron/";
-    statTopic.concat(serial);
-    statTopic.concat("/");
-    statTopic.concat(subTopic);
-
     JsonDocument root;
     root["name"] = caption;
     root["uniq_id"] = serial + "_" + sensorId;
-    root["stat_t"] = statTopic;
+    MqttPublisherClass::setHassStateTopic(root, "victron/" + serial + "/", subTopic);
     root["pl_on"] = payload_on;
     root["pl_off"] = payload_off;
 
@@ -202,9 +207,7 @@ void MqttHandleVedirectHassClass::publishBinarySensor(const char *caption, const
         return;
     }
 
-    char buffer[512];
-    serializeJson(root, buffer);
-    publish(configTopic, buffer);
+    _discovery.publish(configTopic, root);
 }
 
 void MqttHandleVedirectHassClass::createDeviceInfo(JsonObject &object,
@@ -219,10 +222,3 @@ void MqttHandleVedirectHassClass::createDeviceInfo(JsonObject &object,
     object["sw"] = __COMPILED_GIT_HASH__;
     object["via_device"] = MqttHandleHass.getDtuUniqueId();
 }
-
-void MqttHandleVedirectHassClass::publish(const String& subtopic, const String& payload)
-{
-    String topic = Configuration.get().Mqtt.Hass.Topic;
-    topic += subtopic;
-    MqttSettings.publishGeneric(topic.c_str(), payload.c_str(), Configuration.get().Mqtt.Hass.Retain);
-}
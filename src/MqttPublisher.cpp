@@ -0,0 +1,318 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "MqttPublisher.h"
+#include "Configuration.h"
+#include "MqttSettings.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+MqttPublisherClass MqttPublisher;
+
+namespace {
+
+// FNV-1a, continued from the hash of the group's prefix
+uint32_t hashString(char const* str, uint32_t hash = 2166136261U)
+{
+    while (*str) {
+        hash ^= static_cast<uint8_t>(*str++);
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+// true if the string is a number as defined by JSON
+bool isJsonNumber(char const* str)
+{
+    auto skipDigits = [&str]() {
+        if (!isdigit(static_cast<unsigned char>(*str))) { return false; }
+        while (isdigit(static_cast<unsigned char>(*str))) { ++str; }
+        return true;
+    };
+
+    if (*str == '-') { ++str; }
+
+    if (*str == '0') {
+        ++str;
+    } else if (!skipDigits()) {
+        return false;
+    }
+
+    if (*str == '.') {
+        ++str;
+        if (!skipDigits()) { return false; }
+    }
+
+    if (*str == 'e' || *str == 'E') {
+        ++str;
+        if (*str == '+' || *str == '-') { ++str; }
+        if (!skipDigits()) { return false; }
+    }
+
+    return *str == '\0';
+}
+
+void appendJsonString(std::string& out, char const* str)
+{
+    out += '"';
+    for (; *str != '\0'; ++str) {
+        if (*str == '"' || *str == '\\') {
+            out += '\\';
+            out += *str;
+        } else if (static_cast<unsigned char>(*str) < 0x20) {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(*str));
+            out += escaped;
+        } else {
+            out += *str;
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+MqttPublisherClass::Group::Group(String const& prefix)
+    : _prefix(prefix)
+    , _hash(hashString(prefix.c_str()))
+{
+}
+
+MqttPublisherClass::Entry* MqttPublisherClass::getEntry(Group const& group, char const* name)
+{
+    // without the change filter, every value is published anyway. caching
+    // the values would only cost memory then.
+    if (!Configuration.get().Mqtt.ChangeFilter.Enabled) { return nullptr; }
+
+    auto& entry = _entries[hashString(name, group._hash)];
+
+    if (entry.topic.isEmpty()) {
+        entry.topic = MqttSettings.getPrefix() + group._prefix + name;
+        return &entry;
+    }
+
+    // the hash of another topic collided with this one's. the topic is
+    // published without caching it then. all topics share the base topic,
+    // so comparing the part following it suffices.
+    auto prefixLength = group._prefix.length();
+    auto nameLength = strlen(name);
+    auto topicLength = entry.topic.length();
+    if (topicLength < prefixLength + nameLength) { return nullptr; }
+
+    char const* subtopic = entry.topic.c_str() + topicLength - prefixLength - nameLength;
+    if (strncmp(subtopic, group._prefix.c_str(), prefixLength) != 0
+            || strcmp(subtopic + prefixLength, name) != 0) {
+        return nullptr;
+    }
+
+    return &entry;
+}
+
+bool MqttPublisherClass::isRefreshDue(MqttPublisherClass::Entry const& entry) const
+{
+    auto const& config = Configuration.get();
+    if (entry.lastPublish == 0) { return true; }
+
+    uint32_t refreshMillis = config.Mqtt.ChangeFilter.RefreshInterval * 1000;
+
+    // when Home Assistant MQTT-Auto-Discovery is active, and "enable
+    // expiration" is active, all values must be published at least once
+    // before the announced expiry interval is reached.
+    if (config.Mqtt.Hass.Enabled && config.Mqtt.Hass.Expire) {
+        refreshMillis = std::min<uint32_t>(refreshMillis,
+                ((config.Mqtt.PublishInterval * 3) - 1) * 1000);
+    }
+
+    return (millis() - entry.lastPublish) >= refreshMillis;
+}
+
+void MqttPublisherClass::publish(MqttPublisherClass::Entry& entry, char const* payload)
+{
+    if (entry.payload != payload) { entry.payload = payload; }
+    MqttSettings.publishGeneric(entry.topic, entry.payload, Configuration.get().Mqtt.Retain);
+    entry.lastPublish = millis() | 1; // zero means never published
+}
+
+void MqttPublisherClass::publish(Group const& group, char const* name, char const* payload)
+{
+    // payloads rarely need to be trimmed, only copy them in this case
+    size_t length = strlen(payload);
+    if (length > 0 && (isspace(static_cast<unsigned char>(payload[0]))
+                || isspace(static_cast<unsigned char>(payload[length - 1])))) {
+        String value(payload);
+        value.trim();
+        publish(group, name, value.c_str());
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (appendToDocument(group, name, payload) && !isTopicModeEnabled()) { return; }
+
+    auto pEntry = getEntry(group, name);
+    if (pEntry == nullptr) {
+        lock.unlock();
+        MqttSettings.publish(group._prefix + name, payload);
+        return;
+    }
+
+    if (!isRefreshDue(*pEntry) && pEntry->payload == payload) { return; }
+
+    publish(*pEntry, payload);
+}
+
+void MqttPublisherClass::publish(Group const& group, char const* name, float value,
+        uint8_t decimals, float deadband, bool counter)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (appendToDocument(group, name, value, decimals) && !isTopicModeEnabled()) { return; }
+
+    auto pEntry = getEntry(group, name);
+    if (pEntry == nullptr) {
+        lock.unlock();
+        MqttSettings.publish(group._prefix + name, String(value, decimals));
+        return;
+    }
+
+    bool refresh = isRefreshDue(*pEntry);
+
+    if (!refresh) {
+        // changes that do not show in the payload are ignored anyway
+        float threshold = 0.5f * std::pow(10.0f, -decimals);
+        threshold = std::max(threshold, deadband);
+
+        if (!counter) {
+            auto const& filter = Configuration.get().Mqtt.ChangeFilter;
+            threshold = std::max(threshold, filter.AbsoluteDeadband);
+            threshold = std::max(threshold, std::fabs(pEntry->value) * filter.Deadband / 100);
+        }
+
+        if (std::fabs(value - pEntry->value) < threshold) { return; }
+    }
+
+    char payload[32];
+    snprintf(payload, sizeof(payload), "%.*f", decimals, value);
+    if (!refresh && pEntry->payload == payload) { return; }
+
+    pEntry->value = value;
+    publish(*pEntry, payload);
+}
+
+void MqttPublisherClass::reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+}
+
+MqttPublisherClass::PayloadMode MqttPublisherClass::getPayloadMode()
+{
+    auto mode = Configuration.get().Mqtt.PayloadMode;
+    if (mode > static_cast<uint8_t>(PayloadMode::Both)) { return PayloadMode::Topics; }
+    return static_cast<PayloadMode>(mode);
+}
+
+void MqttPublisherClass::beginDocument(Group const& group)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!isJsonModeEnabled()) {
+        _document.reset();
+        return;
+    }
+
+    _document = group;
+    _documentBuffer.clear();
+    _documentBuffer += '{';
+}
+
+void MqttPublisherClass::endDocument()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (!_document.has_value()) { return; }
+
+    Group group = *_document;
+    _document.reset();
+
+    if (_documentBuffer.size() <= 1) { return; } // no values
+
+    _documentBuffer += '}';
+    String payload(_documentBuffer.c_str());
+
+    lock.unlock();
+    publish(group, "json", payload);
+}
+
+// appends the key of the value to the open document, which is the subtopic
+// relative to the document's prefix. returns false if there is no open
+// document or if the value does not belong to it.
+bool MqttPublisherClass::appendKey(Group const& group, char const* name)
+{
+    if (!_document.has_value()) { return false; }
+
+    auto const& documentPrefix = _document->_prefix;
+    auto documentLength = documentPrefix.length();
+    auto prefixLength = group._prefix.length();
+
+    char const* keyPrefix = "";
+    char const* keyName = name;
+
+    if (prefixLength >= documentLength) {
+        if (strncmp(group._prefix.c_str(), documentPrefix.c_str(), documentLength) != 0) { return false; }
+        keyPrefix = group._prefix.c_str() + documentLength;
+    } else {
+        if (strncmp(group._prefix.c_str(), documentPrefix.c_str(), prefixLength) != 0) { return false; }
+        auto remaining = documentLength - prefixLength;
+        if (strncmp(name, documentPrefix.c_str() + prefixLength, remaining) != 0) { return false; }
+        keyName = name + remaining;
+    }
+
+    if (*keyPrefix == '\0' && *keyName == '\0') { return false; }
+
+    if (_documentBuffer.size() > 1) { _documentBuffer += ','; }
+    _documentBuffer += '"';
+    _documentBuffer += keyPrefix;
+    _documentBuffer += keyName;
+    _documentBuffer += "\":";
+    return true;
+}
+
+bool MqttPublisherClass::appendToDocument(Group const& group, char const* name, char const* value)
+{
+    if (!appendKey(group, name)) { return false; }
+
+    if (isJsonNumber(value)) {
+        _documentBuffer += value;
+    } else {
+        appendJsonString(_documentBuffer, value);
+    }
+
+    return true;
+}
+
+bool MqttPublisherClass::appendToDocument(Group const& group, char const* name, float value, uint8_t decimals)
+{
+    if (!appendKey(group, name)) { return false; }
+
+    if (!std::isfinite(value)) {
+        _documentBuffer += "null";
+        return true;
+    }
+
+    char number[32];
+    snprintf(number, sizeof(number), "%.*f", decimals, value);
+    _documentBuffer += number;
+    return true;
+}
+
+void MqttPublisherClass::setHassStateTopic(JsonVariant root, String const& prefix, String const& name)
+{
+    if (isTopicModeEnabled()) {
+        root["stat_t"] = MqttSettings.getPrefix() + prefix + name;
+        return;
+    }
+
+    root["stat_t"] = MqttSettings.getPrefix() + prefix + "json";
+    root["val_tpl"] = "{{ value_json['" + name + "'] }}";
+}
@@ -5,6 +5,7 @@
 #include "MqttSettings.h"
 #include "Configuration.h"
 #include "MessageOutput.h"
+#include "MqttPublisher.h"
 
 MqttSettingsClass::MqttSettingsClass()
 {
@@ -29,6 +30,11 @@ void MqttSettingsClass::NetworkEvent(network_event event)
 void MqttSettingsClass::onMqttConnect(const bool sessionPresent)
 {
     MessageOutput.println("Connected to MQTT.");
+
+    // the broker might not know about any values yet, and the base topic
+    // might have changed.
+    MqttPublisher.reset();
+
     const CONFIG_T& config = Configuration.get();
     publish(config.Mqtt.Lwt.Topic, config.Mqtt.Lwt.Value_Online);
 
@@ -7,15 +7,17 @@
 #include "Battery.h"
 #include "PowerMeter.h"
 #include "PowerLimiter.h"
+#include "PowerLimiterCalc.h"
 #include "Configuration.h"
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
-#include "Huawei_can.h"
+#include "EnergyFlow.h"
 #include <VictronMppt.h>
 #include "MessageOutput.h"
 #include "inverters/HMS_4CH.h"
 #include <ctime>
 #include <cmath>
+#include <algorithm>
 #include <frozen/map.h>
 #include "SunPosition.h"
 
@@ -23,10 +25,27 @@ PowerLimiterClass PowerLimiter;
 
 void PowerLimiterClass::init(Scheduler& scheduler)
 {
+    _schedulerTask = xTaskGetCurrentTaskHandle();
+
+    // the DPL runs whenever one of its data sources notifies it about new
+    // data. the interval serves as fallback to handle timeouts, data becoming
+    // outdated and changes made in other contexts.
     scheduler.addTask(_loopTask);
     _loopTask.setCallback(std::bind(&PowerLimiterClass::loop, this));
     _loopTask.setIterations(TASK_FOREVER);
+    _loopTask.setInterval(1 * TASK_SECOND);
     _loopTask.enable();
+
+    // limit and power commands as well as new stats
+    Hoymiles.setCommandFinishedCallback([this](InverterAbstract&) { notify(); });
+}
+
+void PowerLimiterClass::notify()
+{
+    // the scheduler's tasks must not be manipulated from other contexts
+    if (xTaskGetCurrentTaskHandle() != _schedulerTask) { return; }
+
+    _loopTask.forceNextIteration();
 }
 
 frozen::string const& PowerLimiterClass::getStatusText(PowerLimiterClass::Status status)
@@ -92,6 +111,16 @@ bool PowerLimiterClass::shutdown(PowerLimiterClass::Status status)
 
     _oTargetPowerState = false;
 
+    _controller.reset();
+
+    // the secondary inverters are commanded once per transition into a
+    // shutdown state. while disabled by config or MQTT, the DPL does not
+    // touch them at all, as the user might be controlling them manually.
+    bool disabled = status == Status::DisabledByConfig || status == Status::DisabledByMqtt;
+    if (!disabled && !_secondariesShutdown) {
+        _secondariesShutdown = shutdownSecondaryInverters();
+    }
+
     return updateInverter();
 }
 
@@ -100,6 +129,8 @@ void PowerLimiterClass::loop()
     CONFIG_T const& config = Configuration.get();
     _verboseLogging = config.PowerLimiter.VerboseLogging;
 
+    updatePollPriority();
+
     // we know that the Hoymiles library refuses to send any message to any
     // inverter until the system has valid time information. until then we can
     // do nothing, not even shutdown the inverter.
@@ -127,14 +158,7 @@ void PowerLimiterClass::loop()
         return;
     }
 
-    std::shared_ptr<InverterAbstract> currentInverter =
-        Hoymiles.getInverterBySerial(config.PowerLimiter.InverterId);
-
-    if (currentInverter == nullptr && config.PowerLimiter.InverterId < INV_MAX_COUNT) {
-        // we previously had an index saved as InverterId. fall back to the
-        // respective positional lookup if InverterId is not a known serial.
-        currentInverter = Hoymiles.getInverterByPos(config.PowerLimiter.InverterId);
-    }
+    std::shared_ptr<InverterAbstract> currentInverter = getConfiguredInverter();
 
     // in case of (newly) broken configuration, shut down
     // the last inverter we worked with (if any)
@@ -181,35 +205,33 @@ void PowerLimiterClass::loop()
             _inverter->SystemConfigPara()->getLastUpdateCommand(),
             _inverter->PowerCommand()->getLastUpdateCommand());
 
-    // we need inverter stats younger than the last update command
-    if (_oInverterStatsMillis.has_value() && lastUpdateCmd > *_oInverterStatsMillis) {
-        _oInverterStatsMillis = std::nullopt;
-    }
+    // new limits are only calculated based on inverter stats and power meter
+    // readings that reflect the previous limit, see CalculationGate.
+    auto oPreviousStatsMillis = _calculationGate.getStatsMillis();
 
-    if (!_oInverterStatsMillis.has_value()) {
-        auto lastStats = _inverter->Statistics()->getLastUpdate();
-        if (lastStats <= lastUpdateCmd) {
-            return announceStatus(Status::InverterStatsPending);
-        }
-
-        _oInverterStatsMillis = lastStats;
-    }
+    auto gate = _calculationGate.check(millis(), lastUpdateCmd,
+            _inverter->Statistics()->getLastUpdate(),
+            PowerMeter.isDataValid(), PowerMeter.getLastUpdate());
 
-    // if the power meter is being used, i.e., if its data is valid, we want to
-    // wait for a new reading after adjusting the inverter limit. otherwise, we
-    // proceed as we will use a fallback limit independent of the power meter.
-    // the power meter reading is expected to be at most 2 seconds old when it
-    // arrives. this can be the case for readings provided by networked meter
-    // readers, where a packet needs to travel through the network for some
-    // time after the actual measurement was done by the reader.
-    if (PowerMeter.isDataValid() && PowerMeter.getLastUpdate() <= (*_oInverterStatsMillis + 2000)) {
-        return announceStatus(Status::PowerMeterPending);
+    auto oStatsMillis = _calculationGate.getStatsMillis();
+    if (oStatsMillis.has_value() && oStatsMillis != oPreviousStatsMillis &&
+            _oLimitConfirmedMillis.has_value()) {
+        _latencyStats.statsSettling.record(*oStatsMillis - *_oLimitConfirmedMillis);
+        _oLimitConfirmedMillis = std::nullopt;
     }
 
-    // since _lastCalculation and _calculationBackoffMs are initialized to
-    // zero, this test is passed the first time the condition is checked.
-    if (millis() < (_lastCalculation + _calculationBackoffMs)) {
-        return announceStatus(Status::Stable);
+    switch (gate) {
+        case PowerLimiterCalc::CalculationGate::State::StatsPending:
+            return announceStatus(Status::InverterStatsPending);
+        case PowerLimiterCalc::CalculationGate::State::MeterPending:
+            return announceStatus(Status::PowerMeterPending);
+        case PowerLimiterCalc::CalculationGate::State::Backoff:
+            // make sure to re-evaluate as soon as the backoff period ends
+            _loopTask.delay(std::min<uint32_t>(TASK_SECOND,
+                    _calculationGate.getRemainingBackoff(millis())));
+            return announceStatus(Status::Stable);
+        case PowerLimiterCalc::CalculationGate::State::Ready:
+            break;
     }
 
     if (_verboseLogging) {
@@ -288,18 +310,21 @@ void PowerLimiterClass::loop()
                 (config.PowerLimiter.BatteryAlwaysUseAtNight?"yes":"no"));
     };
 
+    bool meterValid = PowerMeter.isDataValid();
+    uint32_t meterMillis = PowerMeter.getLastUpdate();
+    if (meterValid) { _latencyStats.meterAge.record(millis() - meterMillis); }
+
     // Calculate and set Power Limit (NOTE: might reset _inverter to nullptr!)
+    uint32_t calculationStart = micros();
     bool limitUpdated = calcPowerLimit(_inverter, getSolarPower(), _batteryDischargeEnabled);
+    _latencyStats.calculation.record(micros() - calculationStart);
 
-    _lastCalculation = millis();
+    _calculationGate.calculated(millis());
+    _calculationGate.adaptBackoff(limitUpdated);
 
-    if (!limitUpdated) {
-        // increase polling backoff if system seems to be stable
-        _calculationBackoffMs = std::min<uint32_t>(1024, _calculationBackoffMs * 2);
-        return announceStatus(Status::Stable);
-    }
+    if (!limitUpdated) { return announceStatus(Status::Stable); }
 
-    _calculationBackoffMs = _calculationBackoffMsDefault;
+    _oDecisionMeterMillis = meterValid ? std::optional<uint32_t>(meterMillis) : std::nullopt;
 }
 
 /**
@@ -380,13 +405,13 @@ int32_t PowerLimiterClass::inverterPowerDcToAc(std::shared_ptr<InverterAbstract>
  */
 void PowerLimiterClass::unconditionalSolarPassthrough(std::shared_ptr<InverterAbstract> inverter)
 {
-    if ((millis() - _lastCalculation) < _calculationBackoffMs) { return; }
-    _lastCalculation = millis();
+    if (_calculationGate.getRemainingBackoff(millis()) > 0) { return; }
+    _calculationGate.calculated(millis());
 
     auto const& config = Configuration.get();
 
     if (config.PowerLimiter.IsInverterSolarPowered) {
-        _calculationBackoffMs = 10 * 1000;
+        _calculationGate.setBackoff(10 * 1000);
         setNewPowerLimit(inverter, config.PowerLimiter.UpperPowerLimit);
         announceStatus(Status::UnconditionalSolarPassthrough);
         return;
@@ -397,7 +422,7 @@ void PowerLimiterClass::unconditionalSolarPassthrough(std::shared_ptr<InverterAb
         return;
     }
 
-    _calculationBackoffMs = 1 * 1000;
+    _calculationGate.setBackoff(1 * 1000);
     int32_t solarPower = VictronMppt.getPowerOutputWatts();
     setNewPowerLimit(inverter, inverterPowerDcToAc(inverter, solarPower));
     announceStatus(Status::UnconditionalSolarPassthrough);
@@ -442,12 +467,14 @@ bool PowerLimiterClass::calcPowerLimit(std::shared_ptr<InverterAbstract> inverte
         return shutdown(Status::NoEnergy);
     }
 
-    // We check if the PSU is on and disable the Power Limiter in this case.
-    // The PSU should reduce power or shut down first before the Power Limiter
-    // kicks in. The only case where this is not desired is if the battery is
-    // over the Full Solar Passthrough Threshold. In this case the Power
-    // Limiter should run and the PSU will shut down as a consequence.
-    if (!useFullSolarPassthrough() && HuaweiCan.getAutoPowerStatus()) {
+    // The energy flow decision tells whether the battery may be discharged
+    // or whether the Huawei PSU is (about to start) charging it. The PSU
+    // shuts down first before the Power Limiter kicks in. The only case
+    // where this is not desired is if the battery is over the Full Solar
+    // Passthrough Threshold. In this case the Power Limiter runs and the PSU
+    // is told to shut down.
+    if (!useFullSolarPassthrough() &&
+            EnergyFlow.getDecision().direction != EnergyFlowClass::Direction::Discharge) {
         return shutdown(Status::HuaweiPsu);
     }
 
@@ -481,54 +508,51 @@ bool PowerLimiterClass::calcPowerLimit(std::shared_ptr<InverterAbstract> inverte
                 solarPowerAC);
     }
 
-    auto newPowerLimit = baseLoad;
+    // the output of all inverters governed by the DPL
+    auto governedOutput = inverterOutput;
+    if (meterValid && meterIncludesInv) { governedOutput += getSecondaryInvertersOutput(); }
 
-    if (meterValid) {
-        newPowerLimit = meterValue;
+    auto newPowerLimit = PowerLimiterCalc::requiredPower(meterValid, meterValue,
+            meterIncludesInv, governedOutput, targetConsumption, baseLoad);
 
-        if (meterIncludesInv) {
-            // If the inverter is wired behind the power meter, i.e., if its
-            // output is part of the power meter measurement, the produced
-            // power of this inverter has to be taken into account.
-            newPowerLimit += inverterOutput;
-        }
-
-        newPowerLimit -= targetConsumption;
-    }
+    // the PI controller corrects the deviation of the grid power from the
+    // target, which is only observable if the power meter includes the
+    // output of the governed inverters.
+    bool usePi = meterValid && meterIncludesInv &&
+        static_cast<ControllerMode>(config.PowerLimiter.ControllerMode) == ControllerMode::PiFeedForward;
 
-    // Case 2:
-    if (!batteryPower) {
-        newPowerLimit = std::min(newPowerLimit, solarPowerAC);
+    bool fullSolarPassthrough = useFullSolarPassthrough();
+    auto bounds = PowerLimiterCalc::energySourceBounds(batteryPower,
+            fullSolarPassthrough, solarPowerAC);
 
-        // do not drain the battery. use as much power as needed to match the
-        // household consumption, but not more than the available solar power.
-        if (_verboseLogging) {
-            MessageOutput.printf("[DPL::calcPowerLimit] limited to solar power: %d W\r\n",
-                newPowerLimit);
-        }
+    if (usePi) {
+        auto base = PowerLimiterCalc::controllerBase(getGovernedLimit(inverter), governedOutput);
 
-        return setNewPowerLimit(inverter, newPowerLimit);
+        // the bounds applied below, such that the controller knows when its
+        // output saturates
+        newPowerLimit = calcControllerOutput(meterValue - targetConsumption,
+                base, std::max(0, bounds.lower),
+                std::min(getGovernedCapacity(inverter), bounds.upper));
+    } else {
+        _controller.reset();
     }
 
-    // Case 4:
-    // convert all solar power if full solar-passthrough is active
-    if (useFullSolarPassthrough()) {
-        newPowerLimit = std::max(newPowerLimit, solarPowerAC);
+    // Cases 2 and 4
+    newPowerLimit = std::clamp(newPowerLimit, bounds.lower, bounds.upper);
 
-        if (_verboseLogging) {
+    if (_verboseLogging) {
+        if (!batteryPower) {
+            MessageOutput.printf("[DPL::calcPowerLimit] limited to solar power: %d W\r\n",
+                newPowerLimit);
+        } else if (fullSolarPassthrough) {
             MessageOutput.printf("[DPL::calcPowerLimit] full solar-passthrough active: %d W\r\n",
                 newPowerLimit);
+        } else {
+            MessageOutput.printf("[DPL::calcPowerLimit] match household consumption with limit of %d W\r\n",
+                newPowerLimit);
         }
-
-        return setNewPowerLimit(inverter, newPowerLimit);
-    }
-
-    if (_verboseLogging) {
-        MessageOutput.printf("[DPL::calcPowerLimit] match household consumption with limit of %d W\r\n",
-            newPowerLimit);
     }
 
-    // Case 3:
     return setNewPowerLimit(inverter, newPowerLimit);
 }
 
@@ -659,6 +683,13 @@ bool PowerLimiterClass::updateInverter()
                         newRelativeLimit, currentRelativeLimit);
             }
 
+            _latencyStats.commandRoundTrip.record(lastLimitCommandMillis - *_oUpdateStartMillis);
+            if (_oDecisionMeterMillis.has_value()) {
+                _latencyStats.total.record(lastLimitCommandMillis - *_oDecisionMeterMillis);
+                _oDecisionMeterMillis = std::nullopt;
+            }
+            _oLimitConfirmedMillis = lastLimitCommandMillis;
+
             _oTargetPowerLimitWatts = std::nullopt;
             return false;
         }
@@ -684,6 +715,7 @@ bool PowerLimiterClass::updateInverter()
     if (switchPowerState(true)) { return true; }
 
     _inverterUpdateTimeouts = 0;
+    _lastUpdateDurationMs = millis() - *_oUpdateStartMillis;
 
     return reset();
 }
@@ -701,110 +733,71 @@ bool PowerLimiterClass::updateInverter()
  */
 static int32_t scalePowerLimit(std::shared_ptr<InverterAbstract> inverter, int32_t newLimit, int32_t currentLimitWatts, bool log)
 {
-    // prevent scaling if inverter is not producing, as input channels are not
-    // producing energy and hence are detected as not-producing, causing
-    // unreasonable scaling.
-    if (!inverter->isProducing()) { return newLimit; }
+    using PowerLimiterCalc::ScalingResult;
+
+    auto const& config = Configuration.get();
+    auto stats = inverter->Statistics();
+
+    PowerLimiterCalc::ScalingInput in;
+    in.newLimit = newLimit;
+    in.currentLimit = currentLimitWatts;
+    in.producing = inverter->isProducing();
 
-    std::list<ChannelNum_t> dcChnls = inverter->Statistics()->getChannelsByType(TYPE_DC);
-    size_t dcTotalChnls = dcChnls.size();
+    std::list<ChannelNum_t> dcChnls = stats->getChannelsByType(TYPE_DC);
+    for (auto& c : dcChnls) {
+        in.channelPowerDc.push_back(stats->getChannelFieldValue(TYPE_DC, c, FLD_PDC));
+    }
 
     // according to the upstream projects README (table with supported devs),
     // every 2 channel inverter has 2 MPPTs. then there are the HM*S* 4 channel
     // models which have 4 MPPTs. all others have a different number of MPPTs
     // than inputs. those are not supported by the current scaling mechanism.
-    bool supported = dcTotalChnls == 2;
-    supported |= dcTotalChnls == 4 && HMS_4CH::isValidSerial(inverter->serial());
-    if (!supported) { return newLimit; }
-
-    // test for a reasonable power limit that allows us to assume that an input
-    // channel with little energy is actually not producing, rather than
-    // producing very little due to the very low limit.
-    if (currentLimitWatts < dcTotalChnls * 10) { return newLimit; }
-
-    auto const& config = Configuration.get();
-    auto allowOverscaling = config.PowerLimiter.UseOverscalingToCompensateShading;
-    auto isInverterSolarPowered = config.PowerLimiter.IsInverterSolarPowered;
+    in.mpptPerInput = dcChnls.size() == 2;
+    in.mpptPerInput |= dcChnls.size() == 4 && HMS_4CH::isValidSerial(inverter->serial());
 
     // overscalling allows us to compensate for shaded panels by increasing the
     // total power limit, if the inverter is solar powered.
-    if (allowOverscaling && isInverterSolarPowered) {
-        auto inverterOutputAC = inverter->Statistics()->getChannelFieldValue(TYPE_AC, CH0, FLD_PAC);
-        float inverterEfficiencyFactor = getInverterEfficiency(inverter);
+    in.overscaling = config.PowerLimiter.UseOverscalingToCompensateShading
+        && config.PowerLimiter.IsInverterSolarPowered;
+    in.inverterOutputAc = stats->getChannelFieldValue(TYPE_AC, CH0, FLD_PAC);
+    in.efficiencyFactor = getInverterEfficiency(inverter);
 
-        // 98% of the expected power is good enough
-        auto expectedAcPowerPerChannel = (currentLimitWatts / dcTotalChnls) * 0.98;
+    auto result = PowerLimiterCalc::scaleLimit(in);
 
-        if (log) {
-            MessageOutput.printf("[DPL::scalePowerLimit] expected AC power per channel %f W\r\n",
-                    expectedAcPowerPerChannel);
-        }
-
-        size_t dcShadedChnls = 0;
-        auto shadedChannelACPowerSum = 0.0;
+    if (log && in.overscaling && result.affectedInputs > 0) {
+        MessageOutput.printf("[DPL::scalePowerLimit] expected AC power per channel %f W\r\n",
+                PowerLimiterCalc::expectedAcPowerPerInput(currentLimitWatts, dcChnls.size()));
 
+        size_t idx = 0;
         for (auto& c : dcChnls) {
-            auto channelPowerAC = inverter->Statistics()->getChannelFieldValue(TYPE_DC, c, FLD_PDC) * inverterEfficiencyFactor;
-
-            if (channelPowerAC < expectedAcPowerPerChannel) {
-                dcShadedChnls++;
-                shadedChannelACPowerSum += channelPowerAC;
-            }
+            MessageOutput.printf("[DPL::scalePowerLimit] ch %d AC power %f W\r\n",
+                    c, in.channelPowerDc[idx++] * in.efficiencyFactor);
+        }
+    }
 
+    switch (result.method) {
+        case ScalingResult::Method::KeepCurrent:
             if (log) {
-                MessageOutput.printf("[DPL::scalePowerLimit] ch %d AC power %f W\r\n",
-                        c, channelPowerAC);
+                MessageOutput.printf("[DPL::scalePowerLimit] all channels are shaded, "
+                        "keeping the current limit of %d W\r\n", currentLimitWatts);
             }
-        }
-
-        // no shading or the shaded channels provide more power than what
-        // we currently need.
-        if (dcShadedChnls == 0 || shadedChannelACPowerSum >= newLimit) { return newLimit; }
-
-        if (dcShadedChnls == dcTotalChnls) {
-            // keep the currentLimit when:
-            // - all channels are shaded
-            // - currentLimit >= newLimit
-            // - we get the expected AC power or less and
-            if (currentLimitWatts >= newLimit && inverterOutputAC <= newLimit) {
-                if (log) {
-                    MessageOutput.printf("[DPL::scalePowerLimit] all channels are shaded, "
-                            "keeping the current limit of %d W\r\n", currentLimitWatts);
-                }
-
-                return currentLimitWatts;
-
-            } else {
-                return newLimit;
+            break;
+        case ScalingResult::Method::Overscaling:
+            if (log) {
+                MessageOutput.printf("[DPL::scalePowerLimit] %d/%d channels are shaded, "
+                        "scaling %d W\r\n", result.affectedInputs, dcChnls.size(), result.limit);
             }
-        }
-
-        size_t dcNonShadedChnls = dcTotalChnls - dcShadedChnls;
-        auto overScaledLimit = static_cast<int32_t>((newLimit - shadedChannelACPowerSum) / dcNonShadedChnls * dcTotalChnls);
-
-        if (overScaledLimit <= newLimit) { return newLimit; }
-
-        if (log) {
-            MessageOutput.printf("[DPL::scalePowerLimit] %d/%d channels are shaded, "
-                    "scaling %d W\r\n", dcShadedChnls, dcTotalChnls, overScaledLimit);
-        }
-
-        return overScaledLimit;
-    }
-
-    size_t dcProdChnls = 0;
-    for (auto& c : dcChnls) {
-        if (inverter->Statistics()->getChannelFieldValue(TYPE_DC, c, FLD_PDC) > 2.0) {
-            dcProdChnls++;
-        }
+            break;
+        case ScalingResult::Method::ProducingInputs:
+            MessageOutput.printf("[DPL::scalePowerLimit] %d/%d channels are producing, "
+                    "scaling from %d to %d W\r\n", dcChnls.size() - result.affectedInputs,
+                    dcChnls.size(), newLimit, result.limit);
+            break;
+        case ScalingResult::Method::None:
+            break;
     }
 
-    if (dcProdChnls == 0 || dcProdChnls == dcTotalChnls) { return newLimit; }
-
-    auto scaled = static_cast<int32_t>(newLimit * static_cast<float>(dcTotalChnls) / dcProdChnls);
-    MessageOutput.printf("[DPL::scalePowerLimit] %d/%d channels are producing, "
-            "scaling from %d to %d W\r\n", dcProdChnls, dcTotalChnls, newLimit, scaled);
-    return scaled;
+    return result.limit;
 }
 
 /**
@@ -826,16 +819,23 @@ bool PowerLimiterClass::setNewPowerLimit(std::shared_ptr<InverterAbstract> inver
                 newPowerLimit, lowerLimit, upperLimit, hysteresis);
     }
 
-    if (newPowerLimit < lowerLimit) {
-        if (!config.PowerLimiter.IsInverterSolarPowered) {
-            return shutdown(Status::CalculatedLimitBelowMinLimit);
-        }
+    auto oPowerLimit = PowerLimiterCalc::applyLowerLimit(newPowerLimit,
+            lowerLimit, config.PowerLimiter.IsInverterSolarPowered);
 
+    if (!oPowerLimit.has_value()) {
+        return shutdown(Status::CalculatedLimitBelowMinLimit);
+    }
+
+    if (*oPowerLimit != newPowerLimit) {
         MessageOutput.println("[DPL::setNewPowerLimit] keep solar-powered "
                 "inverter running at min limit");
-        newPowerLimit = lowerLimit;
+        newPowerLimit = *oPowerLimit;
     }
 
+    // hand out shares of the total limit to all other governed inverters,
+    // the remainder is the share of the inverter selected in the config.
+    newPowerLimit = distributePowerLimit(inverter, newPowerLimit);
+
     // enforce configured upper power limit
     int32_t effPowerLimit = std::min(newPowerLimit, upperLimit);
 
@@ -850,16 +850,14 @@ bool PowerLimiterClass::setNewPowerLimit(std::shared_ptr<InverterAbstract> inver
 
     effPowerLimit = std::min<int32_t>(effPowerLimit, maxPower);
 
-    auto diff = std::abs(currentLimitAbs - effPowerLimit);
-
     if (_verboseLogging) {
         MessageOutput.printf("[DPL::setNewPowerLimit] inverter max: %d W, "
                 "inverter %s producing, requesting: %d W, reported: %d W, "
                 "diff: %d W\r\n", maxPower, (inverter->isProducing()?"is":"is NOT"),
-                effPowerLimit, currentLimitAbs, diff);
+                effPowerLimit, currentLimitAbs, std::abs(currentLimitAbs - effPowerLimit));
     }
 
-    if (diff > hysteresis) {
+    if (PowerLimiterCalc::exceedsHysteresis(effPowerLimit, currentLimitAbs, hysteresis)) {
         _oTargetPowerLimitWatts = effPowerLimit;
     }
 
@@ -867,6 +865,351 @@ bool PowerLimiterClass::setNewPowerLimit(std::shared_ptr<InverterAbstract> inver
     return updateInverter();
 }
 
+std::shared_ptr<InverterAbstract> PowerLimiterClass::getConfiguredInverter() const
+{
+    auto const& config = Configuration.get();
+
+    auto inv = Hoymiles.getInverterBySerial(config.PowerLimiter.InverterId);
+
+    if (inv == nullptr && config.PowerLimiter.InverterId < INV_MAX_COUNT) {
+        // we previously had an index saved as InverterId. fall back to the
+        // respective positional lookup if InverterId is not a known serial.
+        inv = Hoymiles.getInverterByPos(config.PowerLimiter.InverterId);
+    }
+
+    return inv;
+}
+
+bool PowerLimiterClass::isGovernedInverterProducing()
+{
+    auto inv = getConfiguredInverter();
+    if (inv != nullptr && inv->isProducing()) { return true; }
+
+    for (auto const& secondary : getSecondaryInverters()) {
+        if (secondary->isProducing()) { return true; }
+    }
+
+    return false;
+}
+
+/**
+ * returns all inverters besides the target inverter which take part in the
+ * power limit distribution. those are all inverters which are polled and
+ * which allow sending commands, if the distribution is enabled at all.
+ */
+std::vector<std::shared_ptr<InverterAbstract>> PowerLimiterClass::getSecondaryInverters()
+{
+    std::vector<std::shared_ptr<InverterAbstract>> res;
+
+    auto const& config = Configuration.get();
+    if (!config.PowerLimiter.DistributeOverAllInverters) { return res; }
+
+    for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
+        auto inv = Hoymiles.getInverterByPos(i);
+        if (inv == nullptr) { continue; }
+        if (_inverter != nullptr && inv->serial() == _inverter->serial()) { continue; }
+        if (!inv->getEnablePolling() || !inv->getEnableCommands()) { continue; }
+        res.push_back(inv);
+    }
+
+    return res;
+}
+
+int32_t PowerLimiterClass::getSecondaryInvertersOutput()
+{
+    int32_t res = 0;
+
+    for (auto const& inv : getSecondaryInverters()) {
+        if (!inv->isReachable()) { continue; }
+        res += static_cast<int32_t>(inv->Statistics()->getChannelFieldValue(TYPE_AC, CH0, FLD_PAC));
+    }
+
+    return res;
+}
+
+/**
+ * splits the total power limit (bounded by the upper power limit and by the
+ * summed capacity of the participating inverters) between the target inverter
+ * and all secondary inverters. the shares are proportional to each inverter's
+ * capacity, such that all inverters run at the same limit relative to their
+ * capacity. the inverters' current relative limits are not used as weights:
+ * they are the result of previous distributions, so an inverter throttled
+ * once would keep receiving a smaller share. an inverter whose share would be
+ * less than the lower power limit does not take part and is shut down. the
+ * secondary inverters are commanded right away, such that all inverters
+ * approach the new setpoint within the same polling round. returns the share
+ * of the target inverter.
+ */
+int32_t PowerLimiterClass::distributePowerLimit(std::shared_ptr<InverterAbstract> primary, int32_t totalLimit)
+{
+    auto secondaries = getSecondaryInverters();
+    if (secondaries.empty()) { return totalLimit; }
+
+    // the secondary inverters are in use again, a future shutdown must
+    // command them once more.
+    _secondariesShutdown = false;
+
+    auto const& config = Configuration.get();
+    auto lowerLimit = config.PowerLimiter.LowerPowerLimit;
+    totalLimit = std::min<int32_t>(totalLimit, config.PowerLimiter.UpperPowerLimit);
+
+    struct Participant {
+        std::shared_ptr<InverterAbstract> inverter;
+        int32_t capacity;
+        int32_t share;
+    };
+
+    // unreachable inverters and inverters whose max power is not yet known
+    // cannot take a share. we can not send them any commands either.
+    auto getParticipant = [&config](std::shared_ptr<InverterAbstract> const& inv, bool isPrimary) -> Participant {
+        Participant res { inv, 0, 0 };
+        if (!isPrimary && !inv->isReachable()) { return res; }
+
+        res.capacity = inv->DevInfo()->getMaxPower();
+        if (isPrimary) {
+            res.capacity = std::min<int32_t>(config.PowerLimiter.UpperPowerLimit, res.capacity);
+        }
+
+        return res;
+    };
+
+    std::vector<Participant> participants;
+    participants.push_back(getParticipant(primary, true));
+    for (auto const& inv : secondaries) {
+        auto participant = getParticipant(inv, false);
+        if (participant.capacity > 0) { participants.push_back(participant); }
+    }
+
+    std::vector<int32_t> capacities;
+    for (auto const& p : participants) { capacities.push_back(p.capacity); }
+
+    auto shares = PowerLimiterCalc::distributeLimit(totalLimit, capacities, lowerLimit);
+
+    // secondary inverters whose share would be less than the lower power
+    // limit are shut down.
+    std::vector<std::shared_ptr<InverterAbstract>> idle;
+    for (size_t i = participants.size(); i-- > 1;) {
+        if (shares[i].has_value()) {
+            participants[i].share = *shares[i];
+            continue;
+        }
+
+        idle.push_back(participants[i].inverter);
+        participants.erase(participants.begin() + i);
+    }
+    participants.front().share = *shares.front();
+
+    for (auto const& inv : idle) {
+        if (_verboseLogging) {
+            MessageOutput.printf("[DPL::distributePowerLimit] %s: share below "
+                    "min limit, shutting down\r\n", inv->serialString().c_str());
+        }
+
+        updateSecondaryInverter(inv, std::nullopt, false);
+    }
+
+    for (auto it = participants.begin() + 1; it != participants.end(); ++it) {
+        if (_verboseLogging) {
+            MessageOutput.printf("[DPL::distributePowerLimit] %s: capacity "
+                    "%d W, share %d W\r\n", it->inverter->serialString().c_str(),
+                    it->capacity, it->share);
+        }
+
+        updateSecondaryInverter(it->inverter, it->share, true);
+    }
+
+    auto remaining = participants.front().share;
+
+    if (_verboseLogging) {
+        MessageOutput.printf("[DPL::distributePowerLimit] total limit %d W, "
+                "%d of %d secondary inverter(s) in use, target inverter share "
+                "%d W\r\n", totalLimit, participants.size() - 1,
+                secondaries.size(), remaining);
+    }
+
+    return remaining;
+}
+
+/**
+ * sends a limit and/or power command to a secondary inverter if its current
+ * state does not match the requested state. other than the target inverter,
+ * secondary inverters are not tracked until the change was confirmed, as the
+ * next calculation will issue the respective commands again if required.
+ * returns false if the inverter's state could not be taken care of, i.e., it
+ * is unreachable or its power state is not known yet, true otherwise.
+ */
+bool PowerLimiterClass::updateSecondaryInverter(std::shared_ptr<InverterAbstract> inverter,
+        std::optional<int32_t> oLimitWatts, bool powerOn)
+{
+    if (!inverter->getEnableCommands()) { return true; }
+    if (!inverter->isReachable()) { return false; }
+
+    auto constexpr halfOfAllMillis = std::numeric_limits<uint32_t>::max() / 2;
+
+    // we need statistics that are more recent than the last power update
+    // command to reliably use inverter->isProducing()
+    auto lastPowerCommandMillis = inverter->PowerCommand()->getLastUpdateCommand();
+    auto lastStatisticsMillis = inverter->Statistics()->getLastUpdate();
+    bool powerStateKnown = (lastStatisticsMillis - lastPowerCommandMillis) < halfOfAllMillis;
+    bool powerCmdPending = CMD_PENDING == inverter->PowerCommand()->getLastPowerCommandSuccess();
+    bool switchPowerState = powerStateKnown && !powerCmdPending &&
+        inverter->isProducing() != powerOn;
+
+    if (!powerOn) {
+        if (switchPowerState) {
+            MessageOutput.printf("[DPL::updateSecondaryInverter] %s: Stopping inverter...\r\n",
+                    inverter->serialString().c_str());
+            inverter->sendPowerControlRequest(false);
+        }
+        return powerStateKnown || powerCmdPending;
+    }
+
+    if (oLimitWatts.has_value() &&
+            CMD_PENDING != inverter->SystemConfigPara()->getLastLimitCommandSuccess()) {
+        auto const& config = Configuration.get();
+        auto maxPower = inverter->DevInfo()->getMaxPower();
+        auto currentLimitAbs = static_cast<int32_t>(
+                inverter->SystemConfigPara()->getLimitPercent() * maxPower / 100);
+
+        if (PowerLimiterCalc::exceedsHysteresis(*oLimitWatts, currentLimitAbs,
+                    config.PowerLimiter.TargetPowerConsumptionHysteresis)) {
+            auto newRelativeLimit = static_cast<float>(*oLimitWatts * 100) / maxPower;
+
+            MessageOutput.printf("[DPL::updateSecondaryInverter] %s: sending limit "
+                    "of %.1f %% (%d W respectively), max output is %d W\r\n",
+                    inverter->serialString().c_str(), newRelativeLimit,
+                    *oLimitWatts, maxPower);
+
+            inverter->sendActivePowerControlRequest(newRelativeLimit,
+                    PowerLimitControlType::RelativNonPersistent);
+        }
+    }
+
+    if (switchPowerState) {
+        MessageOutput.printf("[DPL::updateSecondaryInverter] %s: Starting inverter...\r\n",
+                inverter->serialString().c_str());
+        inverter->sendPowerControlRequest(true);
+    }
+
+    return powerStateKnown || powerCmdPending;
+}
+
+/**
+ * the inverters governed by the DPL are polled at the base poll interval, as
+ * the DPL can only act on fresh inverter stats. all other inverters share the
+ * remaining radio airtime.
+ */
+void PowerLimiterClass::updatePollPriority()
+{
+    auto const& config = Configuration.get();
+
+    bool active = config.PowerLimiter.Enabled && Mode::Disabled != _mode;
+
+    auto primary = getConfiguredInverter();
+
+    for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
+        auto inv = Hoymiles.getInverterByPos(i);
+        if (inv == nullptr) { continue; }
+
+        bool governed = (primary != nullptr && inv->serial() == primary->serial())
+            || (config.PowerLimiter.DistributeOverAllInverters
+                && inv->getEnablePolling() && inv->getEnableCommands());
+
+        inv->Schedule()->setHighPriority(active && governed);
+    }
+}
+
+/**
+ * commands all secondary inverters to stop producing. returns true if this
+ * was taken care of for all of them, false if some inverter could not be
+ * commanded yet (e.g., it is unreachable or its power state is unknown).
+ */
+bool PowerLimiterClass::shutdownSecondaryInverters()
+{
+    bool res = true;
+
+    for (auto const& inv : getSecondaryInverters()) {
+        res &= updateSecondaryInverter(inv, std::nullopt, false);
+    }
+
+    return res;
+}
+
+/**
+ * the maximum total power limit, i.e., the capacity of the target inverter
+ * and all secondary inverters, bounded by the upper power limit.
+ */
+int32_t PowerLimiterClass::getGovernedCapacity(std::shared_ptr<InverterAbstract> primary)
+{
+    auto const& config = Configuration.get();
+    int32_t res = primary->DevInfo()->getMaxPower();
+
+    for (auto const& inv : getSecondaryInverters()) {
+        if (!inv->isReachable()) { continue; }
+        res += inv->DevInfo()->getMaxPower();
+    }
+
+    // the total limit is bounded by the upper power limit before it is
+    // distributed, see distributePowerLimit().
+    return std::min<int32_t>(res, config.PowerLimiter.UpperPowerLimit);
+}
+
+/**
+ * the sum of the limits confirmed by the producing governed inverters. the
+ * limit of an inverter which does not produce does not contribute to the
+ * grid power.
+ */
+int32_t PowerLimiterClass::getGovernedLimit(std::shared_ptr<InverterAbstract> primary)
+{
+    auto getLimit = [](std::shared_ptr<InverterAbstract> const& inv) -> int32_t {
+        if (!inv->isProducing()) { return 0; }
+        return static_cast<int32_t>(inv->SystemConfigPara()->getLimitPercent()
+                * inv->DevInfo()->getMaxPower() / 100);
+    };
+
+    int32_t res = getLimit(primary);
+
+    for (auto const& inv : getSecondaryInverters()) {
+        if (!inv->isReachable()) { continue; }
+        res += getLimit(inv);
+    }
+
+    return res;
+}
+
+/**
+ * calculates the total power limit using the PI controller, starting from the
+ * limit confirmed by the governed inverters (see controllerBase()). new limits
+ * are only calculated after the inverter reported stats and the power meter
+ * provided a reading taken after the previous limit was applied, so the dead
+ * time of both is part of the controller's sample period.
+ */
+int32_t PowerLimiterClass::calcControllerOutput(int32_t error, int32_t base,
+        int32_t lower, int32_t upper)
+{
+    auto const& config = Configuration.get();
+    _controller.setTuning(config.PowerLimiter.ControllerKp, config.PowerLimiter.ControllerKi);
+
+    auto output = _controller.update(error, base, lower, upper);
+
+    if (_verboseLogging) {
+        MessageOutput.printf("[DPL::calcControllerOutput] error: %d W, "
+                "base: %d W, bounds: [%d, %d] W, output: %d W\r\n",
+                error, base, lower, upper, output);
+    }
+
+    return output;
+}
+
+void PowerLimiterClass::resetLatencyStats()
+{
+    _latencyStats.meterAge.reset();
+    _latencyStats.calculation.reset();
+    _latencyStats.commandRoundTrip.reset();
+    _latencyStats.statsSettling.reset();
+    _latencyStats.total.reset();
+}
+
 int32_t PowerLimiterClass::getSolarPower()
 {
     auto const& config = Configuration.get();
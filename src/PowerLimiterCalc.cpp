@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "PowerLimiterCalc.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace PowerLimiterCalc {
+
+int32_t requiredPower(bool meterValid, int32_t meterValue,
+        bool meterIncludesInverters, int32_t governedInvertersOutput,
+        int32_t targetConsumption, int32_t baseLoad)
+{
+    if (!meterValid) { return baseLoad; }
+
+    auto power = meterValue;
+
+    // If the inverters are wired behind the power meter, i.e., if their
+    // output is part of the power meter measurement, the produced power of
+    // the inverters has to be taken into account.
+    if (meterIncludesInverters) { power += governedInvertersOutput; }
+
+    return power - targetConsumption;
+}
+
+CalculationGate::State CalculationGate::check(uint32_t now,
+        uint32_t lastUpdateCommand, uint32_t lastStats,
+        bool meterValid, uint32_t meterMillis)
+{
+    // we need inverter stats younger than the last update command
+    if (_oStatsMillis.has_value() && lastUpdateCommand > *_oStatsMillis) {
+        _oStatsMillis = std::nullopt;
+    }
+
+    if (!_oStatsMillis.has_value()) {
+        if (lastStats <= lastUpdateCommand) { return State::StatsPending; }
+        _oStatsMillis = lastStats;
+    }
+
+    // if the power meter is being used, i.e., if its data is valid, we want to
+    // wait for a new reading after adjusting the inverter limit. otherwise, we
+    // proceed as we will use a fallback limit independent of the power meter.
+    // the power meter reading is expected to be at most 2 seconds old when it
+    // arrives. this can be the case for readings provided by networked meter
+    // readers, where a packet needs to travel through the network for some
+    // time after the actual measurement was done by the reader.
+    if (meterValid && meterMillis <= (*_oStatsMillis + 2000)) {
+        return State::MeterPending;
+    }
+
+    if (getRemainingBackoff(now) > 0) { return State::Backoff; }
+
+    return State::Ready;
+}
+
+uint32_t CalculationGate::getRemainingBackoff(uint32_t now) const
+{
+    // since _lastCalculation is initialized to zero, the backoff period has
+    // passed the first time this is checked (after boot).
+    auto elapsed = now - _lastCalculation;
+    if (elapsed >= _backoffMs) { return 0; }
+    return _backoffMs - elapsed;
+}
+
+void CalculationGate::adaptBackoff(bool limitUpdated)
+{
+    if (limitUpdated) {
+        _backoffMs = _backoffMsDefault;
+        return;
+    }
+
+    // increase the backoff if the system seems to be stable
+    _backoffMs = std::min(_backoffMsMax, _backoffMs * 2);
+}
+
+Bounds energySourceBounds(bool batteryPower, bool fullSolarPassthrough, int32_t solarPowerAC)
+{
+    Bounds res { std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max() };
+
+    // do not drain the battery. use as much power as needed to match the
+    // household consumption, but not more than the available solar power.
+    if (!batteryPower) {
+        res.upper = solarPowerAC;
+        return res;
+    }
+
+    // convert all solar power if full solar-passthrough is active
+    if (fullSolarPassthrough) { res.lower = solarPowerAC; }
+
+    return res;
+}
+
+std::optional<int32_t> applyLowerLimit(int32_t limit, int32_t lowerLimit, bool solarPowered)
+{
+    if (limit >= lowerLimit) { return limit; }
+    if (!solarPowered) { return std::nullopt; }
+    return lowerLimit;
+}
+
+bool exceedsHysteresis(int32_t limit, int32_t currentLimit, int32_t hysteresis)
+{
+    return std::abs(currentLimit - limit) > hysteresis;
+}
+
+std::vector<std::optional<int32_t>> distributeLimit(int32_t totalLimit,
+        std::vector<int32_t> const& capacities, int32_t lowerLimit)
+{
+    std::vector<std::optional<int32_t>> shares(capacities.size());
+    if (capacities.empty()) { return shares; }
+
+    std::vector<size_t> participants;
+    for (size_t i = 0; i < capacities.size(); ++i) { participants.push_back(i); }
+
+    auto calcShares = [&]() {
+        int64_t totalCapacity = 0;
+        for (auto i : participants) { totalCapacity += capacities[i]; }
+
+        auto limit = static_cast<int32_t>(std::min<int64_t>(totalLimit, totalCapacity));
+
+        int32_t remaining = limit;
+        for (auto i : participants) {
+            shares[i] = static_cast<int32_t>(static_cast<int64_t>(limit) * capacities[i] / totalCapacity);
+            remaining -= *shares[i];
+        }
+
+        *shares.front() += remaining;
+    };
+
+    while (true) {
+        calcShares();
+        if (participants.size() < 2) { break; }
+
+        auto smallest = std::min_element(participants.begin() + 1, participants.end(),
+            [&shares](size_t a, size_t b) {
+                return *shares[a] < *shares[b];
+            });
+
+        if (*shares[*smallest] >= lowerLimit && *shares.front() >= lowerLimit) {
+            break;
+        }
+
+        shares[*smallest] = std::nullopt;
+        participants.erase(smallest);
+    }
+
+    return shares;
+}
+
+float expectedAcPowerPerInput(int32_t currentLimit, size_t inputs)
+{
+    // 98% of the expected power is good enough
+    return (currentLimit / static_cast<int32_t>(inputs)) * 0.98;
+}
+
+ScalingResult scaleLimit(ScalingInput const& in)
+{
+    ScalingResult result;
+    result.limit = in.newLimit;
+
+    // prevent scaling if inverter is not producing, as input channels are not
+    // producing energy and hence are detected as not-producing, causing
+    // unreasonable scaling.
+    if (!in.producing || !in.mpptPerInput) { return result; }
+
+    size_t dcTotalChnls = in.channelPowerDc.size();
+
+    // test for a reasonable power limit that allows us to assume that an input
+    // channel with little energy is actually not producing, rather than
+    // producing very little due to the very low limit.
+    if (in.currentLimit < static_cast<int32_t>(dcTotalChnls * 10)) { return result; }
+
+    // overscalling allows us to compensate for shaded panels by increasing the
+    // total power limit.
+    if (in.overscaling) {
+        auto expectedAcPowerPerChannel = expectedAcPowerPerInput(in.currentLimit, dcTotalChnls);
+
+        size_t dcShadedChnls = 0;
+        auto shadedChannelACPowerSum = 0.0;
+
+        for (auto powerDc : in.channelPowerDc) {
+            auto channelPowerAC = powerDc * in.efficiencyFactor;
+
+            if (channelPowerAC < expectedAcPowerPerChannel) {
+                dcShadedChnls++;
+                shadedChannelACPowerSum += channelPowerAC;
+            }
+        }
+
+        result.affectedInputs = dcShadedChnls;
+
+        // no shading or the shaded channels provide more power than what
+        // we currently need.
+        if (dcShadedChnls == 0 || shadedChannelACPowerSum >= in.newLimit) { return result; }
+
+        if (dcShadedChnls == dcTotalChnls) {
+            // keep the currentLimit when:
+            // - all channels are shaded
+            // - currentLimit >= newLimit
+            // - we get the expected AC power or less and
+            if (in.currentLimit >= in.newLimit && in.inverterOutputAc <= in.newLimit) {
+                result.limit = in.currentLimit;
+                result.method = ScalingResult::Method::KeepCurrent;
+            }
+
+            return result;
+        }
+
+        size_t dcNonShadedChnls = dcTotalChnls - dcShadedChnls;
+        auto overScaledLimit = static_cast<int32_t>((in.newLimit - shadedChannelACPowerSum) / dcNonShadedChnls * dcTotalChnls);
+
+        if (overScaledLimit <= in.newLimit) { return result; }
+
+        result.limit = overScaledLimit;
+        result.method = ScalingResult::Method::Overscaling;
+        return result;
+    }
+
+    size_t dcProdChnls = 0;
+    for (auto powerDc : in.channelPowerDc) {
+        if (powerDc > 2.0) { dcProdChnls++; }
+    }
+
+    result.affectedInputs = dcTotalChnls - dcProdChnls;
+
+    if (dcProdChnls == 0 || dcProdChnls == dcTotalChnls) { return result; }
+
+    result.limit = static_cast<int32_t>(in.newLimit * static_cast<float>(dcTotalChnls) / dcProdChnls);
+    result.method = ScalingResult::Method::ProducingInputs;
+    return result;
+}
+
+int32_t controllerBase(int32_t confirmedLimit, int32_t measuredOutput)
+{
+    if (measuredOutput < confirmedLimit * 0.8f) { return measuredOutput; }
+    return confirmedLimit;
+}
+
+int32_t PiController::update(float error, float base, int32_t lower, int32_t upper)
+{
+    upper = std::max(upper, lower);
+
+    float change = _oLastError.has_value() ? error - *_oLastError : 0;
+    _oLastError = error;
+
+    auto output = base + _ki * error + _kp * change;
+    output = std::clamp<float>(output, lower, upper);
+
+    return static_cast<int32_t>(std::lround(output));
+}
+
+} // namespace PowerLimiterCalc
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #include "PowerMeter.h"
 #include "Configuration.h"
+#include "PowerLimiter.h"
 #include "PowerMeterHttpJson.h"
 #include "PowerMeterHttpSml.h"
 #include "PowerMeterMqtt.h"
@@ -87,5 +88,14 @@ void PowerMeterClass::loop()
     std::lock_guard<std::mutex> lock(_mutex);
     if (!_upProvider) { return; }
     _upProvider->loop();
+
+    // most providers receive readings in their own task or through a
+    // network callback. we pass the news on from the scheduler's context.
+    auto lastUpdate = _upProvider->getLastUpdate();
+    if (lastUpdate != _lastUpdateNotified) {
+        _lastUpdateNotified = lastUpdate;
+        PowerLimiter.notify();
+    }
+
     _upProvider->mqttLoop();
 }
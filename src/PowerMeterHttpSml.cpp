@@ -5,6 +5,15 @@
 #include <base64.h>
 #include <ESPmDNS.h>
 
+PowerMeterHttpSml::PowerMeterHttpSml(PowerMeterHttpSmlConfig const& cfg)
+    : PowerMeterSml("PowerMeterHttpSml", POWERMETER_HTTP_SML_MAX_VALUES)
+    , _cfg(cfg)
+{
+    for (size_t i = 0; i < POWERMETER_HTTP_SML_MAX_VALUES; ++i) {
+        setSignInverted(i, _cfg.Values[i].SignInverted);
+    }
+}
+
 PowerMeterHttpSml::~PowerMeterHttpSml()
 {
     _taskDone = false;
@@ -23,16 +32,26 @@ PowerMeterHttpSml::~PowerMeterHttpSml()
 
 bool PowerMeterHttpSml::init()
 {
-    _upHttpGetter = std::make_unique<HttpGetter>(_cfg.HttpRequest);
+    for (uint8_t i = 0; i < POWERMETER_HTTP_SML_MAX_VALUES; i++) {
+        auto const& valueConfig = _cfg.Values[i];
+
+        _httpGetters[i] = nullptr;
+
+        if (i > 0 && !valueConfig.Enabled) { continue; }
 
-    if (_upHttpGetter->init()) { return true; }
+        _httpGetters[i] = std::make_unique<HttpGetter>(valueConfig.HttpRequest);
 
-    MessageOutput.printf("[PowerMeterHttpSml] Initializing HTTP getter failed:\r\n");
-    MessageOutput.printf("[PowerMeterHttpSml] %s\r\n", _upHttpGetter->getErrorText());
+        if (_httpGetters[i]->init()) { continue; }
 
-    _upHttpGetter = nullptr;
+        MessageOutput.printf("[PowerMeterHttpSml] Initializing HTTP getter for meter %d failed:\r\n", i + 1);
+        MessageOutput.printf("[PowerMeterHttpSml] %s\r\n", _httpGetters[i]->getErrorText());
 
-    return false;
+        _httpGetters[i] = nullptr;
+
+        return false;
+    }
+
+    return true;
 }
 
 void PowerMeterHttpSml::loop()
@@ -85,21 +104,53 @@ void PowerMeterHttpSml::pollingLoop()
     }
 }
 
+// the total is only valid while every enabled meter delivered recently
 bool PowerMeterHttpSml::isDataValid() const
 {
-    uint32_t age = millis() - getLastUpdate();
-    return getLastUpdate() > 0 && (age < (3 * _cfg.PollingInterval * 1000));
+    uint32_t maxAge = 3 * _cfg.PollingInterval * 1000;
+
+    for (size_t i = 0; i < POWERMETER_HTTP_SML_MAX_VALUES; ++i) {
+        if (!_httpGetters[i]) { continue; }
+
+        uint32_t lastUpdate = getMeterLastUpdate(i);
+        if (lastUpdate == 0 || (millis() - lastUpdate) >= maxAge) { return false; }
+    }
+
+    return true;
 }
 
+// every enabled meter is polled, even if polling another one failed. the
+// round only succeeds if every enabled meter delivered a complete datagram.
 String PowerMeterHttpSml::poll()
 {
-    if (!_upHttpGetter) {
+    if (!_httpGetters[0]) {
         return "Initialization of HTTP request failed";
     }
 
-    auto res = _upHttpGetter->performGetRequest();
+    String error;
+
+    for (uint8_t i = 0; i < POWERMETER_HTTP_SML_MAX_VALUES; i++) {
+        auto const& upHttpGetter = _httpGetters[i];
+        if (!upHttpGetter) { continue; }
+
+        auto meterError = pollMeter(i);
+        if (meterError.isEmpty()) { continue; }
+
+        if (!error.isEmpty()) { error += ", "; }
+        error += String("Meter ") + String(i + 1) + ": " + meterError;
+    }
+
+    return error;
+}
+
+String PowerMeterHttpSml::pollMeter(size_t meter)
+{
+    auto const& upHttpGetter = _httpGetters[meter];
+    uint32_t previousUpdate = getMeterLastUpdate(meter);
+
+    auto res = upHttpGetter->performGetRequest();
     if (!res) {
-        return _upHttpGetter->getErrorText();
+        return upHttpGetter->getErrorText();
     }
 
     auto pStream = res.getStream();
@@ -107,11 +158,18 @@ String PowerMeterHttpSml::poll()
         return "Programmer error: HTTP request yields no stream";
     }
 
+    uint8_t buffer[128];
     while (pStream->available()) {
-        processSmlByte(pStream->read());
+        size_t length = pStream->readBytes(buffer,
+                std::min<size_t>(pStream->available(), sizeof(buffer)));
+        processSmlData(meter, buffer, length);
     }
 
-    PowerMeterSml::reset();
+    PowerMeterSml::reset(meter);
+
+    if (getMeterLastUpdate(meter) == previousUpdate) {
+        return "No complete SML datagram received";
+    }
 
     return "";
 }
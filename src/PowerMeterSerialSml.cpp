@@ -109,8 +109,10 @@ void PowerMeterSerialSml::pollingLoop()
             continue;
         }
 
+        uint8_t buffer[64];
         while (_upSmlSerial->available() > 0) {
-            processSmlByte(_upSmlSerial->read());
+            size_t length = _upSmlSerial->read(buffer, sizeof(buffer));
+            processSmlData(0, buffer, length);
         }
 
         lastAvailable = 0;
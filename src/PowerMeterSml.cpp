@@ -1,71 +1,148 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #include "PowerMeterSml.h"
 #include "MessageOutput.h"
+#include <frozen/unordered_map.h>
 
 float PowerMeterSml::getPowerTotal() const
+{
+    float total = 0;
+
+    for (size_t i = 0; i < _meters.size(); ++i) {
+        total += getPowerTotal(i);
+    }
+
+    return total;
+}
+
+float PowerMeterSml::getPowerTotal(size_t meter) const
 {
     std::lock_guard<std::mutex> l(_mutex);
-    if (_values.activePowerTotal.has_value()) { return *_values.activePowerTotal; }
-    return 0;
+    if (meter >= _meters.size()) { return 0; }
+
+    auto const& m = _meters[meter];
+    if (!m.values.activePowerTotal.has_value()) { return 0; }
+    return m.signInverted ? -*m.values.activePowerTotal : *m.values.activePowerTotal;
 }
 
+// the values of additional meters are published in a subtopic per meter
 void PowerMeterSml::doMqttPublish() const
 {
+    std::lock_guard<std::mutex> l(_mutex);
+
+    for (size_t i = 0; i < _meters.size(); ++i) {
+        auto const& values = _meters[i].values;
+
+        String prefix;
+        if (i > 0) { prefix = "meter" + String(i + 1) + "/"; }
+
 #define PUB(t, m) \
-    if (_values.m.has_value()) { mqttPublish(t, *_values.m); }
+    if (values.m.has_value()) { mqttPublish(prefix + t, *values.m); }
 
-    std::lock_guard<std::mutex> l(_mutex);
-    PUB("power1", activePowerL1);
-    PUB("power2", activePowerL2);
-    PUB("power3", activePowerL3);
-    PUB("voltage1", voltageL1);
-    PUB("voltage2", voltageL2);
-    PUB("voltage3", voltageL3);
-    PUB("current1", currentL1);
-    PUB("current2", currentL2);
-    PUB("current3", currentL3);
-    PUB("import", energyImport);
-    PUB("export", energyExport);
+        if (i > 0) { PUB("powertotal", activePowerTotal); }
+        PUB("power1", activePowerL1);
+        PUB("power2", activePowerL2);
+        PUB("power3", activePowerL3);
+        PUB("voltage1", voltageL1);
+        PUB("voltage2", voltageL2);
+        PUB("voltage3", voltageL3);
+        PUB("current1", currentL1);
+        PUB("current2", currentL2);
+        PUB("current3", currentL3);
+        PUB("import", energyImport);
+        PUB("export", energyExport);
 
 #undef PUB
+    }
+}
+
+void PowerMeterSml::setSignInverted(size_t meter, bool inverted)
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    if (meter >= _meters.size()) { return; }
+    _meters[meter].signInverted = inverted;
+}
+
+uint32_t PowerMeterSml::getMeterLastUpdate(size_t meter) const
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    if (meter >= _meters.size()) { return 0; }
+    return _meters[meter].lastUpdate;
 }
 
-void PowerMeterSml::reset()
+void PowerMeterSml::reset(size_t meter)
 {
-    smlReset();
-    _cache = { std::nullopt };
+    if (meter >= _meters.size()) { return; }
+    _meters[meter].parser.reset();
+    _meters[meter].cache = { std::nullopt };
 }
 
-void PowerMeterSml::processSmlByte(uint8_t byte)
+void PowerMeterSml::processSmlData(size_t meter, uint8_t const* data, size_t length)
 {
-    switch (smlState(byte)) {
-        case SML_LISTEND:
-            for (auto& handler: smlHandlerList) {
-                if (!smlOBISCheck(handler.OBIS)) { continue; }
+    if (meter >= _meters.size()) { return; }
+    _meters[meter].parser.parse(data, length, *this);
+}
 
-                float helper = 0.0;
-                handler.decoder(helper);
+void PowerMeterSml::onSmlEvent(SmlParser& parser, sml_states_t state)
+{
+    static constexpr auto handlers = frozen::make_unordered_map<uint64_t, OBISHandler>({
+        { SmlParser::obisKey(0x01, 0x00, 0x10, 0x07, 0x00, 0xff), { &SmlParser::obisW, &values_t::activePowerTotal, "active power total" } },
+        { SmlParser::obisKey(0x01, 0x00, 0x24, 0x07, 0x00, 0xff), { &SmlParser::obisW, &values_t::activePowerL1, "active power L1" } },
+        { SmlParser::obisKey(0x01, 0x00, 0x38, 0x07, 0x00, 0xff), { &SmlParser::obisW, &values_t::activePowerL2, "active power L2" } },
+        { SmlParser::obisKey(0x01, 0x00, 0x4c, 0x07, 0x00, 0xff), { &SmlParser::obisW, &values_t::activePowerL3, "active power L3" } },
+        { SmlParser::obisKey(0x01, 0x00, 0x20, 0x07, 0x00, 0xff), { &SmlParser::obisVolt, &values_t::voltageL1, "voltage L1" } },
+        { SmlParser::obisKey(0x01, 0x00, 0x34, 0x07, 0x00, 0xff), { &SmlParser::obisVolt, &values_t::voltageL2, "voltage L2" } },
+        { SmlParser::obisKey(0x01, 0x00, 0x48, 0x07, 0x00, 0xff), { &SmlParser::obisVolt, &values_t::voltageL3, "voltage L3" } },
+        { SmlParser::obisKey(0x01, 0x00, 0x1f, 0x07, 0x00, 0xff), { &SmlParser::obisAmpere, &values_t::currentL1, "current L1" } },
+        { SmlParser::obisKey(0x01, 0x00, 0x33, 0x07, 0x00, 0xff), { &SmlParser::obisAmpere, &values_t::currentL2, "current L2" } },
+        { SmlParser::obisKey(0x01, 0x00, 0x47, 0x07, 0x00, 0xff), { &SmlParser::obisAmpere, &values_t::currentL3, "current L3" } },
+        { SmlParser::obisKey(0x01, 0x00, 0x01, 0x08, 0x00, 0xff), { &SmlParser::obisWh, &values_t::energyImport, "energy import" } },
+        { SmlParser::obisKey(0x01, 0x00, 0x02, 0x08, 0x00, 0xff), { &SmlParser::obisWh, &values_t::energyExport, "energy export" } }
+    });
 
-                if (_verboseLogging) {
-                    MessageOutput.printf("[%s] decoded %s to %.2f\r\n",
-                            _user.c_str(), handler.name, helper);
-                }
+    // the parser identifies the meter the event belongs to
+    size_t meter = 0;
+    while (meter < _meters.size() && &_meters[meter].parser != &parser) { ++meter; }
+    if (meter >= _meters.size()) { return; }
 
-                std::lock_guard<std::mutex> l(_mutex);
-                *handler.target = helper;
+    auto& cache = _meters[meter].cache;
+
+    switch (state) {
+        case SML_LISTEND: {
+            auto iter = handlers.find(parser.obisKey());
+            if (iter == handlers.end()) { break; }
+
+            auto const& handler = iter->second;
+            float helper = 0.0;
+            (parser.*handler.decoder)(helper);
+
+            if (_verboseLogging) {
+                MessageOutput.printf("[%s] meter %u: decoded %s to %.2f\r\n",
+                        _user.c_str(), static_cast<unsigned>(meter + 1), handler.name, helper);
             }
+
+            cache.*handler.target = helper;
             break;
-        case SML_FINAL:
-            gotUpdate();
-            _values = _cache;
-            reset();
-            MessageOutput.printf("[%s] TotalPower: %5.2f\r\n",
-                    _user.c_str(), getPowerTotal());
+        }
+        case SML_FINAL: {
+            {
+                std::lock_guard<std::mutex> l(_mutex);
+                _meters[meter].values = cache;
+                _meters[meter].lastUpdate = millis();
+            }
+
+            // with several meters, the total is only updated once all of
+            // them delivered new values, which the subclass keeps track of.
+            if (_meters.size() == 1) { gotUpdate(); }
+
+            reset(meter);
+            MessageOutput.printf("[%s] meter %u: TotalPower: %5.2f\r\n",
+                    _user.c_str(), static_cast<unsigned>(meter + 1), getPowerTotal(meter));
             break;
+        }
         case SML_CHECKSUM_ERROR:
-            reset();
-            MessageOutput.printf("[%s] checksum verification failed\r\n",
-                    _user.c_str());
+            reset(meter);
+            MessageOutput.printf("[%s] meter %u: checksum verification failed\r\n",
+                    _user.c_str(), static_cast<unsigned>(meter + 1));
             break;
         default:
             break;
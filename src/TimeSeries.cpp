@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "TimeSeries.h"
+#include <algorithm>
+#include <cmath>
+
+TimeSeries::TimeSeries(float resolution, std::vector<TimeSeries::TierConfig> const& tiers)
+    : _resolution(resolution)
+{
+    setTiers(tiers);
+}
+
+void TimeSeries::setTiers(std::vector<TimeSeries::TierConfig> const& tiers)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_allocated) { return; }
+
+    _tiers.clear();
+    for (auto const& config : tiers) {
+        Tier tier;
+        tier.config = config;
+        _tiers.push_back(std::move(tier));
+    }
+}
+
+int16_t TimeSeries::encode(float value) const
+{
+    auto scaled = std::lround(value / _resolution);
+    return static_cast<int16_t>(std::clamp<long>(scaled, NoData + 1,
+                std::numeric_limits<int16_t>::max()));
+}
+
+float TimeSeries::decode(int16_t value) const
+{
+    return value * _resolution;
+}
+
+TimeSeries::Aggregate TimeSeries::decode(TimeSeries::Bucket const& bucket) const
+{
+    Aggregate res;
+    if (bucket.avg == NoData) { return res; }
+
+    res.valid = true;
+    res.min = decode(bucket.min);
+    res.avg = decode(bucket.avg);
+    res.max = decode(bucket.max);
+    return res;
+}
+
+void TimeSeries::store(TimeSeries::Tier& tier)
+{
+    Bucket& bucket = tier.buckets[tier.head];
+    bucket = Bucket();
+
+    if (tier.count > 0) {
+        bucket.min = encode(tier.min);
+        bucket.avg = encode(tier.sum / tier.count);
+        bucket.max = encode(tier.max);
+    }
+
+    tier.head = (tier.head + 1) % tier.config.capacity;
+    tier.size = std::min(tier.size + 1, tier.config.capacity);
+
+    tier.sum = 0;
+    tier.count = 0;
+}
+
+void TimeSeries::advance(TimeSeries::Tier& tier, uint32_t now)
+{
+    uint32_t index = now / tier.config.period;
+    if (index <= tier.index) { return; }
+
+    // periods without any samples are stored as empty buckets. there is no
+    // need to store more than a whole ring of them.
+    uint32_t elapsed = std::min<uint32_t>(index - tier.index, tier.config.capacity);
+    for (uint32_t i = 0; i < elapsed; ++i) { store(tier); }
+
+    tier.index = index;
+}
+
+void TimeSeries::add(float value, uint32_t now)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_allocated) {
+        for (auto& tier : _tiers) {
+            tier.buckets = std::make_unique<Bucket[]>(tier.config.capacity);
+            tier.index = now / tier.config.period;
+        }
+        _allocated = true;
+    }
+
+    for (auto& tier : _tiers) {
+        advance(tier, now);
+
+        tier.min = (tier.count == 0) ? value : std::min(tier.min, value);
+        tier.max = (tier.count == 0) ? value : std::max(tier.max, value);
+        tier.sum += value;
+        ++tier.count;
+    }
+}
+
+void TimeSeries::update(uint32_t now)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_allocated) { return; }
+
+    for (auto& tier : _tiers) { advance(tier, now); }
+}
+
+uint32_t TimeSeries::getPeriod(size_t tier) const
+{
+    return _tiers[tier].config.period;
+}
+
+size_t TimeSeries::getCapacity(size_t tier) const
+{
+    return _tiers[tier].config.capacity;
+}
+
+size_t TimeSeries::getSize(size_t tier) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _tiers[tier].size;
+}
+
+uint32_t TimeSeries::getLastEnd(size_t tier) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _tiers[tier].index * _tiers[tier].config.period;
+}
+
+TimeSeries::Aggregate TimeSeries::get(size_t tier, size_t age) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto const& t = _tiers[tier];
+    if (age >= t.size) { return Aggregate(); }
+
+    auto capacity = t.config.capacity;
+    return decode(t.buckets[(t.head + capacity - 1 - age) % capacity]);
+}
+
+size_t TimeSeries::resample(uint32_t duration, TimeSeries::Aggregate* points, size_t count,
+        uint32_t* lastEnd, float* interval) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_allocated || _tiers.empty() || count == 0) { return 0; }
+
+    auto iter = std::find_if(_tiers.begin(), _tiers.end(), [duration](Tier const& t) {
+        return t.config.period * t.config.capacity >= duration;
+    });
+    auto const& tier = (iter != _tiers.end()) ? *iter : _tiers.back();
+
+    if (lastEnd != nullptr) { *lastEnd = tier.index * tier.config.period; }
+
+    size_t capacity = tier.config.capacity;
+    size_t needed = std::min<size_t>((duration + tier.config.period - 1) / tier.config.period, capacity);
+    size_t available = std::min(tier.size, needed);
+    if (available == 0) { return 0; }
+
+    // there is no point in more points than buckets
+    count = std::min(count, needed);
+
+    if (interval != nullptr) { *interval = static_cast<float>(needed * tier.config.period) / count; }
+
+    // bucket b (0 is the oldest of the needed buckets) contributes to slot
+    // b * count / needed. leading slots without stored buckets are omitted.
+    size_t firstBucket = needed - available;
+    size_t firstSlot = firstBucket * count / needed;
+
+    for (size_t slot = 0; slot < count - firstSlot; ++slot) { points[slot] = Aggregate(); }
+
+    size_t slot = firstSlot;
+    size_t samples = 0;
+    for (size_t b = firstBucket; b < needed; ++b) {
+        size_t bSlot = b * count / needed;
+        if (bSlot != slot) {
+            if (samples > 0) { points[slot - firstSlot].avg /= samples; }
+            slot = bSlot;
+            samples = 0;
+        }
+
+        size_t age = needed - 1 - b;
+        auto value = decode(tier.buckets[(tier.head + capacity - 1 - age) % capacity]);
+        if (!value.valid) { continue; }
+
+        auto& point = points[slot - firstSlot];
+        point.min = point.valid ? std::min(point.min, value.min) : value.min;
+        point.max = point.valid ? std::max(point.max, value.max) : value.max;
+        point.avg += value.avg;
+        point.valid = true;
+        ++samples;
+    }
+
+    if (samples > 0) { points[slot - firstSlot].avg /= samples; }
+
+    return count - firstSlot;
+}
@@ -3,6 +3,7 @@
 #include "Configuration.h"
 #include "PinMapping.h"
 #include "MessageOutput.h"
+#include "PowerLimiter.h"
 #include "SerialPortManager.h"
 
 VictronMpptClass VictronMppt;
@@ -19,27 +20,62 @@ void VictronMpptClass::init(Scheduler& scheduler)
 
 void VictronMpptClass::updateSettings()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    stopReceivers();
 
-    _controllers.clear();
     for (auto const& o: _serialPortOwners) {
         SerialPortManager.freePort(o.c_str());
     }
     _serialPortOwners.clear();
 
     CONFIG_T& config = Configuration.get();
-    if (!config.Vedirect.Enabled) { return; }
+    if (config.Vedirect.Enabled) {
+        const PinMapping_t& pin = PinMapping.get();
 
-    const PinMapping_t& pin = PinMapping.get();
+        initController(pin.victron_rx, pin.victron_tx,
+                config.Vedirect.VerboseLogging, 1);
 
-    initController(pin.victron_rx, pin.victron_tx,
-            config.Vedirect.VerboseLogging, 1);
+        initController(pin.victron_rx2, pin.victron_tx2,
+                config.Vedirect.VerboseLogging, 2);
 
-    initController(pin.victron_rx2, pin.victron_tx2,
-            config.Vedirect.VerboseLogging, 2);
+        initController(pin.victron_rx3, pin.victron_tx3,
+                config.Vedirect.VerboseLogging, 3);
+    }
+
+    // the receiver tasks are stopped, hence there are no concurrent writers
+    auto spEmpty = std::make_shared<ControllerSnapshot const>();
+    for (auto& spSnapshot : _snapshots) {
+        std::atomic_store(&spSnapshot, spEmpty);
+    }
+    _controllerCount = _receivers.size();
 
-    initController(pin.victron_rx3, pin.victron_tx3,
-            config.Vedirect.VerboseLogging, 3);
+    for (auto& upReceiver : _receivers) {
+        String name("VE.Direct ");
+        name += String(upReceiver->index + 1);
+
+        uint32_t constexpr stackSize = 4096;
+        xTaskCreate(VictronMpptClass::pollingLoopHelper, name.c_str(),
+                stackSize, upReceiver.get(), 1/*prio*/, &upReceiver->taskHandle);
+    }
+}
+
+void VictronMpptClass::stopReceivers()
+{
+    _controllerCount = 0;
+
+    for (auto& upReceiver : _receivers) {
+        upReceiver->stopPolling = true;
+    }
+
+    for (auto& upReceiver : _receivers) {
+        if (upReceiver->taskHandle != nullptr) {
+            xSemaphoreTake(upReceiver->stopped, portMAX_DELAY);
+            upReceiver->taskHandle = nullptr;
+        }
+
+        vSemaphoreDelete(upReceiver->stopped);
+    }
+
+    _receivers.clear();
 }
 
 bool VictronMpptClass::initController(int8_t rx, int8_t tx, bool logging,
@@ -53,6 +89,8 @@ bool VictronMpptClass::initController(int8_t rx, int8_t tx, bool logging,
         return false;
     }
 
+    if (_receivers.size() >= s_maxControllers) { return false; }
+
     String owner("Victron MPPT ");
     owner += String(instance);
     auto oHwSerialPort = SerialPortManager.allocatePort(owner.c_str());
@@ -60,62 +98,114 @@ bool VictronMpptClass::initController(int8_t rx, int8_t tx, bool logging,
 
     _serialPortOwners.push_back(owner);
 
-    auto upController = std::make_unique<VeDirectMpptController>();
-    upController->init(rx, tx, &MessageOutput, logging, *oHwSerialPort);
-    _controllers.push_back(std::move(upController));
+    auto upReceiver = std::make_unique<Receiver>();
+    upReceiver->upController = std::make_unique<VeDirectMpptController>();
+    upReceiver->upController->init(rx, tx, &MessageOutput, logging, *oHwSerialPort);
+    upReceiver->index = _receivers.size();
+    upReceiver->stopped = xSemaphoreCreateBinary();
+    _receivers.push_back(std::move(upReceiver));
     return true;
 }
 
-void VictronMpptClass::loop()
+void VictronMpptClass::pollingLoopHelper(void* context)
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    auto pReceiver = static_cast<Receiver*>(context);
+    VictronMppt.pollingLoop(*pReceiver);
 
-    for (auto const& upController : _controllers) {
-        upController->loop();
+    // the receiver is destroyed once the semaphore was given
+    xSemaphoreGive(pReceiver->stopped);
+    vTaskDelete(nullptr);
+}
+
+void VictronMpptClass::pollingLoop(Receiver& receiver)
+{
+    auto& controller = *receiver.upController;
+    uint32_t lastUpdate = controller.getLastUpdate();
+
+    while (!receiver.stopPolling) {
+        controller.loop();
+
+        if (controller.getLastUpdate() != lastUpdate) {
+            lastUpdate = controller.getLastUpdate();
+            publish(receiver.index, lastUpdate, controller.getData());
+        }
+
+        // at 19200 baud, about 20 bytes arrive within 10 ms, which is
+        // far less than the UART's receive buffer holds.
+        delay(10);
     }
 }
 
+// only the controller's own slot is replaced, hence the data of the other
+// controllers is neither copied nor locked.
+void VictronMpptClass::publish(size_t index, uint32_t lastUpdate,
+        VeDirectMpptController::data_t const& data)
+{
+    if (index >= _snapshots.size()) { return; }
+
+    auto spSnapshot = std::make_shared<ControllerSnapshot>();
+    spSnapshot->lastUpdate = lastUpdate;
+    spSnapshot->data = data;
+
+    std::atomic_store(&_snapshots[index], SnapshotPtr(std::move(spSnapshot)));
+    ++_publishCount;
+}
+
+VictronMpptClass::SnapshotPtr VictronMpptClass::getSnapshot(size_t idx) const
+{
+    return std::atomic_load(&_snapshots[idx]);
+}
+
+bool VictronMpptClass::ControllerSnapshot::isDataValid() const
+{
+    return strlen(data.serialNr_SER) > 0 && (millis() - lastUpdate) < (10 * 1000);
+}
+
+// the DPL is notified from the scheduler's task, as it must not be woken
+// up from the receiver tasks.
+void VictronMpptClass::loop()
+{
+    uint32_t publishCount = _publishCount;
+    if (publishCount == _publishCountNotified) { return; }
+
+    _publishCountNotified = publishCount;
+    PowerLimiter.notify();
+}
+
 /*
  * isDataValid()
  * return: true = if at least one of the MPPT controllers delivers valid data
  */
 bool VictronMpptClass::isDataValid() const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    size_t count = controllerAmount();
 
-    for (auto const& upController: _controllers) {
-        if (upController->isDataValid()) { return true; }
+    for (size_t idx = 0; idx < count; ++idx) {
+        if (getSnapshot(idx)->isDataValid()) { return true; }
     }
 
-    return !_controllers.empty();
+    return count > 0;
 }
 
 bool VictronMpptClass::isDataValid(size_t idx) const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    if (idx >= controllerAmount()) { return false; }
 
-    if (_controllers.empty() || idx >= _controllers.size()) {
-        return false;
-    }
-
-    return _controllers[idx]->isDataValid();
+    return getSnapshot(idx)->isDataValid();
 }
 
 uint32_t VictronMpptClass::getDataAgeMillis() const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    size_t count = controllerAmount();
 
-    if (_controllers.empty()) { return 0; }
+    if (count == 0) { return 0; }
 
     auto now = millis();
 
-    auto iter = _controllers.cbegin();
-    uint32_t age = now - (*iter)->getLastUpdate();
-    ++iter;
+    uint32_t age = now - getSnapshot(0)->lastUpdate;
 
-    while (iter != _controllers.end()) {
-        age = std::min<uint32_t>(age, now - (*iter)->getLastUpdate());
-        ++iter;
+    for (size_t idx = 1; idx < count; ++idx) {
+        age = std::min<uint32_t>(age, now - getSnapshot(idx)->lastUpdate);
     }
 
     return age;
@@ -123,46 +213,48 @@ uint32_t VictronMpptClass::getDataAgeMillis() const
 
 uint32_t VictronMpptClass::getDataAgeMillis(size_t idx) const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    if (idx >= controllerAmount()) { return 0; }
 
-    if (_controllers.empty() || idx >= _controllers.size()) { return 0; }
-
-    return millis() - _controllers[idx]->getLastUpdate();
+    return millis() - getSnapshot(idx)->lastUpdate;
 }
 
 std::optional<VeDirectMpptController::data_t> VictronMpptClass::getData(size_t idx) const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    size_t count = controllerAmount();
 
-    if (_controllers.empty() || idx >= _controllers.size()) {
+    if (idx >= count) {
         MessageOutput.printf("ERROR: MPPT controller index %d is out of bounds (%d controllers)\r\n",
-                             idx, _controllers.size());
+                             idx, count);
         return std::nullopt;
     }
 
-    if (!_controllers[idx]->isDataValid()) { return std::nullopt; }
+    auto spSnapshot = getSnapshot(idx);
+
+    if (!spSnapshot->isDataValid()) { return std::nullopt; }
 
-    return _controllers[idx]->getData();
+    return spSnapshot->data;
 }
 
 int32_t VictronMpptClass::getPowerOutputWatts() const
 {
     int32_t sum = 0;
 
-    for (const auto& upController : _controllers) {
-        if (!upController->isDataValid()) { continue; }
+    for (size_t idx = 0; idx < controllerAmount(); ++idx) {
+        auto spSnapshot = getSnapshot(idx);
+        auto const& controller = *spSnapshot;
+        if (!controller.isDataValid()) { continue; }
 
         // if any charge controller is part of a VE.Smart network, and if the
         // charge controller is connected in a way that allows to send
         // requests, we should have the "network total DC input power"
         // available. if so, to estimate the output power, we multiply by
         // the calculated efficiency of the connected charge controller.
-        auto networkPower = upController->getData().NetworkTotalDcInputPowerMilliWatts;
+        auto networkPower = controller.data.NetworkTotalDcInputPowerMilliWatts;
         if (networkPower.first > 0) {
-            return static_cast<int32_t>(networkPower.second / 1000.0 * upController->getData().mpptEfficiency_Percent / 100);
+            return static_cast<int32_t>(networkPower.second / 1000.0 * controller.data.mpptEfficiency_Percent / 100);
         }
 
-        sum += upController->getData().batteryOutputPower_W;
+        sum += controller.data.batteryOutputPower_W;
     }
 
     return sum;
@@ -172,18 +264,20 @@ int32_t VictronMpptClass::getPanelPowerWatts() const
 {
     int32_t sum = 0;
 
-    for (const auto& upController : _controllers) {
-        if (!upController->isDataValid()) { continue; }
+    for (size_t idx = 0; idx < controllerAmount(); ++idx) {
+        auto spSnapshot = getSnapshot(idx);
+        auto const& controller = *spSnapshot;
+        if (!controller.isDataValid()) { continue; }
 
         // if any charge controller is part of a VE.Smart network, and if the
         // charge controller is connected in a way that allows to send
         // requests, we should have the "network total DC input power" available.
-        auto networkPower = upController->getData().NetworkTotalDcInputPowerMilliWatts;
+        auto networkPower = controller.data.NetworkTotalDcInputPowerMilliWatts;
         if (networkPower.first > 0) {
             return static_cast<int32_t>(networkPower.second / 1000.0);
         }
 
-        sum += upController->getData().panelPower_PPV_W;
+        sum += controller.data.panelPower_PPV_W;
     }
 
     return sum;
@@ -193,9 +287,11 @@ float VictronMpptClass::getYieldTotal() const
 {
     float sum = 0;
 
-    for (const auto& upController : _controllers) {
-        if (!upController->isDataValid()) { continue; }
-        sum += upController->getData().yieldTotal_H19_Wh / 1000.0;
+    for (size_t idx = 0; idx < controllerAmount(); ++idx) {
+        auto spSnapshot = getSnapshot(idx);
+        auto const& controller = *spSnapshot;
+        if (!controller.isDataValid()) { continue; }
+        sum += controller.data.yieldTotal_H19_Wh / 1000.0;
     }
 
     return sum;
@@ -205,9 +301,11 @@ float VictronMpptClass::getYieldDay() const
 {
     float sum = 0;
 
-    for (const auto& upController : _controllers) {
-        if (!upController->isDataValid()) { continue; }
-        sum += upController->getData().yieldToday_H20_Wh / 1000.0;
+    for (size_t idx = 0; idx < controllerAmount(); ++idx) {
+        auto spSnapshot = getSnapshot(idx);
+        auto const& controller = *spSnapshot;
+        if (!controller.isDataValid()) { continue; }
+        sum += controller.data.yieldToday_H20_Wh / 1000.0;
     }
 
     return sum;
@@ -217,9 +315,11 @@ float VictronMpptClass::getOutputVoltage() const
 {
     float min = -1;
 
-    for (const auto& upController : _controllers) {
-        if (!upController->isDataValid()) { continue; }
-        float volts = upController->getData().batteryVoltage_V_mV / 1000.0;
+    for (size_t idx = 0; idx < controllerAmount(); ++idx) {
+        auto spSnapshot = getSnapshot(idx);
+        auto const& controller = *spSnapshot;
+        if (!controller.isDataValid()) { continue; }
+        float volts = controller.data.batteryVoltage_V_mV / 1000.0;
         if (min == -1) { min = volts; }
         min = std::min(min, volts);
     }
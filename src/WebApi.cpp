@@ -7,6 +7,8 @@
 #include "MessageOutput.h"
 #include "defaults.h"
 #include <AsyncJson.h>
+#include <memory>
+#include <string>
 
 WebApiClass::WebApiClass()
     : _server(HTTP_PORT)
@@ -22,6 +24,7 @@ void WebApiClass::init(Scheduler& scheduler)
     _webApiEventlog.init(_server, scheduler);
     _webApiFirmware.init(_server, scheduler);
     _webApiGridprofile.init(_server, scheduler);
+    _webApiHistory.init(_server, scheduler);
     _webApiInverter.init(_server, scheduler);
     _webApiLimit.init(_server, scheduler);
     _webApiMaintenance.init(_server, scheduler);
@@ -148,4 +151,93 @@ bool WebApiClass::sendJsonResponse(AsyncWebServerRequest* request, AsyncJsonResp
     return ret_val;
 }
 
+/*
+ * Adapter which appends everything printed to a std::string, which holds
+ * the section of a chunked response currently being sent.
+ */
+class SectionBufferPrint : public Print {
+public:
+    explicit SectionBufferPrint(std::string& buffer)
+        : _buffer(buffer)
+    {
+    }
+
+    size_t write(uint8_t c) final
+    {
+        _buffer.push_back(static_cast<char>(c));
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) final
+    {
+        _buffer.append(reinterpret_cast<const char*>(buffer), size);
+        return size;
+    }
+
+private:
+    std::string& _buffer;
+};
+
+void WebApiClass::sendChunkedResponse(AsyncWebServerRequest* request, const char* contentType, ChunkGenerator&& generator)
+{
+    struct ResponseState {
+        ChunkGenerator generator;
+        String url;
+        size_t section = 0;
+        std::string buffer;
+        size_t offset = 0;
+    };
+
+    try {
+        auto state = std::make_shared<ResponseState>();
+        state->generator = std::move(generator);
+        state->url = request->url();
+
+        auto response = request->beginChunkedResponse(contentType,
+            [state](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                try {
+                    while (state->offset >= state->buffer.size()) {
+                        state->buffer.clear();
+                        state->offset = 0;
+
+                        SectionBufferPrint out(state->buffer);
+                        if (!state->generator(out, state->section++)) {
+                            return 0; // all sections sent
+                        }
+                    }
+                } catch (std::bad_alloc& bad_alloc) {
+                    MessageOutput.printf("Calling %s has temporarily run out of resources. Reason: \"%s\".\r\n", state->url.c_str(), bad_alloc.what());
+                    return 0;
+                } catch (std::exception& exc) {
+                    MessageOutput.printf("Unknown exception in %s. Reason: \"%s\".\r\n", state->url.c_str(), exc.what());
+                    return 0;
+                }
+
+                size_t len = std::min(maxLen, state->buffer.size() - state->offset);
+                memcpy(buffer, state->buffer.data() + state->offset, len);
+                state->offset += len;
+                return len;
+            });
+
+        response->addHeader("Cache-Control", "no-cache");
+        request->send(response);
+
+    } catch (std::bad_alloc& bad_alloc) {
+        MessageOutput.printf("Calling %s has temporarily run out of resources. Reason: \"%s\".\r\n", request->url().c_str(), bad_alloc.what());
+
+        WebApi.sendTooManyRequests(request);
+    }
+}
+
+void WebApiClass::sendChunkedJsonResponse(AsyncWebServerRequest* request, JsonChunkGenerator&& generator)
+{
+    auto writer = std::make_shared<JsonStreamWriter>();
+
+    sendChunkedResponse(request, "application/json",
+        [writer, generator = std::move(generator)](Print& out, size_t section) -> bool {
+            writer->setOutput(&out);
+            return generator(*writer, section);
+        });
+}
+
 WebApiClass WebApi;
@@ -20,6 +20,8 @@ void WebApiDtuClass::init(AsyncWebServer& server, Scheduler& scheduler)
 
     server.on("/api/dtu/config", HTTP_GET, std::bind(&WebApiDtuClass::onDtuAdminGet, this, _1));
     server.on("/api/dtu/config", HTTP_POST, std::bind(&WebApiDtuClass::onDtuAdminPost, this, _1));
+    server.on("/api/dtu/schedule", HTTP_GET, std::bind(&WebApiDtuClass::onDtuScheduleGet, this, _1));
+    server.on("/api/dtu/links", HTTP_GET, std::bind(&WebApiDtuClass::onDtuLinksGet, this, _1));
 
     scheduler.addTask(_applyDataTask);
 }
@@ -35,6 +37,7 @@ void WebApiDtuClass::applyDataTaskCb()
     Hoymiles.getRadioCmt()->setCountryMode(static_cast<CountryModeId_t>(config.Dtu.Cmt.CountryMode));
     Hoymiles.getRadioCmt()->setInverterTargetFrequency(config.Dtu.Cmt.Frequency);
     Hoymiles.setPollInterval(config.Dtu.PollInterval);
+    Hoymiles.setParallelPolling(config.Dtu.ParallelPolling);
 }
 
 void WebApiDtuClass::onDtuAdminGet(AsyncWebServerRequest* request)
@@ -54,6 +57,7 @@ void WebApiDtuClass::onDtuAdminGet(AsyncWebServerRequest* request)
         ((uint32_t)(config.Dtu.Serial & 0xFFFFFFFF)));
     root["serial"] = buffer;
     root["pollinterval"] = config.Dtu.PollInterval;
+    root["parallel_polling"] = config.Dtu.ParallelPolling;
     root["verbose_logging"] = config.Dtu.VerboseLogging;
     root["nrf_enabled"] = Hoymiles.getRadioNrf()->isInitialized();
     root["nrf_palevel"] = config.Dtu.Nrf.PaLevel;
@@ -93,6 +97,7 @@ void WebApiDtuClass::onDtuAdminPost(AsyncWebServerRequest* request)
 
     if (!(root.containsKey("serial") 
             && root.containsKey("pollinterval")
+            && root.containsKey("parallel_polling")
             && root.containsKey("verbose_logging") 
             && root.containsKey("nrf_palevel") 
             && root.containsKey("cmt_palevel") 
@@ -159,6 +164,7 @@ void WebApiDtuClass::onDtuAdminPost(AsyncWebServerRequest* request)
 
     config.Dtu.Serial = serial;
     config.Dtu.PollInterval = root["pollinterval"].as<uint32_t>();
+    config.Dtu.ParallelPolling = root["parallel_polling"].as<bool>();
     config.Dtu.VerboseLogging = root["verbose_logging"].as<bool>();
     config.Dtu.Nrf.PaLevel = root["nrf_palevel"].as<uint8_t>();
     config.Dtu.Cmt.PaLevel = root["cmt_palevel"].as<int8_t>();
@@ -172,3 +178,91 @@ void WebApiDtuClass::onDtuAdminPost(AsyncWebServerRequest* request)
     _applyDataTask.enable();
     _applyDataTask.restart();
 }
+
+void WebApiDtuClass::onDtuScheduleGet(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) {
+        return;
+    }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& root = response->getRoot();
+
+    root["pollinterval"] = Hoymiles.PollInterval();
+    root["parallel_polling"] = Hoymiles.getParallelPolling();
+
+    const uint32_t now = millis();
+    auto data = root["inverters"].to<JsonArray>();
+    for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
+        auto inv = Hoymiles.getInverterByPos(i);
+        if (inv == nullptr) {
+            continue;
+        }
+
+        auto schedule = inv->Schedule();
+        auto obj = data.add<JsonObject>();
+        obj["serial"] = inv->serialString();
+        obj["name"] = inv->name();
+        obj["mode"] = schedule->getModeName();
+        obj["high_priority"] = schedule->getHighPriority();
+        obj["backoff"] = schedule->getBackoff();
+        obj["interval"] = schedule->getInterval();
+        obj["next_poll"] = static_cast<int32_t>(schedule->getNextPoll() - now);
+        obj["polls"] = schedule->getPollCount();
+        obj["update_rate"] = schedule->getUpdateRate();
+    }
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
+
+void WebApiDtuClass::onDtuLinksGet(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) {
+        return;
+    }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& root = response->getRoot();
+
+    auto data = root["inverters"].to<JsonArray>();
+    for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
+        auto inv = Hoymiles.getInverterByPos(i);
+        if (inv == nullptr) {
+            continue;
+        }
+
+        auto link = inv->LinkStats();
+        auto obj = data.add<JsonObject>();
+        obj["serial"] = inv->serialString();
+        obj["name"] = inv->name();
+        obj["radio"] = inv->getRadio() == Hoymiles.getRadioNrf() ? "nrf" : "cmt";
+        obj["commands"] = link->getCommandCount();
+        obj["success"] = link->getSuccessCount();
+        obj["resends"] = link->getResendCount();
+        obj["retransmits"] = link->getRetransmitCount();
+        obj["timeouts"] = link->getTimeoutCount();
+        obj["errors"] = link->getErrorCount();
+        obj["rx_failures"] = inv->Statistics()->getRxFailureCount();
+        obj["rx_channel"] = link->getBestRxChannel();
+        obj["latency_ms"] = link->getAnswerLatency();
+        obj["fragment_gap_ms"] = link->getFragmentGap();
+
+        auto channels = obj["channels"].to<JsonArray>();
+        for (uint8_t c = 0; c < link->getChannelCount(); c++) {
+            auto const& stats = link->getChannel(c);
+            auto ch = channels.add<JsonObject>();
+            ch["channel"] = stats.channel;
+            ch["tx"] = stats.txCount;
+            ch["tx_answered"] = stats.txAnswered;
+            ch["rx"] = stats.rxCount;
+            if (stats.rxCount > 0) {
+                ch["rssi"] = serialized(String(stats.rssi, 1));
+            } else {
+                ch["rssi"] = nullptr;
+            }
+            ch["answer_rate"] = serialized(String(stats.txScore, 2));
+        }
+    }
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
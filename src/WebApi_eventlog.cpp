@@ -6,6 +6,7 @@
 #include "WebApi.h"
 #include <AsyncJson.h>
 #include <Hoymiles.h>
+#include <algorithm>
 
 void WebApiEventlogClass::init(AsyncWebServer& server, Scheduler& scheduler)
 {
@@ -20,8 +21,6 @@ void WebApiEventlogClass::onEventlogStatus(AsyncWebServerRequest* request)
         return;
     }
 
-    AsyncJsonResponse* response = new AsyncJsonResponse();
-    auto& root = response->getRoot();
     auto serial = WebApi.parseSerialFromRequest(request);
 
     AlarmMessageLocale_t locale = AlarmMessageLocale_t::EN;
@@ -36,26 +35,56 @@ void WebApiEventlogClass::onEventlogStatus(AsyncWebServerRequest* request)
         }
     }
 
-    auto inv = Hoymiles.getInverterBySerial(serial);
+    // the entries are sent in small batches. the number of entries is
+    // determined once, entries that vanish in the meantime are skipped.
+    static constexpr uint8_t entriesPerSection = 8;
+    uint8_t logEntryCount = 0;
+    bool found = false;
+    bool done = false;
 
-    if (inv != nullptr) {
-        uint8_t logEntryCount = inv->EventLog()->getEntryCount();
+    WebApi.sendChunkedJsonResponse(request,
+        [serial, locale, logEntryCount, found, done](JsonStreamWriter& writer, size_t section) mutable -> bool {
+            auto inv = Hoymiles.getInverterBySerial(serial);
 
-        root["count"] = logEntryCount;
-        JsonArray eventsArray = root["events"].to<JsonArray>();
+            if (section == 0) {
+                writer.beginObject();
+                if (inv != nullptr) {
+                    found = true;
+                    logEntryCount = inv->EventLog()->getEntryCount();
+                    writer.add("count", logEntryCount);
+                    writer.beginArray("events");
+                }
+                return true;
+            }
 
-        for (uint8_t logEntry = 0; logEntry < logEntryCount; logEntry++) {
-            JsonObject eventsObject = eventsArray.add<JsonObject>();
+            size_t first = (section - 1) * entriesPerSection;
+            if (first < logEntryCount) {
+                if (inv == nullptr) { return true; }
 
-            AlarmLogEntry_t entry;
-            inv->EventLog()->getLogEntry(logEntry, entry, locale);
+                size_t last = std::min<size_t>(first + entriesPerSection, logEntryCount);
+                for (size_t logEntry = first; logEntry < last; logEntry++) {
+                    if (logEntry >= inv->EventLog()->getEntryCount()) { break; }
 
-            eventsObject["message_id"] = entry.MessageId;
-            eventsObject["message"] = entry.Message;
-            eventsObject["start_time"] = entry.StartTime;
-            eventsObject["end_time"] = entry.EndTime;
-        }
-    }
+                    AlarmLogEntry_t entry;
+                    inv->EventLog()->getLogEntry(logEntry, entry, locale);
+
+                    JsonDocument doc;
+                    doc["message_id"] = entry.MessageId;
+                    doc["message"] = entry.Message;
+                    doc["start_time"] = entry.StartTime;
+                    doc["end_time"] = entry.EndTime;
+                    writer.add(doc.as<JsonVariantConst>());
+                }
+                return true;
+            }
+
+            if (!done) {
+                if (found) { writer.endArray(); }
+                writer.endObject();
+                done = true;
+                return true;
+            }
 
-    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+            return false;
+        });
 }
@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "WebApi_history.h"
+#include "Configuration.h"
+#include "EnergyLog.h"
+#include "History.h"
+#include "MessageOutput.h"
+#include "WebApi.h"
+#include "WebApi_errors.h"
+#include <AsyncJson.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+void WebApiHistoryClass::init(AsyncWebServer& server, Scheduler& scheduler)
+{
+    using std::placeholders::_1;
+
+    server.on("/api/history", HTTP_GET, std::bind(&WebApiHistoryClass::onHistoryGet, this, _1));
+    server.on("/api/history/energy", HTTP_GET, std::bind(&WebApiHistoryClass::onEnergyGet, this, _1));
+    server.on("/api/history/config", HTTP_GET, std::bind(&WebApiHistoryClass::onConfigGet, this, _1));
+    server.on("/api/history/config", HTTP_POST, std::bind(&WebApiHistoryClass::onConfigPost, this, _1));
+}
+
+/*
+ * without parameters, the available series and their tiers are listed.
+ * otherwise the series given by "series" is aggregated into "points" (at
+ * most 600, default 120) points covering the last "duration" seconds
+ * (default one hour). invalid points (no data) are null.
+ */
+void WebApiHistoryClass::onHistoryGet(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) {
+        return;
+    }
+
+    uint32_t now = HistoryClass::now();
+
+    if (!request->hasParam("series")) {
+        AsyncJsonResponse* response = new AsyncJsonResponse();
+        auto& root = response->getRoot();
+
+        root["uptime"] = now;
+
+        auto series = root["series"].to<JsonArray>();
+        for (size_t i = 0; i < HistoryClass::SeriesCount; ++i) {
+            auto id = static_cast<HistoryClass::Series>(i);
+            auto const& ts = History.get(id);
+
+            auto entry = series.add<JsonObject>();
+            entry["name"] = HistoryClass::getName(id).data();
+
+            auto tiers = entry["tiers"].to<JsonArray>();
+            for (size_t tier = 0; tier < ts.getTierCount(); ++tier) {
+                auto t = tiers.add<JsonObject>();
+                t["period"] = ts.getPeriod(tier);
+                t["capacity"] = ts.getCapacity(tier);
+                t["size"] = ts.getSize(tier);
+            }
+        }
+
+        WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+        return;
+    }
+
+    auto id = HistoryClass::fromName(request->getParam("series")->value().c_str());
+    if (!id.has_value()) {
+        request->send(404);
+        return;
+    }
+
+    uint32_t duration = 3600;
+    if (request->hasParam("duration")) {
+        duration = std::max<long>(1, request->getParam("duration")->value().toInt());
+    }
+
+    size_t count = 120;
+    if (request->hasParam("points")) {
+        count = std::clamp<long>(request->getParam("points")->value().toInt(), 1, 600);
+    }
+
+    auto points = std::make_unique<TimeSeries::Aggregate[]>(count);
+    uint32_t lastEnd = now;
+    float interval = 0;
+    count = History.get(*id).resample(duration, points.get(), count, &lastEnd, &interval);
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& root = response->getRoot();
+
+    root["series"] = HistoryClass::getName(*id).data();
+    root["duration"] = duration;
+    root["age"] = now - lastEnd; // seconds since the end of the last point
+    root["interval"] = interval; // seconds per point
+
+    auto min = root["min"].to<JsonArray>();
+    auto avg = root["avg"].to<JsonArray>();
+    auto max = root["max"].to<JsonArray>();
+    for (size_t i = 0; i < count; ++i) {
+        auto const& point = points[i];
+        if (!point.valid) {
+            min.add(nullptr);
+            avg.add(nullptr);
+            max.add(nullptr);
+            continue;
+        }
+
+        min.add(point.min);
+        avg.add(point.avg);
+        max.add(point.max);
+    }
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
+
+/*
+ * streams the records of the energy log with the given "resolution" (raw,
+ * day or month, default day) and a timestamp within ["from", "to"). the
+ * records are read in small batches while the response is sent.
+ */
+void WebApiHistoryClass::onEnergyGet(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) {
+        return;
+    }
+
+    auto resolution = EnergyLogClass::Resolution::Day;
+    if (request->hasParam("resolution")) {
+        auto parsed = EnergyLogClass::resolutionFromName(request->getParam("resolution")->value().c_str());
+        if (!parsed.has_value()) {
+            request->send(404);
+            return;
+        }
+        resolution = *parsed;
+    }
+
+    uint32_t from = 0;
+    if (request->hasParam("from")) {
+        from = strtoul(request->getParam("from")->value().c_str(), nullptr, 10);
+    }
+
+    uint32_t to = UINT32_MAX;
+    if (request->hasParam("to")) {
+        to = strtoul(request->getParam("to")->value().c_str(), nullptr, 10);
+    }
+
+    auto cursor = EnergyLog.getCursor(resolution, from, to);
+    String resolutionName = request->hasParam("resolution") ? request->getParam("resolution")->value() : "day";
+
+    WebApi.sendChunkedJsonResponse(request,
+        [cursor, resolutionName](JsonStreamWriter& writer, size_t section) mutable -> bool {
+            if (section == 0) {
+                writer.beginObject();
+                writer.add("resolution", resolutionName.c_str());
+
+                // inverter records refer to the config slot
+                writer.beginArray("inverters");
+                auto const& config = Configuration.get();
+                for (uint8_t i = 0; i < INV_MAX_COUNT; ++i) {
+                    if (config.Inverter[i].Serial == 0) { continue; }
+
+                    JsonDocument doc;
+                    doc["index"] = i;
+                    doc["name"] = config.Inverter[i].Name;
+                    writer.add(doc.as<JsonVariantConst>());
+                }
+                writer.endArray();
+
+                writer.beginArray("records");
+                return true;
+            }
+
+            if (cursor.offset == SIZE_MAX) { return false; }
+
+            EnergyLogClass::Record records[16];
+            size_t count = EnergyLog.read(cursor, records, 16);
+            if (count == 0) {
+                writer.endArray();
+                writer.endObject();
+                cursor.offset = SIZE_MAX; // done
+                return true;
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                // copies, as the packed fields cannot be bound to references
+                uint32_t timestamp = records[i].timestamp;
+                uint8_t index = records[i].index;
+                uint32_t value = records[i].value;
+
+                JsonDocument doc;
+                doc["timestamp"] = timestamp;
+                doc["source"] = EnergyLogClass::getSourceName(records[i].source).data();
+                doc["index"] = index;
+                doc["value"] = value;
+                writer.add(doc.as<JsonVariantConst>());
+            }
+
+            return true;
+        });
+}
+
+void WebApiHistoryClass::onConfigGet(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentials(request)) {
+        return;
+    }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& root = response->getRoot();
+    auto const& config = Configuration.get();
+
+    root["enabled"] = config.EnergyLog.Enabled;
+    root["interval"] = config.EnergyLog.Interval;
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
+
+void WebApiHistoryClass::onConfigPost(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentials(request)) {
+        return;
+    }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    JsonDocument root;
+    if (!WebApi.parseRequestData(request, response, root)) {
+        return;
+    }
+
+    auto& retMsg = response->getRoot();
+
+    if (!root.containsKey("enabled") || !root.containsKey("interval")) {
+        retMsg["message"] = "Values are missing!";
+        retMsg["code"] = WebApiError::GenericValueMissing;
+        WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+        return;
+    }
+
+    auto interval = root["interval"].as<uint32_t>();
+    if (interval < ENERGYLOG_MIN_INTERVAL || interval > ENERGYLOG_MAX_INTERVAL) {
+        retMsg["message"] = "Interval is out of range!";
+        retMsg["code"] = WebApiError::EnergyLogIntervalInvalid;
+        retMsg["param"]["min"] = ENERGYLOG_MIN_INTERVAL;
+        retMsg["param"]["max"] = ENERGYLOG_MAX_INTERVAL;
+        WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+        return;
+    }
+
+    CONFIG_T& config = Configuration.get();
+    config.EnergyLog.Enabled = root["enabled"].as<bool>();
+    config.EnergyLog.Interval = interval;
+
+    WebApi.writeConfig(retMsg);
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
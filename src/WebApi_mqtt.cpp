@@ -4,10 +4,12 @@
  */
 #include "WebApi_mqtt.h"
 #include "Configuration.h"
+#include "MqttHandleBatteryHass.h"
 #include "MqttHandleHass.h"
 #include "MqttHandleInverter.h"
 #include "MqttHandleVedirectHass.h"
 #include "MqttHandleVedirect.h"
+#include "MqttPublisher.h"
 #include "MqttSettings.h"
 #include "WebApi.h"
 #include "WebApi_errors.h"
@@ -51,6 +53,7 @@ void WebApiMqttClass::onMqttStatus(AsyncWebServerRequest* request)
     root["mqtt_lwt_topic"] = String(config.Mqtt.Topic) + config.Mqtt.Lwt.Topic;
     root["mqtt_publish_interval"] = config.Mqtt.PublishInterval;
     root["mqtt_clean_session"] = config.Mqtt.CleanSession;
+    root["mqtt_payload_mode"] = config.Mqtt.PayloadMode;
     root["mqtt_hass_enabled"] = config.Mqtt.Hass.Enabled;
     root["mqtt_hass_expire"] = config.Mqtt.Hass.Expire;
     root["mqtt_hass_retain"] = config.Mqtt.Hass.Retain;
@@ -95,6 +98,10 @@ void WebApiMqttClass::onMqttAdminGet(AsyncWebServerRequest* request)
     root["mqtt_hass_retain"] = config.Mqtt.Hass.Retain;
     root["mqtt_hass_topic"] = config.Mqtt.Hass.Topic;
     root["mqtt_hass_individualpanels"] = config.Mqtt.Hass.IndividualPanels;
+    root["mqtt_changefilter_enabled"] = config.Mqtt.ChangeFilter.Enabled;
+    root["mqtt_changefilter_deadband"] = config.Mqtt.ChangeFilter.Deadband;
+    root["mqtt_changefilter_deadband_absolute"] = config.Mqtt.ChangeFilter.AbsoluteDeadband;
+    root["mqtt_changefilter_refresh_interval"] = config.Mqtt.ChangeFilter.RefreshInterval;
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
@@ -132,11 +139,15 @@ void WebApiMqttClass::onMqttAdminPost(AsyncWebServerRequest* request)
             && root.containsKey("mqtt_lwt_qos")
             && root.containsKey("mqtt_publish_interval")
             && root.containsKey("mqtt_clean_session")
+            && root.containsKey("mqtt_payload_mode")
             && root.containsKey("mqtt_hass_enabled")
             && root.containsKey("mqtt_hass_expire")
             && root.containsKey("mqtt_hass_retain")
             && root.containsKey("mqtt_hass_topic")
-            && root.containsKey("mqtt_hass_individualpanels"))) {
+            && root.containsKey("mqtt_hass_individualpanels")
+            && root.containsKey("mqtt_changefilter_enabled")
+            && root.containsKey("mqtt_changefilter_deadband")
+            && root.containsKey("mqtt_changefilter_refresh_interval"))) {
         retMsg["message"] = "Values are missing!";
         retMsg["code"] = WebApiError::GenericValueMissing;
         WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
@@ -260,6 +271,40 @@ void WebApiMqttClass::onMqttAdminPost(AsyncWebServerRequest* request)
             return;
         }
 
+        if (root["mqtt_payload_mode"].as<uint8_t>() > static_cast<uint8_t>(MqttPublisherClass::PayloadMode::Both)) {
+            retMsg["message"] = "Invalid payload mode!";
+            retMsg["code"] = WebApiError::MqttPayloadMode;
+            WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+            return;
+        }
+
+        if (root["mqtt_changefilter_deadband"].as<float>() < 0 || root["mqtt_changefilter_deadband"].as<float>() > 100) {
+            retMsg["message"] = "Deadband must be a number between 0 and 100!";
+            retMsg["code"] = WebApiError::MqttChangeFilterDeadband;
+            retMsg["param"]["min"] = 0;
+            retMsg["param"]["max"] = 100;
+            WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+            return;
+        }
+
+        if (root["mqtt_changefilter_deadband_absolute"].as<float>() < 0 || root["mqtt_changefilter_deadband_absolute"].as<float>() > 1000) {
+            retMsg["message"] = "Absolute deadband must be a number between 0 and 1000!";
+            retMsg["code"] = WebApiError::MqttChangeFilterAbsoluteDeadband;
+            retMsg["param"]["min"] = 0;
+            retMsg["param"]["max"] = 1000;
+            WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+            return;
+        }
+
+        if (root["mqtt_changefilter_refresh_interval"].as<uint32_t>() < 5 || root["mqtt_changefilter_refresh_interval"].as<uint32_t>() > 86400) {
+            retMsg["message"] = "Refresh interval must be a number between 5 and 86400!";
+            retMsg["code"] = WebApiError::MqttChangeFilterRefreshInterval;
+            retMsg["param"]["min"] = 5;
+            retMsg["param"]["max"] = 86400;
+            WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+            return;
+        }
+
         if (root["mqtt_hass_enabled"].as<bool>()) {
             if (root["mqtt_hass_topic"].as<String>().length() > MQTT_MAX_TOPIC_STRLEN) {
                 retMsg["message"] = "Hass topic must not be longer than " STR(MQTT_MAX_TOPIC_STRLEN) " characters!";
@@ -298,10 +343,15 @@ void WebApiMqttClass::onMqttAdminPost(AsyncWebServerRequest* request)
     config.Mqtt.Lwt.Qos = root["mqtt_lwt_qos"].as<uint8_t>();
     config.Mqtt.PublishInterval = root["mqtt_publish_interval"].as<uint32_t>();
     config.Mqtt.CleanSession = root["mqtt_clean_session"].as<bool>();
+    config.Mqtt.PayloadMode = root["mqtt_payload_mode"].as<uint8_t>();
     config.Mqtt.Hass.Enabled = root["mqtt_hass_enabled"].as<bool>();
     config.Mqtt.Hass.Expire = root["mqtt_hass_expire"].as<bool>();
     config.Mqtt.Hass.Retain = root["mqtt_hass_retain"].as<bool>();
     config.Mqtt.Hass.IndividualPanels = root["mqtt_hass_individualpanels"].as<bool>();
+    config.Mqtt.ChangeFilter.Enabled = root["mqtt_changefilter_enabled"].as<bool>();
+    config.Mqtt.ChangeFilter.Deadband = root["mqtt_changefilter_deadband"].as<float>();
+    config.Mqtt.ChangeFilter.AbsoluteDeadband = root["mqtt_changefilter_deadband_absolute"].as<float>();
+    config.Mqtt.ChangeFilter.RefreshInterval = root["mqtt_changefilter_refresh_interval"].as<uint32_t>();
     strlcpy(config.Mqtt.Hass.Topic, root["mqtt_hass_topic"].as<String>().c_str(), sizeof(config.Mqtt.Hass.Topic));
 
     // Check if base topic was changed
@@ -317,6 +367,7 @@ void WebApiMqttClass::onMqttAdminPost(AsyncWebServerRequest* request)
 
     MqttSettings.performReconnect();
     MqttHandleHass.forceUpdate();
+    MqttHandleBatteryHass.forceUpdate();
     MqttHandleVedirectHass.forceUpdate();
     MqttHandleVedirect.forceUpdate();
 }
@@ -12,6 +12,7 @@
 #include "WebApi.h"
 #include "helper.h"
 #include "WebApi_errors.h"
+#include "defaults.h"
 
 void WebApiPowerLimiterClass::init(AsyncWebServer& server, Scheduler& scheduler)
 {
@@ -23,6 +24,8 @@ void WebApiPowerLimiterClass::init(AsyncWebServer& server, Scheduler& scheduler)
     _server->on("/api/powerlimiter/config", HTTP_GET, std::bind(&WebApiPowerLimiterClass::onAdminGet, this, _1));
     _server->on("/api/powerlimiter/config", HTTP_POST, std::bind(&WebApiPowerLimiterClass::onAdminPost, this, _1));
     _server->on("/api/powerlimiter/metadata", HTTP_GET, std::bind(&WebApiPowerLimiterClass::onMetaData, this, _1));
+    _server->on("/api/powerlimiter/latency", HTTP_GET, std::bind(&WebApiPowerLimiterClass::onLatencyGet, this, _1));
+    _server->on("/api/powerlimiter/latency", HTTP_DELETE, std::bind(&WebApiPowerLimiterClass::onLatencyDelete, this, _1));
 }
 
 void WebApiPowerLimiterClass::onStatus(AsyncWebServerRequest* request)
@@ -39,10 +42,14 @@ void WebApiPowerLimiterClass::onStatus(AsyncWebServerRequest* request)
     root["is_inverter_behind_powermeter"] = config.PowerLimiter.IsInverterBehindPowerMeter;
     root["is_inverter_solar_powered"] = config.PowerLimiter.IsInverterSolarPowered;
     root["use_overscaling_to_compensate_shading"] = config.PowerLimiter.UseOverscalingToCompensateShading;
+    root["distribute_over_all_inverters"] = config.PowerLimiter.DistributeOverAllInverters;
     root["inverter_serial"] = String(config.PowerLimiter.InverterId);
     root["inverter_channel_id"] = config.PowerLimiter.InverterChannelId;
     root["target_power_consumption"] = config.PowerLimiter.TargetPowerConsumption;
     root["target_power_consumption_hysteresis"] = config.PowerLimiter.TargetPowerConsumptionHysteresis;
+    root["controller_mode"] = config.PowerLimiter.ControllerMode;
+    root["controller_kp"] = config.PowerLimiter.ControllerKp;
+    root["controller_ki"] = config.PowerLimiter.ControllerKi;
     root["lower_power_limit"] = config.PowerLimiter.LowerPowerLimit;
     root["base_load_limit"] = config.PowerLimiter.BaseLoadLimit;
     root["upper_power_limit"] = config.PowerLimiter.UpperPowerLimit;
@@ -60,6 +67,38 @@ void WebApiPowerLimiterClass::onStatus(AsyncWebServerRequest* request)
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
 
+void WebApiPowerLimiterClass::onLatencyGet(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) { return; }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& root = response->getRoot();
+
+    auto const& stats = PowerLimiter.getLatencyStats();
+    stats.meterAge.toJson(root["meter_age_ms"].to<JsonObject>(), true);
+    stats.calculation.toJson(root["calculation_us"].to<JsonObject>(), true);
+    stats.commandRoundTrip.toJson(root["command_round_trip_ms"].to<JsonObject>(), true);
+    stats.statsSettling.toJson(root["stats_settling_ms"].to<JsonObject>(), true);
+    stats.total.toJson(root["total_ms"].to<JsonObject>(), true);
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
+
+void WebApiPowerLimiterClass::onLatencyDelete(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentials(request)) { return; }
+
+    PowerLimiter.resetLatencyStats();
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& retMsg = response->getRoot();
+    retMsg["type"] = "success";
+    retMsg["message"] = "Latency statistics reset!";
+    retMsg["code"] = WebApiError::GenericSuccess;
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
+
 void WebApiPowerLimiterClass::onMetaData(AsyncWebServerRequest* request)
 {
     if (!WebApi.checkCredentials(request)) { return; }
@@ -161,10 +200,14 @@ void WebApiPowerLimiterClass::onAdminPost(AsyncWebServerRequest* request)
     config.PowerLimiter.IsInverterBehindPowerMeter = root["is_inverter_behind_powermeter"].as<bool>();
     config.PowerLimiter.IsInverterSolarPowered = root["is_inverter_solar_powered"].as<bool>();
     config.PowerLimiter.UseOverscalingToCompensateShading = root["use_overscaling_to_compensate_shading"].as<bool>();
+    config.PowerLimiter.DistributeOverAllInverters = root["distribute_over_all_inverters"].as<bool>();
     config.PowerLimiter.InverterId = root["inverter_serial"].as<uint64_t>();
     config.PowerLimiter.InverterChannelId = root["inverter_channel_id"].as<uint8_t>();
     config.PowerLimiter.TargetPowerConsumption = root["target_power_consumption"].as<int32_t>();
     config.PowerLimiter.TargetPowerConsumptionHysteresis = root["target_power_consumption_hysteresis"].as<int32_t>();
+    config.PowerLimiter.ControllerMode = root["controller_mode"] | POWERLIMITER_CONTROLLER_MODE;
+    config.PowerLimiter.ControllerKp = root["controller_kp"] | POWERLIMITER_CONTROLLER_KP;
+    config.PowerLimiter.ControllerKi = root["controller_ki"] | POWERLIMITER_CONTROLLER_KI;
     config.PowerLimiter.LowerPowerLimit = root["lower_power_limit"].as<int32_t>();
     config.PowerLimiter.BaseLoadLimit = root["base_load_limit"].as<int32_t>();
     config.PowerLimiter.UpperPowerLimit = root["upper_power_limit"].as<int32_t>();
@@ -145,9 +145,17 @@ void WebApiPowerMeterClass::onAdminPost(AsyncWebServerRequest* request)
     }
 
     if (static_cast<PowerMeterProvider::Type>(root["source"].as<uint8_t>()) == PowerMeterProvider::Type::HTTP_SML) {
-        JsonObject httpSml = root["http_sml"];
-        if (!checkHttpConfig(httpSml["http_request"].as<JsonObject>())) {
-            return;
+        JsonArray valueConfigs = root["http_sml"]["values"];
+        for (uint8_t i = 0; i < valueConfigs.size(); i++) {
+            JsonObject valueConfig = valueConfigs[i].as<JsonObject>();
+
+            if (i > 0 && !valueConfig["enabled"].as<bool>()) {
+                continue;
+            }
+
+            if (!checkHttpConfig(valueConfig["http_request"].as<JsonObject>())) {
+                return;
+            }
         }
     }
 
@@ -240,7 +248,12 @@ void WebApiPowerMeterClass::onTestHttpSmlRequest(AsyncWebServerRequest* request)
     auto res = upMeter->poll();
     if (res.isEmpty()) {
         retMsg["type"] = "success";
-        snprintf(response, sizeof(response), "Result: %5.2fW", upMeter->getPowerTotal());
+        auto pos = snprintf(response, sizeof(response), "Result: %5.2fW", upMeter->getPowerTotal(0));
+        for (size_t i = 1; i < POWERMETER_HTTP_SML_MAX_VALUES; ++i) {
+            if (!powerMeterConfig->Values[i].Enabled) { continue; }
+            pos += snprintf(response + pos, sizeof(response) - pos, ", %5.2fW", upMeter->getPowerTotal(i));
+        }
+        snprintf(response + pos, sizeof(response) - pos, ", Total: %5.2f", upMeter->getPowerTotal());
     } else {
         snprintf(response, sizeof(response), "%s", res.c_str());
     }
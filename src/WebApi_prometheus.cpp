@@ -4,11 +4,21 @@
  * Copyright (C) 2022-2024 Thomas Basler and others
  */
 #include "WebApi_prometheus.h"
+#include "Battery.h"
 #include "Configuration.h"
+#include "EnergyFlow.h"
+#include "Huawei_can.h"
 #include "MessageOutput.h"
 #include "NetworkSettings.h"
+#include "PowerLimiter.h"
+#include "PowerMeter.h"
+#include "VictronMppt.h"
 #include "WebApi.h"
 #include <Hoymiles.h>
+#include <cfloat>
+#include <functional>
+#include <string>
+#include <vector>
 #include "__compiled_constants.h"
 
 void WebApiPrometheusClass::init(AsyncWebServer& server, Scheduler& scheduler)
@@ -24,106 +34,154 @@ void WebApiPrometheusClass::onPrometheusMetricsGet(AsyncWebServerRequest* reques
         return;
     }
 
-    try {
-        auto stream = request->beginResponseStream("text/plain; charset=utf-8", 4096 * INV_MAX_COUNT); // TODO(helge) check if this calculation is correct
+    WebApi.sendChunkedResponse(request, "text/plain; charset=utf-8",
+        [this](Print& out, size_t section) -> bool {
+            return generateSection(&out, section);
+        });
+}
+
+bool WebApiPrometheusClass::generateSection(Print* stream, const size_t section)
+{
+    const size_t inverterCount = Hoymiles.getNumInverters();
 
-        stream->print("# HELP opendtu_build Build info\n");
-        stream->print("# TYPE opendtu_build gauge\n");
-        stream->printf("opendtu_build{name=\"%s\",id=\"%s\",version=\"%d.%d.%d\"} 1\n",
-            NetworkSettings.getHostname().c_str(), __COMPILED_GIT_HASH__, CONFIG_VERSION >> 24 & 0xff, CONFIG_VERSION >> 16 & 0xff, CONFIG_VERSION >> 8 & 0xff);
+    if (section == 0) {
+        addSystemInfo(stream);
+        return true;
+    }
 
-        stream->print("# HELP opendtu_platform Platform info\n");
-        stream->print("# TYPE opendtu_platform gauge\n");
-        stream->printf("opendtu_platform{arch=\"%s\",mac=\"%s\"} 1\n", ESP.getChipModel(), NetworkSettings.macAddress().c_str());
+    if (section <= inverterCount) {
+        addInverterInfo(stream, section - 1);
+        return true;
+    }
+
+    switch (section - inverterCount) {
+    case 1:
+        addPowerLimiterInfo(stream);
+        return true;
+    case 2:
+        addPowerMeterInfo(stream);
+        return true;
+    case 3:
+        addBatteryInfo(stream);
+        return true;
+    case 4:
+        addMpptInfo(stream);
+        return true;
+    case 5:
+        addHuaweiInfo(stream);
+        return true;
+    default:
+        return false;
+    }
+}
 
-        stream->print("# HELP opendtu_uptime Uptime in seconds\n");
-        stream->print("# TYPE opendtu_uptime counter\n");
-        stream->printf("opendtu_uptime %lld\n", esp_timer_get_time() / 1000000);
+void WebApiPrometheusClass::addSystemInfo(Print* stream)
+{
+    stream->print("# HELP opendtu_build Build info\n");
+    stream->print("# TYPE opendtu_build gauge\n");
+    stream->printf("opendtu_build{name=\"%s\",id=\"%s\",version=\"%d.%d.%d\"} 1\n",
+        NetworkSettings.getHostname().c_str(), __COMPILED_GIT_HASH__, CONFIG_VERSION >> 24 & 0xff, CONFIG_VERSION >> 16 & 0xff, CONFIG_VERSION >> 8 & 0xff);
 
-        stream->print("# HELP opendtu_heap_size System memory size\n");
-        stream->print("# TYPE opendtu_heap_size gauge\n");
-        stream->printf("opendtu_heap_size %zu\n", ESP.getHeapSize());
+    stream->print("# HELP opendtu_platform Platform info\n");
+    stream->print("# TYPE opendtu_platform gauge\n");
+    stream->printf("opendtu_platform{arch=\"%s\",mac=\"%s\"} 1\n", ESP.getChipModel(), NetworkSettings.macAddress().c_str());
 
-        stream->print("# HELP opendtu_free_heap_size System free memory\n");
-        stream->print("# TYPE opendtu_free_heap_size gauge\n");
-        stream->printf("opendtu_free_heap_size %zu\n", ESP.getFreeHeap());
+    stream->print("# HELP opendtu_uptime Uptime in seconds\n");
+    stream->print("# TYPE opendtu_uptime counter\n");
+    stream->printf("opendtu_uptime %lld\n", esp_timer_get_time() / 1000000);
 
-        stream->print("# HELP opendtu_biggest_heap_block Biggest free heap block\n");
-        stream->print("# TYPE opendtu_biggest_heap_block gauge\n");
-        stream->printf("opendtu_biggest_heap_block %zu\n", ESP.getMaxAllocHeap());
+    stream->print("# HELP opendtu_heap_size System memory size\n");
+    stream->print("# TYPE opendtu_heap_size gauge\n");
+    stream->printf("opendtu_heap_size %zu\n", ESP.getHeapSize());
 
-        stream->print("# HELP opendtu_heap_min_free Minimum free memory since boot\n");
-        stream->print("# TYPE opendtu_heap_min_free gauge\n");
-        stream->printf("opendtu_heap_min_free %zu\n", ESP.getMinFreeHeap());
+    stream->print("# HELP opendtu_free_heap_size System free memory\n");
+    stream->print("# TYPE opendtu_free_heap_size gauge\n");
+    stream->printf("opendtu_free_heap_size %zu\n", ESP.getFreeHeap());
 
-        stream->print("# HELP wifi_rssi WiFi RSSI\n");
-        stream->print("# TYPE wifi_rssi gauge\n");
-        stream->printf("wifi_rssi %d\n", WiFi.RSSI());
+    stream->print("# HELP opendtu_biggest_heap_block Biggest free heap block\n");
+    stream->print("# TYPE opendtu_biggest_heap_block gauge\n");
+    stream->printf("opendtu_biggest_heap_block %zu\n", ESP.getMaxAllocHeap());
 
-        stream->print("# HELP wifi_station WiFi Station info\n");
-        stream->print("# TYPE wifi_station gauge\n");
-        stream->printf("wifi_station{bssid=\"%s\"} 1\n", WiFi.BSSIDstr().c_str());
+    stream->print("# HELP opendtu_heap_min_free Minimum free memory since boot\n");
+    stream->print("# TYPE opendtu_heap_min_free gauge\n");
+    stream->printf("opendtu_heap_min_free %zu\n", ESP.getMinFreeHeap());
 
-        for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
-            auto inv = Hoymiles.getInverterByPos(i);
+    stream->print("# HELP opendtu_log_lines_dropped Log lines dropped as the console buffer was full\n");
+    stream->print("# TYPE opendtu_log_lines_dropped counter\n");
+    stream->printf("opendtu_log_lines_dropped %u\n", MessageOutput.getDroppedLines());
 
-            String serial = inv->serialString();
-            const char* name = inv->name();
-            if (i == 0) {
-                stream->print("# HELP opendtu_last_update last update from inverter in s\n");
-                stream->print("# TYPE opendtu_last_update gauge\n");
-            }
-            stream->printf("opendtu_last_update{serial=\"%s\",unit=\"%d\",name=\"%s\"} %d\n",
-                serial.c_str(), i, name, inv->Statistics()->getLastUpdate() / 1000);
+    stream->print("# HELP opendtu_log_lines_dropped_websocket Log lines not sent to the websocket as its clients fell behind\n");
+    stream->print("# TYPE opendtu_log_lines_dropped_websocket counter\n");
+    stream->printf("opendtu_log_lines_dropped_websocket %u\n", MessageOutput.getDroppedWebsocketLines());
 
-            if (i == 0) {
-                stream->print("# HELP opendtu_inverter_limit_relative current relative limit of the inverter\n");
-                stream->print("# TYPE opendtu_inverter_limit_relative gauge\n");
-            }
-            stream->printf("opendtu_inverter_limit_relative{serial=\"%s\",unit=\"%d\",name=\"%s\"} %f\n",
-                serial.c_str(), i, name, inv->SystemConfigPara()->getLimitPercent() / 100.0);
+    stream->print("# HELP wifi_rssi WiFi RSSI\n");
+    stream->print("# TYPE wifi_rssi gauge\n");
+    stream->printf("wifi_rssi %d\n", WiFi.RSSI());
 
-            if (inv->DevInfo()->getMaxPower() > 0) {
-                if (i == 0) {
-                    stream->print("# HELP opendtu_inverter_limit_absolute current relative limit of the inverter\n");
-                    stream->print("# TYPE opendtu_inverter_limit_absolute gauge\n");
-                }
-                stream->printf("opendtu_inverter_limit_absolute{serial=\"%s\",unit=\"%d\",name=\"%s\"} %f\n",
-                    serial.c_str(), i, name, inv->SystemConfigPara()->getLimitPercent() * inv->DevInfo()->getMaxPower() / 100.0);
-            }
+    stream->print("# HELP wifi_station WiFi Station info\n");
+    stream->print("# TYPE wifi_station gauge\n");
+    stream->printf("wifi_station{bssid=\"%s\"} 1\n", WiFi.BSSIDstr().c_str());
+}
 
-            // Loop all channels if Statistics have been updated at least once since DTU boot
-            if (inv->Statistics()->getLastUpdate() > 0) {
-                for (auto& t : inv->Statistics()->getChannelTypes()) {
-                    for (auto& c : inv->Statistics()->getChannelsByType(t)) {
-                        addPanelInfo(stream, serial, i, inv, t, c);
-                        for (uint8_t f = 0; f < sizeof(_publishFields) / sizeof(_publishFields[0]); f++) {
-                            if (t == TYPE_INV && _publishFields[f].field == FLD_PDC) {
-                                addField(stream, serial, i, inv, t, c, _publishFields[f].field, _metricTypes[_publishFields[f].type], "PowerDC");
-                            } else {
-                                addField(stream, serial, i, inv, t, c, _publishFields[f].field, _metricTypes[_publishFields[f].type]);
-                            }
-                        }
+void WebApiPrometheusClass::addInverterInfo(Print* stream, const uint8_t idx)
+{
+    auto inv = Hoymiles.getInverterByPos(idx);
+    if (inv == nullptr) {
+        return;
+    }
+
+    String serial = inv->serialString();
+    const char* name = inv->name();
+
+    // all values are taken from the same statistics packet
+    auto stats = inv->Statistics()->getSnapshot();
+
+    if (idx == 0) {
+        stream->print("# HELP opendtu_last_update last update from inverter in s\n");
+        stream->print("# TYPE opendtu_last_update gauge\n");
+    }
+    stream->printf("opendtu_last_update{serial=\"%s\",unit=\"%d\",name=\"%s\"} %d\n",
+        serial.c_str(), idx, name, stats->getLastUpdate() / 1000);
+
+    if (idx == 0) {
+        stream->print("# HELP opendtu_inverter_limit_relative current relative limit of the inverter\n");
+        stream->print("# TYPE opendtu_inverter_limit_relative gauge\n");
+    }
+    stream->printf("opendtu_inverter_limit_relative{serial=\"%s\",unit=\"%d\",name=\"%s\"} %f\n",
+        serial.c_str(), idx, name, inv->SystemConfigPara()->getLimitPercent() / 100.0);
+
+    if (inv->DevInfo()->getMaxPower() > 0) {
+        if (idx == 0) {
+            stream->print("# HELP opendtu_inverter_limit_absolute current relative limit of the inverter\n");
+            stream->print("# TYPE opendtu_inverter_limit_absolute gauge\n");
+        }
+        stream->printf("opendtu_inverter_limit_absolute{serial=\"%s\",unit=\"%d\",name=\"%s\"} %f\n",
+            serial.c_str(), idx, name, inv->SystemConfigPara()->getLimitPercent() * inv->DevInfo()->getMaxPower() / 100.0);
+    }
+
+    // Loop all channels if Statistics have been updated at least once since DTU boot
+    if (stats->getLastUpdate() > 0) {
+        for (auto& t : stats->getChannelTypes()) {
+            for (auto& c : stats->getChannelsByType(t)) {
+                addPanelInfo(stream, serial, idx, inv, t, c);
+                for (uint8_t f = 0; f < sizeof(_publishFields) / sizeof(_publishFields[0]); f++) {
+                    if (t == TYPE_INV && _publishFields[f].field == FLD_PDC) {
+                        addField(stream, serial, idx, inv, *stats, t, c, _publishFields[f].field, _metricTypes[_publishFields[f].type], "PowerDC");
+                    } else {
+                        addField(stream, serial, idx, inv, *stats, t, c, _publishFields[f].field, _metricTypes[_publishFields[f].type]);
                     }
                 }
             }
         }
-        stream->addHeader("Cache-Control", "no-cache");
-        request->send(stream);
-
-    } catch (std::bad_alloc& bad_alloc) {
-        MessageOutput.printf("Calling /api/prometheus/metrics has temporarily run out of resources. Reason: \"%s\".\r\n", bad_alloc.what());
-
-        WebApi.sendTooManyRequests(request);
     }
 }
 
-void WebApiPrometheusClass::addField(AsyncResponseStream* stream, const String& serial, const uint8_t idx, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, const char* metricName, const char* channelName)
+void WebApiPrometheusClass::addField(Print* stream, const String& serial, const uint8_t idx, std::shared_ptr<InverterAbstract> inv, const StatisticsSnapshot& stats, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, const char* metricName, const char* channelName)
 {
-    if (inv->Statistics()->hasChannelFieldValue(type, channel, fieldId)) {
-        const char* chanName = (channelName == nullptr) ? inv->Statistics()->getChannelFieldName(type, channel, fieldId) : channelName;
+    if (stats.hasChannelFieldValue(type, channel, fieldId)) {
+        const char* chanName = (channelName == nullptr) ? stats.getChannelFieldName(type, channel, fieldId) : channelName;
         if (idx == 0 && type == TYPE_AC && channel == 0) {
-            stream->printf("# HELP opendtu_%s in %s\n", chanName, inv->Statistics()->getChannelFieldUnit(type, channel, fieldId));
+            stream->printf("# HELP opendtu_%s in %s\n", chanName, stats.getChannelFieldUnit(type, channel, fieldId));
             stream->printf("# TYPE opendtu_%s %s\n", chanName, metricName);
         }
         stream->printf("opendtu_%s{serial=\"%s\",unit=\"%d\",name=\"%s\",type=\"%s\",channel=\"%d\"} %s\n",
@@ -131,13 +189,13 @@ void WebApiPrometheusClass::addField(AsyncResponseStream* stream, const String&
             serial.c_str(),
             idx,
             inv->name(),
-            inv->Statistics()->getChannelTypeName(type),
+            stats.getChannelTypeName(type),
             channel,
-            inv->Statistics()->getChannelFieldValueString(type, channel, fieldId).c_str());
+            stats.getChannelFieldValueString(type, channel, fieldId).c_str());
     }
 }
 
-void WebApiPrometheusClass::addPanelInfo(AsyncResponseStream* stream, const String& serial, const uint8_t idx, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel)
+void WebApiPrometheusClass::addPanelInfo(Print* stream, const String& serial, const uint8_t idx, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel)
 {
     if (type != TYPE_DC) {
         return;
@@ -179,3 +237,258 @@ void WebApiPrometheusClass::addPanelInfo(AsyncResponseStream* stream, const Stri
         channel,
         config->channel[channel].YieldTotalOffset);
 }
+
+void WebApiPrometheusClass::addMetricHeader(Print* stream, const char* name, const char* help, const char* type)
+{
+    stream->printf("# HELP %s %s\n", name, help);
+    stream->printf("# TYPE %s %s\n", name, type);
+}
+
+void WebApiPrometheusClass::addHistogram(Print* stream, const char* name, const char* help, const LatencyHistogram& histogram)
+{
+    addMetricHeader(stream, name, help, "histogram");
+
+    auto snapshot = histogram.getSnapshot();
+
+    // prometheus buckets are cumulative, the last one is "+Inf"
+    uint32_t cumulated = 0;
+    for (size_t bucket = 0; bucket < LatencyHistogram::BucketCount - 1; ++bucket) {
+        cumulated += snapshot.buckets[bucket];
+        stream->printf("%s_bucket{le=\"%u\"} %u\n", name,
+            LatencyHistogram::getUpperBound(bucket), cumulated);
+    }
+    stream->printf("%s_bucket{le=\"+Inf\"} %u\n", name, snapshot.count);
+    stream->printf("%s_sum %llu\n", name, static_cast<unsigned long long>(snapshot.sum));
+    stream->printf("%s_count %u\n", name, snapshot.count);
+}
+
+void WebApiPrometheusClass::addPowerLimiterInfo(Print* stream)
+{
+    if (!Configuration.get().PowerLimiter.Enabled) {
+        return;
+    }
+
+    addMetricHeader(stream, "opendtu_dpl_status", "dynamic power limiter status "
+        "(0: initializing, 1: disabled by config, 2: disabled by MQTT, 3: waiting for valid timestamp, "
+        "4: power meter pending, 5: inverter invalid, 6: inverter changed, 7: inverter offline, "
+        "8: inverter commands disabled, 9: limit pending, 10: power command pending, "
+        "11: device info pending, 12: stats pending, 13: calculated limit below min limit, "
+        "14: unconditional solar passthrough, 15: no VE.Direct, 16: no energy, 17: Huawei PSU, "
+        "18: stable)", "gauge");
+    stream->printf("opendtu_dpl_status %u\n", static_cast<unsigned>(PowerLimiter.getStatus()));
+
+    addMetricHeader(stream, "opendtu_dpl_mode", "dynamic power limiter mode (0: normal, 1: disabled, 2: full solar passthrough)", "gauge");
+    stream->printf("opendtu_dpl_mode %u\n", static_cast<unsigned>(PowerLimiter.getMode()));
+
+    addMetricHeader(stream, "opendtu_dpl_state", "dynamic power limiter state (0: inactive, 1: charging, 2: solar only, 3: solar and battery)", "gauge");
+    stream->printf("opendtu_dpl_state %u\n", PowerLimiter.getPowerLimiterState());
+
+    addMetricHeader(stream, "opendtu_dpl_last_requested_limit", "last power limit in W sent to the inverter", "gauge");
+    stream->printf("opendtu_dpl_last_requested_limit %d\n", PowerLimiter.getLastRequestedPowerLimit());
+
+    addMetricHeader(stream, "opendtu_dpl_inverter_update_timeouts", "inverter updates timed out in succession", "gauge");
+    stream->printf("opendtu_dpl_inverter_update_timeouts %u\n", PowerLimiter.getInverterUpdateTimeouts());
+
+    addMetricHeader(stream, "opendtu_dpl_calculation_backoff", "minimum time in ms between two limit calculations", "gauge");
+    stream->printf("opendtu_dpl_calculation_backoff %u\n", PowerLimiter.getCalculationBackoffMs());
+
+    if (PowerLimiter.getLastCalculationMillis() > 0) {
+        addMetricHeader(stream, "opendtu_dpl_last_calculation_age", "time in ms since the last limit calculation", "gauge");
+        stream->printf("opendtu_dpl_last_calculation_age %u\n", millis() - PowerLimiter.getLastCalculationMillis());
+    }
+
+    addMetricHeader(stream, "opendtu_dpl_last_update_duration", "time in ms the last inverter update took to complete", "gauge");
+    stream->printf("opendtu_dpl_last_update_duration %u\n", PowerLimiter.getLastUpdateDurationMs());
+
+    auto const& latency = PowerLimiter.getLatencyStats();
+    addHistogram(stream, "opendtu_dpl_meter_age_milliseconds",
+        "age of the power meter reading when calculating a new limit", latency.meterAge);
+    addHistogram(stream, "opendtu_dpl_calculation_microseconds",
+        "time to calculate a new limit", latency.calculation);
+    addHistogram(stream, "opendtu_dpl_command_round_trip_milliseconds",
+        "time from starting an inverter update until the limit is confirmed", latency.commandRoundTrip);
+    addHistogram(stream, "opendtu_dpl_stats_settling_milliseconds",
+        "time from the limit confirmation until the inverter reports new stats", latency.statsSettling);
+    addHistogram(stream, "opendtu_dpl_control_loop_milliseconds",
+        "time from the power meter reading until the limit is confirmed", latency.total);
+}
+
+void WebApiPrometheusClass::addPowerMeterInfo(Print* stream)
+{
+    if (!Configuration.get().PowerMeter.Enabled) {
+        return;
+    }
+
+    addMetricHeader(stream, "opendtu_powermeter_power", "total power in W measured by the power meter", "gauge");
+    stream->printf("opendtu_powermeter_power %f\n", PowerMeter.getPowerTotal());
+
+    addMetricHeader(stream, "opendtu_powermeter_data_valid", "power meter reading is recent", "gauge");
+    stream->printf("opendtu_powermeter_data_valid %d\n", PowerMeter.isDataValid());
+
+    addMetricHeader(stream, "opendtu_powermeter_data_age", "age of the power meter reading in s", "gauge");
+    stream->printf("opendtu_powermeter_data_age %u\n", (millis() - PowerMeter.getLastUpdate()) / 1000);
+}
+
+void WebApiPrometheusClass::addBatteryInfo(Print* stream)
+{
+    if (!Configuration.get().Battery.Enabled) {
+        return;
+    }
+
+    auto stats = Battery.getStats();
+    const char* manufacturer = stats->getManufacturer().c_str();
+
+    addMetricHeader(stream, "opendtu_battery_data_age", "age of the battery data in s", "gauge");
+    stream->printf("opendtu_battery_data_age{manufacturer=\"%s\"} %u\n", manufacturer, stats->getAgeSeconds());
+
+    if (stats->isSoCValid()) {
+        addMetricHeader(stream, "opendtu_battery_soc", "battery state of charge in %", "gauge");
+        stream->printf("opendtu_battery_soc{manufacturer=\"%s\"} %.*f\n",
+            manufacturer, stats->getSoCPrecision(), static_cast<float>(stats->getSoC()));
+    }
+
+    if (stats->isVoltageValid()) {
+        addMetricHeader(stream, "opendtu_battery_voltage", "battery voltage in V", "gauge");
+        stream->printf("opendtu_battery_voltage{manufacturer=\"%s\"} %f\n", manufacturer, stats->getVoltage());
+    }
+
+    if (stats->isCurrentValid()) {
+        addMetricHeader(stream, "opendtu_battery_current", "battery charge (positive) or discharge (negative) current in A", "gauge");
+        stream->printf("opendtu_battery_current{manufacturer=\"%s\"} %.*f\n",
+            manufacturer, stats->getChargeCurrentPrecision(), stats->getChargeCurrent());
+    }
+
+    if (stats->getChargeCurrentLimitation() != FLT_MAX) {
+        addMetricHeader(stream, "opendtu_battery_charge_current_limit", "charge current limit in A requested by the battery", "gauge");
+        stream->printf("opendtu_battery_charge_current_limit{manufacturer=\"%s\"} %f\n", manufacturer, stats->getChargeCurrentLimitation());
+    }
+
+    addMetricHeader(stream, "opendtu_battery_immediate_charging_request", "battery requests to be charged immediately", "gauge");
+    stream->printf("opendtu_battery_immediate_charging_request{manufacturer=\"%s\"} %d\n", manufacturer, stats->getImmediateChargingRequest());
+}
+
+void WebApiPrometheusClass::addMpptInfo(Print* stream)
+{
+    if (!Configuration.get().Vedirect.Enabled) {
+        return;
+    }
+
+    using data_t = VeDirectMpptController::data_t;
+
+    std::vector<std::pair<size_t, data_t>> controllers;
+    for (size_t idx = 0; idx < VictronMppt.controllerAmount(); ++idx) {
+        auto oData = VictronMppt.getData(idx);
+        if (!oData.has_value() || !VictronMppt.isDataValid(idx)) {
+            continue;
+        }
+        controllers.emplace_back(idx, *oData);
+    }
+
+    if (controllers.empty()) {
+        return;
+    }
+
+    // all samples of a metric family have to be grouped together
+    auto addFamily = [&](const char* name, const char* help, std::function<float(data_t const&)> getValue) {
+        addMetricHeader(stream, name, help, "gauge");
+        for (auto const& controller : controllers) {
+            stream->printf("%s{serial=\"%s\",unit=\"%u\",product=\"%s\"} %f\n",
+                name,
+                controller.second.serialNr_SER,
+                static_cast<unsigned>(controller.first),
+                controller.second.getPidAsString().data(),
+                getValue(controller.second));
+        }
+    };
+
+    addMetricHeader(stream, "opendtu_mppt_data_age", "age of the charge controller data in s", "gauge");
+    for (auto const& controller : controllers) {
+        stream->printf("opendtu_mppt_data_age{serial=\"%s\",unit=\"%u\",product=\"%s\"} %u\n",
+            controller.second.serialNr_SER,
+            static_cast<unsigned>(controller.first),
+            controller.second.getPidAsString().data(),
+            VictronMppt.getDataAgeMillis(controller.first) / 1000);
+    }
+
+    addFamily("opendtu_mppt_battery_voltage", "battery voltage in V",
+        [](data_t const& d) { return d.batteryVoltage_V_mV / 1000.0f; });
+    addFamily("opendtu_mppt_battery_current", "battery current in A",
+        [](data_t const& d) { return d.batteryCurrent_I_mA / 1000.0f; });
+    addFamily("opendtu_mppt_battery_power", "output power in W",
+        [](data_t const& d) { return static_cast<float>(d.batteryOutputPower_W); });
+    addFamily("opendtu_mppt_panel_voltage", "panel voltage in V",
+        [](data_t const& d) { return d.panelVoltage_VPV_mV / 1000.0f; });
+    addFamily("opendtu_mppt_panel_current", "panel current in A",
+        [](data_t const& d) { return d.panelCurrent_mA / 1000.0f; });
+    addFamily("opendtu_mppt_panel_power", "panel power in W",
+        [](data_t const& d) { return static_cast<float>(d.panelPower_PPV_W); });
+    addFamily("opendtu_mppt_efficiency", "conversion efficiency in %",
+        [](data_t const& d) { return d.mpptEfficiency_Percent; });
+    addFamily("opendtu_mppt_yield_day", "yield today in Wh",
+        [](data_t const& d) { return static_cast<float>(d.yieldToday_H20_Wh); });
+    addFamily("opendtu_mppt_yield_total", "yield total in Wh",
+        [](data_t const& d) { return static_cast<float>(d.yieldTotal_H19_Wh); });
+    addFamily("opendtu_mppt_max_power_day", "maximum power today in W",
+        [](data_t const& d) { return static_cast<float>(d.maxPowerToday_H21_W); });
+    addFamily("opendtu_mppt_state_of_operation", "state of operation (CS)",
+        [](data_t const& d) { return static_cast<float>(d.currentState_CS); });
+    addFamily("opendtu_mppt_tracker_state", "state of the MPP tracker (MPPT)",
+        [](data_t const& d) { return static_cast<float>(d.stateOfTracker_MPPT); });
+    addFamily("opendtu_mppt_error", "error code (ERR)",
+        [](data_t const& d) { return static_cast<float>(d.errorCode_ERR); });
+    addFamily("opendtu_mppt_off_reason", "off reason (OR)",
+        [](data_t const& d) { return static_cast<float>(d.offReason_OR); });
+}
+
+void WebApiPrometheusClass::addHuaweiInfo(Print* stream)
+{
+    if (!Configuration.get().Huawei.Enabled) {
+        return;
+    }
+
+    const RectifierParameters_t* rp = HuaweiCan.get();
+
+    addMetricHeader(stream, "opendtu_huawei_mode", "charger mode (0: off, 1: on, 2: external auto, 3: internal auto)", "gauge");
+    stream->printf("opendtu_huawei_mode %u\n", HuaweiCan.getMode());
+
+    addMetricHeader(stream, "opendtu_huawei_auto_power_enabled", "charger is enabled by the automatic power control", "gauge");
+    stream->printf("opendtu_huawei_auto_power_enabled %d\n", HuaweiCan.getAutoPowerStatus());
+
+    addMetricHeader(stream, "opendtu_huawei_data_age", "age of the charger data in s", "gauge");
+    stream->printf("opendtu_huawei_data_age %u\n", (millis() - HuaweiCan.getLastUpdate()) / 1000);
+
+    auto const& decision = EnergyFlow.getLastDecision();
+    addMetricHeader(stream, "opendtu_energy_flow_direction", "energy flow decision (0: idle, 1: charge, 2: discharge)", "gauge");
+    stream->printf("opendtu_energy_flow_direction %u\n", static_cast<unsigned>(decision.direction));
+
+    addMetricHeader(stream, "opendtu_energy_flow_reason", "reason for the energy flow decision "
+        "(0: initializing, 1: PSU not automatic, 2: no power meter, 3: full solar passthrough, "
+        "4: SoC stop threshold, 5: surplus, 6: no surplus, 7: inverter stopping, 8: PSU stopping)", "gauge");
+    stream->printf("opendtu_energy_flow_reason %u\n", static_cast<unsigned>(decision.reason));
+
+    addMetricHeader(stream, "opendtu_energy_flow_charge_power", "charge power in W assigned to the charger", "gauge");
+    stream->printf("opendtu_energy_flow_charge_power %.0f\n", decision.chargePower);
+
+    const struct {
+        const char* name;
+        const char* help;
+        float value;
+    } values[] = {
+        { "opendtu_huawei_input_voltage", "input voltage in V", rp->input_voltage },
+        { "opendtu_huawei_input_frequency", "input frequency in Hz", rp->input_frequency },
+        { "opendtu_huawei_input_current", "input current in A", rp->input_current },
+        { "opendtu_huawei_input_power", "input power in W", rp->input_power },
+        { "opendtu_huawei_input_temperature", "input temperature in °C", rp->input_temp },
+        { "opendtu_huawei_efficiency", "efficiency in %", rp->efficiency * 100 },
+        { "opendtu_huawei_output_voltage", "output voltage in V", rp->output_voltage },
+        { "opendtu_huawei_output_current", "output current in A", rp->output_current },
+        { "opendtu_huawei_max_output_current", "maximum output current in A", rp->max_output_current },
+        { "opendtu_huawei_output_power", "output power in W", rp->output_power },
+        { "opendtu_huawei_output_temperature", "output temperature in °C", rp->output_temp },
+    };
+
+    for (auto const& v : values) {
+        addMetricHeader(stream, v.name, v.help, "gauge");
+        stream->printf("%s %f\n", v.name, v.value);
+    }
+}
@@ -13,6 +13,7 @@
 #include "VictronMppt.h"
 #include "defaults.h"
 #include <AsyncJson.h>
+#include <cmath>
 
 WebApiWsLiveClass::WebApiWsLiveClass()
     : _ws("/livedata")
@@ -136,10 +137,113 @@ void WebApiWsLiveClass::sendOnBatteryStats()
     if (root.isNull()) { return; }
 
     if (Utils::checkJsonAlloc(root, __FUNCTION__, __LINE__)) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        sendJson(root);
+        sendMsgPack(root);
+    }
+}
+
+bool WebApiWsLiveClass::hasJsonClients()
+{
+    for (auto& client : _ws.getClients()) {
+        if (client.status() != WS_CONNECTED) { continue; }
+        if (_deltaClients.find(client.id()) == _deltaClients.end()) { return true; }
+    }
+
+    return false;
+}
+
+// sends the document as text to all clients which did not negotiate the
+// binary delta format
+void WebApiWsLiveClass::sendJson(JsonDocument& root)
+{
+    if (_deltaClients.empty()) {
         String buffer;
         serializeJson(root, buffer);
+        _ws.textAll(buffer);
+        return;
+    }
+
+    std::shared_ptr<std::vector<uint8_t>> buffer;
+
+    for (auto& client : _ws.getClients()) {
+        if (client.status() != WS_CONNECTED) { continue; }
+        if (_deltaClients.find(client.id()) != _deltaClients.end()) { continue; }
+
+        if (!buffer) {
+            // serializeJson() appends a terminating null character
+            buffer = std::make_shared<std::vector<uint8_t>>(measureJson(root) + 1);
+            serializeJson(root, reinterpret_cast<char*>(buffer->data()), buffer->size());
+            buffer->pop_back();
+        }
+
+        client.text(buffer);
+    }
+}
+
+// sends the document in MessagePack format to all clients which negotiated
+// the binary delta format
+void WebApiWsLiveClass::sendMsgPack(JsonDocument& root)
+{
+    std::shared_ptr<std::vector<uint8_t>> buffer;
+
+    for (auto& [id, state] : _deltaClients) {
+        auto client = _ws.client(id);
+        if (client == nullptr || client->status() != WS_CONNECTED) { continue; }
+
+        if (!buffer) {
+            buffer = std::make_shared<std::vector<uint8_t>>(measureMsgPack(root));
+            serializeMsgPack(root, buffer->data(), buffer->size());
+        }
 
-        _ws.textAll(buffer);;
+        client->binary(buffer);
+    }
+}
+
+void WebApiWsLiveClass::sendDeltaFrame(AsyncWebSocketClient& client, DeltaClient& state, const uint8_t idx, std::shared_ptr<InverterAbstract> inv)
+{
+    auto& delta = state.inverters[idx];
+    if (delta.serial != inv->serial()) {
+        delta = LiveDataDelta();
+        delta.serial = inv->serial();
+    }
+
+    // send static data like units and names once in a while, such that
+    // changes are picked up eventually
+    if (++delta.frames % 60 == 0) { delta.acked.clear(); }
+
+    JsonDocument root;
+    JsonVariant var = root;
+
+    root["seq"] = ++state.seq;
+
+    auto invArray = var["inverters"].to<JsonArray>();
+    auto invObject = invArray.add<JsonObject>();
+
+    generateCommonJsonResponse(var);
+    generateInverterCommonJsonResponse(invObject, inv);
+    generateInverterChannelJsonResponse(invObject, inv, &delta);
+
+    delta.pendingSeq = state.seq;
+
+    if (!Utils::checkJsonAlloc(root, __FUNCTION__, __LINE__)) {
+        return;
+    }
+
+    auto buffer = std::make_shared<std::vector<uint8_t>>(measureMsgPack(root));
+    serializeMsgPack(root, buffer->data(), buffer->size());
+    client.binary(buffer);
+}
+
+// the client applied all frames up to and including seq, so the values
+// sent with them may be omitted from now on
+void WebApiWsLiveClass::acknowledge(DeltaClient& state, const uint32_t seq)
+{
+    for (auto& delta : state.inverters) {
+        if (delta.pendingSeq == 0 || seq < delta.pendingSeq) { continue; }
+
+        delta.acked = delta.pending;
+        delta.pendingSeq = 0;
     }
 }
 
@@ -168,6 +272,18 @@ void WebApiWsLiveClass::sendDataTaskCb()
 
         try {
             std::lock_guard<std::mutex> lock(_mutex);
+
+            for (auto& [id, state] : _deltaClients) {
+                auto client = _ws.client(id);
+                if (client == nullptr || client->status() != WS_CONNECTED) { continue; }
+
+                sendDeltaFrame(*client, state, i, inv);
+            }
+
+            if (!hasJsonClients()) {
+                continue;
+            }
+
             JsonDocument root;
             JsonVariant var = root;
 
@@ -182,10 +298,7 @@ void WebApiWsLiveClass::sendDataTaskCb()
                 continue;
             }
 
-            String buffer;
-            serializeJson(root, buffer);
-
-            _ws.textAll(buffer);
+            sendJson(root);
 
         } catch (const std::bad_alloc& bad_alloc) {
             MessageOutput.printf("Calling /api/livedata/status has temporarily run out of resources. Reason: \"%s\".\r\n", bad_alloc.what());
@@ -231,65 +344,110 @@ void WebApiWsLiveClass::generateInverterCommonJsonResponse(JsonObject& root, std
     }
 }
 
-void WebApiWsLiveClass::generateInverterChannelJsonResponse(JsonObject& root, std::shared_ptr<InverterAbstract> inv)
+void WebApiWsLiveClass::generateInverterChannelJsonResponse(JsonObject& root, std::shared_ptr<InverterAbstract> inv, LiveDataDelta* delta)
 {
     const INVERTER_CONFIG_T* inv_cfg = Configuration.getInverterConfig(inv->serial());
     if (inv_cfg == nullptr) {
         return;
     }
 
+    // all values are taken from the same statistics packet
+    auto stats = inv->Statistics()->getSnapshot();
+
+    bool keyframe = (delta == nullptr || delta->isKeyframe());
+    if (delta != nullptr) { delta->slot = 0; }
+
     // Loop all channels
-    for (auto& t : inv->Statistics()->getChannelTypes()) {
-        auto chanTypeObj = root[inv->Statistics()->getChannelTypeName(t)].to<JsonObject>();
-        for (auto& c : inv->Statistics()->getChannelsByType(t)) {
-            if (t == TYPE_DC) {
+    for (auto& t : stats->getChannelTypes()) {
+        auto chanTypeObj = root[stats->getChannelTypeName(t)].to<JsonObject>();
+        for (auto& c : stats->getChannelsByType(t)) {
+            if (t == TYPE_DC && keyframe) {
                 chanTypeObj[String(static_cast<uint8_t>(c))]["name"]["u"] = inv_cfg->channel[c].Name;
             }
-            addField(chanTypeObj, inv, t, c, FLD_PAC);
-            addField(chanTypeObj, inv, t, c, FLD_UAC);
-            addField(chanTypeObj, inv, t, c, FLD_IAC);
+            addField(chanTypeObj, *stats, t, c, FLD_PAC, "", delta);
+            addField(chanTypeObj, *stats, t, c, FLD_UAC, "", delta);
+            addField(chanTypeObj, *stats, t, c, FLD_IAC, "", delta);
             if (t == TYPE_INV) {
-                addField(chanTypeObj, inv, t, c, FLD_PDC, "Power DC");
+                addField(chanTypeObj, *stats, t, c, FLD_PDC, "Power DC", delta);
             } else {
-                addField(chanTypeObj, inv, t, c, FLD_PDC);
+                addField(chanTypeObj, *stats, t, c, FLD_PDC, "", delta);
             }
-            addField(chanTypeObj, inv, t, c, FLD_UDC);
-            addField(chanTypeObj, inv, t, c, FLD_IDC);
-            addField(chanTypeObj, inv, t, c, FLD_YD);
-            addField(chanTypeObj, inv, t, c, FLD_YT);
-            addField(chanTypeObj, inv, t, c, FLD_F);
-            addField(chanTypeObj, inv, t, c, FLD_T);
-            addField(chanTypeObj, inv, t, c, FLD_PF);
-            addField(chanTypeObj, inv, t, c, FLD_Q);
-            addField(chanTypeObj, inv, t, c, FLD_EFF);
-            if (t == TYPE_DC && inv->Statistics()->getStringMaxPower(c) > 0) {
-                addField(chanTypeObj, inv, t, c, FLD_IRR);
-                chanTypeObj[String(c)][inv->Statistics()->getChannelFieldName(t, c, FLD_IRR)]["max"] = inv->Statistics()->getStringMaxPower(c);
+            addField(chanTypeObj, *stats, t, c, FLD_UDC, "", delta);
+            addField(chanTypeObj, *stats, t, c, FLD_IDC, "", delta);
+            addField(chanTypeObj, *stats, t, c, FLD_YD, "", delta);
+            addField(chanTypeObj, *stats, t, c, FLD_YT, "", delta);
+            addField(chanTypeObj, *stats, t, c, FLD_F, "", delta);
+            addField(chanTypeObj, *stats, t, c, FLD_T, "", delta);
+            addField(chanTypeObj, *stats, t, c, FLD_PF, "", delta);
+            addField(chanTypeObj, *stats, t, c, FLD_Q, "", delta);
+            addField(chanTypeObj, *stats, t, c, FLD_EFF, "", delta);
+            if (t == TYPE_DC && stats->getStringMaxPower(c) > 0) {
+                addField(chanTypeObj, *stats, t, c, FLD_IRR, "", delta);
+                if (keyframe) {
+                    chanTypeObj[String(c)][stats->getChannelFieldName(t, c, FLD_IRR)]["max"] = stats->getStringMaxPower(c);
+                }
             }
         }
     }
 
-    if (inv->Statistics()->hasChannelFieldValue(TYPE_INV, CH0, FLD_EVT_LOG)) {
+    if (delta != nullptr) {
+        delta->keys.resize(delta->slot);
+        delta->pending.resize(delta->slot);
+        if (delta->acked.size() > delta->slot) { delta->acked.resize(delta->slot); }
+    }
+
+    if (stats->hasChannelFieldValue(TYPE_INV, CH0, FLD_EVT_LOG)) {
         root["events"] = inv->EventLog()->getEntryCount();
     } else {
         root["events"] = -1;
     }
 }
 
-void WebApiWsLiveClass::addField(JsonObject& root, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, String topic)
+void WebApiWsLiveClass::addField(JsonObject& root, const StatisticsSnapshot& stats, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, String topic, LiveDataDelta* delta)
 {
-    if (inv->Statistics()->hasChannelFieldValue(type, channel, fieldId)) {
+    if (stats.hasChannelFieldValue(type, channel, fieldId)) {
+        float value = stats.getChannelFieldValue(type, channel, fieldId);
+
+        // fields known to the client are omitted if unchanged, units and
+        // digits are only sent along with unknown fields
+        bool known = false;
+        if (delta != nullptr) {
+            uint16_t key = (type * CH_CNT + channel) * FLD_CNT + fieldId;
+            size_t slot = delta->slot++;
+
+            if (slot >= delta->keys.size()) {
+                delta->keys.resize(slot + 1);
+                delta->pending.resize(slot + 1);
+            }
+
+            if (delta->keys[slot] != key) {
+                // the layout changed, forget about all following fields
+                delta->keys[slot] = key;
+                for (size_t i = slot; i < delta->acked.size(); ++i) { delta->acked[i] = NAN; }
+            }
+
+            delta->pending[slot] = value;
+
+            if (slot < delta->acked.size() && !std::isnan(delta->acked[slot])) {
+                if (delta->acked[slot] == value) { return; }
+                known = true;
+            }
+        }
+
         String chanName;
         if (topic == "") {
-            chanName = inv->Statistics()->getChannelFieldName(type, channel, fieldId);
+            chanName = stats.getChannelFieldName(type, channel, fieldId);
         } else {
             chanName = topic;
         }
         String chanNum;
         chanNum = channel;
-        root[chanNum][chanName]["v"] = inv->Statistics()->getChannelFieldValue(type, channel, fieldId);
-        root[chanNum][chanName]["u"] = inv->Statistics()->getChannelFieldUnit(type, channel, fieldId);
-        root[chanNum][chanName]["d"] = inv->Statistics()->getChannelFieldDigits(type, channel, fieldId);
+        root[chanNum][chanName]["v"] = value;
+
+        if (known) { return; }
+
+        root[chanNum][chanName]["u"] = stats.getChannelFieldUnit(type, channel, fieldId);
+        root[chanNum][chanName]["d"] = stats.getChannelFieldDigits(type, channel, fieldId);
     }
 }
 
@@ -306,6 +464,38 @@ void WebApiWsLiveClass::onWebsocketEvent(AsyncWebSocket* server, AsyncWebSocketC
         MessageOutput.printf("Websocket: [%s][%u] connect\r\n", server->url(), client->id());
     } else if (type == WS_EVT_DISCONNECT) {
         MessageOutput.printf("Websocket: [%s][%u] disconnect\r\n", server->url(), client->id());
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _deltaClients.erase(client->id());
+    } else if (type == WS_EVT_DATA) {
+        // only short text messages are expected: the format negotiation
+        // {"format":"msgpack-delta"} and acknowledgements {"ack":<seq>}
+        auto info = reinterpret_cast<AwsFrameInfo*>(arg);
+        if (!info->final || info->index != 0 || info->len != len || info->opcode != WS_TEXT) {
+            return;
+        }
+
+        JsonDocument doc;
+        if (deserializeJson(doc, reinterpret_cast<const char*>(data), len)) {
+            return; // e.g., the heartbeat "ping"
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (doc["format"].is<const char*>()) {
+            if (doc["format"] == "msgpack-delta") {
+                _deltaClients[client->id()] = DeltaClient();
+                MessageOutput.printf("Websocket: [%s][%u] using binary delta format\r\n", server->url(), client->id());
+            } else {
+                _deltaClients.erase(client->id());
+            }
+            return;
+        }
+
+        auto iter = _deltaClients.find(client->id());
+        if (iter != _deltaClients.end() && doc["ack"].is<uint32_t>()) {
+            acknowledge(iter->second, doc["ack"].as<uint32_t>());
+        }
     }
 }
 
@@ -315,44 +505,53 @@ void WebApiWsLiveClass::onLivedataStatus(AsyncWebServerRequest* request)
         return;
     }
 
-    try {
-        std::lock_guard<std::mutex> lock(_mutex);
-        AsyncJsonResponse* response = new AsyncJsonResponse();
-        auto& root = response->getRoot();
-        auto invArray = root["inverters"].to<JsonArray>();
-        auto serial = WebApi.parseSerialFromRequest(request);
-
-        if (serial > 0) {
-            auto inv = Hoymiles.getInverterBySerial(serial);
-            if (inv != nullptr) {
-                JsonObject invObject = invArray.add<JsonObject>();
-                generateInverterCommonJsonResponse(invObject, inv);
-                generateInverterChannelJsonResponse(invObject, inv);
+    auto serial = WebApi.parseSerialFromRequest(request);
+
+    // every inverter is serialized into a document of its own, such that
+    // the memory needed does not grow with the number of inverters.
+    WebApi.sendChunkedJsonResponse(request,
+        [this, serial](JsonStreamWriter& writer, size_t section) -> bool {
+            size_t inverterSections = (serial > 0) ? 1 : Hoymiles.getNumInverters();
+
+            if (section == 0) {
+                writer.beginObject();
+                writer.beginArray("inverters");
+                return true;
             }
-        } else {
-            // Loop all inverters
-            for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
-                auto inv = Hoymiles.getInverterByPos(i);
-                if (inv == nullptr) {
-                    continue;
-                }
 
-                JsonObject invObject = invArray.add<JsonObject>();
+            if (section <= inverterSections) {
+                auto inv = (serial > 0) ? Hoymiles.getInverterBySerial(serial)
+                    : Hoymiles.getInverterByPos(section - 1);
+                if (inv == nullptr) { return true; }
+
+                JsonDocument doc;
+                JsonObject invObject = doc.to<JsonObject>();
+
+                std::lock_guard<std::mutex> lock(_mutex);
                 generateInverterCommonJsonResponse(invObject, inv);
+                if (serial > 0) {
+                    generateInverterChannelJsonResponse(invObject, inv);
+                }
+
+                writer.add(doc.as<JsonVariantConst>());
+                return true;
             }
-        }
 
-        generateCommonJsonResponse(root);
+            if (section == inverterSections + 1) {
+                writer.endArray();
 
-        generateOnBatteryJsonResponse(root, true);
+                JsonDocument doc;
+                JsonVariant root = doc.to<JsonObject>();
 
-        WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
-    
-    } catch (const std::bad_alloc& bad_alloc) {
-        MessageOutput.printf("Calling /api/livedata/status has temporarily run out of resources. Reason: \"%s\".\r\n", bad_alloc.what());
-        WebApi.sendTooManyRequests(request);
-    } catch (const std::exception& exc) {
-        MessageOutput.printf("Unknown exception in /api/livedata/status. Reason: \"%s\".\r\n", exc.what());
-        WebApi.sendTooManyRequests(request);
-    }
+                std::lock_guard<std::mutex> lock(_mutex);
+                generateCommonJsonResponse(root);
+                generateOnBatteryJsonResponse(root, true);
+
+                writer.merge(doc.as<JsonObjectConst>());
+                writer.endObject();
+                return true;
+            }
+
+            return false;
+        });
 }
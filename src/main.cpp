@@ -5,6 +5,8 @@
 #include "Configuration.h"
 #include "Datastore.h"
 #include "Display_Graphic.h"
+#include "EnergyLog.h"
+#include "History.h"
 #include "InverterSettings.h"
 #include "Led_Single.h"
 #include "MessageOutput.h"
@@ -195,6 +197,9 @@ void setup()
     }
 
     Battery.init(scheduler);
+
+    History.init(scheduler);
+    EnergyLog.init(scheduler);
 }
 
 void loop()
@@ -0,0 +1,353 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "DplSimulator.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace DplSimulation {
+
+static constexpr uint32_t SecondsPerDay = 24 * 3600;
+
+LoadProfile LoadProfile::syntheticDay(uint32_t seed)
+{
+    LoadProfile res;
+    res._watts.resize(SecondsPerDay);
+
+    // linear congruential generator, reproducible across platforms
+    uint32_t state = seed;
+    auto random = [&state]() -> float {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) / static_cast<float>(1u << 24);
+    };
+
+    auto between = [](uint32_t s, float fromHour, float toHour) -> bool {
+        return s >= fromHour * 3600 && s < toHour * 3600;
+    };
+
+    float noise = 0;
+    for (uint32_t s = 0; s < SecondsPerDay; ++s) {
+        float watts = 120; // standby devices, network, heating pump
+
+        // the fridge compressor runs 15 of every 45 minutes
+        if ((s / 60) % 45 < 15) { watts += 90; }
+
+        if (between(s, 6.5, 6.55)) { watts += 2000; } // kettle
+        if (between(s, 7, 7.25)) { watts += 1000; } // toaster, coffee
+        if (between(s, 10, 10.25)) { watts += 2000; } // washing machine heats
+        if (between(s, 10.25, 11.5)) { watts += 150 + ((s / 30) % 3) * 100; } // and spins
+        if (between(s, 12, 12.5)) { watts += 1500; } // cooking
+        if (between(s, 13, 13.05)) { watts += 800; } // microwave
+        if (between(s, 18, 18.75)) { watts += 1800; } // cooking
+        if (between(s, 19, 23)) { watts += 180; } // TV, lights
+
+        // the noise is a random walk which is pulled back to zero
+        noise = noise * 0.9f + (random() - 0.5f) * 20;
+        res._watts[s] = std::max(0.0f, watts + noise);
+    }
+
+    return res;
+}
+
+LoadProfile LoadProfile::fromCsv(std::string const& path)
+{
+    LoadProfile res;
+    std::ifstream file(path);
+    std::string line;
+
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') { continue; }
+
+        std::replace(line.begin(), line.end(), ';', ',');
+        std::istringstream fields(line);
+        std::string first, second;
+        std::getline(fields, first, ',');
+
+        if (!std::getline(fields, second, ',')) {
+            res._watts.push_back(std::strtof(first.c_str(), nullptr));
+            continue;
+        }
+
+        // sample and hold until the given second
+        auto until = static_cast<size_t>(std::strtoul(first.c_str(), nullptr, 10));
+        float watts = std::strtof(second.c_str(), nullptr);
+        float last = res._watts.empty() ? watts : res._watts.back();
+        while (res._watts.size() < until) { res._watts.push_back(last); }
+        res._watts.push_back(watts);
+    }
+
+    return res;
+}
+
+float LoadProfile::at(uint32_t millis) const
+{
+    if (_watts.empty()) { return 0; }
+    return _watts[std::min<size_t>(millis / 1000, _watts.size() - 1)];
+}
+
+double LoadProfile::getEnergyWh() const
+{
+    double res = 0;
+    for (auto watts : _watts) { res += watts; }
+    return res / 3600;
+}
+
+Simulator::Simulator(Config const& config, LoadProfile const& load)
+    : _config(config)
+    , _load(load)
+{
+    _soc = config.initialSoc;
+    _controller.setTuning(config.kp, config.ki);
+}
+
+float Simulator::getSolarPower(uint32_t now) const
+{
+    uint32_t s = (now / 1000) % SecondsPerDay;
+    if (s <= _config.sunrise || s >= _config.sunset) { return 0; }
+
+    float phase = static_cast<float>(s - _config.sunrise) / (_config.sunset - _config.sunrise);
+    return _config.solarPeakPower * std::sin(phase * static_cast<float>(M_PI));
+}
+
+Report Simulator::run()
+{
+    uint32_t duration = _load.getDurationSeconds() * 1000;
+    float dt = _config.timeStep / 1000.0f;
+    double deviation = 0;
+    double producingSeconds = 0;
+
+    for (uint32_t now = 0; now < duration; now += _config.timeStep) {
+        stepPlant(now, dt);
+        loopDpl(now);
+
+        float load = _load.at(now);
+        float grid = load - _output;
+        _report.loadWh += load * dt / 3600;
+        _report.inverterWh += _output * dt / 3600;
+        if (grid > 0) { _report.importedWh += grid * dt / 3600; }
+        if (grid < 0) { _report.exportedWh -= grid * dt / 3600; }
+
+        if (_producing) {
+            deviation += std::fabs(grid - _config.targetConsumption) * dt;
+            producingSeconds += dt;
+        }
+
+        _report.minSoc = std::min(_report.minSoc, _soc);
+        _report.maxSoc = std::max(_report.maxSoc, _soc);
+    }
+
+    _report.finalSoc = _soc;
+    if (producingSeconds > 0) { _report.meanDeviation = deviation / producingSeconds; }
+    return _report;
+}
+
+void Simulator::stepPlant(uint32_t now, float dt)
+{
+    if (_pendingCommand.has_value() && now >= _pendingCommand->ackAt) {
+        if (_pendingCommand->isLimit) {
+            _appliedLimit = _pendingCommand->value;
+        } else if (_pendingCommand->value != 0 && !_producing) {
+            _producingFrom = now + _config.startupDelay;
+        } else if (_pendingCommand->value == 0) {
+            _producing = false;
+            _producingFrom = std::nullopt;
+        }
+
+        _lastUpdateCommand = now;
+        _pendingCommand = std::nullopt;
+    }
+
+    if (_producingFrom.has_value() && now >= *_producingFrom) {
+        _producing = true;
+        _producingFrom = std::nullopt;
+    }
+
+    // the solar charger feeds the battery and the inverter. the battery can
+    // supply any power the inverter draws until it is empty.
+    float solar = getSolarPower(now);
+    float target = _producing ? std::min(_appliedLimit, _config.maxPower) : 0;
+    if (_soc <= 0) { target = std::min(target, solar * _config.efficiency); }
+    _output += (target - _output) * (1 - std::exp(-dt / _config.rampTimeConstant));
+
+    float draw = _output / _config.efficiency;
+    if (_soc >= 100) { solar = std::min(solar, draw); } // charger throttles
+    _solar = solar;
+    _report.solarWh += solar * dt / 3600;
+
+    float energy = _soc / 100 * _config.batteryCapacityWh + (solar - draw) * dt / 3600;
+    _soc = std::clamp(energy / _config.batteryCapacityWh * 100, 0.0f, 100.0f);
+
+    // inverter statistics are requested at the poll interval
+    if (now >= _nextPoll) {
+        _statsDueAt = now + _config.statsLatency;
+        _nextPoll += _config.pollInterval;
+    }
+
+    if (_statsDueAt.has_value() && now >= *_statsDueAt) {
+        _statsOutput = _output;
+        _statsProducing = _producing;
+        _statsMillis = now;
+        _statsDueAt = std::nullopt;
+    }
+
+    // the meter samples the grid power, the reading arrives after a latency
+    if (now >= _nextMeterSample) {
+        _meterSample = _load.at(now) - _output;
+        _meterDueAt = now + _config.meterLatency;
+        _nextMeterSample += _config.meterInterval;
+    }
+
+    if (_meterDueAt.has_value() && now >= *_meterDueAt) {
+        _meterValue = _meterSample;
+        _meterMillis = now;
+        _meterDueAt = std::nullopt;
+    }
+}
+
+void Simulator::loopDpl(uint32_t now)
+{
+    if (updateInverter(now)) { return; }
+
+    auto gate = _calculationGate.check(now, _lastUpdateCommand, _statsMillis,
+            true, _meterMillis);
+    if (gate != PowerLimiterCalc::CalculationGate::State::Ready) { return; }
+
+    if (_soc <= _config.socStopThreshold) {
+        _batteryDischargeEnabled = false;
+    } else if (_soc >= _config.socStartThreshold) {
+        _batteryDischargeEnabled = true;
+    }
+
+    ++_report.calculations;
+    bool limitUpdated = calcPowerLimit(now, _batteryDischargeEnabled);
+    _calculationGate.calculated(now);
+    _calculationGate.adaptBackoff(limitUpdated);
+}
+
+bool Simulator::calcPowerLimit(uint32_t now, bool batteryPower)
+{
+    if (_solar <= 0 && !batteryPower) { return shutdown(now); }
+
+    // solar passthrough losses of 3 %, see POWERLIMITER_SOLAR_PASSTHROUGH_LOSSES
+    auto solarPowerAC = static_cast<int32_t>(_solar * _config.efficiency * 0.97f);
+    auto governedOutput = static_cast<int32_t>(_statsOutput);
+    auto meterValue = static_cast<int32_t>(_meterValue);
+
+    auto newPowerLimit = PowerLimiterCalc::requiredPower(true, meterValue, true,
+            governedOutput, _config.targetConsumption, _config.baseLoad);
+
+    auto bounds = PowerLimiterCalc::energySourceBounds(batteryPower, false, solarPowerAC);
+
+    if (_config.piController) {
+        int32_t capacity = std::min(_config.upperLimit, _config.maxPower);
+        auto base = PowerLimiterCalc::controllerBase(_appliedLimit, governedOutput);
+        newPowerLimit = _controller.update(meterValue - _config.targetConsumption,
+                base, std::max(0, bounds.lower), std::min(capacity, bounds.upper));
+    } else {
+        _controller.reset();
+    }
+
+    newPowerLimit = std::clamp(newPowerLimit, bounds.lower, bounds.upper);
+
+    return setNewPowerLimit(now, newPowerLimit);
+}
+
+bool Simulator::setNewPowerLimit(uint32_t now, int32_t newPowerLimit)
+{
+    auto oPowerLimit = PowerLimiterCalc::applyLowerLimit(newPowerLimit,
+            _config.lowerLimit, false);
+    if (!oPowerLimit.has_value()) { return shutdown(now); }
+
+    int32_t effPowerLimit = std::min(*oPowerLimit, _config.upperLimit);
+
+    // the simulated inverter has a single input, so the limit is not scaled
+    PowerLimiterCalc::ScalingInput scaling;
+    scaling.newLimit = effPowerLimit;
+    scaling.currentLimit = _appliedLimit;
+    scaling.producing = _statsProducing;
+    scaling.inverterOutputAc = _statsOutput;
+    scaling.efficiencyFactor = _config.efficiency;
+    scaling.channelPowerDc.push_back(_statsOutput / _config.efficiency);
+    effPowerLimit = PowerLimiterCalc::scaleLimit(scaling).limit;
+
+    effPowerLimit = std::min(effPowerLimit, _config.maxPower);
+
+    if (PowerLimiterCalc::exceedsHysteresis(effPowerLimit, _appliedLimit, _config.hysteresis)) {
+        _oTargetPowerLimitWatts = effPowerLimit;
+    }
+
+    _oTargetPowerState = true;
+    return updateInverter(now);
+}
+
+bool Simulator::shutdown(uint32_t now)
+{
+    _oTargetPowerState = false;
+    _controller.reset();
+    return updateInverter(now);
+}
+
+void Simulator::sendCommand(uint32_t now, bool isLimit, int32_t value)
+{
+    _pendingCommand = PendingCommand { isLimit, value, now + _config.commandLatency };
+    ++(isLimit ? _report.limitCommands : _report.powerCommands);
+}
+
+bool Simulator::updateInverter(uint32_t now)
+{
+    auto reset = [this]() -> bool {
+        _oTargetPowerState = std::nullopt;
+        _oTargetPowerLimitWatts = std::nullopt;
+        _oUpdateStartMillis = std::nullopt;
+        return false;
+    };
+
+    if (!_oTargetPowerState.has_value() && !_oTargetPowerLimitWatts.has_value()) {
+        return reset();
+    }
+
+    if (!_oUpdateStartMillis.has_value()) { _oUpdateStartMillis = now; }
+
+    if ((now - *_oUpdateStartMillis) > 30 * 1000) { return reset(); }
+
+    auto switchPowerState = [this,now](bool transitionOn) -> bool {
+        if (!_oTargetPowerState.has_value()) { return false; }
+        if (transitionOn != *_oTargetPowerState) { return false; }
+        if (_pendingCommand.has_value()) { return true; }
+
+        // stats more recent than the last command are required
+        if (_statsMillis <= _lastUpdateCommand) { return true; }
+
+        if (_statsProducing != *_oTargetPowerState) {
+            sendCommand(now, false, *_oTargetPowerState);
+            return true;
+        }
+
+        _oTargetPowerState = std::nullopt;
+        return false;
+    };
+
+    auto updateLimit = [this,now]() -> bool {
+        if (!_oTargetPowerLimitWatts.has_value()) { return false; }
+        if (_pendingCommand.has_value()) { return true; }
+
+        // the limit command was acknowledged after the update started
+        if (_lastUpdateCommand >= *_oUpdateStartMillis && _appliedLimit == *_oTargetPowerLimitWatts) {
+            _oTargetPowerLimitWatts = std::nullopt;
+            return false;
+        }
+
+        sendCommand(now, true, *_oTargetPowerLimitWatts);
+        return true;
+    };
+
+    if (switchPowerState(false)) { return true; }
+
+    if (updateLimit()) { return true; }
+
+    if (switchPowerState(true)) { return true; }
+
+    return reset();
+}
+
+} // namespace DplSimulation
@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <PowerLimiterCalc.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*
+ * Time-accelerated closed-loop simulation of the dynamic power limiter. The
+ * household load, the grid meter, one battery-powered inverter, the battery
+ * and the solar charger are modelled. The DPL side follows the sequence of
+ * PowerLimiterClass::loop(), calcPowerLimit(), setNewPowerLimit() and
+ * updateInverter(), using the same hardware independent functions from
+ * PowerLimiterCalc. All times are in milliseconds of simulated time.
+ */
+namespace DplSimulation {
+
+// household consumption in W with a resolution of one second
+class LoadProfile {
+public:
+    // a synthetic, reproducible day: base load, a cycling fridge, cooking
+    // peaks, a washing machine and TV in the evening, plus noise
+    static LoadProfile syntheticDay(uint32_t seed = 1);
+
+    // reads "<seconds>,<watts>" or "<watts>" (one line per second) records.
+    // empty lines and lines starting with '#' are skipped. returns an empty
+    // profile if the file cannot be read.
+    static LoadProfile fromCsv(std::string const& path);
+
+    bool empty() const { return _watts.empty(); }
+    uint32_t getDurationSeconds() const { return _watts.size(); }
+    float at(uint32_t millis) const;
+    double getEnergyWh() const;
+
+private:
+    std::vector<float> _watts;
+};
+
+struct Config {
+    // DPL settings, see PowerLimiterConfig
+    bool piController = false;
+    float kp = 1;
+    float ki = 0;
+    int32_t targetConsumption = 0;
+    int32_t hysteresis = 0;
+    int32_t lowerLimit = 10;
+    int32_t upperLimit = 800;
+    int32_t baseLoad = 100;
+    uint8_t socStartThreshold = 80;
+    uint8_t socStopThreshold = 20;
+
+    // inverter
+    int32_t maxPower = 800;
+    float efficiency = 0.95f;
+    uint32_t pollInterval = 5000; // statistics are requested at this interval
+    uint32_t statsLatency = 600; // until a statistics response is processed
+    uint32_t commandLatency = 1500; // until a command is acknowledged
+    uint32_t startupDelay = 5000; // from power on command to production
+    float rampTimeConstant = 1.5f; // s, output follows the limit (1st order)
+
+    // grid meter
+    uint32_t meterInterval = 1000;
+    uint32_t meterLatency = 300; // until a reading is available to the DPL
+
+    // battery and solar charger
+    float batteryCapacityWh = 5000;
+    float initialSoc = 90;
+    float solarPeakPower = 1200; // DC, sine shaped between sunrise and sunset
+    uint32_t sunrise = 6 * 3600;
+    uint32_t sunset = 20 * 3600;
+
+    uint32_t timeStep = 100;
+};
+
+struct Report {
+    double loadWh = 0;
+    double importedWh = 0;
+    double exportedWh = 0;
+    double inverterWh = 0;
+    double solarWh = 0;
+
+    uint32_t limitCommands = 0;
+    uint32_t powerCommands = 0;
+    uint32_t calculations = 0;
+
+    // mean absolute deviation of the grid power from the target consumption
+    // while the inverter is producing
+    double meanDeviation = 0;
+
+    float finalSoc = 0;
+    float minSoc = 100;
+    float maxSoc = 0;
+};
+
+class Simulator {
+public:
+    Simulator(Config const& config, LoadProfile const& load);
+
+    Report run();
+
+private:
+    struct PendingCommand {
+        bool isLimit;
+        int32_t value; // limit in W or power state
+        uint32_t ackAt;
+    };
+
+    void stepPlant(uint32_t now, float dt);
+    void loopDpl(uint32_t now);
+    bool calcPowerLimit(uint32_t now, bool batteryPower);
+    bool setNewPowerLimit(uint32_t now, int32_t newPowerLimit);
+    bool shutdown(uint32_t now);
+    bool updateInverter(uint32_t now);
+    void sendCommand(uint32_t now, bool isLimit, int32_t value);
+    float getSolarPower(uint32_t now) const;
+
+    Config _config;
+    LoadProfile const& _load;
+    Report _report;
+
+    // plant state
+    float _output = 0; // AC W
+    float _soc = 0;
+    float _solar = 0; // DC W actually harvested
+    bool _producing = false;
+    std::optional<uint32_t> _producingFrom = std::nullopt;
+    int32_t _appliedLimit = 0;
+    std::optional<PendingCommand> _pendingCommand = std::nullopt;
+    uint32_t _lastUpdateCommand = 0; // last acknowledged command
+
+    uint32_t _nextPoll = 0;
+    std::optional<uint32_t> _statsDueAt = std::nullopt;
+    float _statsOutput = 0;
+    bool _statsProducing = false;
+    uint32_t _statsMillis = 0;
+
+    uint32_t _nextMeterSample = 0;
+    std::optional<uint32_t> _meterDueAt = std::nullopt;
+    float _meterSample = 0;
+    float _meterValue = 0;
+    uint32_t _meterMillis = 0;
+
+    // DPL state, see PowerLimiterClass
+    std::optional<int32_t> _oTargetPowerLimitWatts = std::nullopt;
+    std::optional<bool> _oTargetPowerState = std::nullopt;
+    std::optional<uint32_t> _oUpdateStartMillis = std::nullopt;
+    PowerLimiterCalc::CalculationGate _calculationGate;
+    bool _batteryDischargeEnabled = false;
+    PowerLimiterCalc::PiController _controller;
+};
+
+} // namespace DplSimulation
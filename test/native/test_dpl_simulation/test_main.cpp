@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+ * Replays a day of household load through the closed-loop DPL simulation and
+ * reports the energy imported from and exported to the grid as well as the
+ * number of commands sent to the inverter.
+ *
+ *   pio test -e native -f native/test_dpl_simulation -v
+ *
+ * A recorded load profile can be replayed instead of the synthetic day by
+ * setting DPL_SIM_LOAD_PROFILE to the path of a CSV file holding either
+ * "<seconds since midnight>,<watts>" records or one value per second.
+ */
+
+#include "DplSimulator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <defaults.h>
+#include <unity.h>
+
+using namespace DplSimulation;
+
+static LoadProfile const& getLoad()
+{
+    static LoadProfile load = []() {
+        char const* path = std::getenv("DPL_SIM_LOAD_PROFILE");
+        if (path == nullptr) { return LoadProfile::syntheticDay(); }
+        return LoadProfile::fromCsv(path);
+    }();
+
+    return load;
+}
+
+static Config getDefaultConfig()
+{
+    Config config;
+    config.targetConsumption = POWERLIMITER_TARGET_POWER_CONSUMPTION;
+    config.hysteresis = POWERLIMITER_TARGET_POWER_CONSUMPTION_HYSTERESIS;
+    config.lowerLimit = POWERLIMITER_LOWER_POWER_LIMIT;
+    config.upperLimit = POWERLIMITER_UPPER_POWER_LIMIT;
+    config.baseLoad = POWERLIMITER_BASE_LOAD_LIMIT;
+    config.socStartThreshold = POWERLIMITER_BATTERY_SOC_START_THRESHOLD;
+    config.socStopThreshold = POWERLIMITER_BATTERY_SOC_STOP_THRESHOLD;
+    return config;
+}
+
+static void report(char const* name, Report const& r)
+{
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%-24s import %7.1f Wh, export %6.1f Wh, "
+            "inverter %7.1f Wh, limit cmds %5u, power cmds %3u, "
+            "mean |grid| %5.1f W, SoC %.0f..%.0f %%",
+            name, r.importedWh, r.exportedWh, r.inverterWh,
+            static_cast<unsigned>(r.limitCommands),
+            static_cast<unsigned>(r.powerCommands),
+            r.meanDeviation, r.minSoc, r.maxSoc);
+    TEST_MESSAGE(buf);
+}
+
+static void assertEnergyBalance(Report const& r)
+{
+    // whatever the inverter did not cover was imported, its surplus exported
+    double balance = r.importedWh - r.exportedWh + r.inverterWh;
+    TEST_ASSERT_FLOAT_WITHIN(r.loadWh * 0.001, r.loadWh, balance);
+}
+
+static void test_load_profile()
+{
+    auto const& load = getLoad();
+    TEST_ASSERT_FALSE(load.empty());
+
+    char buf[96];
+    snprintf(buf, sizeof(buf), "load profile: %u s, %.1f Wh",
+            static_cast<unsigned>(load.getDurationSeconds()), load.getEnergyWh());
+    TEST_MESSAGE(buf);
+}
+
+static void test_proportional_mode()
+{
+    Simulator sim(getDefaultConfig(), getLoad());
+    auto r = sim.run();
+    report("proportional", r);
+
+    assertEnergyBalance(r);
+    TEST_ASSERT_GREATER_THAN(0, r.limitCommands);
+    TEST_ASSERT_TRUE(r.importedWh < r.loadWh);
+    TEST_ASSERT_TRUE(r.exportedWh < r.inverterWh);
+    TEST_ASSERT_TRUE(r.minSoc >= 0 && r.maxSoc <= 100);
+}
+
+static void test_hysteresis_reduces_commands()
+{
+    auto config = getDefaultConfig();
+    Simulator plain(config, getLoad());
+    auto r0 = plain.run();
+
+    config.hysteresis = 25;
+    Simulator damped(config, getLoad());
+    auto r1 = damped.run();
+    report("proportional, hyst 25 W", r1);
+
+    assertEnergyBalance(r1);
+    TEST_ASSERT_TRUE(r1.limitCommands < r0.limitCommands);
+}
+
+static void test_pi_mode()
+{
+    auto config = getDefaultConfig();
+    Simulator proportional(config, getLoad());
+    auto rp = proportional.run();
+
+    config.piController = true;
+    config.kp = POWERLIMITER_CONTROLLER_KP;
+    config.ki = POWERLIMITER_CONTROLLER_KI;
+
+    Simulator sim(config, getLoad());
+    auto r = sim.run();
+    report("pi (default tuning)", r);
+
+    assertEnergyBalance(r);
+    TEST_ASSERT_GREATER_THAN(0, r.limitCommands);
+    TEST_ASSERT_TRUE(r.meanDeviation < rp.meanDeviation);
+    TEST_ASSERT_TRUE(r.importedWh < rp.importedWh);
+    TEST_ASSERT_TRUE(r.exportedWh < rp.exportedWh);
+}
+
+// reproduces the comparison of the proportional and the PI method which led
+// to the default tuning, always on the synthetic day. both methods send any
+// change of the calculated limit without a hysteresis, so the command rate
+// is compared with a hysteresis.
+static void test_controller_comparison()
+{
+    static LoadProfile const load = LoadProfile::syntheticDay();
+
+    auto config = getDefaultConfig();
+    config.hysteresis = 10;
+
+    Simulator proportional(config, load);
+    auto rp = proportional.run();
+    report("proportional, hyst 10 W", rp);
+
+    Report rpi;
+    for (float ki : { 1.0f, 0.9f, 0.8f }) {
+        for (float kp : { 0.0f, 0.1f, 0.2f }) {
+            config.piController = true;
+            config.kp = kp;
+            config.ki = ki;
+
+            Simulator sim(config, load);
+            auto r = sim.run();
+            assertEnergyBalance(r);
+
+            char name[32];
+            snprintf(name, sizeof(name), "pi %.1f/%.1f, hyst 10 W", kp, ki);
+            report(name, r);
+
+            if (kp == static_cast<float>(POWERLIMITER_CONTROLLER_KP) &&
+                    ki == static_cast<float>(POWERLIMITER_CONTROLLER_KI)) {
+                rpi = r;
+            }
+        }
+    }
+
+    TEST_ASSERT_TRUE(rpi.limitCommands < rp.limitCommands);
+    TEST_ASSERT_TRUE(rpi.meanDeviation < rp.meanDeviation);
+    TEST_ASSERT_TRUE(rpi.importedWh < rp.importedWh);
+    TEST_ASSERT_TRUE(rpi.exportedWh < rp.exportedWh);
+}
+
+void setUp() { }
+void tearDown() { }
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_load_profile);
+    RUN_TEST(test_proportional_mode);
+    RUN_TEST(test_hysteresis_reduces_commands);
+    RUN_TEST(test_pi_mode);
+    RUN_TEST(test_controller_comparison);
+    return UNITY_END();
+}
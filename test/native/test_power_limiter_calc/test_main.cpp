@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+ * Unit tests of the hardware independent parts of the dynamic power limiter.
+ *
+ *   pio test -e native -f native/test_power_limiter_calc
+ */
+
+#include <PowerLimiterCalc.h>
+#include <unity.h>
+
+using namespace PowerLimiterCalc;
+using Method = ScalingResult::Method;
+
+// a two input inverter with one MPPT per input, producing at a limit of 400 W
+static ScalingInput getScalingInput(int32_t newLimit, float powerDc0, float powerDc1)
+{
+    ScalingInput in;
+    in.newLimit = newLimit;
+    in.currentLimit = 400;
+    in.producing = true;
+    in.mpptPerInput = true;
+    in.inverterOutputAc = powerDc0 + powerDc1;
+    in.channelPowerDc = { powerDc0, powerDc1 };
+    return in;
+}
+
+static void assertScaling(ScalingResult const& r, Method method, int32_t limit, size_t affected)
+{
+    TEST_ASSERT_EQUAL(static_cast<int>(method), static_cast<int>(r.method));
+    TEST_ASSERT_EQUAL_INT32(limit, r.limit);
+    TEST_ASSERT_EQUAL(affected, r.affectedInputs);
+}
+
+static void test_scale_limit_not_applicable()
+{
+    auto in = getScalingInput(300, 0, 200);
+    in.producing = false;
+    assertScaling(scaleLimit(in), Method::None, 300, 0);
+
+    in = getScalingInput(300, 0, 200);
+    in.mpptPerInput = false;
+    assertScaling(scaleLimit(in), Method::None, 300, 0);
+
+    // inputs cannot be told apart from non-producing ones at very low limits
+    in = getScalingInput(300, 0, 10);
+    in.currentLimit = 19;
+    assertScaling(scaleLimit(in), Method::None, 300, 0);
+}
+
+static void test_scale_limit_producing_inputs()
+{
+    assertScaling(scaleLimit(getScalingInput(300, 0, 200)), Method::ProducingInputs, 600, 1);
+    assertScaling(scaleLimit(getScalingInput(300, 2, 200)), Method::ProducingInputs, 600, 1);
+
+    assertScaling(scaleLimit(getScalingInput(300, 150, 150)), Method::None, 300, 0);
+    assertScaling(scaleLimit(getScalingInput(300, 0, 0)), Method::None, 300, 2);
+}
+
+static void test_scale_limit_overscaling()
+{
+    // the expected power per input is 196 W at a limit of 400 W
+    auto in = getScalingInput(400, 250, 100);
+    in.overscaling = true;
+    assertScaling(scaleLimit(in), Method::Overscaling, 600, 1);
+
+    // the efficiency is applied to the inputs' DC power
+    in.efficiencyFactor = 0.5;
+    in.channelPowerDc = { 500, 200 };
+    assertScaling(scaleLimit(in), Method::Overscaling, 600, 1);
+
+    // no input is shaded
+    in = getScalingInput(400, 250, 200);
+    in.overscaling = true;
+    assertScaling(scaleLimit(in), Method::None, 400, 0);
+
+    // the shaded input alone provides the requested power
+    in = getScalingInput(100, 250, 150);
+    in.overscaling = true;
+    assertScaling(scaleLimit(in), Method::None, 100, 1);
+}
+
+static void test_scale_limit_keep_current()
+{
+    auto in = getScalingInput(300, 100, 50);
+    in.overscaling = true;
+    assertScaling(scaleLimit(in), Method::KeepCurrent, 400, 2);
+
+    // the current limit is less than the requested limit
+    in.newLimit = 500;
+    assertScaling(scaleLimit(in), Method::None, 500, 2);
+}
+
+static void test_distribute_limit()
+{
+    auto shares = distributeLimit(900, { 600, 300, 300 }, 50);
+    TEST_ASSERT_EQUAL_INT32(450, *shares[0]);
+    TEST_ASSERT_EQUAL_INT32(225, *shares[1]);
+    TEST_ASSERT_EQUAL_INT32(225, *shares[2]);
+
+    // clamped to the summed capacity, the remainder goes to the target inverter
+    shares = distributeLimit(2000, { 600, 300, 300 }, 50);
+    TEST_ASSERT_EQUAL_INT32(600, *shares[0]);
+    TEST_ASSERT_EQUAL_INT32(300, *shares[1]);
+    TEST_ASSERT_EQUAL_INT32(300, *shares[2]);
+
+    shares = distributeLimit(100, { 300, 300, 300 }, 0);
+    TEST_ASSERT_EQUAL_INT32(34, *shares[0]);
+    TEST_ASSERT_EQUAL_INT32(33, *shares[1]);
+
+    // secondary inverters are dropped until all shares reach the lower limit
+    shares = distributeLimit(150, { 600, 300, 200 }, 50);
+    TEST_ASSERT_EQUAL_INT32(100, *shares[0]);
+    TEST_ASSERT_EQUAL_INT32(50, *shares[1]);
+    TEST_ASSERT_FALSE(shares[2].has_value());
+
+    shares = distributeLimit(60, { 600, 300 }, 50);
+    TEST_ASSERT_EQUAL_INT32(60, *shares[0]);
+    TEST_ASSERT_FALSE(shares[1].has_value());
+}
+
+static void test_calculation_gate()
+{
+    using State = CalculationGate::State;
+    CalculationGate gate;
+
+    // stats must be received after the last command
+    TEST_ASSERT_EQUAL(static_cast<int>(State::StatsPending),
+            static_cast<int>(gate.check(10000, 9000, 8000, true, 9500)));
+
+    // the meter reading must arrive more than 2 seconds after the stats
+    TEST_ASSERT_EQUAL(static_cast<int>(State::MeterPending),
+            static_cast<int>(gate.check(11000, 9000, 10000, true, 11000)));
+    TEST_ASSERT_EQUAL_UINT32(10000, *gate.getStatsMillis());
+    TEST_ASSERT_EQUAL(static_cast<int>(State::Ready),
+            static_cast<int>(gate.check(12100, 9000, 11000, false, 0)));
+    TEST_ASSERT_EQUAL(static_cast<int>(State::Ready),
+            static_cast<int>(gate.check(12100, 9000, 11000, true, 12001)));
+
+    // the backoff doubles while the limit is stable
+    gate.calculated(12100);
+    gate.adaptBackoff(false);
+    TEST_ASSERT_EQUAL_UINT32(256, gate.getBackoffMs());
+    TEST_ASSERT_EQUAL(static_cast<int>(State::Backoff),
+            static_cast<int>(gate.check(12200, 9000, 11000, true, 12001)));
+    TEST_ASSERT_EQUAL_UINT32(156, gate.getRemainingBackoff(12200));
+    TEST_ASSERT_EQUAL(static_cast<int>(State::Ready),
+            static_cast<int>(gate.check(12356, 9000, 11000, true, 12001)));
+
+    for (int i = 0; i < 8; ++i) { gate.adaptBackoff(false); }
+    TEST_ASSERT_EQUAL_UINT32(1024, gate.getBackoffMs());
+    gate.adaptBackoff(true);
+    TEST_ASSERT_EQUAL_UINT32(128, gate.getBackoffMs());
+
+    // a new command invalidates the stats
+    TEST_ASSERT_EQUAL(static_cast<int>(State::StatsPending),
+            static_cast<int>(gate.check(13000, 12500, 11000, true, 12900)));
+    TEST_ASSERT_FALSE(gate.getStatsMillis().has_value());
+}
+
+static void test_energy_source_bounds()
+{
+    auto bounds = energySourceBounds(false, false, 300);
+    TEST_ASSERT_EQUAL_INT32(300, bounds.upper);
+    TEST_ASSERT_TRUE(bounds.lower < 0);
+
+    bounds = energySourceBounds(true, true, 300);
+    TEST_ASSERT_EQUAL_INT32(300, bounds.lower);
+    TEST_ASSERT_TRUE(bounds.upper > 300);
+
+    TEST_ASSERT_EQUAL_INT32(100, *applyLowerLimit(100, 50, false));
+    TEST_ASSERT_FALSE(applyLowerLimit(40, 50, false).has_value());
+    TEST_ASSERT_EQUAL_INT32(50, *applyLowerLimit(40, 50, true));
+
+    TEST_ASSERT_FALSE(exceedsHysteresis(110, 100, 10));
+    TEST_ASSERT_TRUE(exceedsHysteresis(89, 100, 10));
+}
+
+static void test_pi_controller()
+{
+    TEST_ASSERT_EQUAL_INT32(400, controllerBase(400, 350));
+    TEST_ASSERT_EQUAL_INT32(300, controllerBase(400, 300));
+    TEST_ASSERT_EQUAL_INT32(0, controllerBase(400, 0));
+
+    PiController pi;
+    pi.setTuning(0.5, 0.8);
+
+    // the first update has no previous deviation
+    TEST_ASSERT_EQUAL_INT32(280, pi.update(100, 200, 0, 800));
+    TEST_ASSERT_EQUAL_INT32(345, pi.update(50, 330, 0, 800));
+    TEST_ASSERT_EQUAL_INT32(800, pi.update(1000, 500, 0, 800));
+    TEST_ASSERT_EQUAL_INT32(0, pi.update(-100, 50, 0, 800));
+
+    pi.reset();
+    TEST_ASSERT_EQUAL_INT32(280, pi.update(100, 200, 0, 800));
+
+    // equivalent to the proportional method
+    pi.setTuning(0, 1);
+    TEST_ASSERT_EQUAL_INT32(requiredPower(true, 150, true, 250, 0, 100),
+            pi.update(150, 250, 0, 800));
+}
+
+void setUp() { }
+void tearDown() { }
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_scale_limit_not_applicable);
+    RUN_TEST(test_scale_limit_producing_inputs);
+    RUN_TEST(test_scale_limit_overscaling);
+    RUN_TEST(test_scale_limit_keep_current);
+    RUN_TEST(test_distribute_limit);
+    RUN_TEST(test_calculation_gate);
+    RUN_TEST(test_energy_source_bounds);
+    RUN_TEST(test_pi_controller);
+    return UNITY_END();
+}
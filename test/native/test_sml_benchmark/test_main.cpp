@@ -0,0 +1,299 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+ * Feeds SML telegrams, as sent by an electronic household meter, through the
+ * SML parser and reports the throughput for different chunk sizes. Also
+ * verifies the decoded values, that the result does not depend on how the
+ * input is split into chunks, and that two parsers can be fed interleaved.
+ *
+ *   pio test -e native -f native/test_sml_benchmark -v
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <sml.h>
+#include <unity.h>
+#include <vector>
+
+static constexpr uint32_t TelegramCount = 20000;
+
+using Bytes = std::vector<uint8_t>;
+
+struct Reading {
+    float powerTotal;
+    float powerL1;
+    float powerL2;
+    float powerL3;
+    float voltageL1;
+    float currentL1;
+    float energyImport;
+    float energyExport;
+};
+
+// X.25 CRC as used by SML, see SmlParser::crc16()
+static uint16_t crc16(Bytes const& data)
+{
+    uint16_t crc = 0xFFFF;
+    for (uint8_t byte : data) {
+        crc ^= byte;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0x8408) : (crc >> 1);
+        }
+    }
+    return crc ^ 0xFFFF;
+}
+
+// list entry with OBIS code a-b:c.d.e*255, unit, scaler and a 32 bit value
+static void addEntry(Bytes& out, uint8_t c, uint8_t d, uint8_t unit, int8_t scaler, int32_t value)
+{
+    uint32_t raw = static_cast<uint32_t>(value);
+    Bytes entry = {
+        0x77,
+        0x07, 0x01, 0x00, c, d, 0x00, 0xFF, // objName
+        0x01, // status
+        0x01, // valTime
+        0x62, unit,
+        0x52, static_cast<uint8_t>(scaler),
+        0x55, static_cast<uint8_t>(raw >> 24), static_cast<uint8_t>(raw >> 16),
+              static_cast<uint8_t>(raw >> 8), static_cast<uint8_t>(raw),
+        0x01 // valueSignature
+    };
+    out.insert(out.end(), entry.begin(), entry.end());
+}
+
+// a single GetList.Res message holding the values of the reading
+static Bytes telegram(Reading const& r)
+{
+    static constexpr uint8_t Wh = 30, W = 27, V = 35, A = 33;
+
+    Bytes out = {
+        0x1B, 0x1B, 0x1B, 0x1B, 0x01, 0x01, 0x01, 0x01,
+        0x76, // SML message
+        0x05, 0x01, 0x02, 0x03, 0x04, // transactionId
+        0x62, 0x00, // groupNo
+        0x62, 0x00, // abortOnError
+        0x72, 0x63, 0x07, 0x01, // GetList.Res
+        0x77, 0x01, 0x01, 0x01, 0x01, // clientId, serverId, listName, actSensorTime
+        0x78 // valList with 8 entries
+    };
+
+    addEntry(out, 0x01, 0x08, Wh, -1, static_cast<int32_t>(r.energyImport * 10));
+    addEntry(out, 0x02, 0x08, Wh, -1, static_cast<int32_t>(r.energyExport * 10));
+    addEntry(out, 0x10, 0x07, W, 0, static_cast<int32_t>(r.powerTotal));
+    addEntry(out, 0x24, 0x07, W, 0, static_cast<int32_t>(r.powerL1));
+    addEntry(out, 0x38, 0x07, W, 0, static_cast<int32_t>(r.powerL2));
+    addEntry(out, 0x4C, 0x07, W, 0, static_cast<int32_t>(r.powerL3));
+    addEntry(out, 0x20, 0x07, V, -1, static_cast<int32_t>(r.voltageL1 * 10));
+    addEntry(out, 0x1F, 0x07, A, -2, static_cast<int32_t>(r.currentL1 * 100));
+
+    Bytes trailer = {
+        0x01, 0x01, // listSignature, actGatewayTime
+        0x63, 0x12, 0x34, // message crc, not verified by the parser
+        0x00, // endOfSmlMsg
+        0x1B, 0x1B, 0x1B, 0x1B, 0x1A, 0x00
+    };
+    out.insert(out.end(), trailer.begin(), trailer.end());
+
+    uint16_t crc = crc16(out);
+    out.push_back(crc & 0xFF);
+    out.push_back(crc >> 8);
+    return out;
+}
+
+// decodes like PowerMeterSml::onSmlEvent()
+class Decoder : public SmlParser::Listener {
+public:
+    void onSmlEvent(SmlParser& parser, sml_states_t state) override
+    {
+        switch (state) {
+            case SML_LISTEND:
+                decode(parser);
+                break;
+            case SML_FINAL:
+                ++finals;
+                last = current;
+                parser.reset();
+                break;
+            case SML_CHECKSUM_ERROR:
+                ++errors;
+                parser.reset();
+                break;
+            default:
+                break;
+        }
+    }
+
+    Reading current = {};
+    Reading last = {};
+    uint32_t finals = 0;
+    uint32_t errors = 0;
+
+private:
+    void decode(SmlParser const& parser)
+    {
+        switch (parser.obisKey()) {
+            case SmlParser::obisKey(0x01, 0x00, 0x01, 0x08, 0x00, 0xFF): parser.obisWh(current.energyImport); break;
+            case SmlParser::obisKey(0x01, 0x00, 0x02, 0x08, 0x00, 0xFF): parser.obisWh(current.energyExport); break;
+            case SmlParser::obisKey(0x01, 0x00, 0x10, 0x07, 0x00, 0xFF): parser.obisW(current.powerTotal); break;
+            case SmlParser::obisKey(0x01, 0x00, 0x24, 0x07, 0x00, 0xFF): parser.obisW(current.powerL1); break;
+            case SmlParser::obisKey(0x01, 0x00, 0x38, 0x07, 0x00, 0xFF): parser.obisW(current.powerL2); break;
+            case SmlParser::obisKey(0x01, 0x00, 0x4C, 0x07, 0x00, 0xFF): parser.obisW(current.powerL3); break;
+            case SmlParser::obisKey(0x01, 0x00, 0x20, 0x07, 0x00, 0xFF): parser.obisVolt(current.voltageL1); break;
+            case SmlParser::obisKey(0x01, 0x00, 0x1F, 0x07, 0x00, 0xFF): parser.obisAmpere(current.currentL1); break;
+            default: break;
+        }
+    }
+};
+
+static Reading reading(uint32_t i)
+{
+    float power = 300.0f + (i % 500);
+    return { power, power / 2, power / 4, power / 4, 230.1f + (i % 10), 1.25f,
+        12345678.9f, 4321.0f + i };
+}
+
+static void feed(SmlParser& parser, Decoder& decoder, Bytes const& data, size_t chunkSize)
+{
+    for (size_t pos = 0; pos < data.size(); pos += chunkSize) {
+        size_t length = std::min(chunkSize, data.size() - pos);
+        parser.parse(data.data() + pos, length, decoder);
+    }
+}
+
+static void assertReading(Reading const& expected, Reading const& actual)
+{
+    TEST_ASSERT_FLOAT_WITHIN(1, expected.powerTotal, actual.powerTotal);
+    TEST_ASSERT_FLOAT_WITHIN(1, expected.powerL1, actual.powerL1);
+    TEST_ASSERT_FLOAT_WITHIN(1, expected.powerL3, actual.powerL3);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, expected.voltageL1, actual.voltageL1);
+    TEST_ASSERT_FLOAT_WITHIN(0.005, expected.currentL1, actual.currentL1);
+    TEST_ASSERT_FLOAT_WITHIN(1, expected.energyImport, actual.energyImport);
+    TEST_ASSERT_FLOAT_WITHIN(0.1, expected.energyExport, actual.energyExport);
+}
+
+static void test_decoding()
+{
+    auto expected = reading(7);
+    SmlParser parser;
+    Decoder decoder;
+    feed(parser, decoder, telegram(expected), SIZE_MAX);
+
+    TEST_ASSERT_EQUAL(1, decoder.finals);
+    TEST_ASSERT_EQUAL(0, decoder.errors);
+    assertReading(expected, decoder.last);
+}
+
+static void test_checksum_error()
+{
+    auto data = telegram(reading(7));
+    data[data.size() - 1] ^= 0x01;
+
+    SmlParser parser;
+    Decoder decoder;
+    feed(parser, decoder, data, SIZE_MAX);
+
+    TEST_ASSERT_EQUAL(0, decoder.finals);
+    TEST_ASSERT_EQUAL(1, decoder.errors);
+}
+
+// the result must not depend on how the input is split, e.g., by the
+// software serial or the HTTP client
+static void test_chunk_sizes()
+{
+    Bytes stream;
+    for (uint32_t i = 0; i < 10; ++i) {
+        auto data = telegram(reading(i));
+        stream.insert(stream.end(), data.begin(), data.end());
+        if (i % 3 == 1) { stream.push_back(0x42); } // garbage between telegrams
+    }
+
+    for (size_t chunkSize : { 1, 2, 7, 13, 64, 1024 }) {
+        SmlParser parser;
+        Decoder decoder;
+        feed(parser, decoder, stream, chunkSize);
+
+        TEST_ASSERT_EQUAL(10, decoder.finals);
+        TEST_ASSERT_EQUAL(0, decoder.errors);
+        assertReading(reading(9), decoder.last);
+    }
+}
+
+// every meter owns a parser, hence two meters can be parsed in parallel,
+// e.g., a grid meter and a sub-meter polled from different tasks
+static void test_two_parsers()
+{
+    auto gridReading = reading(100);
+    auto subReading = reading(200);
+    auto grid = telegram(gridReading);
+    auto sub = telegram(subReading);
+
+    SmlParser gridParser, subParser;
+    Decoder gridDecoder, subDecoder;
+
+    size_t constexpr chunkSize = 16;
+    for (size_t pos = 0; pos < std::max(grid.size(), sub.size()); pos += chunkSize) {
+        if (pos < grid.size()) {
+            gridParser.parse(grid.data() + pos, std::min(chunkSize, grid.size() - pos), gridDecoder);
+        }
+        if (pos < sub.size()) {
+            subParser.parse(sub.data() + pos, std::min(chunkSize, sub.size() - pos), subDecoder);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(1, gridDecoder.finals);
+    TEST_ASSERT_EQUAL(1, subDecoder.finals);
+    assertReading(gridReading, gridDecoder.last);
+    assertReading(subReading, subDecoder.last);
+}
+
+static void test_throughput()
+{
+    Bytes stream;
+    uint32_t telegrams = 100;
+    for (uint32_t i = 0; i < telegrams; ++i) {
+        auto data = telegram(reading(i));
+        stream.insert(stream.end(), data.begin(), data.end());
+    }
+
+    uint32_t replays = TelegramCount / telegrams;
+
+    // chunk sizes of the byte-wise state machine, the serial and the HTTP
+    // SML power meter, and a whole buffer
+    for (size_t chunkSize : { size_t(1), size_t(64), size_t(128), stream.size() }) {
+        SmlParser parser;
+        Decoder decoder;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t r = 0; r < replays; ++r) {
+            feed(parser, decoder, stream, chunkSize);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        TEST_ASSERT_EQUAL(telegrams * replays, decoder.finals);
+        TEST_ASSERT_EQUAL(0, decoder.errors);
+
+        double bytes = static_cast<double>(stream.size()) * replays;
+        char buf[160];
+        snprintf(buf, sizeof(buf), "chunks of %5u bytes: %8.0f telegrams/s, %6.1f MB/s (%u telegrams in %.3f s)",
+                static_cast<unsigned>(chunkSize), decoder.finals / elapsed.count(),
+                bytes / elapsed.count() / 1e6, static_cast<unsigned>(decoder.finals),
+                elapsed.count());
+        TEST_MESSAGE(buf);
+    }
+}
+
+void setUp() { }
+void tearDown() { }
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_decoding);
+    RUN_TEST(test_checksum_error);
+    RUN_TEST(test_chunk_sizes);
+    RUN_TEST(test_two_parsers);
+    RUN_TEST(test_throughput);
+    return UNITY_END();
+}
@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+ * Replays VE.Direct text frames, as captured from a SmartSolar MPPT and a
+ * SmartShunt, through the frame handler and reports the throughput. Also
+ * verifies that the values of the last frame were applied and that parsing
+ * does not allocate memory once the handler was initialized.
+ *
+ *   pio test -e native -f native/test_vedirect_benchmark -v
+ */
+
+#include <Arduino.h>
+#include <VeDirectMpptController.h>
+#include <VeDirectShuntController.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <new>
+#include <string>
+#include <unity.h>
+
+static constexpr uint32_t ReplayCount = 2000;
+static constexpr uint32_t FramesPerCapture = 60;
+static constexpr uint8_t MpptPort = 1;
+static constexpr uint8_t ShuntPort = 2;
+
+// counts the allocations of the whole program, see test_no_allocations
+static std::atomic<uint32_t> s_allocations { 0 };
+
+void* operator new(size_t size)
+{
+    ++s_allocations;
+    if (void* p = std::malloc(size)) { return p; }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// collects the output of the frame handler, which only logs errors here
+class CountingPrint : public Print {
+public:
+    size_t write(uint8_t c) override
+    {
+        ++_count;
+        putchar(c);
+        return 1;
+    }
+
+    size_t getCount() const { return _count; }
+
+private:
+    size_t _count = 0;
+};
+
+// appends the checksum record, such that the bytes of all records including
+// the checksum add up to zero (modulo 256)
+static std::string frame(std::string const& records)
+{
+    std::string result = records + "\r\nChecksum\t";
+    uint8_t sum = 0;
+    for (char c : result) { sum += static_cast<uint8_t>(c); }
+    result += static_cast<char>(static_cast<uint8_t>(256 - sum));
+    return result;
+}
+
+// the frames differ in the values changing once per second on a sunny day
+static std::string mpptFrame(uint32_t i)
+{
+    char buf[320];
+    snprintf(buf, sizeof(buf),
+            "\r\nPID\t0xA053\r\nFW\t159\r\nSER#\tHQ2132QY2KR\r\nV\t%u\r\nI\t%u"
+            "\r\nVPV\t%u\r\nPPV\t%u\r\nCS\t3\r\nMPPT\t2\r\nOR\t0x00000000"
+            "\r\nERR\t0\r\nLOAD\tON\r\nIL\t300\r\nH19\t%u\r\nH20\t%u\r\nH21\t412"
+            "\r\nH22\t318\r\nH23\t397\r\nHSDS\t74",
+            13100 + i * 10, 9400 + i * 20, 37000 + i * 50, 128 + i,
+            34560 + i / 10, 187 + i / 10);
+    return frame(buf);
+}
+
+// the SmartShunt splits its values into two frames
+static std::string shuntFrames(uint32_t i)
+{
+    char first[320];
+    snprintf(first, sizeof(first),
+            "\r\nPID\t0xA389\r\nV\t%u\r\nI\t-%u\r\nP\t-%u\r\nCE\t-%u"
+            "\r\nSOC\t%u\r\nTTG\t1470\r\nALARM\tOFF\r\nAR\t0\r\nBMV\tSmartShunt 500A/50mV"
+            "\r\nFW\t0419\r\nMON\t0",
+            13050 - i, 4200 + i * 10, 55 + i / 10, 21400 + i * 2, 873 - i / 10);
+
+    char second[320];
+    snprintf(second, sizeof(second),
+            "\r\nH1\t-102345\r\nH2\t-%u\r\nH3\t-50112\r\nH4\t12\r\nH5\t0\r\nH6\t-1765432"
+            "\r\nH7\t10521\r\nH8\t14612\r\nH9\t86400\r\nH10\t3\r\nH11\t0\r\nH12\t0"
+            "\r\nH15\t12\r\nH16\t0\r\nH17\t%u\r\nH18\t%u\r\nSER#\tHQ2109ABCDE",
+            21400 + i * 2, 4312, 5121 + i);
+
+    return frame(first) + frame(second);
+}
+
+template<typename Controller>
+static void replay(char const* name, Controller& controller, uint8_t port,
+        std::string const& capture, uint32_t framesPerCapture)
+{
+    auto& rx = NativeShims::SerialRx[port];
+    rx.set(capture);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t r = 0; r < ReplayCount; ++r) {
+        rx.pos = 0;
+        controller.loop();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double frames = static_cast<double>(framesPerCapture) * ReplayCount;
+    double bytes = static_cast<double>(capture.size()) * ReplayCount;
+
+    char buf[160];
+    snprintf(buf, sizeof(buf), "%-6s %9.0f frames/s, %6.1f MB/s (%.0f frames in %.3f s)",
+            name, frames / elapsed.count(), bytes / elapsed.count() / 1e6,
+            frames, elapsed.count());
+    TEST_MESSAGE(buf);
+}
+
+static void test_mppt_frames()
+{
+    std::string capture;
+    for (uint32_t i = 0; i < FramesPerCapture; ++i) { capture += mpptFrame(i); }
+
+    CountingPrint out;
+    VeDirectMpptController mppt;
+    mppt.init(-1, -1, &out, false, MpptPort);
+
+    replay("MPPT", mppt, MpptPort, capture, FramesPerCapture);
+
+    // any checksum error or unknown field would have been logged
+    TEST_ASSERT_EQUAL(0, out.getCount());
+
+    uint32_t last = FramesPerCapture - 1;
+    auto const& data = mppt.getData();
+    TEST_ASSERT_EQUAL_HEX(0xA053, data.productID_PID);
+    TEST_ASSERT_EQUAL_STRING("HQ2132QY2KR", data.serialNr_SER);
+    TEST_ASSERT_EQUAL(13100 + last * 10, data.batteryVoltage_V_mV);
+    TEST_ASSERT_EQUAL(128 + last, data.panelPower_PPV_W);
+    TEST_ASSERT_EQUAL((34560 + last / 10) * 10, data.yieldTotal_H19_Wh);
+    TEST_ASSERT_TRUE(data.loadOutputState_LOAD);
+}
+
+static void test_shunt_frames()
+{
+    std::string capture;
+    for (uint32_t i = 0; i < FramesPerCapture / 2; ++i) { capture += shuntFrames(i); }
+
+    CountingPrint out;
+    VeDirectShuntController shunt;
+    shunt.init(-1, -1, &out, false, ShuntPort);
+
+    replay("shunt", shunt, ShuntPort, capture, FramesPerCapture);
+
+    TEST_ASSERT_EQUAL(0, out.getCount());
+
+    int32_t last = FramesPerCapture / 2 - 1;
+    auto const& data = shunt.getData();
+    TEST_ASSERT_EQUAL_HEX(0xA389, data.productID_PID);
+    TEST_ASSERT_EQUAL(873 - last / 10, data.SOC);
+    TEST_ASSERT_EQUAL(5121 + last, data.H18);
+}
+
+static void test_corrupt_frame_discarded()
+{
+    CountingPrint out;
+    VeDirectMpptController mppt;
+    mppt.init(-1, -1, &out, false, MpptPort);
+
+    NativeShims::SerialRx[MpptPort].set(mpptFrame(0));
+    mppt.loop();
+    TEST_ASSERT_EQUAL(13100, mppt.getData().batteryVoltage_V_mV);
+
+    // a single flipped digit invalidates the checksum, the frame is logged
+    // as invalid and none of its values is applied
+    std::string corrupt = mpptFrame(1);
+    corrupt[corrupt.find("13110")] = '2';
+    NativeShims::SerialRx[MpptPort].set(corrupt);
+    mppt.loop();
+
+    TEST_ASSERT_GREATER_THAN(0, out.getCount());
+    TEST_ASSERT_EQUAL(13100, mppt.getData().batteryVoltage_V_mV);
+    TEST_ASSERT_EQUAL(128, mppt.getData().panelPower_PPV_W);
+}
+
+static void test_no_allocations()
+{
+    std::string capture;
+    for (uint32_t i = 0; i < FramesPerCapture; ++i) { capture += mpptFrame(i); }
+
+    CountingPrint out;
+    VeDirectMpptController mppt;
+    mppt.init(-1, -1, &out, false, MpptPort);
+
+    auto& rx = NativeShims::SerialRx[MpptPort];
+    rx.set(capture);
+
+    uint32_t allocations = s_allocations;
+    for (uint32_t r = 0; r < 10; ++r) {
+        rx.pos = 0;
+        mppt.loop();
+    }
+
+    TEST_ASSERT_EQUAL(0, out.getCount());
+    TEST_ASSERT_EQUAL_UINT32(allocations, s_allocations);
+}
+
+void setUp() { }
+void tearDown() { }
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_mppt_frames);
+    RUN_TEST(test_shunt_frames);
+    RUN_TEST(test_corrupt_frame_discarded);
+    RUN_TEST(test_no_allocations);
+    return UNITY_END();
+}
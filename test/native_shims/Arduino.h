@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+/*
+ * Minimal stand-in for the Arduino core, used by the native (host) test
+ * environment only. Time is simulated: millis() only advances if delay() is
+ * called or a test advances the clock explicitly, such that simulations run
+ * as fast as the host allows and are reproducible.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace NativeShims {
+
+inline uint64_t MicrosNow = 0;
+
+inline void advanceMillis(uint32_t ms) { MicrosNow += static_cast<uint64_t>(ms) * 1000; }
+inline void advanceMicros(uint32_t us) { MicrosNow += us; }
+inline void resetClock() { MicrosNow = 0; }
+
+} // namespace NativeShims
+
+inline uint32_t millis() { return static_cast<uint32_t>(NativeShims::MicrosNow / 1000); }
+inline uint32_t micros() { return static_cast<uint32_t>(NativeShims::MicrosNow); }
+inline void delay(uint32_t ms) { NativeShims::advanceMillis(ms); }
+inline void yield() { }
+
+inline size_t strlcpy(char* dst, const char* src, size_t size)
+{
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t copy = std::min(len, size - 1);
+        memcpy(dst, src, copy);
+        dst[copy] = '\0';
+    }
+    return len;
+}
+
+#include "WString.h"
+#include "Print.h"
+#include "HardwareSerial.h"
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include "Print.h"
+#include <array>
+#include <cstdio>
+#include <string>
+
+#define SERIAL_8N1 0x800001c
+
+namespace NativeShims {
+
+// bytes to be received on the respective UART. tests fill these buffers to
+// replay captured data through code that reads from a HardwareSerial.
+struct RxFeed {
+    std::string data;
+    size_t pos = 0;
+
+    void set(std::string bytes)
+    {
+        data = std::move(bytes);
+        pos = 0;
+    }
+};
+
+inline std::array<RxFeed, 3> SerialRx;
+
+} // namespace NativeShims
+
+class HardwareSerial : public Print {
+public:
+    explicit HardwareSerial(uint8_t port) : _port(port % NativeShims::SerialRx.size()) { }
+
+    void begin(unsigned long, uint32_t = SERIAL_8N1, int8_t = -1, int8_t = -1) { }
+    void end() { }
+    void flush() { fflush(stdout); }
+    size_t setRxBufferSize(size_t size) { return size; }
+    operator bool() const { return true; }
+
+    int available()
+    {
+        auto const& rx = NativeShims::SerialRx[_port];
+        return static_cast<int>(rx.data.size() - rx.pos);
+    }
+
+    int read()
+    {
+        auto& rx = NativeShims::SerialRx[_port];
+        if (rx.pos >= rx.data.size()) { return -1; }
+        return static_cast<uint8_t>(rx.data[rx.pos++]);
+    }
+
+    int availableForWrite() { return 128; }
+
+    // output to UART0 goes to stdout, other ports are discarded
+    size_t write(uint8_t c) override
+    {
+        if (_port == 0) { fputc(c, stdout); }
+        return 1;
+    }
+
+    using Print::write;
+
+private:
+    uint8_t _port;
+};
+
+inline HardwareSerial Serial(0);
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// the subset of the Arduino String used by the code built natively
+class String : public std::string {
+public:
+    String() = default;
+    String(const char* str) : std::string(str != nullptr ? str : "") { }
+    String(const std::string& str) : std::string(str) { }
+    explicit String(char c) : std::string(1, c) { }
+    explicit String(int value) : std::string(std::to_string(value)) { }
+    explicit String(unsigned value) : std::string(std::to_string(value)) { }
+    explicit String(long value) : std::string(std::to_string(value)) { }
+    explicit String(unsigned long value) : std::string(std::to_string(value)) { }
+    explicit String(float value, unsigned char decimals = 2) : std::string(format(value, decimals)) { }
+    explicit String(double value, unsigned char decimals = 2) : std::string(format(value, decimals)) { }
+
+    bool isEmpty() const { return empty(); }
+    long toInt() const { return strtol(c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(c_str(), nullptr); }
+
+    int indexOf(char c, size_t from = 0) const
+    {
+        auto pos = find(c, from);
+        return pos == npos ? -1 : static_cast<int>(pos);
+    }
+
+    String substring(size_t from, size_t to = npos) const
+    {
+        if (from >= size()) { return String(); }
+        return String(substr(from, to == npos ? npos : to - from));
+    }
+
+    bool equals(const String& other) const { return *this == other; }
+
+private:
+    static std::string format(double value, unsigned char decimals)
+    {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+        return buf;
+    }
+};
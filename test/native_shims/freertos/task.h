@@ -0,0 +1,20 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include "FreeRTOS.h"
+#include <Arduino.h>
+
+typedef void* TaskHandle_t;
+
+enum eTaskState { eRunning = 0, eReady, eBlocked, eSuspended, eDeleted, eInvalid };
+
+// every host thread is considered a task
+inline TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    static thread_local char handle;
+    return &handle;
+}
+
+inline eTaskState eTaskGetState(TaskHandle_t) { return eRunning; }
+inline TickType_t xTaskGetTickCount() { return millis(); }
+inline void vTaskDelay(TickType_t ticks) { delay(ticks); }
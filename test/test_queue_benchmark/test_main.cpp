@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+ * Compares the mutex-based ThreadSafeQueue with the LockFreeQueue in SPSC and
+ * MPSC configurations. Every scenario moves a fixed number of items from the
+ * producer task(s) to a consumer task, checks that all items arrived (in
+ * order for a single producer) and reports the throughput.
+ *
+ * Runs on the target (pio test -e <env> -f test_queue_benchmark), where the
+ * producers and the consumer may run on different cores, and on the host
+ * (pio test -e native -f test_queue_benchmark).
+ */
+
+#include <LockFreeQueue.h>
+#include <ThreadSafeQueue.h>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <unity.h>
+#include <vector>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+static constexpr uint32_t ItemCount = 50000;
+#else
+static constexpr uint32_t ItemCount = 1000000;
+#endif
+
+static constexpr uint8_t ProducerCount = 3;
+static constexpr size_t LockFreeCapacity = 64;
+
+struct Result {
+    uint32_t items;
+    uint64_t sum;
+    bool ordered;
+    double seconds;
+};
+
+static void report(char const* name, Result const& r)
+{
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%-28s %9.0f items/s (%u items in %.3f s)",
+        name, r.items / r.seconds, static_cast<unsigned>(r.items), r.seconds);
+    TEST_MESSAGE(buf);
+}
+
+static uint64_t expectedSum(uint32_t items)
+{
+    return static_cast<uint64_t>(items) * (items - 1) / 2;
+}
+
+// the ThreadSafeQueue is unbounded, push() always succeeds
+template <typename Queue>
+static bool tryPush(Queue& queue, uint32_t value, std::true_type /* unbounded */)
+{
+    queue.push(value);
+    return true;
+}
+
+template <typename Queue>
+static bool tryPush(Queue& queue, uint32_t value, std::false_type /* unbounded */)
+{
+    return queue.push(value);
+}
+
+template <typename Queue, bool Unbounded>
+static Result run(Queue& queue, uint8_t producers)
+{
+    uint32_t perProducer = ItemCount / producers;
+    uint32_t items = perProducer * producers;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (uint8_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p, perProducer]() {
+            uint32_t base = p * perProducer;
+            for (uint32_t i = 0; i < perProducer; ++i) {
+                while (!tryPush(queue, base + i, std::integral_constant<bool, Unbounded>())) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    Result res { items, 0, true, 0 };
+    uint32_t received = 0;
+    uint32_t last = 0;
+    while (received < items) {
+        auto item = queue.pop();
+        if (!item) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (received > 0 && *item <= last) { res.ordered = false; }
+        last = *item;
+        res.sum += *item;
+        ++received;
+    }
+
+    for (auto& t : threads) { t.join(); }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    res.seconds = elapsed.count();
+    return res;
+}
+
+static void test_spsc_thread_safe_queue()
+{
+    ThreadSafeQueue<uint32_t> queue;
+    auto r = run<decltype(queue), true>(queue, 1);
+    TEST_ASSERT_TRUE(r.ordered);
+    TEST_ASSERT_EQUAL_UINT64(expectedSum(r.items), r.sum);
+    report("SPSC ThreadSafeQueue", r);
+}
+
+static void test_spsc_lock_free_queue()
+{
+    auto queue = std::make_unique<SpscQueue<uint32_t, LockFreeCapacity>>();
+    auto r = run<SpscQueue<uint32_t, LockFreeCapacity>, false>(*queue, 1);
+    TEST_ASSERT_TRUE(r.ordered);
+    TEST_ASSERT_EQUAL_UINT64(expectedSum(r.items), r.sum);
+    report("SPSC LockFreeQueue", r);
+}
+
+static void test_mpsc_thread_safe_queue()
+{
+    ThreadSafeQueue<uint32_t> queue;
+    auto r = run<decltype(queue), true>(queue, ProducerCount);
+    TEST_ASSERT_EQUAL_UINT64(expectedSum(r.items), r.sum);
+    report("MPSC ThreadSafeQueue", r);
+}
+
+static void test_mpsc_lock_free_queue()
+{
+    auto queue = std::make_unique<MpscQueue<uint32_t, LockFreeCapacity>>();
+    auto r = run<MpscQueue<uint32_t, LockFreeCapacity>, false>(*queue, ProducerCount);
+    TEST_ASSERT_EQUAL_UINT64(expectedSum(r.items), r.sum);
+    report("MPSC LockFreeQueue", r);
+}
+
+void setUp() { }
+void tearDown() { }
+
+static int runTests()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_spsc_thread_safe_queue);
+    RUN_TEST(test_spsc_lock_free_queue);
+    RUN_TEST(test_mpsc_thread_safe_queue);
+    RUN_TEST(test_mpsc_lock_free_queue);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    delay(2000); // give the serial monitor time to attach
+    runTests();
+}
+
+void loop() { }
+#else
+int main()
+{
+    return runTests();
+}
+#endif
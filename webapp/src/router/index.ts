@@ -5,8 +5,10 @@ import ConfigAdminView from '@/views/ConfigAdminView.vue';
 import ConsoleInfoView from '@/views/ConsoleInfoView.vue';
 import DeviceAdminView from '@/views/DeviceAdminView.vue';
 import DtuAdminView from '@/views/DtuAdminView.vue';
+import EnergyLogAdminView from '@/views/EnergyLogAdminView.vue';
 import ErrorView from '@/views/ErrorView.vue';
 import FirmwareUpgradeView from '@/views/FirmwareUpgradeView.vue';
+import HistoryInfoView from '@/views/HistoryInfoView.vue';
 import HomeView from '@/views/HomeView.vue';
 import VedirectAdminView from '@/views/VedirectAdminView.vue';
 import PowerMeterAdminView from '@/views/PowerMeterAdminView.vue';
@@ -69,6 +71,11 @@ const router = createRouter({
             name: 'MqTT',
             component: MqttInfoView,
         },
+        {
+            path: '/info/history',
+            name: 'History',
+            component: HistoryInfoView,
+        },
         {
             path: '/info/console',
             name: 'Web Console',
@@ -104,6 +111,11 @@ const router = createRouter({
             name: 'Power limiter Settings',
             component: PowerLimiterAdminView,
         },
+        {
+            path: '/settings/energylog',
+            name: 'Energy Log Settings',
+            component: EnergyLogAdminView,
+        },
         {
             path: '/settings/battery',
             name: 'Battery Settings',
@@ -9,6 +9,7 @@ export interface CountryDef {
 export interface DtuConfig {
     serial: number;
     pollinterval: number;
+    parallel_polling: boolean;
     verbose_logging: boolean;
     nrf_enabled: boolean;
     nrf_palevel: number;
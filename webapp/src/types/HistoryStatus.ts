@@ -0,0 +1,48 @@
+export interface HistoryTier {
+    period: number;
+    capacity: number;
+    size: number;
+}
+
+export interface HistorySeriesInfo {
+    name: string;
+    tiers: HistoryTier[];
+}
+
+export interface HistoryList {
+    uptime: number;
+    series: HistorySeriesInfo[];
+}
+
+export interface HistoryData {
+    series: string;
+    duration: number;
+    age: number;
+    interval: number;
+    min: (number | null)[];
+    avg: (number | null)[];
+    max: (number | null)[];
+}
+
+export interface EnergyLogConfig {
+    enabled: boolean;
+    interval: number;
+}
+
+export interface EnergyLogInverter {
+    index: number;
+    name: string;
+}
+
+export interface EnergyLogRecord {
+    timestamp: number;
+    source: string;
+    index: number;
+    value: number;
+}
+
+export interface EnergyLogData {
+    resolution: string;
+    inverters: EnergyLogInverter[];
+    records: EnergyLogRecord[];
+}
@@ -9,6 +9,7 @@ export interface MqttConfig {
     mqtt_topic: string;
     mqtt_publish_interval: number;
     mqtt_clean_session: boolean;
+    mqtt_payload_mode: number;
     mqtt_retain: boolean;
     mqtt_tls: boolean;
     mqtt_root_ca_cert: string;
@@ -24,4 +25,8 @@ export interface MqttConfig {
     mqtt_hass_retain: boolean;
     mqtt_hass_topic: string;
     mqtt_hass_individualpanels: boolean;
+    mqtt_changefilter_enabled: boolean;
+    mqtt_changefilter_deadband: number;
+    mqtt_changefilter_deadband_absolute: number;
+    mqtt_changefilter_refresh_interval: number;
 }
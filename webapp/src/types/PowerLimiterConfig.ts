@@ -27,10 +27,14 @@ export interface PowerLimiterConfig {
     is_inverter_behind_powermeter: boolean;
     is_inverter_solar_powered: boolean;
     use_overscaling_to_compensate_shading: boolean;
+    distribute_over_all_inverters: boolean;
     inverter_serial: string;
     inverter_channel_id: number;
     target_power_consumption: number;
     target_power_consumption_hysteresis: number;
+    controller_mode: number;
+    controller_kp: number;
+    controller_ki: number;
     lower_power_limit: number;
     base_load_limit: number;
     upper_power_limit: number;
@@ -30,9 +30,15 @@ export interface PowerMeterHttpJsonConfig {
     values: Array<PowerMeterHttpJsonValue>;
 }
 
+export interface PowerMeterHttpSmlValue {
+    http_request: HttpRequestConfig;
+    enabled: boolean;
+    sign_inverted: boolean;
+}
+
 export interface PowerMeterHttpSmlConfig {
     polling_interval: number;
-    http_request: HttpRequestConfig;
+    values: Array<PowerMeterHttpSmlValue>;
 }
 
 export interface PowerMeterConfig {
@@ -0,0 +1,133 @@
+// Minimal MessagePack decoder, covering the types produced by ArduinoJson's serializeMsgPack()
+
+export function decodeMsgPack(buffer: ArrayBuffer): unknown {
+    const view = new DataView(buffer);
+    const decoder = new TextDecoder();
+    let pos = 0;
+
+    const str = (len: number): string => {
+        const value = decoder.decode(new Uint8Array(buffer, pos, len));
+        pos += len;
+        return value;
+    };
+
+    const array = (len: number): unknown[] => {
+        const value = [];
+        for (let i = 0; i < len; i++) {
+            value.push(next());
+        }
+        return value;
+    };
+
+    const map = (len: number): Record<string, unknown> => {
+        const value: Record<string, unknown> = {};
+        for (let i = 0; i < len; i++) {
+            const key = String(next());
+            value[key] = next();
+        }
+        return value;
+    };
+
+    const next = (): unknown => {
+        const type = view.getUint8(pos++);
+        let value: unknown;
+
+        if (type <= 0x7f) return type;
+        if (type >= 0xe0) return type - 0x100;
+        if ((type & 0xf0) === 0x80) return map(type & 0x0f);
+        if ((type & 0xf0) === 0x90) return array(type & 0x0f);
+        if ((type & 0xe0) === 0xa0) return str(type & 0x1f);
+
+        switch (type) {
+            case 0xc0:
+                return null;
+            case 0xc2:
+                return false;
+            case 0xc3:
+                return true;
+            case 0xca:
+                value = view.getFloat32(pos);
+                pos += 4;
+                return value;
+            case 0xcb:
+                value = view.getFloat64(pos);
+                pos += 8;
+                return value;
+            case 0xcc:
+                return view.getUint8(pos++);
+            case 0xcd:
+                value = view.getUint16(pos);
+                pos += 2;
+                return value;
+            case 0xce:
+                value = view.getUint32(pos);
+                pos += 4;
+                return value;
+            case 0xcf:
+                value = Number(view.getBigUint64(pos));
+                pos += 8;
+                return value;
+            case 0xd0:
+                return view.getInt8(pos++);
+            case 0xd1:
+                value = view.getInt16(pos);
+                pos += 2;
+                return value;
+            case 0xd2:
+                value = view.getInt32(pos);
+                pos += 4;
+                return value;
+            case 0xd3:
+                value = Number(view.getBigInt64(pos));
+                pos += 8;
+                return value;
+            case 0xd9:
+                return str(view.getUint8(pos++));
+            case 0xda:
+                pos += 2;
+                return str(view.getUint16(pos - 2));
+            case 0xdb:
+                pos += 4;
+                return str(view.getUint32(pos - 4));
+            case 0xdc:
+                pos += 2;
+                return array(view.getUint16(pos - 2));
+            case 0xdd:
+                pos += 4;
+                return array(view.getUint32(pos - 4));
+            case 0xde:
+                pos += 2;
+                return map(view.getUint16(pos - 2));
+            case 0xdf:
+                pos += 4;
+                return map(view.getUint32(pos - 4));
+        }
+
+        throw new Error('Unsupported MessagePack type 0x' + type.toString(16));
+    };
+
+    return next();
+}
+
+// Recursively merges the properties of source into target, such that
+// properties missing in source are retained in target
+export function mergeDeep(target: object, source: object) {
+    const dst = target as Record<string, unknown>;
+    const src = source as Record<string, unknown>;
+    for (const key of Object.keys(src)) {
+        const value = src[key];
+        const existing = dst[key];
+        if (
+            value !== null &&
+            typeof value === 'object' &&
+            !Array.isArray(value) &&
+            existing !== null &&
+            typeof existing === 'object' &&
+            !Array.isArray(existing)
+        ) {
+            mergeDeep(existing, value);
+        } else {
+            dst[key] = value;
+        }
+    }
+}